@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include "storage.h"
+
+/**
+ * @file cached_storage.h
+ * @brief In-memory read cache in front of any IStorage implementation
+ *
+ * The ML and analysis code queries storage in tight loops (per prediction,
+ * per club, per recommendation). CachedStorage keeps the hot working set in
+ * memory and forwards every write to the backing store before updating its
+ * own copy, so the backing store stays the source of truth.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Sizing for CachedStorage
+ */
+struct CacheConfig {
+    size_t memoryBudgetBytes = 64 * 1024 * 1024; //!< Upper bound for cached shots and profiles
+    size_t recentShotCapacity = 1000;            //!< Latest shots kept for getShotHistory
+};
+
+/**
+ * @brief Cache hit and occupancy counters
+ */
+struct CacheStats {
+    size_t hits = 0;            //!< Reads served from memory
+    size_t misses = 0;          //!< Reads forwarded to the backing store
+    size_t evictions = 0;       //!< Clubs dropped to stay within budget
+    size_t cachedClubs = 0;     //!< Clubs whose full shot history is cached
+    size_t cachedShots = 0;     //!< Shots held across all cached clubs
+    size_t memoryBytes = 0;     //!< Estimated memory used by cached shots and profiles
+};
+
+/**
+ * @brief Write-through caching decorator for IStorage
+ *
+ * Shots are indexed by club in a hash map, each club's history kept in
+ * timestamp order. A club is cached as a whole the first time it is read,
+ * and whole clubs are evicted least-recently-used first once the memory
+ * budget is exceeded, so a cached club always holds its complete history.
+ * Club profiles are cached individually; the full profile list is cached
+ * after the first getAllClubProfiles call. The recent-shot window and the
+ * profiles count towards the budget too, and are dropped once no club
+ * history is left to evict. Empty results are not cached.
+ *
+ * Hits take a shared lock only. Misses and writes reach the backing store
+ * with no lock held, and concurrent misses for the same entry wait for the
+ * one load in flight instead of repeating it.
+ *
+ * All writes must go through this decorator; changes made to the backing
+ * store directly are not seen until the affected entries are evicted or
+ * invalidate() is called.
+ */
+class CachedStorage : public IStorage {
+public:
+    /**
+     * @brief Wrap a backing store
+     * @param backing Store that receives every write, e.g. SQLiteStorage
+     * @param config Memory budget and recent-shot capacity
+     */
+    explicit CachedStorage(IStorage& backing, const CacheConfig& config = CacheConfig());
+
+    // Shot data operations
+    bool saveShotData(const ShotData& shot) override;
+    std::vector<ShotData> getShotHistory(size_t limit = 100) override;
+    std::vector<ShotData> getShotsByClub(const std::string& clubName) override;
+    std::vector<ShotData> getRecentShotsByClub(const std::string& clubName, size_t limit) override;
+
+    // Club profile operations
+    bool saveClubProfile(const ClubProfile& club) override;
+    bool updateClubProfile(const ClubProfile& club) override;
+    std::optional<ClubProfile> getClubProfile(const std::string& name) override;
+    std::vector<ClubProfile> getAllClubProfiles() override;
+
+    // Preference operations (passed through)
+    bool savePreference(const std::string& key, const std::string& value) override;
+    std::string getPreference(const std::string& key, const std::string& defaultValue = "") override;
+
+    /**
+     * @brief Drop every cached entry
+     */
+    void invalidate();
+
+    /**
+     * @brief Snapshot of cache counters
+     */
+    CacheStats getStats() const;
+
+private:
+    struct ClubShots {
+        std::vector<ShotData> shots;            // Oldest first
+        size_t bytes = 0;                       // Estimated footprint of shots and key
+        std::atomic<std::uint64_t> lastUsed{0}; // useClock_ tick of the latest read or write
+    };
+
+    /**
+     * @brief Estimated heap and inline footprint of one cached shot
+     */
+    static size_t shotBytes(const ShotData& shot);
+
+    /**
+     * @brief Estimated footprint of one cached profile, sketches included
+     */
+    static size_t profileBytes(const ClubProfile& club);
+
+    /**
+     * @brief Insert keeping timestamp order; shots usually arrive in order
+     */
+    static void insertOrdered(std::vector<ShotData>& shots, const ShotData& shot);
+
+    /**
+     * @brief Mark a club most recently used; safe under the shared lock
+     */
+    void touch(ClubShots& entry);
+
+    /**
+     * @brief Claim the load of one entry, or wait for the thread loading it
+     *
+     * Called with mutex_ held exclusively, which it may release while
+     * waiting. Returns false after another thread's load finished, so the
+     * caller must look in the cache again.
+     */
+    bool beginLoad(std::unique_lock<std::shared_mutex>& lock, const std::string& key);
+
+    /**
+     * @brief Release a load claimed by beginLoad; mutex_ held exclusively
+     */
+    void endLoad(const std::string& key);
+
+    /**
+     * @brief Load an entry outside the lock, single-flight per key
+     *
+     * @param lookup Serves the entry from the cache under the exclusive lock;
+     *               returns false if it is not cached
+     * @param load Reads the backing store; called with no lock held
+     * @param store Caches the loaded value under the exclusive lock; skipped
+     *              if a write landed or was in flight while loading
+     */
+    template <typename Lookup, typename Load, typename Store>
+    auto loadOnce(const std::string& key, Lookup lookup, Load load, Store store) -> decltype(load());
+
+    /**
+     * @brief Run a backing store write with no lock held
+     *
+     * lock must wrap mutex_ unlocked; it is held exclusively on return, so
+     * the caller can update the cache. Loads overlapping the write are not
+     * cached, so cached entries never already hold the written data.
+     */
+    template <typename Write>
+    bool writeBacking(std::unique_lock<std::shared_mutex>& lock, Write write);
+
+    /**
+     * @brief Add or remove cached bytes that are not part of a club history
+     */
+    void replaceRecent(std::vector<ShotData> shots);
+    void cacheProfile(const ClubProfile& club);
+    void dropProfiles();
+
+    /**
+     * @brief Evict until within budget: club histories least-recently-used
+     *        first, then the profiles, then the recent-shot window
+     *
+     * @param keep Club that must stay cached, typically the one just loaded
+     */
+    void enforceBudget(const std::string& keep);
+
+    IStorage& backing_;
+    CacheConfig config_;
+
+    mutable std::shared_mutex mutex_;
+    std::condition_variable_any loaded_;                // Signalled when a load ends
+    std::set<std::string> loading_;                     // Keys being loaded from the backing store
+    std::uint64_t generation_;                          // Bumped by every write and invalidate()
+    size_t writesInFlight_;                             // Backing writes running outside the lock
+    std::unordered_map<std::string, ClubShots> clubs_;  // Complete per-club histories
+    std::atomic<std::uint64_t> useClock_;               // Orders club reads for eviction
+    std::vector<ShotData> recent_;                      // Latest shots across clubs, oldest first
+    size_t recentBytes_;                                // Estimated footprint of recent_
+    bool recentLoaded_;                                 // recent_ seeded from the backing store
+    std::map<std::string, ClubProfile> profiles_;       // Cached club profiles by name
+    size_t profileBytes_;                               // Estimated footprint of profiles_
+    bool allProfilesLoaded_;                            // profiles_ holds every stored profile
+    std::atomic<size_t> hits_;                          // Counted under the shared lock
+    std::atomic<size_t> misses_;
+    CacheStats stats_;                                  // Occupancy and evictions
+};
+
+} // namespace data
+} // namespace gptgolf
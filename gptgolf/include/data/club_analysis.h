@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <map>
+#include <mutex>
 #include <optional>
 #include "storage.h"
 
@@ -51,6 +52,10 @@ struct ClubStatistics {
     double accuracyStdDev;   //!< Standard deviation of lateral deviation (meters)
     double consistencyScore; //!< Overall consistency rating (0-1)
     size_t sampleSize;       //!< Number of shots analyzed
+    double recentDistance;        //!< Exponentially weighted carry distance (meters)
+    double recentDistanceStdDev;  //!< Exponentially weighted distance deviation (meters)
+    double recentAccuracy;        //!< Exponentially weighted lateral deviation (meters)
+    double recentAccuracyStdDev;  //!< Exponentially weighted lateral spread (meters)
 
     /**
      * @brief Check if statistics are statistically significant
@@ -59,6 +64,24 @@ struct ClubStatistics {
     bool isSignificant() const { return sampleSize >= 10; }
 };
 
+/**
+ * @brief Carry and lateral percentiles of one club
+ *
+ * Read from the club's quantile sketches, so no normality assumption is
+ * made and skewed dispersions (e.g. mishit tails) show up as asymmetric
+ * ranges.
+ */
+struct ClubGapping {
+    std::string clubName;   //!< Club identifier
+    double carryP10;        //!< 10th percentile carry (meters)
+    double carryP50;        //!< Median carry (meters)
+    double carryP90;        //!< 90th percentile carry (meters)
+    double lateralP10;      //!< 10th percentile lateral deviation (meters)
+    double lateralP50;      //!< Median lateral deviation (meters)
+    double lateralP90;      //!< 90th percentile lateral deviation (meters)
+    size_t sampleSize;      //!< Shots summarized
+};
+
 /**
  * @brief Club performance analysis and recommendation engine
  *
@@ -89,6 +112,11 @@ public:
      * - Weather effects on carry distance
      * - Player consistency with each club
      * - Risk/reward tradeoffs
+     *
+     * Served from an in-memory index of clubs sorted by carry: a binary
+     * search finds the clubs nearest the target and only neighbours that
+     * could still score higher are evaluated. The index is built on first
+     * use and kept current by updateClubStatistics.
      */
     ClubRecommendation recommendClub(
         double targetDistance,
@@ -120,8 +148,9 @@ public:
      *
      * @param shot Shot data to incorporate
      *
-     * @note This method automatically triggers recalculation of
-     * affected statistics and optimal ranges.
+     * @note Runs in constant time: the club's running statistics are
+     * updated from the shot alone and persisted with its profile, so
+     * the shot history is never reloaded.
      */
     void updateClubStatistics(const ShotData& shot);
 
@@ -133,6 +162,10 @@ public:
      *
      * @return Map of club names to their optimal distance ranges (min, max)
      *
+     * Each range spans the club's p10-p90 carry from its quantile sketch
+     * (mean +/- 2 standard deviations for clubs without one), with
+     * neighbouring clubs split at the midpoint of their medians.
+     *
      * Ranges are calculated to:
      * - Maximize consistency within each range
      * - Minimize gaps between ranges
@@ -140,9 +173,88 @@ public:
      */
     std::map<std::string, std::pair<double, double>> getOptimalDistanceRanges();
 
+    /**
+     * @brief Carry and lateral percentiles for every club
+     *
+     * @return One entry per club with recorded shots, ordered by median carry
+     */
+    std::vector<ClubGapping> getDistanceGapping();
+
+    /**
+     * @brief Percentiles from the merged sketches of a set of profiles
+     *
+     * Profiles sharing a club name are merged, so profiles gathered from
+     * several sessions or players' stores give a combined, venue-wide
+     * gapping report.
+     *
+     * @param profiles Club profiles, possibly several per club name
+     * @return One entry per club name with recorded shots, ordered by median carry
+     */
+    static std::vector<ClubGapping> gappingFromProfiles(const std::vector<ClubProfile>& profiles);
+
+    /**
+     * @brief Drop the recommendation index
+     *
+     * Needed only when club profiles were changed other than through
+     * updateClubStatistics; the index is rebuilt on the next recommendation.
+     */
+    void invalidateRecommendationIndex();
+
+    /**
+     * @brief Weight of the newest shot in the recent-form statistics
+     *
+     * 2 / (N + 1) with N = 20 shots, the usual span-to-alpha conversion.
+     */
+    static constexpr double RECENT_FORM_ALPHA = 2.0 / 21.0;
+
 private:
+    /**
+     * @brief Club entry in the recommendation index
+     */
+    struct IndexedClub {
+        ClubProfile profile;    //!< Profile as last stored
+        double consistency;     //!< Cached ClubStatistics::consistencyScore
+    };
+
     IStorage& storage_; //!< Reference to shot data storage
 
+    std::mutex indexMutex_;             //!< Guards the recommendation index
+    std::vector<IndexedClub> index_;    //!< Clubs sorted by avgDistance, then name
+    double maxConsistency_ = 0.0;       //!< Highest consistency in index_
+    bool indexValid_ = false;           //!< index_ reflects stored profiles
+
+    /**
+     * @brief Load every profile into the index if it is not current
+     *
+     * Caller must hold indexMutex_.
+     */
+    void ensureIndex();
+
+    /**
+     * @brief Move one club to its new sorted position after a stats change
+     *
+     * Caller must hold indexMutex_.
+     */
+    void reindexClub(const ClubProfile& profile);
+
+    /**
+     * @brief Confidence from an adjusted carry and a consistency score
+     */
+    static double confidenceScore(double targetDistance, double adjustedDistance, double consistency);
+
+    /**
+     * @brief Build statistics from a profile's running statistics
+     *
+     * @param profile Club profile with at least one recorded sample
+     * @return Statistics without touching storage
+     */
+    static ClubStatistics statisticsFromProfile(const ClubProfile& profile);
+
+    /**
+     * @brief Fill consistencyScore from the mean and deviation fields
+     */
+    static void scoreConsistency(ClubStatistics& stats);
+
     /**
      * @brief Calculate confidence score for club recommendation
      *
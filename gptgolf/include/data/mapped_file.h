@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @file mapped_file.h
+ * @brief Portable memory-mapped files
+ *
+ * Every file that is read or written through a mapping goes through
+ * MappedFile, which hides the platform calls behind one RAII type:
+ * mmap/msync on POSIX and CreateFileMapping/MapViewOfFile on Windows.
+ * Files are opened with delete sharing on Windows, so a mapped file can
+ * be removed and existing mappings keep working, as on POSIX.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief One file mapped into memory in full
+ */
+class MappedFile {
+public:
+    enum class Mode {
+        ReadOnly,       //!< Map an existing file for reading
+        ReadWrite,      //!< Map an existing file for reading and writing
+        CreateNew       //!< Create a file that must not exist yet, then map it read-write
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Open and map a file, replacing any current mapping
+     *
+     * @param path File to map
+     * @param mode Access and creation mode
+     * @param minSize For writable modes, grow the file to at least this
+     *                many bytes, zero-filled; 0 keeps its size
+     * @return false if the file cannot be opened, sized or mapped. An empty
+     *         file opens successfully with a null data().
+     */
+    bool open(const std::string& path, Mode mode = Mode::ReadOnly, size_t minSize = 0);
+
+    /**
+     * @brief Unmap and close
+     */
+    void close();
+
+    /**
+     * @brief Unmap, cut the file to length bytes and close
+     *
+     * @param sync Flush the new length to disk before closing
+     * @return false if truncating or syncing failed; the file is closed
+     *         either way. Windows refuses to truncate a file other
+     *         mappings still view, so callers must treat this as best effort.
+     */
+    bool closeAndTruncate(size_t length, bool sync);
+
+    /**
+     * @brief Write a byte range of a writable mapping through to disk
+     *
+     * The range need not be page aligned.
+     */
+    bool flush(size_t offset, size_t length);
+
+    /**
+     * @brief Hint that the mapping will be read front to back once; no-op on Windows
+     */
+    void adviseSequential();
+
+    bool isOpen() const { return open_; }
+    char* data() const { return static_cast<char*>(data_); }
+    size_t size() const { return size_; }
+
+private:
+    void unmap();
+
+#ifdef _WIN32
+    void* file_ = nullptr;      // Kept open for writable mappings only
+#else
+    int file_ = -1;             // Kept open for writable mappings only
+#endif
+    bool open_ = false;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Append bytes to a file, creating it if needed
+ *
+ * @param sync Flush the file to disk before returning
+ */
+bool appendToFile(const std::string& path, const std::string& bytes, bool sync);
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @file online_backup.h
+ * @brief Background copies of a live database with the SQLite backup API
+ *
+ * The copy is made a few pages at a time with sqlite3_backup_step on the
+ * connection the application writes through. Each step holds that
+ * connection's lock, so a writer waits at most one step; the number of
+ * pages per step is adjusted after every step to keep it inside the
+ * configured budget. Stepping on the writer connection also means writes
+ * made during the backup are carried into the copy instead of restarting
+ * it, which is what happens when another connection modifies the source.
+ *
+ * The copy is written next to the destination with a ".partial" suffix,
+ * checked with PRAGMA integrity_check and only then renamed into place,
+ * so the destination path never holds an incomplete backup.
+ */
+
+struct sqlite3;
+struct sqlite3_backup;
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Tuning for OnlineBackup
+ */
+struct BackupOptions {
+    std::chrono::microseconds stepBudget{2000};     //!< Longest a step may hold the source connection
+    std::chrono::milliseconds stepInterval{5};      //!< Pause between steps, leaving the connection to writers
+    int initialPagesPerStep = 64;                   //!< Pages copied by the first step
+    int maxPagesPerStep = 4096;                     //!< Upper bound on the adaptive step size
+    bool verify = true;                             //!< Run an integrity check on the copy
+};
+
+/**
+ * @brief Lifecycle of a backup
+ */
+enum class BackupState {
+    Running,
+    Verifying,
+    Completed,
+    Failed,
+    Cancelled
+};
+
+/**
+ * @brief Snapshot of a backup's progress
+ */
+struct BackupProgress {
+    BackupState state = BackupState::Running;
+    int pagesTotal = 0;             //!< Source pages as of the last step
+    int pagesRemaining = 0;         //!< Pages still to copy as of the last step
+    size_t steps = 0;               //!< Backup steps taken
+    size_t busyRetries = 0;         //!< Steps that found the source or destination locked
+    int pagesPerStep = 0;           //!< Current adaptive step size
+    std::chrono::microseconds longestStep{0};   //!< Longest time the source connection was held
+    double elapsedSeconds = 0.0;    //!< Time since the backup started
+    bool verified = false;          //!< Copy passed the integrity check
+    std::string error;              //!< Reason for failure
+
+    /**
+     * @brief Fraction of pages copied, 0 to 1
+     */
+    double fraction() const {
+        return pagesTotal > 0 ? double(pagesTotal - pagesRemaining) / pagesTotal : 0.0;
+    }
+
+    bool finished() const {
+        return state == BackupState::Completed || state == BackupState::Failed ||
+               state == BackupState::Cancelled;
+    }
+};
+
+/**
+ * @brief One backup of a live database, copied on a background thread
+ *
+ * The source connection and its mutex must outlive the backup. Destroying
+ * an unfinished backup cancels it and removes the partial copy.
+ */
+class OnlineBackup {
+public:
+    /**
+     * @brief Start copying a database
+     *
+     * @param source Connection to copy from, normally the writer connection
+     * @param sourceMutex Lock the application holds while using source
+     * @param destinationPath File that receives the copy once verified
+     * @param options Step budget and verification settings
+     */
+    OnlineBackup(sqlite3* source, std::mutex& sourceMutex, const std::string& destinationPath,
+                 const BackupOptions& options = BackupOptions());
+    ~OnlineBackup();
+
+    OnlineBackup(const OnlineBackup&) = delete;
+    OnlineBackup& operator=(const OnlineBackup&) = delete;
+
+    /**
+     * @brief Current progress
+     */
+    BackupProgress progress() const;
+
+    /**
+     * @brief Block until the backup finishes
+     * @return true if the copy completed and, when enabled, verified
+     */
+    bool wait();
+
+    /**
+     * @brief Stop the backup and remove the partial copy
+     */
+    void cancel();
+
+    const std::string& destinationPath() const { return destinationPath_; }
+
+private:
+    /**
+     * @brief Backup thread main loop
+     */
+    void run();
+
+    /**
+     * @brief Copy pages until done, cancelled or failed
+     * @return true if every page was copied
+     */
+    bool copyPages(sqlite3* destination);
+
+    /**
+     * @brief Flush the finished copy to disk
+     */
+    bool syncCopy(sqlite3* destination);
+
+    /**
+     * @brief Check the finished copy with PRAGMA integrity_check
+     */
+    bool verifyCopy(sqlite3* destination);
+
+    /**
+     * @brief Record the final state and wake waiters
+     */
+    void finish(BackupState state, const std::string& error = "");
+
+    sqlite3* source_;
+    std::mutex& sourceMutex_;
+    std::string destinationPath_;
+    std::string partialPath_;
+    BackupOptions options_;
+    std::chrono::steady_clock::time_point started_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    BackupProgress progress_;
+    bool stopping_;
+
+    std::thread worker_;
+};
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "launch_monitor.h"
+#include "storage.h"
+
+/**
+ * @file packed_shot.h
+ * @brief Compact fixed-size shot records for large in-memory working sets
+ *
+ * ShotData spends 8 bytes on every quantity, carries a std::string per
+ * shot for the club and, for LaunchMonitorData, another for the quality
+ * rating. The packed records keep quantities as float32, whose 24-bit
+ * mantissa resolves a 300 m carry to about 0.02 mm and a 10000 rpm spin to
+ * 0.001 rpm, far finer than any launch monitor measures. Club names become
+ * ids into a shared ClubNameTable and quality ratings a one-byte code.
+ *
+ * Packing rounds each quantity to the nearest float; everything else is
+ * kept exactly. Unpacking is exact, so a record survives any number of
+ * unpack/pack round trips unchanged.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Measurement quality grade of a shot
+ *
+ * Matches the launch monitors' "Good"/"Partial"/"Poor" rating.
+ */
+enum class ShotQuality : std::uint8_t {
+    Good,       //!< Every launch measurement present and plausible
+    Partial,    //!< Carry recorded but some launch data missing
+    Poor,       //!< No usable carry
+    Unknown     //!< No rating reported
+};
+
+/**
+ * @brief Quality code of a launch monitor rating string
+ * @return ShotQuality::Unknown for anything but "Good", "Partial" or "Poor"
+ */
+ShotQuality parseShotQuality(const std::string& rating);
+
+/**
+ * @brief Rating string of a quality code, empty for ShotQuality::Unknown
+ */
+const char* shotQualityName(ShotQuality quality);
+
+/**
+ * @brief Index of an interned club name
+ */
+using ClubId = std::uint16_t;
+
+/**
+ * @brief Intern table mapping club names to dense ClubIds
+ *
+ * Ids are assigned in first-seen order and never change, so records packed
+ * against one table stay valid while it grows. Safe for concurrent use;
+ * lookups of known names only take a shared lock.
+ */
+class ClubNameTable {
+public:
+    static constexpr size_t MAX_CLUBS = 65536;
+
+    /**
+     * @brief Id of a name, adding it if it is new
+     * @throws std::length_error once MAX_CLUBS names are interned
+     */
+    ClubId intern(const std::string& name);
+
+    /**
+     * @brief Id of a name already in the table
+     */
+    std::optional<ClubId> find(const std::string& name) const;
+
+    /**
+     * @brief Name of an interned id; the reference stays valid for the table's lifetime
+     * @throws std::out_of_range for ids the table never assigned
+     */
+    const std::string& name(ClubId id) const;
+
+    size_t size() const;
+
+    /**
+     * @brief Approximate heap footprint
+     */
+    size_t sizeInBytes() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, ClubId> ids_;
+    std::deque<std::string> names_;     // By id; deque keeps references stable
+};
+
+/**
+ * @brief ShotData packed into 72 bytes
+ */
+struct PackedShot {
+    std::int64_t timestamp;         //!< ShotData::timestamp
+    std::int64_t weatherTimestamp;  //!< conditions.timestamp
+    float initialVelocity;          //!< m/s
+    float spinRate;                 //!< rpm
+    float launchAngle;              //!< degrees
+    float actualDistance;           //!< m
+    float predictedDistance;        //!< m
+    float lateralDeviation;         //!< m
+    float temperature;              //!< Celsius
+    float humidity;                 //!< %
+    float pressure;                 //!< hPa
+    float windSpeed;                //!< m/s
+    float windDirection;            //!< degrees
+    float precipitation;            //!< mm/hr
+    float altitude;                 //!< m
+    ClubId club;                    //!< Id in the ClubNameTable used to pack
+
+    static PackedShot pack(const ShotData& shot, ClubNameTable& clubs);
+    ShotData unpack(const ClubNameTable& clubs) const;
+};
+
+/**
+ * @brief LaunchMonitorData packed into 76 bytes
+ */
+struct PackedLaunchData {
+    float ballSpeed;
+    float launchAngle;
+    float launchDirection;
+    float spinRate;
+    float spinAxis;
+    float smashFactor;
+    float ballVertical;
+    float ballHorizontal;
+    float carryDistance;
+    float totalDistance;
+    float maxHeight;
+    float landingAngle;
+    float clubSpeed;
+    float clubPath;
+    float faceAngle;
+    float attackAngle;
+    float dynamicLoft;
+    float confidence;
+    ShotQuality quality;
+
+    static PackedLaunchData pack(const LaunchMonitorData& data);
+    LaunchMonitorData unpack() const;
+};
+
+/**
+ * @brief Append-only array of packed shots with its own club table
+ *
+ * Not synchronized: any number of threads may read while no thread appends.
+ */
+class PackedShotStore {
+public:
+    void reserve(size_t shots) { shots_.reserve(shots); }
+    void append(const ShotData& shot) { shots_.push_back(PackedShot::pack(shot, clubs_)); }
+
+    size_t size() const { return shots_.size(); }
+    const PackedShot& operator[](size_t index) const { return shots_[index]; }
+    ShotData at(size_t index) const { return shots_.at(index).unpack(clubs_); }
+
+    const ClubNameTable& clubs() const { return clubs_; }
+
+    /**
+     * @brief Bytes held by the records and the club table
+     */
+    size_t sizeInBytes() const;
+
+private:
+    ClubNameTable clubs_;
+    std::vector<PackedShot> shots_;
+};
+
+/**
+ * @brief Approximate bytes one ShotData takes, including its club name buffer
+ */
+size_t shotDataFootprint(const ShotData& shot);
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Mergeable streaming quantile sketch (merging t-digest)
+ *
+ * Summarizes a stream of values as a bounded set of weighted centroids.
+ * Centroids near the tails are kept small, so extreme quantiles such as
+ * p10 and p90 stay accurate while the sketch needs at most a few hundred
+ * bytes no matter how many values it has seen. Two sketches can be merged
+ * into one that summarizes both streams, which lets per-session or
+ * per-player sketches be combined into venue-wide reports.
+ */
+class QuantileSketch {
+public:
+    static constexpr double DEFAULT_COMPRESSION = 100.0;
+
+    /**
+     * @param compression Accuracy/size tradeoff; roughly the number of centroids kept
+     */
+    explicit QuantileSketch(double compression = DEFAULT_COMPRESSION);
+
+    /**
+     * @brief Add one value, optionally repeated weight times
+     */
+    void add(double value, std::uint64_t weight = 1);
+
+    /**
+     * @brief Fold another sketch into this one
+     */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * @brief Fold buffered values into the centroids
+     *
+     * Reads stay correct without this, but on a sketch with buffered
+     * values each one merges a temporary copy. Call it before sharing a
+     * sketch with readers.
+     */
+    void flush();
+
+    /**
+     * @brief Estimate the value at quantile q
+     *
+     * @param q Quantile in [0, 1]; 0.5 is the median
+     * @return Estimated value, NaN if the sketch is empty
+     */
+    double quantile(double q) const;
+
+    std::uint64_t count() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+
+    /**
+     * @brief Number of centroids after folding in buffered values
+     */
+    size_t centroidCount() const;
+
+    /**
+     * @brief Compact binary form for persistence
+     *
+     * Centroid means are stored as 32-bit floats, which is far below the
+     * sketch's own approximation error for distances in meters.
+     */
+    std::vector<std::uint8_t> serialize() const;
+
+    /**
+     * @brief Rebuild a sketch written by serialize()
+     * @return std::nullopt if the data is truncated or from another format
+     */
+    static std::optional<QuantileSketch> deserialize(const void* data, size_t size);
+
+private:
+    struct Centroid {
+        double mean;
+        std::uint64_t weight;
+    };
+
+    /**
+     * @brief Centroids with the buffered values merged in, leaving this sketch unchanged
+     *
+     * Const reads use this instead of compressing in place, so a shared
+     * const sketch can be read from several threads.
+     */
+    std::vector<Centroid> mergedCentroids() const;
+
+    /**
+     * @brief Read the centroids, merging buffered values into scratch if there are any
+     */
+    const std::vector<Centroid>& summary(std::vector<Centroid>& scratch) const;
+
+    double compression_;
+    std::vector<Centroid> centroids_;   // Sorted by mean
+    std::vector<Centroid> buffer_;      // Values not yet merged
+    std::uint64_t count_;
+    double min_;
+    double max_;
+};
+
+} // namespace data
+} // namespace gptgolf
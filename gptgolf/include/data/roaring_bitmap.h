@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file roaring_bitmap.h
+ * @brief Compressed bitmap of 32-bit row ids (roaring layout)
+ *
+ * Row ids are split into a 16-bit key and a 16-bit offset. Each key owns
+ * one container holding the offsets present under it: a sorted array of
+ * offsets while the container is sparse, or a 65536-bit bitmap once it
+ * holds more than ARRAY_LIMIT values. Sparse filters stay small, dense
+ * ones are processed a machine word at a time.
+ */
+
+namespace gptgolf {
+namespace data {
+
+class RoaringBitmap {
+public:
+    /**
+     * @brief Largest array container; denser containers switch to a bitmap
+     *
+     * 4096 uint16 offsets take the same 8 KB as a full bitmap container.
+     */
+    static constexpr size_t ARRAY_LIMIT = 4096;
+
+    RoaringBitmap() = default;
+
+    /**
+     * @brief Bitmap holding every id in [begin, end)
+     */
+    static RoaringBitmap range(std::uint32_t begin, std::uint32_t end);
+
+    /**
+     * @brief Insert one id; appending in increasing order is cheapest
+     */
+    void add(std::uint32_t value);
+
+    bool contains(std::uint32_t value) const;
+    std::uint64_t cardinality() const;
+    bool empty() const { return keys_.empty(); }
+
+    /**
+     * @brief Approximate heap footprint
+     */
+    size_t sizeInBytes() const;
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const;
+    RoaringBitmap operator|(const RoaringBitmap& other) const;
+    RoaringBitmap& operator&=(const RoaringBitmap& other) { return *this = *this & other; }
+    RoaringBitmap& operator|=(const RoaringBitmap& other) { return *this = *this | other; }
+
+    bool operator==(const RoaringBitmap& other) const;
+
+    /**
+     * @brief Call f(id) for every id in increasing order
+     */
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            std::uint32_t high = static_cast<std::uint32_t>(keys_[i]) << 16;
+            const Container& container = containers_[i];
+            if (container.isBitmap()) {
+                for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+                    std::uint64_t bits = container.words[word];
+                    while (bits) {
+                        f(high | static_cast<std::uint32_t>(word * 64 + __builtin_ctzll(bits)));
+                        bits &= bits - 1;
+                    }
+                }
+            } else {
+                for (std::uint16_t low : container.array) {
+                    f(high | low);
+                }
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> toVector() const;
+
+private:
+    static constexpr size_t BITMAP_WORDS = 65536 / 64;
+
+    struct Container {
+        std::vector<std::uint16_t> array;   // Sorted offsets while sparse
+        std::vector<std::uint64_t> words;   // BITMAP_WORDS words once dense
+        std::uint32_t cardinality = 0;
+
+        bool isBitmap() const { return !words.empty(); }
+        void add(std::uint16_t low);
+        bool contains(std::uint16_t low) const;
+        void toBitmap();
+        void toArrayIfSparse();
+    };
+
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+
+    std::vector<std::uint16_t> keys_;       // Sorted container keys
+    std::vector<Container> containers_;     // Parallel to keys_
+};
+
+} // namespace data
+} // namespace gptgolf
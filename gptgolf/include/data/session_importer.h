@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "launch_monitor.h"
+#include "sqlite_storage.h"
+
+/**
+ * @file session_importer.h
+ * @brief Parallel bulk import of TrackMan and GCQuad session exports
+ *
+ * The export file is mapped into memory and cut into chunks on record
+ * boundaries. Worker threads parse the chunks independently into
+ * LaunchMonitorData, check each shot with the launch monitors' ball data
+ * validation and convert it to ShotData; the results are then inserted in
+ * file order through SQLiteStorage::bulkInsertShots.
+ *
+ * CSV exports are read by header name, so column order does not matter.
+ * Units are taken from the header ("Ball Speed [mph]", "Carry (yds)") or
+ * from a units row directly below it, and converted to the metric units
+ * used internally. JSON exports are an array of flat objects, or one
+ * object per line, keyed by the same names as the CSV headers.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Layout of an export file
+ */
+enum class ExportFormat {
+    Auto,   //!< JSON if the first non-blank character is '[' or '{', CSV otherwise
+    Csv,
+    Json
+};
+
+/**
+ * @brief Tuning for SessionImporter
+ */
+struct ImportOptions {
+    ExportFormat format = ExportFormat::Auto;
+    size_t threads = 0;                     //!< Parser threads, 0 for one per hardware thread
+    size_t chunkBytes = 1 << 20;            //!< Target input bytes per parse task
+    size_t transactionRows = 100000;        //!< Rows per insert transaction
+    bool deferIndexes = true;               //!< Rebuild shot indexes once after loading
+    std::time_t fallbackTimestamp = 0;      //!< Timestamp of rows without a date, 0 for import time
+};
+
+/**
+ * @brief Outcome of one import
+ */
+struct ImportReport {
+    bool success = false;       //!< File was read and every accepted row committed
+    std::string error;          //!< Reason for failure
+    size_t rowsRead = 0;        //!< Data rows found in the file
+    size_t rowsImported = 0;    //!< Rows committed to storage
+    size_t rowsRejected = 0;    //!< Rows failing ball data validation
+    double parseSeconds = 0.0;  //!< Time spent mapping and parsing
+    double insertSeconds = 0.0; //!< Time spent in SQLite
+
+    /**
+     * @brief Rows read per second of total import time
+     */
+    double rowsPerSecond() const {
+        double seconds = parseSeconds + insertSeconds;
+        return seconds > 0.0 ? rowsRead / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Loads launch monitor session exports into shot storage
+ */
+class SessionImporter {
+public:
+    explicit SessionImporter(SQLiteStorage& storage, const ImportOptions& options = ImportOptions());
+
+    /**
+     * @brief Parse, validate and store every shot in an export file
+     */
+    ImportReport importFile(const std::string& path);
+
+    /**
+     * @brief Parse and validate an export already in memory, without storing it
+     *
+     * @param data Export contents
+     * @param size Length of data in bytes
+     * @param report Receives row counts and timing; success is set on return
+     * @return Accepted shots in file order
+     */
+    std::vector<ShotData> parse(const char* data, size_t size, ImportReport& report) const;
+
+private:
+    SQLiteStorage& storage_;
+    ImportOptions options_;
+};
+
+} // namespace data
+} // namespace gptgolf
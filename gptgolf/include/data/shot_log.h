@@ -0,0 +1,354 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+#include "sqlite_storage.h"
+
+/**
+ * @file shot_log.h
+ * @brief Memory-mapped append-only shot log
+ *
+ * Ingest path for peak shot rates. Shots are packed into fixed-size records
+ * and copied straight into a memory-mapped segment file; making them durable
+ * costs one msync per commit instead of a SQLite transaction. Full or aged
+ * segments are sealed, and ShotLogCompactor later copies sealed segments
+ * into SQLite where the indexed queries live.
+ *
+ * Directory layout:
+ *   clubs.dict                  Interned club names, one per line, id = line number
+ *   segments.seq                Highest segment id ever allocated, so ids are never reused
+ *   segment-<id>.log            SegmentHeader followed by ShotRecord slots
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Fixed-size on-disk form of ShotData
+ *
+ * The club name is replaced by its id in the log's club dictionary. All
+ * other fields are stored at full precision, so conversion is lossless.
+ */
+struct ShotRecord {
+    std::int64_t timestamp;         //!< When the shot was taken
+    std::int64_t weatherTimestamp;  //!< Time of the weather measurement
+    double initialVelocity;         //!< m/s
+    double spinRate;                //!< rpm
+    double launchAngle;             //!< degrees
+    double temperature;             //!< °C
+    double humidity;                //!< %
+    double pressure;                //!< hPa
+    double windSpeed;               //!< m/s
+    double windDirection;           //!< degrees
+    double precipitation;           //!< mm/hr
+    double altitude;                //!< m
+    double actualDistance;          //!< m
+    double predictedDistance;       //!< m
+    double lateralDeviation;        //!< m
+    std::uint32_t clubId;           //!< Index into the club dictionary
+    std::uint32_t reserved;         //!< Zero, keeps the record 8-byte aligned
+};
+
+static_assert(sizeof(ShotRecord) == 128, "ShotRecord layout is part of the file format");
+
+/**
+ * @brief Header at the start of every segment file
+ *
+ * committed is the crash-safe commit marker: records at or past it are
+ * ignored on recovery. It is only advanced after the records below it have
+ * been synced, and being 8-byte aligned inside the first page it is never
+ * torn.
+ */
+struct SegmentHeader {
+    char magic[8];                          //!< "GGSHTLOG"
+    std::uint32_t version;                  //!< File format version
+    std::uint32_t recordSize;               //!< sizeof(ShotRecord) when written
+    std::uint64_t segmentId;                //!< Matches the file name
+    std::uint64_t capacity;                 //!< Record slots in the file
+    std::atomic<std::uint64_t> committed;   //!< Records made durable
+    std::atomic<std::uint32_t> sealed;      //!< Non-zero once no more records will be added
+    std::uint32_t reserved;
+    std::int64_t createdAt;                 //!< Unix time the segment was opened
+    std::uint8_t padding[8];
+};
+
+static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader layout is part of the file format");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Commit marker must be lock-free to live in shared memory");
+
+/**
+ * @brief Read-only, zero-copy view of the committed records of one segment
+ *
+ * The view maps the segment file itself and exposes its records in place.
+ * It sees the records committed when it was opened; a view of the active
+ * segment does not grow as more records are committed. Views stay valid
+ * even if the segment is later compacted and deleted.
+ */
+class SegmentView {
+public:
+    SegmentView() = default;
+
+    SegmentView(SegmentView&& other) noexcept;
+    SegmentView& operator=(SegmentView&& other) noexcept;
+    SegmentView(const SegmentView&) = delete;
+    SegmentView& operator=(const SegmentView&) = delete;
+
+    std::uint64_t segmentId() const { return segmentId_; }
+    bool sealed() const { return sealed_; }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    const ShotRecord* begin() const { return records_; }
+    const ShotRecord* end() const { return records_ + count_; }
+    const ShotRecord& operator[](size_t index) const { return records_[index]; }
+
+private:
+    friend class ShotLog;
+
+    MappedFile file_;
+    const ShotRecord* records_ = nullptr;
+    size_t count_ = 0;
+    std::uint64_t segmentId_ = 0;
+    bool sealed_ = false;
+};
+
+/**
+ * @brief Segment sizing and sealing policy
+ */
+struct ShotLogConfig {
+    size_t recordsPerSegment = 65536;               //!< Record slots per segment file (8 MiB)
+    std::chrono::seconds maxSegmentAge{300};        //!< Seal the active segment once it is this old
+    bool syncOnCommit = true;                       //!< msync records and marker on every commit
+};
+
+/**
+ * @brief Append-only log of shots in memory-mapped segment files
+ *
+ * One writer appends and commits; any thread may open views of committed
+ * records. Appended records become visible to readers and survive a crash
+ * only once commit() returns; records appended after the last commit are
+ * discarded when the log is reopened.
+ */
+class ShotLog {
+public:
+    /**
+     * @brief Open or create a log directory
+     *
+     * Recovers the active segment from its commit marker.
+     *
+     * @param directory Directory holding the segment files
+     * @param config Segment sizing and sealing policy
+     * @throws std::runtime_error if the directory or a segment cannot be opened
+     */
+    explicit ShotLog(const std::string& directory, const ShotLogConfig& config = ShotLogConfig());
+
+    /**
+     * @brief Unmap the active segment without committing pending records
+     */
+    ~ShotLog();
+
+    ShotLog(const ShotLog&) = delete;
+    ShotLog& operator=(const ShotLog&) = delete;
+
+    /**
+     * @brief Copy a shot into the active segment
+     *
+     * Seals the active segment first if it is full or older than
+     * maxSegmentAge; sealing commits whatever was pending.
+     *
+     * @return false if a new segment could not be created
+     */
+    bool append(const ShotData& shot);
+
+    /**
+     * @brief Make every appended record durable and visible to readers
+     * @return false if syncing the segment failed
+     */
+    bool commit();
+
+    /**
+     * @brief Commit and close the active segment, starting a new one on the next append
+     */
+    bool seal();
+
+    /**
+     * @brief Ids of sealed segments still on disk, oldest first
+     */
+    std::vector<std::uint64_t> sealedSegments() const;
+
+    /**
+     * @brief Ids of the newest segments on disk including the active one, oldest first
+     *
+     * @param count Maximum number of segments
+     */
+    std::vector<std::uint64_t> recentSegments(size_t count) const;
+
+    /**
+     * @brief Map the committed records of a segment
+     *
+     * @return View of the segment, empty if the segment does not exist
+     */
+    SegmentView openSegment(std::uint64_t segmentId) const;
+
+    /**
+     * @brief Delete a sealed segment file
+     *
+     * Open views of the segment remain readable.
+     *
+     * @return false if the segment is active or unknown
+     */
+    bool removeSegment(std::uint64_t segmentId);
+
+    /**
+     * @brief Never allocate a segment id at or below the given one
+     *
+     * Lets the compactor carry its checkpoint over to a directory whose
+     * segment files and sequence file were removed.
+     */
+    void reserveSegmentIds(std::uint64_t through);
+
+    /**
+     * @brief Expand a record back into ShotData
+     */
+    ShotData toShotData(const ShotRecord& record) const;
+
+    /**
+     * @brief Name interned under an id, or empty if unknown
+     */
+    std::string clubName(std::uint32_t clubId) const;
+
+private:
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    std::string segmentPath(std::uint64_t segmentId) const;
+
+    /**
+     * @brief Durably record segmentId as the highest id allocated
+     */
+    bool writeSequence(std::uint64_t segmentId);
+
+    /**
+     * @brief Id of a club, appending it to the dictionary file if new
+     *
+     * Caller must hold mutex_.
+     */
+    bool internClub(const std::string& name, std::uint32_t& clubId);
+
+    /**
+     * @brief Create and map a new active segment
+     *
+     * Caller must hold mutex_.
+     */
+    bool openNewSegment();
+
+    /**
+     * @brief Map an existing unsealed segment as the active one after restart
+     *
+     * Caller must hold mutex_.
+     */
+    bool recoverSegment(std::uint64_t segmentId);
+
+    /**
+     * @brief Commit, mark sealed and trim the active segment to its records
+     *
+     * Caller must hold mutex_.
+     */
+    bool sealActive();
+
+    bool commitLocked();
+    void closeActive();
+
+    std::string directory_;
+    ShotLogConfig config_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> clubNames_;                     // Dictionary by id
+    std::unordered_map<std::string, std::uint32_t> clubIds_; // Dictionary by name
+    std::vector<std::uint64_t> sealed_;                      // Sealed segment ids, ascending
+    std::uint64_t nextSegmentId_;
+
+    // Active segment, if any
+    std::uint64_t activeId_;
+    MappedFile active_;
+    SegmentHeader* header_;
+    ShotRecord* records_;
+    std::uint64_t written_;         // Records appended, >= header_->committed
+};
+
+/**
+ * @brief Background mover of sealed log segments into SQLite
+ */
+struct ShotLogCompactorConfig {
+    std::chrono::milliseconds interval{5000};   //!< Time between compaction passes
+    size_t retainSegments = 4;                  //!< Compacted segments kept on disk for log scans
+};
+
+/**
+ * @brief Copies sealed segments into SQLite on a background thread
+ *
+ * Each segment is inserted in one transaction together with a checkpoint
+ * preference naming it, so a segment is stored exactly once even if the
+ * process stops between compaction and deleting the file. Only segments
+ * known to be stored, by this compactor or before the checkpoint it
+ * resumed from, are ever deleted.
+ */
+class ShotLogCompactor {
+public:
+    /**
+     * @brief Start the compaction thread
+     *
+     * @param log Log to drain; must outlive the compactor
+     * @param storage Destination; must outlive the compactor
+     * @param config Pass interval and segment retention
+     */
+    ShotLogCompactor(ShotLog& log, SQLiteStorage& storage,
+                     const ShotLogCompactorConfig& config = ShotLogCompactorConfig());
+
+    /**
+     * @brief Stop the compaction thread after its current pass
+     */
+    ~ShotLogCompactor();
+
+    ShotLogCompactor(const ShotLogCompactor&) = delete;
+    ShotLogCompactor& operator=(const ShotLogCompactor&) = delete;
+
+    /**
+     * @brief Run one compaction pass on the calling thread
+     * @return Number of segments copied into SQLite
+     */
+    size_t compactNow();
+
+    /**
+     * @brief Highest segment id stored in SQLite, 0 if none
+     */
+    std::uint64_t compactedThrough() const;
+
+    static constexpr const char* CHECKPOINT_KEY = "shot_log.compacted_through";
+
+private:
+    void run();
+
+    ShotLog& log_;
+    SQLiteStorage& storage_;
+    ShotLogCompactorConfig config_;
+
+    std::mutex passMutex_;          // Serializes compaction passes
+    std::atomic<std::uint64_t> compactedThrough_;
+    std::vector<std::uint64_t> stored_;     // Stored segments still on disk, ascending
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    std::thread worker_;
+};
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "packed_shot.h"
+#include "roaring_bitmap.h"
+#include "sqlite_storage.h"
+
+/**
+ * @file shot_query.h
+ * @brief In-memory, bitmap-indexed shot analytics
+ *
+ * ShotQueryEngine holds the shot history as numeric column arrays with one
+ * roaring bitmap per club, session, wind band, temperature band and
+ * quality grade. Filters combine those bitmaps with AND/OR, and aggregates
+ * run over the selected rows of a column, so dashboard queries over
+ * millions of shots never touch SQLite.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Default quality grading from the values stored with a shot
+ *
+ * ShotData does not carry the launch monitor's rating, so the engine
+ * derives it with ShotQueryConfig::classify.
+ */
+ShotQuality classifyShotQuality(const ShotData& shot);
+
+/**
+ * @brief Numeric columns available to aggregates
+ */
+enum class ShotMetric {
+    Carry,              //!< ShotData::actualDistance (m)
+    Lateral,            //!< ShotData::lateralDeviation (m)
+    PredictionError,    //!< actualDistance - predictedDistance (m)
+    BallSpeed,          //!< ShotData::initialVelocity (m/s)
+    SpinRate,           //!< ShotData::spinRate (rpm)
+    LaunchAngle,        //!< ShotData::launchAngle (degrees)
+    WindSpeed,          //!< Conditions wind speed (m/s)
+    Temperature         //!< Conditions temperature (Celsius)
+};
+
+/**
+ * @brief Binning and session rules of a ShotQueryEngine
+ */
+struct ShotQueryConfig {
+    std::time_t sessionGap = 2 * 3600;      //!< A longer pause between shots starts a new session (s)
+    double windBandWidth = 2.0;             //!< Width of one wind speed band (m/s)
+    double temperatureBandWidth = 5.0;      //!< Width of one temperature band (Celsius)
+    std::function<ShotQuality(const ShotData&)> classify = classifyShotQuality; //!< Quality grading
+};
+
+/**
+ * @brief Boolean filter over indexed dimensions
+ *
+ * Leaves select one dimension value or range; && and || combine them.
+ * Range bounds are inclusive.
+ */
+class ShotFilter {
+public:
+    static ShotFilter all();
+    static ShotFilter club(const std::string& name);
+    static ShotFilter dateRange(std::time_t since, std::time_t until);
+    static ShotFilter session(std::uint32_t id);
+    static ShotFilter windSpeed(double min, double max);
+    static ShotFilter temperature(double min, double max);
+    static ShotFilter quality(ShotQuality grade);
+
+    ShotFilter operator&&(const ShotFilter& other) const;
+    ShotFilter operator||(const ShotFilter& other) const;
+
+private:
+    friend class ShotQueryEngine;
+
+    enum class Kind { All, Club, Date, Session, Wind, Temperature, Quality, And, Or };
+
+    struct Node {
+        Kind kind;
+        std::string club;
+        double min = 0.0;
+        double max = 0.0;
+        std::shared_ptr<const Node> left;
+        std::shared_ptr<const Node> right;
+    };
+
+    explicit ShotFilter(std::shared_ptr<const Node> node) : node_(std::move(node)) {}
+
+    std::shared_ptr<const Node> node_;
+};
+
+/**
+ * @brief Summary of one metric over a set of rows
+ *
+ * All fields except count are NaN when no rows match.
+ */
+struct ShotAggregate {
+    size_t count = 0;
+    double mean = std::numeric_limits<double>::quiet_NaN();
+    double stdDev = std::numeric_limits<double>::quiet_NaN();
+    double min = std::numeric_limits<double>::quiet_NaN();
+    double max = std::numeric_limits<double>::quiet_NaN();
+    double p10 = std::numeric_limits<double>::quiet_NaN();
+    double p50 = std::numeric_limits<double>::quiet_NaN();
+    double p90 = std::numeric_limits<double>::quiet_NaN();
+};
+
+/**
+ * @brief Columnar shot table with bitmap indexes
+ *
+ * Rows are numbered in append order, which must be chronological; that
+ * keeps date filters a binary search and lets sessions be assigned as
+ * shots arrive. Not synchronized: any number of threads may query while
+ * no thread appends.
+ */
+class ShotQueryEngine {
+public:
+    explicit ShotQueryEngine(const ShotQueryConfig& config = ShotQueryConfig());
+
+    /**
+     * @brief Index every stored shot, oldest first
+     * @return Number of shots added
+     */
+    size_t load(SQLiteStorage& storage);
+
+    /**
+     * @brief Add one shot as the newest row
+     * @return false if the shot is older than the newest row; rebuild instead
+     */
+    bool append(const ShotData& shot);
+
+    size_t rowCount() const { return timestamps_.size(); }
+    size_t sessionCount() const { return sessionStarts_.size(); }
+
+    /**
+     * @brief Timestamp of the first shot of a session
+     */
+    std::time_t sessionStart(std::uint32_t id) const { return sessionStarts_.at(id); }
+
+    /**
+     * @brief Rows matching a filter
+     */
+    RoaringBitmap select(const ShotFilter& filter) const;
+
+    /**
+     * @brief Count, mean, spread and percentiles of a metric over some rows
+     */
+    ShotAggregate aggregate(const RoaringBitmap& rows, ShotMetric metric) const;
+
+    /**
+     * @brief aggregate() for the rows matching a filter
+     */
+    ShotAggregate aggregate(const ShotFilter& filter, ShotMetric metric) const {
+        return aggregate(select(filter), metric);
+    }
+
+    /**
+     * @brief Per-club aggregates of the rows matching a filter
+     */
+    std::map<std::string, ShotAggregate> aggregateByClub(const ShotFilter& filter, ShotMetric metric) const;
+
+    /**
+     * @brief Approximate memory held by columns and indexes
+     */
+    size_t sizeInBytes() const;
+
+private:
+    RoaringBitmap evaluate(const ShotFilter::Node& node) const;
+    RoaringBitmap bandRange(const std::map<std::int32_t, RoaringBitmap>& bands, double width,
+                            const std::vector<float>& column, double min, double max) const;
+    const std::vector<float>& column(ShotMetric metric) const;
+
+    ShotQueryConfig config_;
+
+    // Columns, one entry per row
+    std::vector<std::int64_t> timestamps_;
+    std::vector<float> carry_;
+    std::vector<float> lateral_;
+    std::vector<float> predictionError_;
+    std::vector<float> ballSpeed_;
+    std::vector<float> spinRate_;
+    std::vector<float> launchAngle_;
+    std::vector<float> windSpeed_;
+    std::vector<float> temperature_;
+
+    // Indexes
+    std::unordered_map<std::string, std::uint32_t> clubIds_;
+    std::vector<std::string> clubNames_;
+    std::vector<RoaringBitmap> clubRows_;                   // By club id
+    std::vector<RoaringBitmap> sessionRows_;                // By session id
+    std::vector<std::time_t> sessionStarts_;                // By session id
+    std::map<std::int32_t, RoaringBitmap> windBands_;       // By floor(speed / windBandWidth)
+    std::map<std::int32_t, RoaringBitmap> temperatureBands_; // By floor(temperature / temperatureBandWidth)
+    RoaringBitmap qualityRows_[4];                          // By ShotQuality
+};
+
+} // namespace data
+} // namespace gptgolf
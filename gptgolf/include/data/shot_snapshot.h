@@ -0,0 +1,297 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+#include "sqlite_storage.h"
+
+/**
+ * @file shot_snapshot.h
+ * @brief Columnar shot snapshot files for training and analytics scans
+ *
+ * A snapshot holds the shot history in fixed-size row blocks. Inside a
+ * block every column is one contiguous array (PAX layout), and a footer
+ * records each block's min/max per column plus the set of clubs it
+ * contains. Readers map the file and use these zone maps to skip blocks
+ * that cannot match a predicate, then read the surviving column arrays in
+ * place.
+ *
+ * File layout:
+ *   SnapshotFileHeader
+ *   block 0: uint32 club ids[rows], padding to 8 bytes, double column[rows] x SNAPSHOT_COLUMN_COUNT
+ *   block 1 ...
+ *   footer:  SnapshotBlockInfo[blockCount], club dictionary (uint32 length + bytes per name)
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Numeric columns of a snapshot, in file order
+ *
+ * Timestamps are stored as doubles, which is exact for any Unix time.
+ */
+enum class SnapshotColumn : std::uint32_t {
+    Timestamp,
+    WeatherTimestamp,
+    InitialVelocity,
+    SpinRate,
+    LaunchAngle,
+    Temperature,
+    Humidity,
+    Pressure,
+    WindSpeed,
+    WindDirection,
+    Precipitation,
+    Altitude,
+    ActualDistance,
+    PredictedDistance,
+    LateralDeviation
+};
+
+constexpr size_t SNAPSHOT_COLUMN_COUNT = 15;
+
+/**
+ * @brief Fixed header at offset 0 of a snapshot file
+ */
+struct SnapshotFileHeader {
+    char magic[8];                  //!< "GGSHTCOL"
+    std::uint32_t version;          //!< File format version
+    std::uint32_t columnCount;      //!< SNAPSHOT_COLUMN_COUNT when written
+    std::uint64_t rowCount;         //!< Shots in the file
+    std::uint64_t blockCount;       //!< Row blocks in the file
+    std::uint64_t blockRows;        //!< Rows per block; the last block may be shorter
+    std::uint64_t footerOffset;     //!< File offset of the block table
+    std::int64_t createdAt;         //!< Unix time the snapshot was written
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(SnapshotFileHeader) == 64, "SnapshotFileHeader layout is part of the file format");
+
+/**
+ * @brief Zone map and location of one row block
+ */
+struct SnapshotBlockInfo {
+    std::uint64_t offset;                       //!< File offset of the block
+    std::uint64_t rows;                         //!< Rows in the block
+    std::uint64_t clubMask;                     //!< Bit (id % 64) set for every club id present
+    std::uint32_t minClubId;                    //!< Smallest club id in the block
+    std::uint32_t maxClubId;                    //!< Largest club id in the block
+    double min[SNAPSHOT_COLUMN_COUNT];          //!< Per-column minimum
+    double max[SNAPSHOT_COLUMN_COUNT];          //!< Per-column maximum
+};
+
+/**
+ * @brief Row filter used to select snapshot blocks
+ *
+ * Every bound is inclusive. Unset bounds match everything.
+ */
+struct SnapshotPredicate {
+    std::string club;                                                   //!< Only this club, empty for all
+    std::time_t since = std::numeric_limits<std::time_t>::min();        //!< Shot timestamp lower bound
+    std::time_t until = std::numeric_limits<std::time_t>::max();        //!< Shot timestamp upper bound
+    double minWindSpeed = -std::numeric_limits<double>::infinity();     //!< Wind speed lower bound (m/s)
+    double maxWindSpeed = std::numeric_limits<double>::infinity();      //!< Wind speed upper bound (m/s)
+};
+
+/**
+ * @brief Columns of one block that may contain matching rows
+ *
+ * Pointers refer into the mapped file and are valid while the
+ * ShotSnapshot that produced the block is alive.
+ */
+class SnapshotBlock {
+public:
+    size_t firstRow;            //!< Index of the block's first row in the snapshot
+    size_t rows;                //!< Rows in the block
+    bool allMatch;              //!< Zone map proves every row satisfies the predicate
+
+    const std::uint32_t* clubIds() const { return clubIds_; }
+    const double* column(SnapshotColumn column) const {
+        return columns_[static_cast<size_t>(column)];
+    }
+
+    /**
+     * @brief Check one row against the predicate the block was selected with
+     */
+    bool matches(size_t row) const;
+
+private:
+    friend class ShotSnapshot;
+
+    const std::uint32_t* clubIds_;
+    const double* columns_[SNAPSHOT_COLUMN_COUNT];
+    std::int64_t clubId_;           // -1 for any club
+    double since_;
+    double until_;
+    double minWind_;
+    double maxWind_;
+};
+
+/**
+ * @brief Memory-mapped, read-only columnar snapshot
+ */
+class ShotSnapshot {
+public:
+    /**
+     * @brief Map a snapshot file
+     *
+     * @param path Snapshot written by ShotSnapshotWriter
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    explicit ShotSnapshot(const std::string& path);
+
+    ShotSnapshot(const ShotSnapshot&) = delete;
+    ShotSnapshot& operator=(const ShotSnapshot&) = delete;
+
+    size_t rowCount() const { return header_->rowCount; }
+    size_t blockCount() const { return blocks_.size(); }
+    std::time_t createdAt() const { return static_cast<std::time_t>(header_->createdAt); }
+
+    /**
+     * @brief Club names in id order
+     */
+    const std::vector<std::string>& clubs() const { return clubs_; }
+
+    /**
+     * @brief Blocks whose zone maps admit the predicate
+     *
+     * Rows of a block with allMatch == false still need block.matches(row).
+     *
+     * @param predicate Club, date and wind filter
+     * @return Candidate blocks in file order
+     */
+    std::vector<SnapshotBlock> selectBlocks(const SnapshotPredicate& predicate = SnapshotPredicate()) const;
+
+    /**
+     * @brief Rebuild the ShotData of one row, for callers that need whole shots
+     */
+    ShotData shotAt(const SnapshotBlock& block, size_t row) const;
+
+private:
+    MappedFile file_;
+    const SnapshotFileHeader* header_;
+    std::vector<const SnapshotBlockInfo*> blocks_;
+    std::vector<std::string> clubs_;
+    std::unordered_map<std::string, std::uint32_t> clubIds_;
+};
+
+/**
+ * @brief Streams shots into a new snapshot file
+ *
+ * The file is written under a temporary name and renamed into place by
+ * finish(), so readers never see a partial snapshot. Shots should arrive
+ * grouped by club and ordered by time within each club (see
+ * ShotOrder::ByClub): the zone maps then exclude most blocks for club and
+ * date predicates, and each club's rows are contiguous.
+ */
+class ShotSnapshotWriter {
+public:
+    /**
+     * @param path Final snapshot path
+     * @param blockRows Rows per block
+     * @throws std::runtime_error if the temporary file cannot be created
+     */
+    explicit ShotSnapshotWriter(const std::string& path, size_t blockRows = 4096);
+
+    /**
+     * @brief Remove the temporary file if finish() was not called
+     */
+    ~ShotSnapshotWriter();
+
+    ShotSnapshotWriter(const ShotSnapshotWriter&) = delete;
+    ShotSnapshotWriter& operator=(const ShotSnapshotWriter&) = delete;
+
+    bool append(const ShotData& shot);
+
+    /**
+     * @brief Write the footer and publish the file
+     * @return false if any write failed; nothing is published then
+     */
+    bool finish();
+
+private:
+    bool flushBlock();
+
+    std::string path_;
+    std::string tempPath_;
+    std::ofstream out_;
+    size_t blockRows_;
+    bool finished_;
+    bool failed_;
+
+    std::vector<std::uint32_t> clubIds_;                    // Current block
+    std::vector<double> columns_[SNAPSHOT_COLUMN_COUNT];    // Current block
+    std::vector<SnapshotBlockInfo> blocks_;
+    std::vector<std::string> clubs_;
+    std::unordered_map<std::string, std::uint32_t> clubLookup_;
+    std::uint64_t rowCount_;
+};
+
+/**
+ * @brief Schedule and retention for SnapshotExporter
+ */
+struct SnapshotExporterConfig {
+    std::chrono::minutes interval{60};      //!< Time between exports
+    size_t blockRows = 4096;                //!< Rows per block
+    size_t retainSnapshots = 2;             //!< Older snapshot files are deleted
+};
+
+/**
+ * @brief Periodically exports the shot table to columnar snapshots
+ *
+ * Snapshots are named shots-<unix time in ms>.col inside the export directory.
+ */
+class SnapshotExporter {
+public:
+    /**
+     * @brief Start the export thread; the first export runs after one interval
+     *
+     * @param storage Source of shots; must outlive the exporter
+     * @param directory Directory receiving snapshot files
+     * @param config Schedule and retention
+     */
+    SnapshotExporter(SQLiteStorage& storage, const std::string& directory,
+                     const SnapshotExporterConfig& config = SnapshotExporterConfig());
+    ~SnapshotExporter();
+
+    SnapshotExporter(const SnapshotExporter&) = delete;
+    SnapshotExporter& operator=(const SnapshotExporter&) = delete;
+
+    /**
+     * @brief Export on the calling thread
+     * @return Path of the new snapshot, empty on failure
+     */
+    std::string exportNow();
+
+    /**
+     * @brief Path of the newest snapshot in the directory, empty if none
+     */
+    std::string latestSnapshot() const;
+
+private:
+    void run();
+    std::vector<std::string> listSnapshots() const;
+
+    SQLiteStorage& storage_;
+    std::string directory_;
+    SnapshotExporterConfig config_;
+
+    std::mutex exportMutex_;        // Serializes exports
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    std::thread worker_;
+};
+
+} // namespace data
+} // namespace gptgolf
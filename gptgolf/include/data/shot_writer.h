@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sqlite_storage.h"
+
+/**
+ * @file shot_writer.h
+ * @brief Asynchronous group-commit writer for shot ingestion
+ *
+ * Launch monitor threads hand shots to the writer and return immediately.
+ * A background thread collects pending shots into batches and commits each
+ * batch as one transaction on its own WAL-mode connection, so the cost of a
+ * commit is shared by every shot in the batch.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Batching and durability settings for ShotWriter
+ */
+struct ShotWriterConfig {
+    size_t maxBatchSize = 1000;                             //!< Commit once this many shots are pending
+    std::chrono::milliseconds maxBatchDelay{20};            //!< Commit at most this long after the first pending shot
+    SynchronousLevel synchronous = SynchronousLevel::NORMAL; //!< Durability level of each commit
+};
+
+/**
+ * @brief Counters describing writer activity
+ */
+struct ShotWriterStats {
+    size_t shotsWritten = 0;    //!< Shots committed successfully
+    size_t shotsFailed = 0;     //!< Shots in batches that failed to commit
+    size_t batchesCommitted = 0; //!< Transactions committed
+    size_t pendingShots = 0;    //!< Shots queued but not yet committed
+};
+
+/**
+ * @brief Write-behind queue that group-commits shots to SQLite
+ *
+ * Every shot enqueued between two commits belongs to the same batch and
+ * shares its acknowledgement: the returned future becomes ready with true
+ * once the transaction containing the shot has committed, or false if it
+ * was rolled back.
+ */
+class ShotWriter {
+public:
+    /**
+     * @brief Open a writer connection and start the commit thread
+     *
+     * @param dbPath Path to the SQLite database file
+     * @param config Batching and durability settings
+     * @throws std::runtime_error if the database cannot be opened
+     */
+    explicit ShotWriter(const std::string& dbPath,
+                        const ShotWriterConfig& config = ShotWriterConfig());
+
+    /**
+     * @brief Commit everything still pending and stop the commit thread
+     */
+    ~ShotWriter();
+
+    ShotWriter(const ShotWriter&) = delete;
+    ShotWriter& operator=(const ShotWriter&) = delete;
+
+    /**
+     * @brief Queue a shot for the next batch
+     *
+     * Never touches the database on the calling thread.
+     *
+     * @param shot Shot to store
+     * @return Future that resolves when the shot's batch is durable
+     */
+    std::shared_future<bool> enqueue(const ShotData& shot);
+
+    /**
+     * @brief Commit all shots queued so far and wait for the result
+     * @return true if every batch committed successfully
+     */
+    bool flush();
+
+    /**
+     * @brief Snapshot of writer counters
+     */
+    ShotWriterStats getStats() const;
+
+    /**
+     * @brief Start an online backup through the commit thread's connection
+     *
+     * Batches keep committing while the backup runs and end up in the copy.
+     * The writer must outlive the returned backup.
+     */
+    std::unique_ptr<OnlineBackup> startBackup(const std::string& destinationPath,
+                                              const BackupOptions& options = BackupOptions());
+
+private:
+    struct Batch {
+        std::vector<ShotData> shots;
+        std::promise<bool> committed;
+        std::shared_future<bool> result;
+        std::chrono::steady_clock::time_point opened;
+
+        Batch() : result(committed.get_future().share()) {}
+    };
+
+    /**
+     * @brief Commit thread main loop
+     */
+    void run();
+
+    /**
+     * @brief Close the open batch so the commit thread picks it up
+     *
+     * Caller must hold mutex_.
+     */
+    void sealOpenBatch();
+
+    ShotWriterConfig config_;
+    SQLiteStorage storage_;                         // Connection owned by the commit thread
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unique_ptr<Batch> open_;                   // Batch currently accepting shots
+    std::deque<std::unique_ptr<Batch>> sealed_;     // Batches waiting to be committed
+    std::shared_future<bool> inFlight_;             // Result of the batch being committed
+    ShotWriterStats stats_;
+    bool stopping_;
+
+    std::thread worker_;
+};
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "statement_cache.h"
+
+/**
+ * @file sqlite_reader_pool.h
+ * @brief Pool of read-only SQLite connections for concurrent queries
+ *
+ * In WAL mode readers never block the writer or each other, but a single
+ * sqlite3 handle can only run one statement at a time. The pool keeps a
+ * fixed set of read-only connections, each with its own cache of prepared
+ * statements, and hands them out to one thread at a time.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Fixed-size pool of read-only connections to one database
+ */
+class SQLiteReaderPool {
+private:
+    struct Connection {
+        sqlite3* db = nullptr;
+        std::unique_ptr<StatementCache> statements;
+    };
+
+public:
+    /**
+     * @brief Exclusive use of one pooled connection
+     *
+     * Statements handed out by a lease are reset when the lease ends, which
+     * closes their read transactions so the WAL can be checkpointed.
+     */
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        /**
+         * @brief Raw handle, for statements the caller finalizes itself
+         */
+        sqlite3* db() const { return connection_->db; }
+
+        /**
+         * @brief Get a cached prepared statement for this connection
+         *
+         * @param sql SQL text, also used as the cache key
+         * @return Statement with no bindings, or nullptr if preparation fails
+         */
+        sqlite3_stmt* prepare(const std::string& sql);
+
+    private:
+        friend class SQLiteReaderPool;
+        Lease(SQLiteReaderPool* pool, size_t index);
+
+        SQLiteReaderPool* pool_;
+        size_t index_;
+        Connection* connection_;
+        std::vector<sqlite3_stmt*> used_;   // Statements to reset on release
+    };
+
+    /**
+     * @brief Open the read-only connections
+     *
+     * The database must already exist and be in WAL mode.
+     *
+     * @param dbPath Path to the SQLite database file
+     * @param size Number of connections
+     * @param busyTimeoutMs Wait for locks held during checkpoints
+     * @throws std::runtime_error if a connection cannot be opened
+     */
+    SQLiteReaderPool(const std::string& dbPath, size_t size, int busyTimeoutMs);
+    ~SQLiteReaderPool();
+
+    SQLiteReaderPool(const SQLiteReaderPool&) = delete;
+    SQLiteReaderPool& operator=(const SQLiteReaderPool&) = delete;
+
+    /**
+     * @brief Borrow a connection, waiting if all are in use
+     *
+     * A thread gets the connection it used last when that one is free, so
+     * its statement cache stays warm.
+     */
+    Lease acquire();
+
+    size_t size() const { return connections_.size(); }
+
+    /**
+     * @brief Statement cache counters summed over all connections
+     */
+    StatementCacheStats statementStats() const;
+
+private:
+    void release(size_t index);
+
+    std::vector<Connection> connections_;
+    std::vector<bool> inUse_;
+    size_t available_;
+    size_t id_;                         // Distinguishes pools in per-thread affinity hints
+    std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+} // namespace data
+} // namespace gptgolf
@@ -2,17 +2,186 @@
 
 #include <sqlite3.h>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <optional>
 #include "storage.h"
+#include "online_backup.h"
+#include "sqlite_reader_pool.h"
 
 namespace gptgolf {
 namespace data {
 
+/**
+ * @brief SQLite synchronous setting used for commits
+ *
+ * In WAL mode NORMAL is durable across application crashes and only loses
+ * the last commits on power failure; FULL syncs the log on every commit.
+ */
+enum class SynchronousLevel {
+    OFF,
+    NORMAL,
+    FULL
+};
+
+/**
+ * @brief Connection options for SQLiteStorage
+ */
+struct SQLiteOptions {
+    bool walMode = false;                               // Use write-ahead logging
+    SynchronousLevel synchronous = SynchronousLevel::FULL;  // Commit durability level
+    int busyTimeoutMs = 5000;                           // Wait for locks held by other connections
+    size_t readerConnections = 0;                       // Read-only connections for concurrent queries (WAL only)
+};
+
+/**
+ * @brief Row order of a shot cursor
+ */
+enum class ShotOrder {
+    Chronological,      // Oldest first
+    ByClub              // Grouped by club name, oldest first within each club
+};
+
+/**
+ * @brief Position of a shot in (timestamp, id) order
+ *
+ * Used as the keyset for paginated shot queries: the next page starts
+ * strictly after the last shot of the previous one, so paging costs an
+ * index seek rather than an OFFSET scan and is stable under inserts.
+ */
+struct ShotPageKey {
+    std::time_t timestamp;      // Timestamp of the last shot returned
+    sqlite3_int64 id;           // Row id of the last shot returned (tie-breaker)
+};
+
+/**
+ * @brief One page of a keyset-paginated shot query
+ */
+struct ShotPage {
+    std::vector<ShotData> shots;            // Shots in this page, newest first
+    std::optional<ShotPageKey> nextKey;     // Key for the following page, empty on the last page
+};
+
+/**
+ * @brief Kind of row a change feed entry refers to
+ */
+enum class ChangeEntity {
+    Shot,
+    Club
+};
+
+/**
+ * @brief Kind of write a change feed entry records
+ */
+enum class ChangeOperation {
+    Insert,
+    Update
+};
+
+/**
+ * @brief One entry of the change feed
+ *
+ * The payload is the row as it is when the change is read, not as it was
+ * written, so a consumer applying changes in order converges on the
+ * stored state. It is empty if the row no longer exists.
+ */
+struct ChangeRecord {
+    sqlite3_int64 seq = 0;                  // Position in the feed, strictly increasing
+    ChangeEntity entity = ChangeEntity::Shot;
+    ChangeOperation operation = ChangeOperation::Insert;
+    std::time_t changedAt = 0;              // Commit time of the write (seconds)
+    sqlite3_int64 shotId = 0;               // Row id of the shot, 0 for club changes
+    std::string clubName;                   // Name of the club, empty for shot changes
+    std::optional<ShotData> shot;           // Current shot row for shot changes
+    std::optional<ClubProfile> club;        // Current club row for club changes
+};
+
+/**
+ * @brief One batch read from the change feed
+ */
+struct ChangeBatch {
+    std::vector<ChangeRecord> changes;      // Changes in seq order
+    sqlite3_int64 lastSeq = 0;              // Seq to resume from; the requested seq if nothing new
+    bool hasMore = false;                   // More changes follow this batch
+    bool resyncRequired = false;            // Changes after the requested seq were pruned
+};
+
+/**
+ * @brief Limits applied by SQLiteStorage::pruneChanges
+ *
+ * A change is dropped once it falls outside any limit; 0 disables a limit.
+ */
+struct ChangeRetention {
+    sqlite3_int64 acknowledgedSeq = 0;      // Every consumer has read through this seq
+    size_t maxChanges = 0;                  // Keep at most this many of the newest changes
+    std::time_t maxAge = 0;                 // Drop changes older than this (seconds)
+};
+
+/**
+ * @brief Forward-only cursor over stored shots
+ *
+ * Steps a prepared statement one row at a time so that callers can
+ * process arbitrarily long histories in constant memory. A cursor keeps a
+ * read snapshot open until it is exhausted or destroyed and must not
+ * outlive the SQLiteStorage that created it. When the storage has a reader
+ * pool the cursor holds one pooled connection for that time; otherwise it
+ * runs on the writer connection and holds the write lock, so the thread
+ * iterating must not write to the storage until the cursor is done.
+ */
+class ShotCursor {
+public:
+    ShotCursor() : stmt_(nullptr), done_(true), failed_(false) {}
+    explicit ShotCursor(sqlite3_stmt* stmt,
+                        std::unique_ptr<SQLiteReaderPool::Lease> lease = nullptr);
+    ShotCursor(sqlite3_stmt* stmt, std::unique_lock<std::mutex> lock);
+    ~ShotCursor();
+
+    ShotCursor(ShotCursor&& other) noexcept;
+    ShotCursor& operator=(ShotCursor&& other) noexcept;
+    ShotCursor(const ShotCursor&) = delete;
+    ShotCursor& operator=(const ShotCursor&) = delete;
+
+    /**
+     * @brief Advance to the next shot
+     *
+     * @param shot Receives the shot data when a row is available
+     * @return true if a shot was read, false once the cursor is exhausted
+     *         or failed
+     */
+    bool next(ShotData& shot);
+
+    /**
+     * @brief Whether the query failed to prepare or stopped on an error
+     *        rather than running out of rows
+     */
+    bool failed() const { return failed_; }
+
+private:
+    /**
+     * @brief Finalize the statement and release its connection
+     */
+    void release();
+
+    std::unique_ptr<SQLiteReaderPool::Lease> lease_; // Pooled connection the statement runs on
+    std::unique_lock<std::mutex> lock_; // Write lock, when the statement runs on the writer
+    sqlite3_stmt* stmt_;        // Owned statement, finalized on exhaustion
+    bool done_;                 // True once stepping returned anything but a row
+    bool failed_;               // Prepare or step ended in an error
+};
+
 /**
  * @brief SQLite implementation of the storage interface
  * 
  * Provides persistent storage using SQLite database for shot data,
  * club profiles, and user preferences.
+ *
+ * All writes go through one connection guarded by a mutex. When opened in
+ * WAL mode with readerConnections > 0, queries run on a pool of read-only
+ * connections instead, so concurrent readers neither wait for each other
+ * nor for the writer.
+ *
+ * Every connection keeps its statements prepared in a StatementCache, so
+ * repeated calls skip SQL compilation.
  */
 class SQLiteStorage : public IStorage {
 public:
@@ -20,9 +189,11 @@ public:
      * @brief Construct a new SQLite Storage object
      * 
      * @param dbPath Path to the SQLite database file
+     * @param options Journal mode, synchronous level and busy timeout
      * @throws std::runtime_error if database initialization fails
      */
-    explicit SQLiteStorage(const std::string& dbPath);
+    explicit SQLiteStorage(const std::string& dbPath,
+                           const SQLiteOptions& options = SQLiteOptions());
     ~SQLiteStorage();
 
     // Shot data operations
@@ -30,6 +201,73 @@ public:
     std::vector<ShotData> getShotHistory(size_t limit = 100) override;
     std::vector<ShotData> getShotsByClub(const std::string& clubName) override;
 
+    /**
+     * @brief Latest shots with one club, newest first, via an index seek
+     */
+    std::vector<ShotData> getRecentShotsByClub(const std::string& clubName, size_t limit) override;
+
+    /**
+     * @brief Insert several shots in a single transaction
+     *
+     * The optional checkpoint preference is written in the same transaction,
+     * so importers can record how far they got atomically with the rows.
+     *
+     * @param shots Shots to insert
+     * @param checkpointKey Preference key to set on commit, ignored if empty
+     * @param checkpointValue Value stored under checkpointKey
+     * @return true if every shot was committed, false if the batch was rolled back
+     */
+    bool saveShotBatch(const std::vector<ShotData>& shots,
+                       const std::string& checkpointKey = "",
+                       const std::string& checkpointValue = "");
+
+    /**
+     * @brief Insert a large set of shots in a few big transactions
+     *
+     * With deferIndexes the shot indexes are dropped in the first
+     * transaction and rebuilt once, in the last, instead of being updated
+     * row by row. Queries between those commits still return correct
+     * results, only without index seeks. A failed load keeps the batches
+     * already committed and rebuilds the indexes before returning.
+     *
+     * @param shots Shots to insert, in order
+     * @param transactionRows Rows per transaction
+     * @param deferIndexes Rebuild the shot indexes after loading
+     * @return Number of shots committed
+     */
+    size_t bulkInsertShots(const std::vector<ShotData>& shots, size_t transactionRows = 100000,
+                           bool deferIndexes = true);
+
+    /**
+     * @brief Fetch one page of shot history, newest first
+     *
+     * @param pageSize Maximum number of shots in the page
+     * @param after Key returned with the previous page, or empty for the first page
+     * @return Page of shots plus the key for the next page
+     */
+    ShotPage getShotHistoryPage(size_t pageSize,
+                                const std::optional<ShotPageKey>& after = std::nullopt);
+
+    /**
+     * @brief Fetch one page of shots for a club, newest first
+     *
+     * Served from the (club_used, timestamp) index.
+     */
+    ShotPage getShotsByClubPage(const std::string& clubName, size_t pageSize,
+                                const std::optional<ShotPageKey>& after = std::nullopt);
+
+    /**
+     * @brief Open a streaming cursor over shots in chronological order
+     *
+     * @param clubName Restrict to one club, or empty for every club
+     * @param since Only shots with timestamp >= since
+     * @param order Chronological, or grouped by club for exports that
+     *              want each club's shots contiguous
+     * @return Cursor yielding shots oldest first
+     */
+    ShotCursor openShotCursor(const std::string& clubName = "", std::time_t since = 0,
+                              ShotOrder order = ShotOrder::Chronological);
+
     // Club profile operations
     bool saveClubProfile(const ClubProfile& club) override;
     bool updateClubProfile(const ClubProfile& club) override;
@@ -40,6 +278,57 @@ public:
     bool savePreference(const std::string& key, const std::string& value) override;
     std::string getPreference(const std::string& key, const std::string& defaultValue = "") override;
 
+    /**
+     * @brief Read the change feed after a given position
+     *
+     * Every insert and update of a shot or club profile appends a change
+     * in the same transaction as the write, whichever API or connection
+     * made it. A consumer bootstraps by taking latestChangeSeq(), reading
+     * the full history, then following the feed from that seq; applying a
+     * change twice is harmless since each carries the current row.
+     *
+     * @param seq Last seq the consumer has applied, 0 to start at the oldest
+     *            retained change; pruned changes never flag a resync for 0
+     * @param maxBatch Maximum number of changes returned
+     * @return Changes with seq > seq, oldest first
+     */
+    ChangeBatch readChangesSince(sqlite3_int64 seq, size_t maxBatch);
+
+    /**
+     * @brief Seq of the newest change, 0 if the feed is empty
+     */
+    sqlite3_int64 latestChangeSeq();
+
+    /**
+     * @brief Drop changes outside the retention limits
+     *
+     * The newest change is always kept, so a consumer that finds a gap
+     * after its seq knows it has missed pruned changes.
+     *
+     * @return Number of changes removed
+     */
+    size_t pruneChanges(const ChangeRetention& retention);
+
+    /**
+     * @brief Statement cache counters of the writer and all reader connections
+     */
+    StatementCacheStats statementCacheStats() const;
+
+    /**
+     * @brief Start an online backup of this database
+     *
+     * Pages are copied on the writer connection in steps bounded by
+     * options.stepBudget, so writes through this storage continue during
+     * the backup and are included in the copy. The storage must outlive
+     * the returned backup.
+     *
+     * @param destinationPath File that receives the verified copy
+     * @param options Step budget and verification settings
+     * @return Running backup; destroy it to cancel
+     */
+    std::unique_ptr<OnlineBackup> startBackup(const std::string& destinationPath,
+                                              const BackupOptions& options = BackupOptions());
+
 private:
     /**
      * @brief Initialize database tables
@@ -58,15 +347,86 @@ private:
     void executeStatement(const std::string& sql);
 
     /**
-     * @brief Convert WeatherData to/from JSON string
+     * @brief Migrate a legacy shots table to typed weather columns
+     *
+     * Older databases store each shot's conditions as a JSON blob in a
+     * weather_data column. The typed columns are added in place and
+     * backfilled in MIGRATION_BATCH_SIZE row transactions, so a large
+     * history never holds the write lock for the whole migration. Progress
+     * is keyed on the row id, which makes an interrupted migration resume
+     * where it stopped. The legacy column is dropped once every row has
+     * been converted. Skipped once user_version records the current layout.
+     *
+     * @throws std::runtime_error if a migration step fails
+     */
+    void migrateLegacyShots();
+
+    /**
+     * @brief Drop the converted weather_data column
+     *
+     * Uses ALTER TABLE DROP COLUMN where the SQLite library supports it
+     * (3.35 and later), and otherwise rebuilds the shots table without it
+     * in one transaction.
+     *
+     * @throws std::runtime_error if a migration step fails
+     */
+    void dropLegacyWeatherColumn();
+
+    /**
+     * @brief Layout version recorded in PRAGMA user_version; 0 if never set
+     */
+    int schemaVersion();
+
+    /**
+     * @brief Add running statistics columns to a legacy clubs table
+     *
+     * The new columns are seeded from the club's stored shots in one
+     * aggregate pass, so later updates never need the shot history.
+     *
+     * @throws std::runtime_error if a migration step fails
      */
-    std::string weatherDataToJson(const weather::WeatherData& data);
-    weather::WeatherData jsonToWeatherData(const std::string& json);
+    void migrateClubStats();
 
-    sqlite3* db_;                      // SQLite database handle
+    /**
+     * @brief Add quantile sketch columns to a legacy clubs table
+     *
+     * Sketches for existing clubs are built from their stored shots in a
+     * single scan.
+     *
+     * @throws std::runtime_error if a migration step fails
+     */
+    void migrateClubSketches();
+
+    class ReadStatement;
+
+    /**
+     * @brief Prepare a read query on a pooled reader or the writer connection
+     */
+    ReadStatement prepareRead(const std::string& sql);
+
+    /**
+     * @brief Run a keyset page query and build the next-page key
+     */
+    ShotPage fetchShotPage(sqlite3_stmt* stmt, size_t pageSize);
+
+    /**
+     * @brief Check whether a table has a given column
+     */
+    bool hasColumn(const std::string& table, const std::string& column);
+
+    sqlite3* db_;                      // SQLite database handle (writer connection)
+    std::mutex writeMutex_;            // Serializes use of db_
+    std::unique_ptr<StatementCache> statements_; // Prepared statements on db_, guarded by writeMutex_
+    std::unique_ptr<SQLiteReaderPool> readers_; // Read-only connections, if enabled
     static const char* SHOTS_TABLE;    // SQL for shots table creation
+    static const char* SHOTS_INDEXES;  // SQL for shots index creation
     static const char* CLUBS_TABLE;    // SQL for clubs table creation
     static const char* PREFS_TABLE;    // SQL for preferences table creation
+    static const char* CHANGES_TABLE;  // SQL for change feed table creation
+    static const char* CHANGE_TRIGGERS; // SQL for triggers feeding the changes table
+
+    static constexpr int SHOTS_SCHEMA_VERSION = 1;        // PRAGMA user_version of the current layout
+    static constexpr int MIGRATION_BATCH_SIZE = 5000;     // Rows converted per migration transaction
 };
 
 } // namespace data
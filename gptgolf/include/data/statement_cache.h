@@ -0,0 +1,118 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @file statement_cache.h
+ * @brief Per-connection cache of prepared SQLite statements
+ *
+ * Compiling SQL costs far more than running a simple statement, so each
+ * connection keeps its statements prepared and reuses them with
+ * sqlite3_reset and sqlite3_clear_bindings. A cache belongs to exactly one
+ * connection and, like the connection, is used by one thread at a time:
+ * callers serialize access with whatever lock guards the connection.
+ */
+
+namespace gptgolf {
+namespace data {
+
+/**
+ * @brief Lookup counters of a statement cache
+ */
+struct StatementCacheStats {
+    std::uint64_t hits = 0;     //!< Lookups served by an already prepared statement
+    std::uint64_t misses = 0;   //!< Lookups that compiled SQL
+    size_t statements = 0;      //!< Statements currently prepared
+
+    StatementCacheStats& operator+=(const StatementCacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        statements += other.statements;
+        return *this;
+    }
+};
+
+/**
+ * @brief Prepared statements of one connection, keyed by SQL text
+ */
+class StatementCache {
+public:
+    /**
+     * @param db Connection the statements are prepared on; must outlive the cache
+     */
+    explicit StatementCache(sqlite3* db);
+
+    /**
+     * @brief Finalize every statement, which must happen before the connection closes
+     */
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief Get the prepared statement for some SQL text
+     *
+     * A cached statement is reset and its bindings cleared before it is
+     * returned. The statement stays owned by the cache; callers reset it
+     * when done (see CachedStatement) so it does not hold a read
+     * transaction open.
+     *
+     * @param sql SQL text of a single statement, also used as the cache key
+     * @return Statement with no bindings, or nullptr if preparation fails
+     */
+    sqlite3_stmt* prepare(const std::string& sql);
+
+    /**
+     * @brief Finalize every cached statement, e.g. before a schema change
+     */
+    void clear();
+
+    sqlite3* db() const { return db_; }
+
+    /**
+     * @brief Lookup counters; safe to call from any thread
+     */
+    StatementCacheStats stats() const;
+
+private:
+    sqlite3* db_;
+    std::unordered_map<std::string, sqlite3_stmt*> statements_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+    std::atomic<size_t> size_;
+};
+
+/**
+ * @brief Scoped use of a cached statement
+ *
+ * Resets the statement when the scope ends, which releases its read
+ * snapshot and any locks while keeping it compiled.
+ */
+class CachedStatement {
+public:
+    CachedStatement(StatementCache& cache, const std::string& sql)
+        : stmt_(cache.prepare(sql)) {}
+
+    ~CachedStatement() {
+        if (stmt_) {
+            sqlite3_reset(stmt_);
+        }
+    }
+
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    sqlite3_stmt* get() const { return stmt_; }
+    explicit operator bool() const { return stmt_ != nullptr; }
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
+} // namespace data
+} // namespace gptgolf
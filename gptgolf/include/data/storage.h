@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <cmath>
 #include <ctime>
+#include "quantile_sketch.h"
 #include "../weather/weather_data.h"
 
 namespace gptgolf {
@@ -28,6 +30,14 @@ public:
     virtual std::vector<ShotData> getShotHistory(size_t limit = 100) = 0;
     virtual std::vector<ShotData> getShotsByClub(const std::string& clubName) = 0;
 
+    /**
+     * @brief Latest shots with one club, newest first
+     *
+     * The default implementation truncates getShotsByClub; stores that can
+     * limit the query should override it.
+     */
+    virtual std::vector<ShotData> getRecentShotsByClub(const std::string& clubName, size_t limit);
+
     // Club profile operations
     virtual bool saveClubProfile(const ClubProfile& club) = 0;
     virtual bool updateClubProfile(const ClubProfile& club) = 0;
@@ -59,6 +69,47 @@ struct ShotData {
                  timestamp(std::time(nullptr)) {}
 };
 
+/**
+ * @brief Constant-time running statistics for one measurement
+ *
+ * Keeps Welford's running mean and sum of squared deviations over every
+ * sample, plus an exponentially weighted mean and variance that track
+ * recent form. Both are updated in O(1) per sample.
+ */
+struct RunningStats {
+    size_t count = 0;           // Samples seen
+    double mean = 0.0;          // Mean over all samples
+    double m2 = 0.0;            // Sum of squared deviations from the mean
+    double recentMean = 0.0;    // Exponentially weighted mean
+    double recentVariance = 0.0; // Exponentially weighted variance
+
+    /**
+     * @brief Add one sample
+     * @param value Sample value
+     * @param alpha Weight of the new sample in the recent-form estimates (0-1]
+     */
+    void add(double value, double alpha) {
+        ++count;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+
+        if (count == 1) {
+            recentMean = value;
+            recentVariance = 0.0;
+        } else {
+            double recentDelta = value - recentMean;
+            double increment = alpha * recentDelta;
+            recentMean += increment;
+            recentVariance = (1.0 - alpha) * (recentVariance + recentDelta * increment);
+        }
+    }
+
+    double variance() const { return count > 0 ? m2 / count : 0.0; }
+    double stdDev() const { return std::sqrt(variance()); }
+    double recentStdDev() const { return std::sqrt(recentVariance); }
+};
+
 /**
  * @brief Represents a golf club's profile and performance data
  */
@@ -73,12 +124,24 @@ struct ClubProfile {
     // Performance statistics
     double distanceDeviation;   // Standard deviation in distance
     double directionDeviation;  // Standard deviation in direction
-    
+    RunningStats distanceStats; // Running carry distance statistics
+    RunningStats lateralStats;  // Running lateral deviation statistics
+    QuantileSketch distanceSketch; // Carry distance distribution
+    QuantileSketch lateralSketch;  // Lateral deviation distribution
+
     // Constructor with default values
     ClubProfile() : avgDistance(0), avgSpinRate(0), avgLaunchAngle(0),
                     totalShots(0), lastUpdated(std::time(nullptr)),
                     distanceDeviation(0), directionDeviation(0) {}
 };
 
+inline std::vector<ShotData> IStorage::getRecentShotsByClub(const std::string& clubName, size_t limit) {
+    std::vector<ShotData> shots = getShotsByClub(clubName);
+    if (shots.size() > limit) {
+        shots.resize(limit);
+    }
+    return shots;
+}
+
 } // namespace data
 } // namespace gptgolf
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include "../data/storage.h"
+#include "../data/shot_snapshot.h"
 #include "../weather/weather_data.h"
 #include "data_collector.h"
 
@@ -99,6 +100,23 @@ public:
      */
     virtual void train(const std::vector<data::ShotData>& trainingData);
 
+    /**
+     * @brief Train model from a columnar shot snapshot
+     *
+     * Reads feature columns straight from the mapped snapshot blocks that
+     * survive the predicate's zone-map check into one flat feature buffer
+     * per club, without materializing ShotData or per-shot vectors.
+     * Produces the same weights as train() on the same shots as long as
+     * extractFeatures is not overridden, since it writes the base features
+     * with writeFeatures directly.
+     *
+     * @param snapshot Mapped snapshot, typically the exporter's latest
+     * @param predicate Restricts training to a club, date or wind range
+     * @throws std::runtime_error if fewer than minTrainingSize_ shots match
+     */
+    virtual void train(const data::ShotSnapshot& snapshot,
+                       const data::SnapshotPredicate& predicate = data::SnapshotPredicate());
+
     /**
      * @brief Update model with new shot data
      *
@@ -157,6 +175,8 @@ public:
     /** @} */
 
 protected:
+    static constexpr size_t FEATURE_COUNT = 5;  //!< Values per shot from extractFeatures
+
     data::IStorage& storage_;      //!< Reference to shot data storage
     DataCollector& collector_;     //!< Reference to data collection system
 
@@ -213,6 +233,26 @@ protected:
         const weather::WeatherData& conditions,
         double swingSpeed
     );
+
+    /**
+     * @brief Write the base feature set for one shot
+     *
+     * @param out FEATURE_COUNT values, in extractFeatures order
+     */
+    static void writeFeatures(double* out, double windSpeed, double windDirection,
+                              double temperature, double humidity, double swingSpeed);
+
+    /**
+     * @brief Fit one club's weights by gradient descent
+     *
+     * @param features FEATURE_COUNT values per shot, row-major, as from extractFeatures
+     * @param targets Actual distance per shot
+     * @return Fitted weights
+     */
+    std::vector<double> fitClubWeights(
+        const std::vector<double>& features,
+        const std::vector<double>& targets
+    ) const;
     /** @} */
 
     /** @name Model Parameters
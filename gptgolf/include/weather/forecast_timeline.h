@@ -0,0 +1,82 @@
+#pragma once
+
+#include "weather_data.h"
+#include <cstddef>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @file forecast_timeline.h
+ * @brief Hourly forecast for one location, interpolated in memory
+ *
+ * Tee-sheet planning asks for the weather at many future times per course.
+ * A ForecastTimeline holds one provider forecast as evenly spaced samples
+ * and answers those questions without network or SQL: scalars are
+ * interpolated linearly between the two neighbouring samples, and wind is
+ * interpolated as a vector so that a veer from 350° to 10° passes through
+ * north, and opposing winds weaken rather than swing through 180°.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+/**
+ * @brief Evenly spaced forecast samples for one location
+ */
+class ForecastTimeline {
+public:
+    ForecastTimeline() = default;
+
+    /**
+     * @brief Build a timeline from forecast readings
+     *
+     * @param readings Samples in time order, evenly spaced by at least a second
+     * @return Timeline, or nullopt if readings is empty, unordered or uneven
+     */
+    static std::optional<ForecastTimeline> fromReadings(const std::vector<WeatherData>& readings);
+
+    /**
+     * @brief Parse a provider forecast response
+     *
+     * Reads timelines.hourly[].time and .values as returned by the
+     * tomorrow.io forecast endpoint with metric units.
+     *
+     * @return Timeline, or nullopt if the body is malformed or uneven
+     */
+    static std::optional<ForecastTimeline> parse(const std::string& body);
+
+    /**
+     * @brief Forecast weather at a time within the timeline
+     *
+     * @return Interpolated reading stamped with time, or nullopt outside
+     *         [startTime(), endTime()]
+     */
+    std::optional<WeatherData> at(std::time_t time) const;
+
+    bool empty() const { return samples_.empty(); }
+    size_t size() const { return samples_.size(); }
+    std::time_t startTime() const { return start_; }
+    std::time_t endTime() const { return samples_.empty() ? start_ : start_ + (samples_.size() - 1) * step_; }
+    std::time_t stepSeconds() const { return step_; }
+    bool covers(std::time_t time) const { return !samples_.empty() && time >= start_ && time <= endTime(); }
+
+private:
+    // 24 bytes per sample; wind is kept as east and north components
+    struct Sample {
+        float temperature;
+        float humidity;
+        float pressure;
+        float windEast;
+        float windNorth;
+        float precipitation;
+    };
+
+    std::time_t start_ = 0;
+    std::time_t step_ = 3600;
+    std::vector<Sample> samples_;
+};
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "weather_data.h"
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file geohash_cache.h
+ * @brief In-process weather cache keyed by geohash cell
+ *
+ * WeatherStorage matches locations on exact coordinates and answers every
+ * read with SQL. GeohashWeatherCache sits in front of it: readings are keyed
+ * by the geohash cell that contains them, so every tee box and green of a
+ * course shares one entry, and a hit costs a hash lookup under a per-shard
+ * lock.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+/**
+ * @brief Encode a coordinate as a geohash
+ *
+ * @param latitude Latitude in degrees (-90 to 90)
+ * @param longitude Longitude in degrees (-180 to 180)
+ * @param precision Characters in the result (1-12); 6 is a cell of about 1.2 x 0.6 km
+ * @return Base-32 geohash; coordinates in the same cell give the same string
+ */
+std::string encodeGeohash(double latitude, double longitude, int precision);
+
+/**
+ * @brief Settings for GeohashWeatherCache
+ */
+struct GeohashCacheConfig {
+    int precision = 6;                  //!< Geohash length; lower means larger shared cells
+    std::time_t ttlSeconds = 3600;      //!< Age of a reading after which it is dropped
+    size_t shardCount = 16;             //!< Independently locked partitions
+    size_t shardCapacity = 256;         //!< Cells kept per shard before the oldest is evicted
+};
+
+/**
+ * @brief Cache hit and occupancy counters
+ */
+struct GeohashCacheStats {
+    size_t hits = 0;            //!< Reads served from memory
+    size_t misses = 0;          //!< Reads with no usable entry
+    size_t expired = 0;         //!< Entries dropped for exceeding the TTL
+    size_t evictions = 0;       //!< Entries dropped to stay within shard capacity
+    size_t entries = 0;         //!< Cells currently cached
+};
+
+/**
+ * @brief Sharded TTL cache of the latest reading per geohash cell
+ *
+ * Age is measured from WeatherData::timestamp, the observation time, so a
+ * reading loaded from storage expires when it would have been fetched fresh
+ * anyway. A cell keeps the newest reading put into it.
+ */
+class GeohashWeatherCache {
+public:
+    explicit GeohashWeatherCache(const GeohashCacheConfig& config = GeohashCacheConfig());
+
+    /**
+     * @brief Latest reading for the cell containing a location
+     *
+     * @param now Current time, for the TTL check
+     * @return Reading, or nullopt when the cell is empty or expired
+     */
+    std::optional<WeatherData> get(double latitude, double longitude,
+                                   std::time_t now = std::time(nullptr));
+
+    /**
+     * @brief Cache a reading for the cell containing a location
+     *
+     * Ignored if the cell already holds a newer reading.
+     */
+    void put(double latitude, double longitude, const WeatherData& data);
+
+    /**
+     * @brief Drop the entry for the cell containing a location
+     */
+    void invalidate(double latitude, double longitude);
+
+    /**
+     * @brief Drop every entry
+     */
+    void clear();
+
+    /**
+     * @brief Snapshot of cache counters summed over shards
+     */
+    GeohashCacheStats getStats() const;
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, WeatherData> cells;
+        GeohashCacheStats stats;
+    };
+
+    Shard& shardFor(const std::string& cell);
+
+    GeohashCacheConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace weather
+} // namespace gptgolf
@@ -3,23 +3,16 @@
 #include "physics/wind.h"
 #include "weather/weather_data.h"
 #include "weather/weather_storage.h"
+#include "weather/terrain_tiles.h"
+#include "weather/wind_accumulator.h"
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
 #include <ctime>
 
-// Land use classification based on OpenStreetMap data
-enum class LandUseType {
-    WATER,              // Ocean, lakes, rivers
-    COASTAL,            // Coastal areas, beaches
-    GRASSLAND,          // Open fields, golf courses
-    FOREST,             // Dense vegetation
-    SUBURBAN,           // Residential areas
-    URBAN,              // City centers
-    INDUSTRIAL,         // Industrial zones
-    MOUNTAIN,           // High elevation, complex terrain
-    UNKNOWN             // Default when data unavailable
-};
+namespace gptgolf {
+namespace weather {
 
 // Terrain analysis result
 struct TerrainAnalysis {
@@ -36,24 +29,6 @@ struct TerrainAnalysis {
         , isComplex(false) {}
 };
 
-// Wind pattern data for statistical analysis
-struct WindPattern {
-    double speed;
-    double direction;
-    double gustSpeed;
-    double temperature;
-    double pressure;
-    std::time_t timestamp;
-    
-    WindPattern()
-        : speed(0.0)
-        , direction(0.0)
-        , gustSpeed(0.0)
-        , temperature(0.0)
-        , pressure(0.0)
-        , timestamp(0) {}
-};
-
 // Statistical wind analysis
 struct WindStatistics {
     double meanSpeed;
@@ -76,30 +51,43 @@ struct WindStatistics {
 
 class TerrainAnalyzer {
 public:
-    TerrainAnalyzer(WeatherStorage& storage);
+    // Terrain comes from tiles when given; without them every location is
+    // open terrain of unknown land use
+    TerrainAnalyzer(WeatherStorage& storage, std::shared_ptr<TerrainTileStore> tiles = nullptr);
     
-    // Analyze terrain at a location
+    // Analyze terrain at a location; one tile lookup
     TerrainAnalysis analyzeTerrain(double latitude, double longitude);
     
     // Get recommended wind profile for conditions
     WindProfile recommendProfile(const TerrainAnalysis& terrain,
                                const WeatherData& weather);
     
-    // Store and analyze wind patterns
+    // Store and analyze wind patterns. Each observation updates the running
+    // statistics for its location and UTC hour in O(1). WeatherData carries
+    // no gust, so the gust is taken as the mean speed; use the WindPattern
+    // overload when gusts are measured.
     void storeWindPattern(double latitude, double longitude,
                          const WeatherData& weather);
+    void storeWindPattern(double latitude, double longitude,
+                         const WindPattern& pattern);
     
-    // Get wind statistics for location
+    // Get wind statistics for location over the UTC hours of day startHour
+    // through endHour (0-23, inclusive, wrapping past midnight when endHour
+    // is earlier), drawn from all stored history at those hours; 0 to 23
+    // covers the whole day. Merges at most 24 stored accumulators. nullopt
+    // for hours out of range or below MIN_PATTERNS_FOR_STATS observations.
     std::optional<WindStatistics> getWindStats(double latitude, double longitude,
-                                             std::time_t startTime,
-                                             std::time_t endTime);
+                                             int startHour, int endHour);
     
-    // Get typical wind conditions by time of day
+    // Get typical wind conditions by UTC hour of day: a single pattern of
+    // mean speed, gust, temperature and pressure and the circular mean
+    // direction, or empty without data
     std::vector<WindPattern> getTypicalPatterns(double latitude, double longitude,
                                               int hourOfDay);
 
 private:
     WeatherStorage& storage;
+    std::shared_ptr<TerrainTileStore> tiles;
     
     // Internal analysis methods
     LandUseType detectLandUse(double latitude, double longitude);
@@ -110,6 +98,7 @@ private:
     // Wind pattern analysis
     WindStatistics calculateStats(const std::vector<WindPattern>& patterns);
     double calculateTurbulenceIntensity(const std::vector<WindPattern>& patterns);
+    static WindStatistics toStatistics(const WindAccumulator& accumulator);
     
     // Constants
     static constexpr double COMPLEX_TERRAIN_THRESHOLD = 100.0;  // meters elevation change
@@ -117,3 +106,6 @@ private:
     static constexpr int HOURS_IN_DAY = 24;
     static constexpr double GUST_FACTOR_THRESHOLD = 1.5;        // threshold for considering gusty conditions
 };
+
+} // namespace weather
+} // namespace gptgolf
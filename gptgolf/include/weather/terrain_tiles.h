@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @file terrain_tiles.h
+ * @brief Offline terrain grid in fixed-size memory-mapped tiles
+ *
+ * TerrainAnalyzer needs land use, elevation and roughness at a course
+ * without network lookups. buildTerrainTiles grids local point files into
+ * square tiles of equal size and writes them behind a small index;
+ * TerrainTileStore maps that file and answers a lookup with one hash probe
+ * for the tile and one array index for the cell.
+ *
+ * File layout, in host byte order:
+ * - header: magic "GTTILES", version, byte-order mark, tile size in cells,
+ *   tile count and cell size in degrees
+ * - index: (tile row, tile column) of each tile as two int32
+ * - tiles: tileSize x tileSize cells of 8 bytes each, row-major from the
+ *   south-west corner, in index order
+ *
+ * A cell holds elevation (float, metres), roughness (uint16, decimetres)
+ * and land use (uint8, LandUseType; 0xFF where no source point fell).
+ */
+
+namespace gptgolf {
+namespace weather {
+
+// Land use classification based on OpenStreetMap data
+enum class LandUseType {
+    WATER,              // Ocean, lakes, rivers
+    COASTAL,            // Coastal areas, beaches
+    GRASSLAND,          // Open fields, golf courses
+    FOREST,             // Dense vegetation
+    SUBURBAN,           // Residential areas
+    URBAN,              // City centers
+    INDUSTRIAL,         // Industrial zones
+    MOUNTAIN,           // High elevation, complex terrain
+    UNKNOWN             // Default when data unavailable
+};
+
+/**
+ * @brief Land use class for a name such as "forest" or a class number
+ *
+ * @return Matching class, UNKNOWN for anything else
+ */
+LandUseType parseLandUse(const std::string& text);
+
+/**
+ * @brief Terrain at one grid cell
+ */
+struct TerrainCell {
+    double elevation;       //!< Metres above sea level
+    double roughness;       //!< Elevation range around the cell (m)
+    LandUseType landUse;
+};
+
+/**
+ * @brief Grid settings for buildTerrainTiles
+ */
+struct TerrainTileOptions {
+    double cellDegrees = 0.001;     //!< Cell edge in degrees, about 110 m of latitude
+    uint32_t tileSize = 64;         //!< Cells per tile edge
+};
+
+/**
+ * @brief Outcome of buildTerrainTiles
+ */
+struct TerrainTileBuildReport {
+    bool success = false;           //!< Every source was read and the tile file written
+    std::string error;              //!< Reason for failure
+    size_t pointsRead = 0;          //!< Data rows found in the sources
+    size_t pointsRejected = 0;      //!< Rows without a valid location or elevation
+    size_t tilesWritten = 0;        //!< Tiles holding at least one point
+};
+
+/**
+ * @brief Grid local terrain points into a tile file
+ *
+ * Sources are CSV files with a header naming at least latitude/lat,
+ * longitude/lon/lng and elevation/altitude, plus optional land_use and
+ * roughness columns. Points in the same cell are averaged and the most
+ * common land use wins. Without a roughness column, a cell's roughness is
+ * the elevation range over it and its eight neighbours.
+ *
+ * @param sources Point files to read
+ * @param outputPath Tile file to write, replaced if it exists
+ */
+TerrainTileBuildReport buildTerrainTiles(const std::vector<std::string>& sources,
+                                         const std::string& outputPath,
+                                         const TerrainTileOptions& options = TerrainTileOptions());
+
+/**
+ * @brief Tile lookup counters
+ */
+struct TerrainTileStats {
+    size_t lookups = 0;         //!< Calls to lookup
+    size_t tileHits = 0;        //!< Lookups served by an already decoded tile
+    size_t tileDecodes = 0;     //!< Tiles decoded from the mapping
+    size_t evictions = 0;       //!< Decoded tiles dropped to stay within capacity
+    size_t tiles = 0;           //!< Tiles in the open file
+};
+
+/**
+ * @brief Read-only view of a tile file with an LRU of decoded tiles
+ *
+ * Safe to share between threads.
+ */
+class TerrainTileStore {
+public:
+    /**
+     * @param cacheTiles Decoded tiles kept in memory
+     */
+    explicit TerrainTileStore(size_t cacheTiles = 64);
+    ~TerrainTileStore();
+
+    TerrainTileStore(const TerrainTileStore&) = delete;
+    TerrainTileStore& operator=(const TerrainTileStore&) = delete;
+
+    /**
+     * @brief Map a file written by buildTerrainTiles
+     *
+     * @return false if the file is missing, truncated or from another format
+     */
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Terrain of the cell containing a location
+     *
+     * @return Cell, or nullopt where the file has no data
+     */
+    std::optional<TerrainCell> lookup(double latitude, double longitude);
+
+    TerrainTileStats getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace weather
+} // namespace gptgolf
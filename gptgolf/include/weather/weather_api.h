@@ -3,9 +3,14 @@
 
 #include "weather_data.h"
 #include "weather_storage.h"
+#include "weather_fetcher.h"
+#include "geohash_cache.h"
+#include "forecast_timeline.h"
 #include <string>
 #include <memory>
 #include <functional>
+#include <future>
+#include <optional>
 
 namespace gptgolf {
 namespace weather {
@@ -24,9 +29,46 @@ public:
     // Check if offline mode is active
     bool isOfflineMode() const;
 
-    // Get current weather data for a location
+    // Get current weather data for a location. Readings are cached per
+    // geohash cell, so nearby coordinates share one and a hit runs no SQL.
+    // Data older than REFRESH_AHEAD_MINUTES is still returned while a
+    // background fetch replaces it; only data past MAX_CACHE_AGE_MINUTES
+    // waits for the API.
     bool getCurrentWeather(double latitude, double longitude, WeatherData& data);
 
+    // Fetch current weather without blocking. Concurrent requests for the
+    // same location share one API call; the result is stored on arrival.
+    std::shared_future<std::optional<WeatherData>> fetchCurrentWeatherAsync(double latitude, double longitude);
+
+    // Forecast weather at a future time, interpolated from an hourly
+    // forecast kept in memory per geohash cell. The forecast is fetched
+    // once and refetched after FORECAST_MAX_AGE_MINUTES, so repeated
+    // queries for a course cost no API call or SQL. Fails when no forecast
+    // can be fetched or the time is outside it.
+    bool getForecastWeather(double latitude, double longitude, std::time_t time, WeatherData& data);
+
+    // Fetch the hourly forecast without blocking; concurrent requests for
+    // the same cell share one API call. Yields null if the fetch fails.
+    std::shared_future<std::shared_ptr<const ForecastTimeline>> fetchForecastAsync(double latitude, double longitude);
+
+    // Override the provider endpoints, e.g. to point at a local stand-in
+    void setEndpoint(const std::string& url);
+    void setForecastEndpoint(const std::string& url);
+
+    // Request counters
+    struct FetchStats {
+        std::uint64_t requests = 0;         // API calls started
+        std::uint64_t forecastRequests = 0; // Forecast API calls started
+        std::uint64_t forecastHits = 0;     // Forecast queries answered from memory
+        std::uint64_t coalesced = 0;        // Requests that joined a call already in flight
+        std::uint64_t staleServed = 0;      // Stale readings returned while refreshing
+        WeatherFetcherStats transport;      // Connection reuse and failures
+    };
+    FetchStats getFetchStats() const;
+
+    // In-memory cache counters
+    GeohashCacheStats getCacheStats() const;
+
     // Set callback for error handling
     void setErrorCallback(std::function<void(const std::string&)> callback);
 
@@ -35,6 +77,8 @@ public:
 
     // Constants (static constexpr for in-class initialization)
     static constexpr int MAX_CACHE_AGE_MINUTES = 60;
+    static constexpr int REFRESH_AHEAD_MINUTES = 45;
+    static constexpr int FORECAST_MAX_AGE_MINUTES = 180;
     static constexpr double MAX_DISTANCE_KM = 10.0;
 
 private:
@@ -51,8 +95,7 @@ private:
     bool offlineMode;
 
     // Internal helper methods
-    bool fetchFromAPI(double latitude, double longitude, WeatherData& data);
-    bool parseWeatherResponse(const std::string& response, WeatherData& data);
+    static bool parseWeatherResponse(const std::string& response, WeatherData& data);
     bool getOfflineWeather(double latitude, double longitude, WeatherData& data);
 };
 
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @file weather_fetcher.h
+ * @brief Non-blocking HTTP GETs for weather providers on one curl multi handle
+ *
+ * Requests are queued by the caller and driven by a single event thread
+ * with curl_multi_poll, so any number of transfers can be in flight without
+ * a thread each. Finished easy handles go back to a pool, and the multi
+ * handle keeps its connection cache across transfers, so repeated requests
+ * to the same provider reuse one keep-alive connection instead of paying
+ * for a TCP and TLS handshake every time.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+/**
+ * @brief Outcome of one HTTP request
+ */
+struct HttpResponse {
+    bool ok = false;            //!< Transfer succeeded with a 2xx status
+    long status = 0;            //!< HTTP status, 0 if no response was received
+    std::string body;           //!< Response body
+    std::string error;          //!< Transport error or status description
+};
+
+/**
+ * @brief Settings for WeatherFetcher
+ */
+struct WeatherFetcherConfig {
+    long timeoutMs = 10000;             //!< Whole-transfer timeout
+    long connectTimeoutMs = 5000;       //!< Connection setup timeout
+    long maxHostConnections = 4;        //!< Parallel connections per provider host
+};
+
+/**
+ * @brief Transfer counters of a fetcher
+ */
+struct WeatherFetcherStats {
+    std::uint64_t transfers = 0;            //!< Requests completed
+    std::uint64_t connectionsOpened = 0;    //!< New connections made; the rest reused one
+    std::uint64_t failures = 0;             //!< Requests without a 2xx response
+};
+
+/**
+ * @brief Event-loop HTTP client shared by the weather providers
+ */
+class WeatherFetcher {
+public:
+    using Callback = std::function<void(const HttpResponse&)>;
+
+    explicit WeatherFetcher(const WeatherFetcherConfig& config = WeatherFetcherConfig());
+
+    /**
+     * @brief Stop the event thread; see stop()
+     */
+    ~WeatherFetcher();
+
+    WeatherFetcher(const WeatherFetcher&) = delete;
+    WeatherFetcher& operator=(const WeatherFetcher&) = delete;
+
+    /**
+     * @brief Queue a GET request
+     *
+     * @param url Address to fetch
+     * @param onComplete Called once on the event thread with the response,
+     *                   or on the calling thread once stopped; it must not block
+     */
+    void get(const std::string& url, Callback onComplete);
+
+    /**
+     * @brief Stop the event thread and wait for it
+     *
+     * Requests still queued or in flight complete with an error response
+     * before this returns, and later requests fail at once. Owners whose
+     * callbacks use their own members call this before those go away.
+     */
+    void stop();
+
+    /**
+     * @brief Snapshot of transfer counters
+     */
+    WeatherFetcherStats getStats() const;
+
+private:
+    struct Request {
+        std::string url;
+        Callback onComplete;
+    };
+
+    /**
+     * @brief Event thread main loop
+     */
+    void run();
+
+    WeatherFetcherConfig config_;
+    void* multi_;                               // CURLM, which curl declares as void
+
+    mutable std::mutex mutex_;
+    std::deque<Request> queued_;                // Requests not yet handed to curl
+    WeatherFetcherStats stats_;
+    bool stopping_;
+
+    std::thread worker_;
+};
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "weather_storage.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @file weather_history_loader.h
+ * @brief Bulk load of historical weather files with a climatology pass
+ *
+ * Typical weather and historical statistics need years of observations per
+ * location, which storeWeatherData would write one implicit transaction at
+ * a time. The loader maps the file into memory, parses chunks of it on
+ * worker threads and inserts the rows through
+ * WeatherStorage::bulkStoreWeatherData in large transactions.
+ *
+ * While parsing, each worker also sums its rows per (location, month).
+ * Storage keeps the same sums over every stored observation, and the
+ * monthly typical_weather means of the loaded months are rewritten from
+ * those, so the climatology needs no second pass over the data. History
+ * split over several files averages across all of them, and reloading a
+ * file counts its rows once. Wind direction is averaged as a unit vector
+ * so that 350° and 10° average to 0°, not 180°.
+ *
+ * CSV files are read by header name in any column order; NDJSON files hold
+ * one flat object per line with the same names as keys. Recognised names
+ * are latitude/lat, longitude/lon/lng, timestamp/time/date, temperature/temp,
+ * humidity, pressure/pressureSeaLevel, windSpeed, windDirection,
+ * precipitation/precipitationIntensity and altitude/elevation, ignoring case
+ * and punctuation. Values are in the units of WeatherData.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+/**
+ * @brief Layout of a history file
+ */
+enum class HistoryFormat {
+    Auto,   //!< NDJSON if the first non-blank character is '{', CSV otherwise
+    Csv,
+    Ndjson
+};
+
+/**
+ * @brief Tuning for WeatherHistoryLoader
+ */
+struct HistoryLoadOptions {
+    HistoryFormat format = HistoryFormat::Auto;
+    size_t threads = 0;                     //!< Parser threads, 0 for one per hardware thread
+    size_t chunkBytes = 1 << 20;            //!< Target input bytes per parse task
+    size_t transactionRows = 100000;        //!< Rows per insert transaction
+    bool buildClimatology = true;           //!< Write monthly typical_weather rows
+};
+
+/**
+ * @brief Outcome of one load
+ */
+struct HistoryLoadReport {
+    bool success = false;           //!< File was read and every accepted row committed
+    std::string error;              //!< Reason for failure
+    size_t rowsRead = 0;            //!< Data rows found in the file
+    size_t rowsLoaded = 0;          //!< Observations committed to storage
+    size_t rowsRejected = 0;        //!< Rows missing a location or time, or failing WeatherData::isValid
+    size_t climatologyRows = 0;     //!< typical_weather rows written
+    double parseSeconds = 0.0;      //!< Time spent mapping, parsing and summing
+    double insertSeconds = 0.0;     //!< Time spent in SQLite
+
+    /**
+     * @brief Rows read per second of total load time
+     */
+    double rowsPerSecond() const {
+        double seconds = parseSeconds + insertSeconds;
+        return seconds > 0.0 ? rowsRead / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Loads historical weather files into WeatherStorage
+ */
+class WeatherHistoryLoader {
+public:
+    explicit WeatherHistoryLoader(WeatherStorage& storage,
+                                  const HistoryLoadOptions& options = HistoryLoadOptions());
+
+    /**
+     * @brief Parse, validate and store every observation in a file
+     */
+    HistoryLoadReport loadFile(const std::string& path);
+
+    /**
+     * @brief Parse a history file already in memory, without storing it
+     *
+     * @param data File contents
+     * @param size Length of data in bytes
+     * @param report Receives row counts and timing; success is set on return
+     * @param climatology If not null, receives the monthly means of the rows
+     * @return Accepted observations in file order
+     */
+    std::vector<WeatherObservation> parse(const char* data, size_t size, HistoryLoadReport& report,
+                                          std::vector<TypicalWeatherRow>* climatology = nullptr) const;
+
+private:
+    WeatherStorage& storage_;
+    HistoryLoadOptions options_;
+};
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "weather_storage.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+/**
+ * @file weather_retention.h
+ * @brief Background removal of old observations within an I/O budget
+ *
+ * A single DELETE of every expired observation holds the storage for as
+ * long as it takes to remove the rows, update the spatial index and the
+ * monthly rollup, and commit, and the pages it frees stay in the file.
+ * WeatherRetention instead removes the oldest observations in steps of a
+ * few hundred rows, each its own short transaction, then returns the freed
+ * pages to the file system with incremental vacuum steps. Like
+ * OnlineBackup, it sizes each step from the cost of the previous one so no
+ * step holds the storage longer than the step budget, and each pass stops
+ * at a row and page budget. Passes can be confined to maintenance hours.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+/**
+ * @brief Tuning for WeatherRetention
+ */
+struct RetentionOptions {
+    std::chrono::seconds maxAge{30 * 24 * 3600};        //!< Observations older than this are removed
+    std::chrono::milliseconds passInterval{60000};      //!< Time between maintenance passes
+    std::chrono::microseconds stepBudget{2000};         //!< Longest a step may hold the storage
+    std::chrono::milliseconds stepInterval{5};          //!< Pause between steps, leaving the storage to writers
+    size_t maxRowsPerPass = 50000;                      //!< Rows deleted per pass at most
+    int maxPagesPerPass = 4096;                         //!< Pages released per pass at most
+    int activeFromHour = 0;                             //!< First local hour in which passes run
+    int activeUntilHour = 24;                           //!< Local hour at which passes stop; may wrap past midnight
+};
+
+/**
+ * @brief Counters across all passes
+ */
+struct RetentionProgress {
+    size_t passes = 0;              //!< Passes run
+    size_t skippedPasses = 0;       //!< Passes skipped outside the active hours
+    size_t steps = 0;               //!< Delete and vacuum steps taken
+    size_t rowsDeleted = 0;         //!< Observations removed
+    size_t pagesReleased = 0;       //!< Pages returned to the file system
+    size_t rowsPerStep = 0;         //!< Current adaptive delete step
+    std::chrono::microseconds longestStep{0};   //!< Longest time one step held the storage
+    bool incrementalVacuum = false; //!< Whether the file can release pages
+};
+
+/**
+ * @brief Periodic retention and vacuum for a WeatherStorage
+ *
+ * The storage must outlive the retention task. Destroying the task stops
+ * it after its current step.
+ */
+class WeatherRetention {
+public:
+    /**
+     * @param storage Storage to maintain
+     * @param options Age limit, budgets and active hours
+     * @param background Run passes on a background thread every passInterval;
+     *                   otherwise only runPass does work
+     */
+    explicit WeatherRetention(WeatherStorage& storage,
+                              const RetentionOptions& options = RetentionOptions(),
+                              bool background = true);
+    ~WeatherRetention();
+
+    WeatherRetention(const WeatherRetention&) = delete;
+    WeatherRetention& operator=(const WeatherRetention&) = delete;
+
+    /**
+     * @brief Run one pass on the calling thread
+     *
+     * @param now Current time, for the age limit and active hours
+     * @return Observations removed by this pass
+     */
+    size_t runPass(std::time_t now = std::time(nullptr));
+
+    RetentionProgress progress() const;
+
+private:
+    void run();
+    bool isActiveHour(std::time_t now) const;
+    bool pause();   // Waits stepInterval; false once stopping
+
+    WeatherStorage& storage_;
+    RetentionOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    RetentionProgress progress_;
+    bool stopping_;
+
+    std::mutex passMutex_;          // One pass at a time
+    std::thread worker_;
+};
+
+} // namespace weather
+} // namespace gptgolf
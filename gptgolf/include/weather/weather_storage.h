@@ -1,6 +1,9 @@
 #pragma once
 
 #include "weather_data.h"
+#include "wind_accumulator.h"
+#include "data/online_backup.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
@@ -8,10 +11,49 @@
 
 // Forward declare sqlite3 to avoid direct dependency
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace gptgolf {
+namespace data {
+struct StatementCacheStats;  // data/statement_cache.h
+}
+
 namespace weather {
 
+// One observation for bulk loading
+struct WeatherObservation {
+    double latitude;
+    double longitude;
+    WeatherData data;
+};
+
+// Running sums of the observations of one location and month
+struct TypicalWeatherSums {
+    uint64_t count = 0;
+    double temperature = 0.0;
+    double humidity = 0.0;
+    double pressure = 0.0;
+    double windSpeed = 0.0;
+    double directionSin = 0.0;      // Wind direction as summed unit vectors
+    double directionCos = 0.0;
+    double precipitation = 0.0;
+    double altitude = 0.0;
+
+    void add(const WeatherData& data);
+    void merge(const TypicalWeatherSums& other);
+    WeatherData mean() const;
+};
+
+// Monthly typical weather for one location, for bulk loading
+struct TypicalWeatherRow {
+    double latitude;
+    double longitude;
+    int month;                  // 1-12
+    WeatherData data;           // Monthly means
+    TypicalWeatherSums sums;    // Observations behind data, already stored in weather_data;
+                                // non-empty recomputes data from every stored observation
+};
+
 class WeatherStorage {
 public:
     WeatherStorage();
@@ -23,6 +65,10 @@ public:
     // Store weather data
     bool storeWeatherData(double latitude, double longitude, const WeatherData& data);
 
+    // Store many observations, transactionRows per transaction; returns rows committed
+    size_t bulkStoreWeatherData(const std::vector<WeatherObservation>& rows,
+                                size_t transactionRows = 100000);
+
     // Retrieve weather data
     std::optional<WeatherData> getWeatherData(double latitude, double longitude);
 
@@ -33,16 +79,55 @@ public:
     bool storeTypicalWeather(double latitude, double longitude, 
                            int month, const WeatherData& data);
 
-    // Clear old data
+    // Store many typical weather rows in one transaction; returns rows committed.
+    // Rows with sums are added to the sums already stored for their location
+    // and month, so history loaded over several calls averages across all of it.
+    size_t bulkStoreTypicalWeather(const std::vector<TypicalWeatherRow>& rows);
+
+    // Clear old data in short batches, then release the freed pages. For
+    // retention without latency spikes use WeatherRetention instead.
     void clearOldData(std::time_t olderThan);
 
+    // Delete up to maxRows of the oldest observations before olderThan in
+    // one transaction; returns rows deleted
+    size_t deleteObservationsBefore(std::time_t olderThan, size_t maxRows);
+
+    // Return up to maxPages free pages to the file system with an
+    // incremental vacuum; returns pages released, 0 unless
+    // incrementalVacuumEnabled()
+    int releaseFreePages(int maxPages);
+
+    // Pages freed by deletes and not yet released
+    int freePageCount();
+
+    // Whether the file uses incremental auto-vacuum; new files always do
+    bool incrementalVacuumEnabled();
+
+    // Switch an older file to incremental auto-vacuum. Rewrites the whole
+    // database with VACUUM, so run it outside operating hours.
+    bool enableIncrementalVacuum();
+
     // Check if we have recent data for location
     bool hasRecentData(double latitude, double longitude, int maxAgeMinutes = 60);
 
-    // Get nearest available weather data
+    // Get nearest available weather data from the last hour. Uses an R*Tree
+    // bounding-box search, so cost depends on nearby rows, not table size.
+    // Only rows stored within a day of their observation time are indexed.
     std::optional<WeatherData> getNearestWeatherData(double latitude, double longitude, 
                                                    double maxDistanceKm = 10.0);
 
+    // Record a wind observation and fold it into the running statistics for
+    // its location and UTC hour of day, in one transaction. A repeat of a
+    // stored (location, timestamp) is ignored and returns false.
+    bool storeWindPattern(double latitude, double longitude, const WindPattern& pattern);
+
+    // Running wind statistics for a location and UTC hour (0-23); nullopt without data
+    std::optional<WindAccumulator> getWindAccumulator(double latitude, double longitude, int hourOfDay);
+
+    // Running wind statistics for every UTC hour of a location, indexed by
+    // hour; hours without data have a count of 0
+    std::vector<WindAccumulator> getWindAccumulators(double latitude, double longitude);
+
     // Statistics
     struct WeatherStats {
         double avgTemperature;
@@ -52,16 +137,35 @@ public:
         std::vector<double> windDirectionFrequency; // 0-360 degrees in 10-degree bins
     };
 
-    // Get historical statistics for location
+    // Get historical statistics for location and UTC month from the rollup
+    // table kept current by insert and delete triggers; nullopt without data
     std::optional<WeatherStats> getHistoricalStats(double latitude, double longitude,
                                                  int month);
 
+    // Prepared statement reuse counters
+    data::StatementCacheStats statementCacheStats() const;
+
+    // Start an online backup of the weather database; nullptr if not initialized.
+    // The storage must outlive the returned backup.
+    std::unique_ptr<data::OnlineBackup> startBackup(const std::string& destinationPath,
+                                                    const data::BackupOptions& options = data::BackupOptions());
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
 
+    static constexpr size_t CLEAR_BATCH_ROWS = 5000;
+    static constexpr int CLEAR_BATCH_PAGES = 1024;
+
     // Helper methods
     bool initializeTables();
+    bool tableExists(const std::string& name);
+    int pragmaInt(const char* name);
+    bool backfillWindStats();
+    bool writeWindAccumulator(double latitude, double longitude, int hourOfDay,
+                              const WindAccumulator& accumulator);
+    // Means of every stored observation for a row's location and month
+    bool readTypicalSums(sqlite3_stmt* select, const TypicalWeatherRow& row, WeatherData& typical);
     double calculateDistance(double lat1, double lon1, double lat2, double lon2);
     int getLocationBin(double latitude, double longitude);
 };
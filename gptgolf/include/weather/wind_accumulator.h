@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @file wind_accumulator.h
+ * @brief Streaming wind statistics that update in constant time
+ *
+ * Wind statistics per location and hour of day used to be recomputed from
+ * the full observation history. A WindAccumulator instead keeps the few
+ * running values those statistics need: a Welford mean and sum of squared
+ * deviations for speed, summed unit vectors for the circular mean of
+ * direction, and the maximum and mean gust. Adding an observation or
+ * merging two accumulators is O(1), and an accumulator persists as one row.
+ */
+
+namespace gptgolf {
+namespace weather {
+
+// Wind pattern data for statistical analysis
+struct WindPattern {
+    double speed;
+    double direction;
+    double gustSpeed;
+    double temperature;
+    double pressure;
+    std::time_t timestamp;
+
+    WindPattern()
+        : speed(0.0)
+        , direction(0.0)
+        , gustSpeed(0.0)
+        , temperature(0.0)
+        , pressure(0.0)
+        , timestamp(0) {}
+};
+
+/**
+ * @brief Running wind statistics over any number of observations
+ */
+struct WindAccumulator {
+    std::uint64_t count = 0;        //!< Observations added
+    double meanSpeed = 0.0;         //!< Running mean speed (m/s)
+    double m2Speed = 0.0;           //!< Sum of squared deviations from meanSpeed
+    double sumSin = 0.0;            //!< Sum of sin(direction)
+    double sumCos = 0.0;            //!< Sum of cos(direction)
+    double maxSpeed = 0.0;          //!< Highest speed or gust seen (m/s)
+    double meanGust = 0.0;          //!< Running mean gust speed (m/s)
+    double meanTemperature = 0.0;   //!< Running mean temperature (°C)
+    double meanPressure = 0.0;      //!< Running mean pressure (hPa)
+    std::time_t lastTimestamp = 0;  //!< Latest observation time
+
+    /**
+     * @brief Add one observation
+     */
+    void add(const WindPattern& pattern);
+
+    /**
+     * @brief Combine with an accumulator over disjoint observations
+     *
+     * The result equals adding both sets of observations to one accumulator.
+     */
+    void merge(const WindAccumulator& other);
+
+    /**
+     * @brief Sample standard deviation of speed; 0 below two observations
+     */
+    double speedStdDev() const;
+
+    /**
+     * @brief Circular mean direction in degrees [0, 360)
+     */
+    double prevailingDirection() const;
+
+    /**
+     * @brief Circular standard deviation of direction in degrees
+     *
+     * sqrt(-2 ln R) for mean resultant length R: 0 for a steady direction,
+     * growing as directions spread, capped at 180.
+     */
+    double directionStdDev() const;
+
+    /**
+     * @brief Mean gust over mean speed; 0 in calm air
+     */
+    double gustRatio() const;
+
+    /**
+     * @brief Speed standard deviation over mean speed; 0 in calm air
+     */
+    double turbulenceIntensity() const;
+};
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,442 @@
+#include "data/cached_storage.h"
+#include <algorithm>
+
+namespace gptgolf {
+namespace data {
+
+CachedStorage::CachedStorage(IStorage& backing, const CacheConfig& config)
+    : backing_(backing)
+    , config_(config)
+    , generation_(0)
+    , writesInFlight_(0)
+    , useClock_(0)
+    , recentBytes_(0)
+    , recentLoaded_(false)
+    , profileBytes_(0)
+    , allProfilesLoaded_(false)
+    , hits_(0)
+    , misses_(0) {}
+
+template <typename Lookup, typename Load, typename Store>
+auto CachedStorage::loadOnce(const std::string& key, Lookup lookup, Load load, Store store) -> decltype(load()) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // Another thread may have loaded the entry since the shared lock was
+    // dropped; if its load was not cached, this thread loads in turn
+    do {
+        if (lookup()) {
+            hits_++;
+            return {};
+        }
+    } while (!beginLoad(lock, key));
+
+    misses_++;
+    std::uint64_t generation = generation_;
+    lock.unlock();
+    decltype(load()) value;
+    try {
+        value = load();
+    } catch (...) {
+        lock.lock();
+        endLoad(key);
+        throw;
+    }
+    lock.lock();
+    endLoad(key);
+
+    // A write during the load may or may not be in value; serve it uncached
+    if (generation == generation_ && writesInFlight_ == 0) {
+        store(value);
+    }
+    return value;
+}
+
+template <typename Write>
+bool CachedStorage::writeBacking(std::unique_lock<std::shared_mutex>& lock, Write write) {
+    lock.lock();
+    writesInFlight_++;
+    lock.unlock();
+    bool written;
+    try {
+        written = write();
+    } catch (...) {
+        lock.lock();
+        writesInFlight_--;
+        generation_++;
+        throw;
+    }
+    lock.lock();
+    writesInFlight_--;
+    generation_++;
+    return written;
+}
+
+bool CachedStorage::saveShotData(const ShotData& shot) {
+    std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (!writeBacking(lock, [&]() { return backing_.saveShotData(shot); })) {
+        return false;
+    }
+
+    auto it = clubs_.find(shot.clubUsed);
+    if (it != clubs_.end()) {
+        insertOrdered(it->second.shots, shot);
+        size_t bytes = shotBytes(shot);
+        it->second.bytes += bytes;
+        stats_.cachedShots++;
+        stats_.memoryBytes += bytes;
+        touch(it->second);
+    }
+
+    if (recentLoaded_) {
+        std::vector<ShotData> recent = std::move(recent_);
+        insertOrdered(recent, shot);
+        if (recent.size() > config_.recentShotCapacity) {
+            recent.erase(recent.begin());
+        }
+        replaceRecent(std::move(recent));
+    }
+    enforceBudget(shot.clubUsed);
+    return true;
+}
+
+std::vector<ShotData> CachedStorage::getShotHistory(size_t limit) {
+    if (limit > config_.recentShotCapacity) {
+        misses_++;
+        return backing_.getShotHistory(limit);
+    }
+
+    auto newest = [&]() {
+        size_t count = std::min(limit, recent_.size());
+        return std::vector<ShotData>(recent_.rbegin(), recent_.rbegin() + count);
+    };
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (recentLoaded_) {
+            hits_++;
+            return newest();
+        }
+    }
+
+    std::optional<std::vector<ShotData>> cached;
+    auto loaded = loadOnce("recent",
+        [&]() {
+            if (recentLoaded_) {
+                cached = newest();
+            }
+            return recentLoaded_;
+        },
+        [&]() { return backing_.getShotHistory(config_.recentShotCapacity); },
+        [&](const std::vector<ShotData>& newestFirst) {
+            replaceRecent(std::vector<ShotData>(newestFirst.rbegin(), newestFirst.rend()));
+            recentLoaded_ = true;
+            enforceBudget(std::string());
+        });
+    if (cached) {
+        return std::move(*cached);
+    }
+    if (loaded.size() > limit) {
+        loaded.resize(limit);
+    }
+    return loaded;
+}
+
+std::vector<ShotData> CachedStorage::getShotsByClub(const std::string& clubName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = clubs_.find(clubName);
+        if (it != clubs_.end()) {
+            hits_++;
+            touch(it->second);
+            return std::vector<ShotData>(it->second.shots.rbegin(), it->second.shots.rend());
+        }
+    }
+
+    std::vector<ShotData> cached;
+    bool hit = false;
+    auto loaded = loadOnce("shots:" + clubName,
+        [&]() {
+            auto it = clubs_.find(clubName);
+            if (it != clubs_.end()) {
+                touch(it->second);
+                cached.assign(it->second.shots.rbegin(), it->second.shots.rend());
+                hit = true;
+            }
+            return hit;
+        },
+        [&]() { return backing_.getShotsByClub(clubName); },
+        [&](const std::vector<ShotData>& newestFirst) {
+            // Unknown clubs stay uncached, so arbitrary names cannot pin entries
+            if (newestFirst.empty()) {
+                return;
+            }
+            ClubShots& entry = clubs_[clubName];
+            entry.shots.assign(newestFirst.rbegin(), newestFirst.rend());
+            entry.bytes = sizeof(ClubShots) + clubName.capacity();
+            for (const auto& shot : entry.shots) {
+                entry.bytes += shotBytes(shot);
+            }
+            touch(entry);
+
+            stats_.cachedClubs++;
+            stats_.cachedShots += entry.shots.size();
+            stats_.memoryBytes += entry.bytes;
+            enforceBudget(clubName);
+        });
+    return hit ? cached : loaded;
+}
+
+std::vector<ShotData> CachedStorage::getRecentShotsByClub(const std::string& clubName, size_t limit) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = clubs_.find(clubName);
+        if (it != clubs_.end()) {
+            hits_++;
+            touch(it->second);
+            const auto& shots = it->second.shots;
+            size_t count = std::min(limit, shots.size());
+            return std::vector<ShotData>(shots.rbegin(), shots.rbegin() + count);
+        }
+    }
+
+    // Loading the whole club for a few recent shots would defeat the limit
+    misses_++;
+    return backing_.getRecentShotsByClub(clubName, limit);
+}
+
+bool CachedStorage::saveClubProfile(const ClubProfile& club) {
+    std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (!writeBacking(lock, [&]() { return backing_.saveClubProfile(club); })) {
+        return false;
+    }
+    cacheProfile(club);
+    enforceBudget(std::string());
+    return true;
+}
+
+bool CachedStorage::updateClubProfile(const ClubProfile& club) {
+    std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+    if (!writeBacking(lock, [&]() { return backing_.updateClubProfile(club); })) {
+        return false;
+    }
+
+    // An update of an unknown club changes nothing in the backing store,
+    // so only refresh entries that are already cached
+    if (profiles_.count(club.name)) {
+        cacheProfile(club);
+        enforceBudget(std::string());
+    }
+    return true;
+}
+
+std::optional<ClubProfile> CachedStorage::getClubProfile(const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = profiles_.find(name);
+        if (it != profiles_.end()) {
+            hits_++;
+            return it->second;
+        }
+        if (allProfilesLoaded_) {
+            hits_++;
+            return std::nullopt;
+        }
+    }
+
+    std::optional<ClubProfile> cached;
+    bool hit = false;
+    auto loaded = loadOnce("profile:" + name,
+        [&]() {
+            auto it = profiles_.find(name);
+            if (it != profiles_.end()) {
+                cached = it->second;
+                hit = true;
+            } else if (allProfilesLoaded_) {
+                hit = true;
+            }
+            return hit;
+        },
+        [&]() { return backing_.getClubProfile(name); },
+        [&](const std::optional<ClubProfile>& profile) {
+            if (profile) {
+                cacheProfile(*profile);
+                enforceBudget(std::string());
+            }
+        });
+    return hit ? cached : loaded;
+}
+
+std::vector<ClubProfile> CachedStorage::getAllClubProfiles() {
+    auto list = [&]() {
+        std::vector<ClubProfile> clubs;
+        clubs.reserve(profiles_.size());
+        for (const auto& entry : profiles_) {
+            clubs.push_back(entry.second);
+        }
+        return clubs;
+    };
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (allProfilesLoaded_) {
+            hits_++;
+            return list();
+        }
+    }
+
+    std::optional<std::vector<ClubProfile>> cached;
+    auto loaded = loadOnce("profiles",
+        [&]() {
+            if (allProfilesLoaded_) {
+                cached = list();
+            }
+            return allProfilesLoaded_;
+        },
+        [&]() { return backing_.getAllClubProfiles(); },
+        [&](const std::vector<ClubProfile>& clubs) {
+            dropProfiles();
+            for (const auto& club : clubs) {
+                cacheProfile(club);
+            }
+            allProfilesLoaded_ = true;
+            enforceBudget(std::string());
+        });
+    if (cached) {
+        return std::move(*cached);
+    }
+    // Same order as a cached list
+    std::sort(loaded.begin(), loaded.end(),
+              [](const ClubProfile& a, const ClubProfile& b) { return a.name < b.name; });
+    return loaded;
+}
+
+bool CachedStorage::savePreference(const std::string& key, const std::string& value) {
+    return backing_.savePreference(key, value);
+}
+
+std::string CachedStorage::getPreference(const std::string& key, const std::string& defaultValue) {
+    return backing_.getPreference(key, defaultValue);
+}
+
+void CachedStorage::invalidate() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    generation_++;
+    clubs_.clear();
+    replaceRecent({});
+    recentLoaded_ = false;
+    dropProfiles();
+    stats_.cachedClubs = 0;
+    stats_.cachedShots = 0;
+    stats_.memoryBytes = 0;
+}
+
+CacheStats CachedStorage::getStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    CacheStats stats = stats_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    return stats;
+}
+
+size_t CachedStorage::shotBytes(const ShotData& shot) {
+    // Short club names live in the string's inline buffer
+    size_t heap = shot.clubUsed.capacity() > 15 ? shot.clubUsed.capacity() + 1 : 0;
+    return sizeof(ShotData) + heap;
+}
+
+size_t CachedStorage::profileBytes(const ClubProfile& club) {
+    // Centroids are a mean and a weight each
+    constexpr size_t centroidBytes = sizeof(double) + sizeof(std::uint64_t);
+    size_t heap = club.name.capacity() > 15 ? club.name.capacity() + 1 : 0;
+    size_t centroids = club.distanceSketch.centroidCount() + club.lateralSketch.centroidCount();
+    return sizeof(ClubProfile) + heap + centroids * centroidBytes;
+}
+
+void CachedStorage::insertOrdered(std::vector<ShotData>& shots, const ShotData& shot) {
+    if (shots.empty() || shots.back().timestamp <= shot.timestamp) {
+        shots.push_back(shot);
+        return;
+    }
+    auto pos = std::upper_bound(shots.begin(), shots.end(), shot.timestamp,
+        [](std::time_t timestamp, const ShotData& existing) {
+            return timestamp < existing.timestamp;
+        });
+    shots.insert(pos, shot);
+}
+
+void CachedStorage::touch(ClubShots& entry) {
+    entry.lastUsed.store(++useClock_, std::memory_order_relaxed);
+}
+
+bool CachedStorage::beginLoad(std::unique_lock<std::shared_mutex>& lock, const std::string& key) {
+    if (loading_.insert(key).second) {
+        return true;
+    }
+    loaded_.wait(lock, [&]() { return loading_.count(key) == 0; });
+    return false;
+}
+
+void CachedStorage::endLoad(const std::string& key) {
+    loading_.erase(key);
+    loaded_.notify_all();
+}
+
+void CachedStorage::replaceRecent(std::vector<ShotData> shots) {
+    stats_.memoryBytes -= recentBytes_;
+    recent_ = std::move(shots);
+    recentBytes_ = 0;
+    for (const auto& shot : recent_) {
+        recentBytes_ += shotBytes(shot);
+    }
+    stats_.memoryBytes += recentBytes_;
+}
+
+void CachedStorage::cacheProfile(const ClubProfile& club) {
+    auto it = profiles_.find(club.name);
+    if (it != profiles_.end()) {
+        size_t old = profileBytes(it->second);
+        profileBytes_ -= old;
+        stats_.memoryBytes -= old;
+        it->second = club;
+    } else {
+        it = profiles_.emplace(club.name, club).first;
+    }
+    size_t bytes = profileBytes(it->second);
+    profileBytes_ += bytes;
+    stats_.memoryBytes += bytes;
+}
+
+void CachedStorage::dropProfiles() {
+    profiles_.clear();
+    allProfilesLoaded_ = false;
+    stats_.memoryBytes -= profileBytes_;
+    profileBytes_ = 0;
+}
+
+void CachedStorage::enforceBudget(const std::string& keep) {
+    while (stats_.memoryBytes > config_.memoryBudgetBytes) {
+        // Club histories are the bulk of the cache, so they go first
+        auto victim = clubs_.end();
+        for (auto it = clubs_.begin(); it != clubs_.end(); ++it) {
+            if (it->first != keep &&
+                (victim == clubs_.end() || it->second.lastUsed < victim->second.lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim != clubs_.end()) {
+            stats_.memoryBytes -= victim->second.bytes;
+            stats_.cachedShots -= victim->second.shots.size();
+            stats_.cachedClubs--;
+            stats_.evictions++;
+            clubs_.erase(victim);
+        } else if (!profiles_.empty()) {
+            dropProfiles();
+        } else if (recentLoaded_) {
+            replaceRecent({});
+            recentLoaded_ = false;
+        } else {
+            // The club just used is larger than the whole budget on its own
+            break;
+        }
+    }
+}
+
+} // namespace data
+} // namespace gptgolf
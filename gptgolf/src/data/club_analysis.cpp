@@ -8,6 +8,17 @@ namespace gptgolf { namespace data {
 
 constexpr double PI = 3.14159265358979323846;
 
+namespace {
+
+// Recommendation index order; names break ties like the by-name profile scan
+template <typename Entry>
+bool byCarry(const Entry& a, const Entry& b) {
+    return a.profile.avgDistance < b.profile.avgDistance ||
+           (a.profile.avgDistance == b.profile.avgDistance && a.profile.name < b.profile.name);
+}
+
+} // namespace
+
 ClubAnalysis::ClubAnalysis(IStorage& storage) : storage_(storage) {}
 
 ClubRecommendation ClubAnalysis::recommendClub(
@@ -15,51 +26,97 @@ ClubRecommendation ClubAnalysis::recommendClub(
     const weather::WeatherData& conditions
 ) {
     ClubRecommendation recommendation;
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    ensureIndex();
+    if (index_.empty()) {
+        return recommendation;
+    }
+
+    // Weather shifts every club's carry by the same amount, so the index
+    // order by base carry is also the order by adjusted carry
+    double offset = adjustDistanceForConditions(0.0, conditions);
+
+    const IndexedClub* best = nullptr;
     double bestConfidence = 0.0;
+    auto consider = [&](const IndexedClub& club) {
+        double confidence = confidenceScore(
+            targetDistance, adjustDistanceForConditions(club.profile.avgDistance, conditions),
+            club.consistency);
+        // Ties go to the club name sorting first, as in a scan by name
+        if (confidence > bestConfidence ||
+            (best && confidence == bestConfidence && club.profile.name < best->profile.name)) {
+            bestConfidence = confidence;
+            best = &club;
+        }
+    };
 
-    auto clubs = storage_.getAllClubProfiles();
+    if (index_.front().profile.avgDistance + offset <= 0.0) {
+        // Distance confidence is only monotonic for positive carries
+        for (const auto& club : index_) {
+            consider(club);
+        }
+    } else {
+        // Distance confidence falls off on both sides of the target, so
+        // expand outwards while a club could still beat the best so far
+        auto bound = [&](const IndexedClub& club) {
+            return confidenceScore(targetDistance,
+                adjustDistanceForConditions(club.profile.avgDistance, conditions), maxConsistency_);
+        };
+        auto split = std::lower_bound(index_.begin(), index_.end(), targetDistance - offset,
+            [](const IndexedClub& club, double carry) { return club.profile.avgDistance < carry; });
+        ptrdiff_t left = (split - index_.begin()) - 1;
+        size_t right = split - index_.begin();
+
+        while (left >= 0 || right < index_.size()) {
+            double leftBound = left >= 0 ? bound(index_[left]) : -1.0;
+            double rightBound = right < index_.size() ? bound(index_[right]) : -1.0;
+            if (std::max(leftBound, rightBound) < bestConfidence) {
+                break;
+            }
+            if (leftBound >= rightBound) {
+                consider(index_[left--]);
+            } else {
+                consider(index_[right++]);
+            }
+        }
+    }
 
-    for (const auto& club : clubs) {
-        double adjustedDistance = adjustDistanceForConditions(
-            club.avgDistance,
-            conditions
-        );
+    if (!best) {
+        return recommendation;
+    }
 
-        double confidence = calculateConfidenceScore(
-            targetDistance,
-            club,
-            conditions
-        );
+    const ClubProfile& club = best->profile;
+    double adjustedDistance = adjustDistanceForConditions(club.avgDistance, conditions);
+    recommendation.clubName = club.name;
+    recommendation.confidenceScore = bestConfidence;
+    recommendation.expectedDistance = adjustedDistance;
+    recommendation.expectedAccuracy = club.directionDeviation;
 
-        if (confidence > bestConfidence) {
-            bestConfidence = confidence;
-            recommendation.clubName = club.name;
-            recommendation.confidenceScore = confidence;
-            recommendation.expectedDistance = adjustedDistance;
-            recommendation.expectedAccuracy = club.directionDeviation;
-
-            std::stringstream reason;
-            reason << "Expected carry: " << static_cast<int>(adjustedDistance)
-                  << "m with " << static_cast<int>(confidence * 100)
-                  << "% confidence. ";
-            
-            if (club.totalShots > 10) {
-                reason << "Based on " << club.totalShots << " recorded shots. ";
-            }
+    std::stringstream reason;
+    reason << "Expected carry: " << static_cast<int>(adjustedDistance)
+          << "m with " << static_cast<int>(bestConfidence * 100)
+          << "% confidence. ";
 
-            if (std::abs(conditions.windSpeed) > 5.0) {
-                reason << "Wind adjustment applied. ";
-            }
+    if (club.totalShots > 10) {
+        reason << "Based on " << club.totalShots << " recorded shots. ";
+    }
 
-            recommendation.reasoning = reason.str();
-        }
+    if (std::abs(conditions.windSpeed) > 5.0) {
+        reason << "Wind adjustment applied. ";
     }
 
+    recommendation.reasoning = reason.str();
     return recommendation;
 }
 
 ClubStatistics ClubAnalysis::analyzeClubPerformance(const std::string& clubName) {
-    ClubStatistics stats;
+    auto profile = storage_.getClubProfile(clubName);
+    if (profile && profile->distanceStats.count > 0) {
+        return statisticsFromProfile(*profile);
+    }
+
+    // Clubs without running statistics fall back to their recent shots
+    ClubStatistics stats{};
     auto shots = getRecentShots(clubName);
 
     if (shots.empty()) {
@@ -88,15 +145,12 @@ ClubStatistics ClubAnalysis::analyzeClubPerformance(const std::string& clubName)
 
     stats.distanceStdDev = std::sqrt(sumDistanceSquares / shots.size());
     stats.accuracyStdDev = std::sqrt(sumDeviationSquares / shots.size());
+    stats.recentDistance = stats.meanDistance;
+    stats.recentDistanceStdDev = stats.distanceStdDev;
+    stats.recentAccuracy = stats.meanAccuracy;
+    stats.recentAccuracyStdDev = stats.accuracyStdDev;
 
-    double maxAllowedDistanceVar = stats.meanDistance * 0.15;
-    double maxAllowedAccuracyVar = 20.0;
-
-    double distanceConsistency = std::max(0.0, 1.0 - (stats.distanceStdDev / maxAllowedDistanceVar));
-    double accuracyConsistency = std::max(0.0, 1.0 - (stats.accuracyStdDev / maxAllowedAccuracyVar));
-
-    stats.consistencyScore = (distanceConsistency + accuracyConsistency) / 2.0;
-
+    scoreConsistency(stats);
     return stats;
 }
 
@@ -110,7 +164,16 @@ void ClubAnalysis::updateClubStatistics(const ShotData& shot) {
         newProfile.avgLaunchAngle = shot.launchAngle;
         newProfile.totalShots = 1;
         newProfile.lastUpdated = std::time(nullptr);
-        storage_.saveClubProfile(newProfile);
+        newProfile.distanceStats.add(shot.actualDistance, RECENT_FORM_ALPHA);
+        newProfile.lateralStats.add(shot.lateralDeviation, RECENT_FORM_ALPHA);
+        newProfile.distanceSketch.add(shot.actualDistance);
+        newProfile.lateralSketch.add(shot.lateralDeviation);
+        newProfile.distanceSketch.flush();
+        newProfile.lateralSketch.flush();
+        if (storage_.saveClubProfile(newProfile)) {
+            std::lock_guard<std::mutex> lock(indexMutex_);
+            reindexClub(newProfile);
+        }
         return;
     }
 
@@ -121,34 +184,60 @@ void ClubAnalysis::updateClubStatistics(const ShotData& shot) {
     updated.avgSpinRate = (updated.avgSpinRate * updated.totalShots + shot.spinRate) * weight;
     updated.avgLaunchAngle = (updated.avgLaunchAngle * updated.totalShots + shot.launchAngle) * weight;
     
-    auto stats = analyzeClubPerformance(shot.clubUsed);
-    updated.distanceDeviation = stats.distanceStdDev;
-    updated.directionDeviation = stats.accuracyStdDev;
+    updated.distanceStats.add(shot.actualDistance, RECENT_FORM_ALPHA);
+    updated.lateralStats.add(shot.lateralDeviation, RECENT_FORM_ALPHA);
+    updated.distanceSketch.add(shot.actualDistance);
+    updated.lateralSketch.add(shot.lateralDeviation);
+    // The index shares profiles with readers; fold now so their reads copy nothing
+    updated.distanceSketch.flush();
+    updated.lateralSketch.flush();
+    updated.distanceDeviation = updated.distanceStats.stdDev();
+    updated.directionDeviation = updated.lateralStats.stdDev();
     
     updated.totalShots++;
     updated.lastUpdated = std::time(nullptr);
     
-    storage_.updateClubProfile(updated);
+    if (storage_.updateClubProfile(updated)) {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        reindexClub(updated);
+    }
 }
 
 std::map<std::string, std::pair<double, double>> ClubAnalysis::getOptimalDistanceRanges() {
-    std::map<std::string, std::pair<double, double>> ranges;
-    auto clubs = storage_.getAllClubProfiles();
+    struct Range {
+        std::string name;
+        double center;
+        double low;
+        double high;
+    };
+
+    std::vector<Range> clubs;
+    for (const auto& profile : storage_.getAllClubProfiles()) {
+        if (!profile.distanceSketch.empty()) {
+            clubs.push_back({profile.name, profile.distanceSketch.quantile(0.5),
+                             profile.distanceSketch.quantile(0.1), profile.distanceSketch.quantile(0.9)});
+            continue;
+        }
+        auto stats = profile.distanceStats.count > 0
+            ? statisticsFromProfile(profile)
+            : analyzeClubPerformance(profile.name);
+        clubs.push_back({profile.name, profile.avgDistance,
+                         profile.avgDistance - 2 * stats.distanceStdDev,
+                         profile.avgDistance + 2 * stats.distanceStdDev});
+    }
 
     std::sort(clubs.begin(), clubs.end(),
-              [](const ClubProfile& a, const ClubProfile& b) {
-                  return a.avgDistance < b.avgDistance;
+              [](const Range& a, const Range& b) {
+                  return a.center < b.center;
               });
 
+    std::map<std::string, std::pair<double, double>> ranges;
     for (size_t i = 0; i < clubs.size(); ++i) {
-        auto stats = analyzeClubPerformance(clubs[i].name);
-        double minDist = clubs[i].avgDistance - 2 * stats.distanceStdDev;
-        double maxDist = clubs[i].avgDistance + 2 * stats.distanceStdDev;
+        double minDist = clubs[i].low;
+        double maxDist = clubs[i].high;
 
         if (i > 0) {
-            // No need to store prevStats since we're not using it
-            analyzeClubPerformance(clubs[i-1].name);
-            double midpoint = (clubs[i].avgDistance + clubs[i-1].avgDistance) / 2;
+            double midpoint = (clubs[i].center + clubs[i-1].center) / 2;
             ranges[clubs[i-1].name].second = midpoint;
             minDist = midpoint;
         }
@@ -159,20 +248,105 @@ std::map<std::string, std::pair<double, double>> ClubAnalysis::getOptimalDistanc
     return ranges;
 }
 
+std::vector<ClubGapping> ClubAnalysis::getDistanceGapping() {
+    return gappingFromProfiles(storage_.getAllClubProfiles());
+}
+
+std::vector<ClubGapping> ClubAnalysis::gappingFromProfiles(const std::vector<ClubProfile>& profiles) {
+    std::map<std::string, std::pair<QuantileSketch, QuantileSketch>> merged;
+    for (const auto& profile : profiles) {
+        auto& sketches = merged[profile.name];
+        sketches.first.merge(profile.distanceSketch);
+        sketches.second.merge(profile.lateralSketch);
+    }
+
+    std::vector<ClubGapping> gapping;
+    for (const auto& [name, sketches] : merged) {
+        const QuantileSketch& carry = sketches.first;
+        const QuantileSketch& lateral = sketches.second;
+        if (carry.empty()) {
+            continue;
+        }
+        gapping.push_back({name,
+                           carry.quantile(0.1), carry.quantile(0.5), carry.quantile(0.9),
+                           lateral.quantile(0.1), lateral.quantile(0.5), lateral.quantile(0.9),
+                           static_cast<size_t>(carry.count())});
+    }
+
+    std::sort(gapping.begin(), gapping.end(),
+              [](const ClubGapping& a, const ClubGapping& b) {
+                  return a.carryP50 < b.carryP50;
+              });
+    return gapping;
+}
+
 double ClubAnalysis::calculateConfidenceScore(
     double targetDistance,
     const ClubProfile& profile,
     const weather::WeatherData& conditions
 ) {
     double adjustedDistance = adjustDistanceForConditions(profile.avgDistance, conditions);
+    auto stats = profile.distanceStats.count > 0
+        ? statisticsFromProfile(profile)
+        : analyzeClubPerformance(profile.name);
+    return confidenceScore(targetDistance, adjustedDistance, stats.consistencyScore);
+}
+
+double ClubAnalysis::confidenceScore(double targetDistance, double adjustedDistance, double consistency) {
     double distanceDiff = std::abs(targetDistance - adjustedDistance);
     double distanceConfidence = std::max(0.0, 1.0 - (distanceDiff / adjustedDistance));
-
-    auto stats = analyzeClubPerformance(profile.name);
     double consistencyWeight = 0.3;
-    
-    return (distanceConfidence * (1.0 - consistencyWeight)) + 
-           (stats.consistencyScore * consistencyWeight);
+
+    return (distanceConfidence * (1.0 - consistencyWeight)) +
+           (consistency * consistencyWeight);
+}
+
+void ClubAnalysis::invalidateRecommendationIndex() {
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    indexValid_ = false;
+    index_.clear();
+}
+
+void ClubAnalysis::ensureIndex() {
+    if (indexValid_) {
+        return;
+    }
+
+    index_.clear();
+    for (auto& profile : storage_.getAllClubProfiles()) {
+        auto stats = profile.distanceStats.count > 0
+            ? statisticsFromProfile(profile)
+            : analyzeClubPerformance(profile.name);
+        index_.push_back({std::move(profile), stats.consistencyScore});
+    }
+    std::sort(index_.begin(), index_.end(), byCarry<IndexedClub>);
+
+    maxConsistency_ = 0.0;
+    for (const auto& club : index_) {
+        maxConsistency_ = std::max(maxConsistency_, club.consistency);
+    }
+    indexValid_ = true;
+}
+
+void ClubAnalysis::reindexClub(const ClubProfile& profile) {
+    if (!indexValid_) {
+        return;  // Built from storage on the next recommendation
+    }
+
+    auto existing = std::find_if(index_.begin(), index_.end(),
+        [&](const IndexedClub& club) { return club.profile.name == profile.name; });
+    if (existing != index_.end()) {
+        index_.erase(existing);
+    }
+
+    IndexedClub entry{profile, statisticsFromProfile(profile).consistencyScore};
+    auto position = std::lower_bound(index_.begin(), index_.end(), entry, byCarry<IndexedClub>);
+    index_.insert(position, std::move(entry));
+
+    maxConsistency_ = 0.0;
+    for (const auto& club : index_) {
+        maxConsistency_ = std::max(maxConsistency_, club.consistency);
+    }
 }
 
 double ClubAnalysis::adjustDistanceForConditions(
@@ -190,9 +364,34 @@ double ClubAnalysis::adjustDistanceForConditions(
 
 std::vector<ShotData> ClubAnalysis::getRecentShots(
     const std::string& clubName,
-    [[maybe_unused]] size_t limit
+    size_t limit
 ) {
-    return storage_.getShotsByClub(clubName);
+    return storage_.getRecentShotsByClub(clubName, limit);
+}
+
+ClubStatistics ClubAnalysis::statisticsFromProfile(const ClubProfile& profile) {
+    ClubStatistics stats{};
+    stats.meanDistance = profile.distanceStats.mean;
+    stats.distanceStdDev = profile.distanceStats.stdDev();
+    stats.meanAccuracy = profile.lateralStats.mean;
+    stats.accuracyStdDev = profile.lateralStats.stdDev();
+    stats.sampleSize = profile.distanceStats.count;
+    stats.recentDistance = profile.distanceStats.recentMean;
+    stats.recentDistanceStdDev = profile.distanceStats.recentStdDev();
+    stats.recentAccuracy = profile.lateralStats.recentMean;
+    stats.recentAccuracyStdDev = profile.lateralStats.recentStdDev();
+    scoreConsistency(stats);
+    return stats;
+}
+
+void ClubAnalysis::scoreConsistency(ClubStatistics& stats) {
+    double maxAllowedDistanceVar = stats.meanDistance * 0.15;
+    double maxAllowedAccuracyVar = 20.0;
+
+    double distanceConsistency = std::max(0.0, 1.0 - (stats.distanceStdDev / maxAllowedDistanceVar));
+    double accuracyConsistency = std::max(0.0, 1.0 - (stats.accuracyStdDev / maxAllowedAccuracyVar));
+
+    stats.consistencyScore = (distanceConsistency + accuracyConsistency) / 2.0;
 }
 
 }} // namespace gptgolf::data
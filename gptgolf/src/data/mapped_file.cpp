@@ -0,0 +1,282 @@
+#include "data/mapped_file.h"
+#include <cstdint>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gptgolf {
+namespace data {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(file_, other.file_);
+        std::swap(open_, other.open_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t minSize) {
+    close();
+    bool writable = mode != Mode::ReadOnly;
+    // Delete sharing lets the file be removed while it is mapped
+    HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              mode == Mode::CreateNew ? CREATE_NEW : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    auto fail = [&]() {
+        CloseHandle(file);
+        if (mode == Mode::CreateNew) {
+            DeleteFileA(path.c_str());
+        }
+        return false;
+    };
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length)) {
+        return fail();
+    }
+    size_t size = static_cast<size_t>(length.QuadPart);
+    if (writable && minSize > size) {
+        // Windows zero-fills the extension when it is read
+        LARGE_INTEGER target;
+        target.QuadPart = static_cast<LONGLONG>(minSize);
+        if (!SetFilePointerEx(file, target, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            return fail();
+        }
+        size = minSize;
+    }
+
+    void* view = nullptr;
+    if (size > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            return fail();
+        }
+        view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+        // The view keeps the mapping object alive
+        CloseHandle(mapping);
+        if (!view) {
+            return fail();
+        }
+    }
+
+    if (writable) {
+        file_ = file;
+    } else {
+        CloseHandle(file);
+    }
+    open_ = true;
+    data_ = view;
+    size_ = size;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (file_) {
+        CloseHandle(file_);
+        file_ = nullptr;
+    }
+}
+
+bool MappedFile::closeAndTruncate(size_t length, bool sync) {
+    unmap();
+    if (!file_) {
+        return false;
+    }
+    LARGE_INTEGER target;
+    target.QuadPart = static_cast<LONGLONG>(length);
+    bool ok = SetFilePointerEx(file_, target, nullptr, FILE_BEGIN) && SetEndOfFile(file_);
+    if (ok && sync) {
+        ok = FlushFileBuffers(file_) != 0;
+    }
+    CloseHandle(file_);
+    file_ = nullptr;
+    return ok;
+}
+
+bool MappedFile::flush(size_t offset, size_t length) {
+    if (!data_ || offset + length > size_) {
+        return false;
+    }
+    // FlushViewOfFile only queues the pages; FlushFileBuffers waits for them
+    if (!FlushViewOfFile(data() + offset, length)) {
+        return false;
+    }
+    return !file_ || FlushFileBuffers(file_);
+}
+
+void MappedFile::adviseSequential() {
+}
+
+bool appendToFile(const std::string& path, const std::string& bytes, bool sync) {
+    HANDLE file = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr) &&
+              written == bytes.size();
+    if (ok && sync) {
+        ok = FlushFileBuffers(file) != 0;
+    }
+    CloseHandle(file);
+    return ok;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t minSize) {
+    close();
+    bool writable = mode != Mode::ReadOnly;
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (mode == Mode::CreateNew) {
+        flags |= O_CREAT | O_EXCL;
+    }
+    int fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    auto fail = [&]() {
+        ::close(fd);
+        if (mode == Mode::CreateNew) {
+            ::unlink(path.c_str());
+        }
+        return false;
+    };
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return fail();
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (writable && minSize > size) {
+        if (::ftruncate(fd, static_cast<off_t>(minSize)) != 0) {
+            return fail();
+        }
+        size = minSize;
+    }
+
+    void* view = nullptr;
+    if (size > 0) {
+        view = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            return fail();
+        }
+    }
+
+    // The mapping keeps the file referenced; only writers need the descriptor
+    if (writable) {
+        file_ = fd;
+    } else {
+        ::close(fd);
+    }
+    open_ = true;
+    data_ = view;
+    size_ = size;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (file_ >= 0) {
+        ::close(file_);
+        file_ = -1;
+    }
+}
+
+bool MappedFile::closeAndTruncate(size_t length, bool sync) {
+    unmap();
+    if (file_ < 0) {
+        return false;
+    }
+    bool ok = ::ftruncate(file_, static_cast<off_t>(length)) == 0;
+    if (ok && sync) {
+        ok = ::fsync(file_) == 0;
+    }
+    ::close(file_);
+    file_ = -1;
+    return ok;
+}
+
+bool MappedFile::flush(size_t offset, size_t length) {
+    if (!data_ || offset + length > size_) {
+        return false;
+    }
+    // msync needs a page-aligned start address
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t aligned = offset & ~(pageSize - 1);
+    return msync(data() + aligned, length + (offset - aligned), MS_SYNC) == 0;
+}
+
+void MappedFile::adviseSequential() {
+    if (data_) {
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+}
+
+bool appendToFile(const std::string& path, const std::string& bytes, bool sync) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size());
+    if (ok && sync) {
+        ok = ::fsync(fd) == 0;
+    }
+    ::close(fd);
+    return ok;
+}
+
+#endif
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,229 @@
+#include "data/online_backup.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+namespace gptgolf {
+namespace data {
+
+OnlineBackup::OnlineBackup(sqlite3* source, std::mutex& sourceMutex, const std::string& destinationPath,
+                           const BackupOptions& options)
+    : source_(source)
+    , sourceMutex_(sourceMutex)
+    , destinationPath_(destinationPath)
+    , partialPath_(destinationPath + ".partial")
+    , options_(options)
+    , started_(std::chrono::steady_clock::now())
+    , stopping_(false) {
+    options_.maxPagesPerStep = std::max(1, options_.maxPagesPerStep);
+    options_.initialPagesPerStep = std::clamp(options_.initialPagesPerStep, 1, options_.maxPagesPerStep);
+    progress_.pagesPerStep = options_.initialPagesPerStep;
+    worker_ = std::thread(&OnlineBackup::run, this);
+}
+
+OnlineBackup::~OnlineBackup() {
+    cancel();
+    worker_.join();
+}
+
+BackupProgress OnlineBackup::progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BackupProgress progress = progress_;
+    if (!progress.finished()) {
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+    return progress;
+}
+
+bool OnlineBackup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [this] { return progress_.finished(); });
+    return progress_.state == BackupState::Completed;
+}
+
+void OnlineBackup::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+}
+
+void OnlineBackup::run() {
+    std::error_code ec;
+    std::filesystem::remove(partialPath_, ec);
+
+    sqlite3* destination = nullptr;
+    if (sqlite3_open(partialPath_.c_str(), &destination) != SQLITE_OK) {
+        std::string error = destination ? sqlite3_errmsg(destination) : "cannot open backup file";
+        sqlite3_close(destination);
+        std::filesystem::remove(partialPath_, ec);
+        finish(BackupState::Failed, error);
+        return;
+    }
+
+    // Each step commits the copy while the source is locked, so skip the
+    // sync there; the copy is synced once after the last step instead
+    sqlite3_exec(destination, "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF;", nullptr, nullptr, nullptr);
+    bool copied = copyPages(destination) && syncCopy(destination);
+
+    bool cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled = stopping_;
+        if (copied && options_.verify) {
+            progress_.state = BackupState::Verifying;
+        }
+    }
+
+    if (!copied) {
+        sqlite3_close(destination);
+        std::filesystem::remove(partialPath_, ec);
+        if (cancelled) {
+            finish(BackupState::Cancelled);
+        }
+        return;
+    }
+
+    // The check reads only the copy, so the source stays available to writers
+    bool verified = !options_.verify || verifyCopy(destination);
+    sqlite3_close(destination);
+    if (!verified) {
+        std::filesystem::remove(partialPath_, ec);
+        return;
+    }
+
+    std::filesystem::rename(partialPath_, destinationPath_, ec);
+    if (ec) {
+        std::filesystem::remove(partialPath_, ec);
+        finish(BackupState::Failed, "cannot move backup into place: " + ec.message());
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.verified = options_.verify;
+    }
+    finish(BackupState::Completed);
+}
+
+bool OnlineBackup::copyPages(sqlite3* destination) {
+    sqlite3_backup* backup;
+    {
+        std::lock_guard<std::mutex> lock(sourceMutex_);
+        backup = sqlite3_backup_init(destination, "main", source_, "main");
+    }
+    if (!backup) {
+        finish(BackupState::Failed, sqlite3_errmsg(destination));
+        return false;
+    }
+
+    int pages = options_.initialPagesPerStep;
+    int rc = SQLITE_OK;
+    while (true) {
+        std::chrono::microseconds held;
+        int remaining;
+        int total;
+        {
+            std::lock_guard<std::mutex> lock(sourceMutex_);
+            auto start = std::chrono::steady_clock::now();
+            rc = sqlite3_backup_step(backup, pages);
+            held = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            remaining = sqlite3_backup_remaining(backup);
+            total = sqlite3_backup_pagecount(backup);
+        }
+
+        // Size the next step from this step's cost per page, growing at
+        // most twofold so one cheap step cannot overshoot the budget
+        std::int64_t target = std::int64_t(pages) * 2;
+        if (held.count() > 0) {
+            target = std::min(target, pages * options_.stepBudget.count() / held.count());
+        }
+        pages = static_cast<int>(std::clamp<std::int64_t>(target, 1, options_.maxPagesPerStep));
+
+        bool busy = rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+        std::unique_lock<std::mutex> lock(mutex_);
+        progress_.steps++;
+        progress_.busyRetries += busy ? 1 : 0;
+        progress_.pagesTotal = total;
+        progress_.pagesRemaining = remaining;
+        progress_.pagesPerStep = pages;
+        progress_.longestStep = std::max(progress_.longestStep, held);
+
+        if (rc == SQLITE_DONE || (rc != SQLITE_OK && !busy)) {
+            break;
+        }
+        if (wake_.wait_for(lock, options_.stepInterval, [this] { return stopping_; })) {
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sourceMutex_);
+        sqlite3_backup_finish(backup);
+    }
+    if (rc == SQLITE_DONE) {
+        return true;
+    }
+    bool cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled = stopping_;
+    }
+    if (!cancelled) {
+        finish(BackupState::Failed, sqlite3_errstr(rc));
+    }
+    return false;
+}
+
+bool OnlineBackup::syncCopy(sqlite3* destination) {
+    // Rewriting the header with synchronous on makes SQLite sync the file
+    sqlite3_stmt* stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(destination, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    std::string sql = "PRAGMA synchronous = FULL; BEGIN; PRAGMA user_version = " +
+                      std::to_string(version) + "; COMMIT;";
+    if (sqlite3_exec(destination, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+        finish(BackupState::Failed, sqlite3_errmsg(destination));
+        return false;
+    }
+    return true;
+}
+
+bool OnlineBackup::verifyCopy(sqlite3* destination) {
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(destination, "PRAGMA integrity_check;", -1, &stmt, nullptr) != SQLITE_OK) {
+        finish(BackupState::Failed, sqlite3_errmsg(destination));
+        return false;
+    }
+    std::string result;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* text = sqlite3_column_text(stmt, 0);
+        result = text ? reinterpret_cast<const char*>(text) : "";
+    }
+    sqlite3_finalize(stmt);
+
+    if (result != "ok") {
+        finish(BackupState::Failed, "integrity check failed: " + result);
+        return false;
+    }
+    return true;
+}
+
+void OnlineBackup::finish(BackupState state, const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.state = state;
+        progress_.error = error;
+        progress_.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+    wake_.notify_all();
+}
+
+} // namespace data
+} // namespace gptgolf
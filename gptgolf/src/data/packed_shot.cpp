@@ -0,0 +1,183 @@
+#include "data/packed_shot.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace gptgolf {
+namespace data {
+
+static_assert(sizeof(PackedShot) == 72, "PackedShot layout changed");
+static_assert(sizeof(PackedLaunchData) == 76, "PackedLaunchData layout changed");
+
+ShotQuality parseShotQuality(const std::string& rating) {
+    if (rating == "Good") return ShotQuality::Good;
+    if (rating == "Partial") return ShotQuality::Partial;
+    if (rating == "Poor") return ShotQuality::Poor;
+    return ShotQuality::Unknown;
+}
+
+const char* shotQualityName(ShotQuality quality) {
+    switch (quality) {
+        case ShotQuality::Good: return "Good";
+        case ShotQuality::Partial: return "Partial";
+        case ShotQuality::Poor: return "Poor";
+        case ShotQuality::Unknown: return "";
+    }
+    return "";
+}
+
+ClubId ClubNameTable::intern(const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= MAX_CLUBS) {
+        throw std::length_error("Club name table is full");
+    }
+    ClubId id = static_cast<ClubId>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    return id;
+}
+
+std::optional<ClubId> ClubNameTable::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string& ClubNameTable::name(ClubId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.at(id);
+}
+
+size_t ClubNameTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+size_t ClubNameTable::sizeInBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t bytes = ids_.bucket_count() * sizeof(void*);
+    for (const auto& name : names_) {
+        // Each name is held twice: as a map key and in names_
+        bytes += 2 * (sizeof(std::string) + name.capacity()) + sizeof(ClubId) + 2 * sizeof(void*);
+    }
+    return bytes;
+}
+
+PackedShot PackedShot::pack(const ShotData& shot, ClubNameTable& clubs) {
+    PackedShot packed;
+    packed.timestamp = static_cast<std::int64_t>(shot.timestamp);
+    packed.weatherTimestamp = static_cast<std::int64_t>(shot.conditions.timestamp);
+    packed.initialVelocity = static_cast<float>(shot.initialVelocity);
+    packed.spinRate = static_cast<float>(shot.spinRate);
+    packed.launchAngle = static_cast<float>(shot.launchAngle);
+    packed.actualDistance = static_cast<float>(shot.actualDistance);
+    packed.predictedDistance = static_cast<float>(shot.predictedDistance);
+    packed.lateralDeviation = static_cast<float>(shot.lateralDeviation);
+    packed.temperature = static_cast<float>(shot.conditions.temperature);
+    packed.humidity = static_cast<float>(shot.conditions.humidity);
+    packed.pressure = static_cast<float>(shot.conditions.pressure);
+    packed.windSpeed = static_cast<float>(shot.conditions.windSpeed);
+    packed.windDirection = static_cast<float>(shot.conditions.windDirection);
+    packed.precipitation = static_cast<float>(shot.conditions.precipitation);
+    packed.altitude = static_cast<float>(shot.conditions.altitude);
+    packed.club = clubs.intern(shot.clubUsed);
+    return packed;
+}
+
+ShotData PackedShot::unpack(const ClubNameTable& clubs) const {
+    ShotData shot;
+    shot.timestamp = static_cast<std::time_t>(timestamp);
+    shot.conditions.timestamp = static_cast<std::time_t>(weatherTimestamp);
+    shot.initialVelocity = initialVelocity;
+    shot.spinRate = spinRate;
+    shot.launchAngle = launchAngle;
+    shot.actualDistance = actualDistance;
+    shot.predictedDistance = predictedDistance;
+    shot.lateralDeviation = lateralDeviation;
+    shot.conditions.temperature = temperature;
+    shot.conditions.humidity = humidity;
+    shot.conditions.pressure = pressure;
+    shot.conditions.windSpeed = windSpeed;
+    shot.conditions.windDirection = windDirection;
+    shot.conditions.precipitation = precipitation;
+    shot.conditions.altitude = altitude;
+    shot.clubUsed = clubs.name(club);
+    return shot;
+}
+
+PackedLaunchData PackedLaunchData::pack(const LaunchMonitorData& data) {
+    PackedLaunchData packed;
+    packed.ballSpeed = static_cast<float>(data.ballSpeed);
+    packed.launchAngle = static_cast<float>(data.launchAngle);
+    packed.launchDirection = static_cast<float>(data.launchDirection);
+    packed.spinRate = static_cast<float>(data.spinRate);
+    packed.spinAxis = static_cast<float>(data.spinAxis);
+    packed.smashFactor = static_cast<float>(data.smashFactor);
+    packed.ballVertical = static_cast<float>(data.ballVertical);
+    packed.ballHorizontal = static_cast<float>(data.ballHorizontal);
+    packed.carryDistance = static_cast<float>(data.carryDistance);
+    packed.totalDistance = static_cast<float>(data.totalDistance);
+    packed.maxHeight = static_cast<float>(data.maxHeight);
+    packed.landingAngle = static_cast<float>(data.landingAngle);
+    packed.clubSpeed = static_cast<float>(data.clubSpeed);
+    packed.clubPath = static_cast<float>(data.clubPath);
+    packed.faceAngle = static_cast<float>(data.faceAngle);
+    packed.attackAngle = static_cast<float>(data.attackAngle);
+    packed.dynamicLoft = static_cast<float>(data.dynamicLoft);
+    packed.confidence = static_cast<float>(data.confidence);
+    packed.quality = parseShotQuality(data.quality);
+    return packed;
+}
+
+LaunchMonitorData PackedLaunchData::unpack() const {
+    LaunchMonitorData data;
+    data.ballSpeed = ballSpeed;
+    data.launchAngle = launchAngle;
+    data.launchDirection = launchDirection;
+    data.spinRate = spinRate;
+    data.spinAxis = spinAxis;
+    data.smashFactor = smashFactor;
+    data.ballVertical = ballVertical;
+    data.ballHorizontal = ballHorizontal;
+    data.carryDistance = carryDistance;
+    data.totalDistance = totalDistance;
+    data.maxHeight = maxHeight;
+    data.landingAngle = landingAngle;
+    data.clubSpeed = clubSpeed;
+    data.clubPath = clubPath;
+    data.faceAngle = faceAngle;
+    data.attackAngle = attackAngle;
+    data.dynamicLoft = dynamicLoft;
+    data.confidence = confidence;
+    data.quality = shotQualityName(quality);
+    return data;
+}
+
+size_t PackedShotStore::sizeInBytes() const {
+    return shots_.capacity() * sizeof(PackedShot) + clubs_.sizeInBytes();
+}
+
+size_t shotDataFootprint(const ShotData& shot) {
+    // Short names live in the string object itself (small string optimization)
+    const char* data = shot.clubUsed.data();
+    const char* object = reinterpret_cast<const char*>(&shot.clubUsed);
+    bool inlined = data >= object && data < object + sizeof(std::string);
+    return sizeof(ShotData) + (inlined ? 0 : shot.clubUsed.capacity() + 1);
+}
+
+} // namespace data
+} // namespace gptgolf
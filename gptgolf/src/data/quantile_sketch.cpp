@@ -0,0 +1,222 @@
+#include "data/quantile_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr std::uint32_t SKETCH_FORMAT_VERSION = 1;
+
+// Serialized layout: header, then (float mean, uint32 weight) per centroid
+struct SketchHeader {
+    std::uint32_t version;
+    std::uint32_t centroidCount;
+    double compression;
+    double min;
+    double max;
+};
+
+constexpr size_t CENTROID_BYTES = sizeof(float) + sizeof(std::uint32_t);
+
+// t-digest k1 scale function and its inverse: a centroid may span at most
+// one unit of k, which keeps centroids near q = 0 and q = 1 small
+double scale(double q, double compression) {
+    return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+double inverseScale(double k, double compression) {
+    double angle = std::clamp(k * 2.0 * PI / compression, -PI / 2.0, PI / 2.0);
+    return (std::sin(angle) + 1.0) / 2.0;
+}
+
+} // namespace
+
+QuantileSketch::QuantileSketch(double compression)
+    : compression_(compression),
+      count_(0),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()) {}
+
+void QuantileSketch::add(double value, std::uint64_t weight) {
+    if (std::isnan(value) || weight == 0) {
+        return;
+    }
+
+    buffer_.push_back({value, weight});
+    count_ += weight;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+
+    if (buffer_.size() >= static_cast<size_t>(compression_ * 5)) {
+        flush();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (&other == this) {
+        // Inserting a vector's own range into it is undefined
+        QuantileSketch copy(other);
+        merge(copy);
+        return;
+    }
+
+    buffer_.insert(buffer_.end(), other.centroids_.begin(), other.centroids_.end());
+    buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    flush();
+}
+
+void QuantileSketch::flush() {
+    if (buffer_.empty()) {
+        return;
+    }
+    centroids_ = mergedCentroids();
+    buffer_.clear();
+}
+
+const std::vector<QuantileSketch::Centroid>& QuantileSketch::summary(std::vector<Centroid>& scratch) const {
+    if (buffer_.empty()) {
+        return centroids_;
+    }
+    scratch = mergedCentroids();
+    return scratch;
+}
+
+std::vector<QuantileSketch::Centroid> QuantileSketch::mergedCentroids() const {
+    std::vector<Centroid> all;
+    all.reserve(centroids_.size() + buffer_.size());
+    all.insert(all.end(), centroids_.begin(), centroids_.end());
+    all.insert(all.end(), buffer_.begin(), buffer_.end());
+    std::sort(all.begin(), all.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    double total = static_cast<double>(count_);
+    std::vector<Centroid> merged;
+    merged.push_back(all.front());
+    double weightBefore = 0.0;
+    double weightLimit = total * inverseScale(scale(0.0, compression_) + 1.0, compression_);
+
+    for (size_t i = 1; i < all.size(); ++i) {
+        Centroid& current = merged.back();
+        if (weightBefore + current.weight + all[i].weight <= weightLimit) {
+            current.weight += all[i].weight;
+            current.mean += (all[i].mean - current.mean) * all[i].weight / current.weight;
+        } else {
+            weightBefore += current.weight;
+            weightLimit = total * inverseScale(scale(weightBefore / total, compression_) + 1.0, compression_);
+            merged.push_back(all[i]);
+        }
+    }
+
+    return merged;
+}
+
+size_t QuantileSketch::centroidCount() const {
+    std::vector<Centroid> scratch;
+    return summary(scratch).size();
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    std::vector<Centroid> scratch;
+    const std::vector<Centroid>& centroids = summary(scratch);
+
+    q = std::clamp(q, 0.0, 1.0);
+    double index = q * count_;
+
+    // Each centroid's mean sits at the middle of its weight; the tails
+    // interpolate towards the exact min and max
+    const Centroid& first = centroids.front();
+    if (index <= first.weight / 2.0) {
+        return min_ + (first.mean - min_) * index / (first.weight / 2.0);
+    }
+
+    const Centroid& last = centroids.back();
+    if (index >= count_ - last.weight / 2.0) {
+        double tail = count_ - index;
+        return max_ - (max_ - last.mean) * tail / (last.weight / 2.0);
+    }
+
+    double center = first.weight / 2.0;
+    for (size_t i = 0; i + 1 < centroids.size(); ++i) {
+        double gap = (centroids[i].weight + centroids[i + 1].weight) / 2.0;
+        if (center + gap >= index) {
+            double fraction = (index - center) / gap;
+            return centroids[i].mean + (centroids[i + 1].mean - centroids[i].mean) * fraction;
+        }
+        center += gap;
+    }
+    return last.mean;
+}
+
+std::vector<std::uint8_t> QuantileSketch::serialize() const {
+    std::vector<Centroid> scratch;
+    const std::vector<Centroid>& centroids = summary(scratch);
+
+    SketchHeader header{};
+    header.version = SKETCH_FORMAT_VERSION;
+    header.centroidCount = static_cast<std::uint32_t>(centroids.size());
+    header.compression = compression_;
+    header.min = min_;
+    header.max = max_;
+
+    std::vector<std::uint8_t> data(sizeof(header) + centroids.size() * CENTROID_BYTES);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::uint8_t* out = data.data() + sizeof(header);
+    for (const auto& centroid : centroids) {
+        float mean = static_cast<float>(centroid.mean);
+        std::uint32_t weight = static_cast<std::uint32_t>(
+            std::min<std::uint64_t>(centroid.weight, std::numeric_limits<std::uint32_t>::max()));
+        std::memcpy(out, &mean, sizeof(mean));
+        std::memcpy(out + sizeof(mean), &weight, sizeof(weight));
+        out += CENTROID_BYTES;
+    }
+    return data;
+}
+
+std::optional<QuantileSketch> QuantileSketch::deserialize(const void* data, size_t size) {
+    SketchHeader header;
+    if (!data || size < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != SKETCH_FORMAT_VERSION || !(header.compression > 0.0) ||
+        size != sizeof(header) + static_cast<size_t>(header.centroidCount) * CENTROID_BYTES) {
+        return std::nullopt;
+    }
+
+    QuantileSketch sketch(header.compression);
+    const std::uint8_t* in = static_cast<const std::uint8_t*>(data) + sizeof(header);
+    for (std::uint32_t i = 0; i < header.centroidCount; ++i) {
+        float mean;
+        std::uint32_t weight;
+        std::memcpy(&mean, in, sizeof(mean));
+        std::memcpy(&weight, in + sizeof(mean), sizeof(weight));
+        in += CENTROID_BYTES;
+        if (weight == 0) {
+            return std::nullopt;
+        }
+        sketch.centroids_.push_back({mean, weight});
+        sketch.count_ += weight;
+    }
+    if (sketch.count_ > 0) {
+        sketch.min_ = header.min;
+        sketch.max_ = header.max;
+    }
+    return sketch;
+}
+
+} // namespace data
+} // namespace gptgolf
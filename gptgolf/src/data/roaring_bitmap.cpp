@@ -0,0 +1,247 @@
+#include "data/roaring_bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace gptgolf {
+namespace data {
+
+void RoaringBitmap::Container::add(std::uint16_t low) {
+    if (isBitmap()) {
+        std::uint64_t mask = std::uint64_t(1) << (low % 64);
+        if (!(words[low / 64] & mask)) {
+            words[low / 64] |= mask;
+            ++cardinality;
+        }
+        return;
+    }
+
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) {
+            return;
+        }
+        array.insert(it, low);
+    }
+    ++cardinality;
+    if (array.size() > ARRAY_LIMIT) {
+        toBitmap();
+    }
+}
+
+bool RoaringBitmap::Container::contains(std::uint16_t low) const {
+    if (isBitmap()) {
+        return (words[low / 64] >> (low % 64)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::toBitmap() {
+    words.assign(BITMAP_WORDS, 0);
+    for (std::uint16_t low : array) {
+        words[low / 64] |= std::uint64_t(1) << (low % 64);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::toArrayIfSparse() {
+    if (!isBitmap() || cardinality > ARRAY_LIMIT) {
+        return;
+    }
+    array.clear();
+    array.reserve(cardinality);
+    for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+        std::uint64_t bits = words[word];
+        while (bits) {
+            array.push_back(static_cast<std::uint16_t>(word * 64 + __builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+    words.clear();
+    words.shrink_to_fit();
+}
+
+RoaringBitmap RoaringBitmap::range(std::uint32_t begin, std::uint32_t end) {
+    RoaringBitmap bitmap;
+    std::uint64_t value = begin;
+    while (value < end) {
+        std::uint32_t key = static_cast<std::uint32_t>(value >> 16);
+        std::uint64_t chunkEnd = std::min<std::uint64_t>(end, (std::uint64_t(key) + 1) << 16);
+        std::uint32_t first = static_cast<std::uint32_t>(value & 0xFFFF);
+        std::uint32_t count = static_cast<std::uint32_t>(chunkEnd - value);
+
+        Container container;
+        container.cardinality = count;
+        if (count > ARRAY_LIMIT) {
+            container.words.assign(BITMAP_WORDS, 0);
+            for (std::uint32_t low = first; low < first + count; ++low) {
+                container.words[low / 64] |= std::uint64_t(1) << (low % 64);
+            }
+        } else {
+            container.array.resize(count);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                container.array[i] = static_cast<std::uint16_t>(first + i);
+            }
+        }
+        bitmap.keys_.push_back(static_cast<std::uint16_t>(key));
+        bitmap.containers_.push_back(std::move(container));
+        value = chunkEnd;
+    }
+    return bitmap;
+}
+
+void RoaringBitmap::add(std::uint32_t value) {
+    std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    std::uint16_t low = static_cast<std::uint16_t>(value & 0xFFFF);
+
+    if (keys_.empty() || keys_.back() < key) {
+        keys_.push_back(key);
+        containers_.emplace_back();
+        containers_.back().add(low);
+        return;
+    }
+
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    size_t index = it - keys_.begin();
+    if (*it != key) {
+        keys_.insert(it, key);
+        containers_.insert(containers_.begin() + index, Container());
+    }
+    containers_[index].add(low);
+}
+
+bool RoaringBitmap::contains(std::uint32_t value) const {
+    std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    if (it == keys_.end() || *it != key) {
+        return false;
+    }
+    return containers_[it - keys_.begin()].contains(static_cast<std::uint16_t>(value & 0xFFFF));
+}
+
+std::uint64_t RoaringBitmap::cardinality() const {
+    std::uint64_t total = 0;
+    for (const auto& container : containers_) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+size_t RoaringBitmap::sizeInBytes() const {
+    size_t bytes = keys_.capacity() * sizeof(std::uint16_t) + containers_.capacity() * sizeof(Container);
+    for (const auto& container : containers_) {
+        bytes += container.array.capacity() * sizeof(std::uint16_t) +
+                 container.words.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container result;
+    if (a.isBitmap() && b.isBitmap()) {
+        result.words.resize(BITMAP_WORDS);
+        for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+            result.words[word] = a.words[word] & b.words[word];
+            result.cardinality += __builtin_popcountll(result.words[word]);
+        }
+        result.toArrayIfSparse();
+    } else if (a.isBitmap() || b.isBitmap()) {
+        const Container& bitmap = a.isBitmap() ? a : b;
+        const Container& array = a.isBitmap() ? b : a;
+        for (std::uint16_t low : array.array) {
+            if (bitmap.contains(low)) {
+                result.array.push_back(low);
+            }
+        }
+        result.cardinality = static_cast<std::uint32_t>(result.array.size());
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+        result.cardinality = static_cast<std::uint32_t>(result.array.size());
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::unite(const Container& a, const Container& b) {
+    Container result;
+    if (a.isBitmap() || b.isBitmap()) {
+        result = a.isBitmap() ? a : b;
+        const Container& other = a.isBitmap() ? b : a;
+        if (other.isBitmap()) {
+            result.cardinality = 0;
+            for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+                result.words[word] |= other.words[word];
+                result.cardinality += __builtin_popcountll(result.words[word]);
+            }
+        } else {
+            for (std::uint16_t low : other.array) {
+                result.add(low);
+            }
+        }
+    } else {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(result.array));
+        result.cardinality = static_cast<std::uint32_t>(result.array.size());
+        if (result.array.size() > ARRAY_LIMIT) {
+            result.toBitmap();
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < keys_.size() && j < other.keys_.size()) {
+        if (keys_[i] < other.keys_[j]) {
+            ++i;
+        } else if (keys_[i] > other.keys_[j]) {
+            ++j;
+        } else {
+            Container container = intersect(containers_[i], other.containers_[j]);
+            if (container.cardinality > 0) {
+                result.keys_.push_back(keys_[i]);
+                result.containers_.push_back(std::move(container));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < keys_.size() || j < other.keys_.size()) {
+        if (j == other.keys_.size() || (i < keys_.size() && keys_[i] < other.keys_[j])) {
+            result.keys_.push_back(keys_[i]);
+            result.containers_.push_back(containers_[i++]);
+        } else if (i == keys_.size() || other.keys_[j] < keys_[i]) {
+            result.keys_.push_back(other.keys_[j]);
+            result.containers_.push_back(other.containers_[j++]);
+        } else {
+            result.keys_.push_back(keys_[i]);
+            result.containers_.push_back(unite(containers_[i++], other.containers_[j++]));
+        }
+    }
+    return result;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const {
+    return cardinality() == other.cardinality() && toVector() == other.toVector();
+}
+
+std::vector<std::uint32_t> RoaringBitmap::toVector() const {
+    std::vector<std::uint32_t> values;
+    values.reserve(cardinality());
+    forEach([&](std::uint32_t value) { values.push_back(value); });
+    return values;
+}
+
+} // namespace data
+} // namespace gptgolf
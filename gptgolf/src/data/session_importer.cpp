@@ -0,0 +1,441 @@
+#include "data/session_importer.h"
+#include "data/mapped_file.h"
+#include "data/text_import.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+using namespace text_import;
+using Clock = std::chrono::steady_clock;
+
+// Export columns the importer understands
+enum class Field {
+    BallSpeed, LaunchAngle, LaunchDirection, SpinRate, SpinAxis, SmashFactor,
+    BallHorizontal, CarryDistance, TotalDistance, MaxHeight, LandingAngle,
+    ClubSpeed, ClubPath, FaceAngle, AttackAngle, DynamicLoft,
+    Club, Date, Ignored
+};
+
+// Header names, lowercased with everything but letters and digits removed.
+// Covers the TrackMan and GCQuad (FSX) export vocabularies.
+const std::unordered_map<std::string, Field>& fieldAliases() {
+    static const std::unordered_map<std::string, Field> aliases = {
+        {"ballspeed", Field::BallSpeed},
+        {"launchangle", Field::LaunchAngle}, {"vla", Field::LaunchAngle},
+        {"verticallaunchangle", Field::LaunchAngle},
+        {"launchdirection", Field::LaunchDirection}, {"hla", Field::LaunchDirection},
+        {"horizontallaunchangle", Field::LaunchDirection}, {"azimuth", Field::LaunchDirection},
+        {"sideangle", Field::LaunchDirection},
+        {"spinrate", Field::SpinRate}, {"totalspin", Field::SpinRate},
+        {"spinaxis", Field::SpinAxis},
+        {"smashfactor", Field::SmashFactor}, {"smash", Field::SmashFactor},
+        {"side", Field::BallHorizontal}, {"offline", Field::BallHorizontal},
+        {"carryside", Field::BallHorizontal}, {"lateral", Field::BallHorizontal},
+        {"carry", Field::CarryDistance}, {"carrydistance", Field::CarryDistance},
+        {"total", Field::TotalDistance}, {"totaldistance", Field::TotalDistance},
+        {"height", Field::MaxHeight}, {"maxheight", Field::MaxHeight},
+        {"peakheight", Field::MaxHeight}, {"apex", Field::MaxHeight},
+        {"landingangle", Field::LandingAngle}, {"descentangle", Field::LandingAngle},
+        {"clubspeed", Field::ClubSpeed}, {"clubheadspeed", Field::ClubSpeed},
+        {"clubpath", Field::ClubPath}, {"path", Field::ClubPath},
+        {"faceangle", Field::FaceAngle}, {"face", Field::FaceAngle},
+        {"attackangle", Field::AttackAngle}, {"angleofattack", Field::AttackAngle},
+        {"aoa", Field::AttackAngle},
+        {"dynamicloft", Field::DynamicLoft}, {"dynloft", Field::DynamicLoft},
+        {"club", Field::Club}, {"clubtype", Field::Club}, {"clubname", Field::Club},
+        {"date", Field::Date}, {"time", Field::Date}, {"timestamp", Field::Date},
+        {"datetime", Field::Date}
+    };
+    return aliases;
+}
+
+// Factor converting a unit to the internal metric unit of its quantity
+double unitScale(std::string_view unit) {
+    std::string key;
+    for (char c : unit) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (key == "mph") return 0.44704;
+    if (key == "km/h" || key == "kmh" || key == "kph") return 1.0 / 3.6;
+    if (key == "yds" || key == "yd" || key == "yards" || key == "yard") return 0.9144;
+    if (key == "ft" || key == "feet") return 0.3048;
+    return 1.0;
+}
+
+struct Column {
+    Field field = Field::Ignored;
+    double scale = 1.0;
+};
+
+// Splits "Ball Speed [mph]" into its field and unit
+Column parseHeaderCell(std::string_view cell) {
+    Column column;
+    std::string_view name = cell;
+    size_t open = cell.find_first_of("[(");
+    if (open != std::string_view::npos) {
+        size_t close = cell.find_first_of("])", open);
+        column.scale = unitScale(cell.substr(open + 1, close == std::string_view::npos
+                                                           ? std::string_view::npos : close - open - 1));
+        name = cell.substr(0, open);
+    }
+
+    std::string key;
+    for (char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    auto it = fieldAliases().find(key);
+    if (it != fieldAliases().end()) {
+        column.field = it->second;
+    }
+    return column;
+}
+
+// Parses a number, accepting the "12.3 L" / "R5.1" side notation of some exports
+double parseNumber(std::string_view text) {
+    text = trim(text);
+    double sign = 1.0;
+    if (!text.empty() && (text.front() == 'L' || text.front() == 'R')) {
+        sign = text.front() == 'L' ? -1.0 : 1.0;
+        text.remove_prefix(1);
+    } else if (!text.empty() && (text.back() == 'L' || text.back() == 'R')) {
+        sign = text.back() == 'L' ? -1.0 : 1.0;
+        text.remove_suffix(1);
+    }
+    text = trim(text);
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+
+    double value = 0.0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() ? sign * value : 0.0;
+}
+
+/**
+ * Stands in for a launch monitor so that exported shots go through the
+ * same validation and conversion as live ones.
+ */
+class ExportFileMonitor final : public LaunchMonitorBase {
+public:
+    bool connect() override { return true; }
+    bool disconnect() override { return true; }
+    bool isConnected() const override { return true; }
+    std::string getDeviceInfo() const override { return "Session export"; }
+    std::optional<LaunchMonitorData> getLastShot() override { return std::nullopt; }
+    bool startTracking() override { return false; }
+    bool stopTracking() override { return false; }
+    bool isTracking() const override { return false; }
+    bool configure(const std::string&, const std::string&) override { return false; }
+    std::string getSetting(const std::string&) const override { return ""; }
+
+    bool accepts(const LaunchMonitorData& data) const { return validateBallData(data); }
+};
+
+void setField(LaunchMonitorData& data, Field field, double value) {
+    switch (field) {
+        case Field::BallSpeed: data.ballSpeed = value; break;
+        case Field::LaunchAngle: data.launchAngle = value; break;
+        case Field::LaunchDirection: data.launchDirection = value; break;
+        case Field::SpinRate: data.spinRate = value; break;
+        case Field::SpinAxis: data.spinAxis = value; break;
+        case Field::SmashFactor: data.smashFactor = value; break;
+        case Field::BallHorizontal: data.ballHorizontal = value; break;
+        case Field::CarryDistance: data.carryDistance = value; break;
+        case Field::TotalDistance: data.totalDistance = value; break;
+        case Field::MaxHeight: data.maxHeight = value; break;
+        case Field::LandingAngle: data.landingAngle = value; break;
+        case Field::ClubSpeed: data.clubSpeed = value; break;
+        case Field::ClubPath: data.clubPath = value; break;
+        case Field::FaceAngle: data.faceAngle = value; break;
+        case Field::AttackAngle: data.attackAngle = value; break;
+        case Field::DynamicLoft: data.dynamicLoft = value; break;
+        case Field::Club:
+        case Field::Date:
+        case Field::Ignored:
+            break;
+    }
+}
+
+// One parse task's output
+struct ChunkResult {
+    std::vector<ShotData> shots;
+    size_t rowsRead = 0;
+    size_t rowsRejected = 0;
+};
+
+// Validates and converts one parsed row
+void acceptRow(ExportFileMonitor& monitor, const LaunchMonitorData& data, const std::string& club,
+               std::time_t timestamp, ChunkResult& result) {
+    ++result.rowsRead;
+    if (!monitor.accepts(data)) {
+        ++result.rowsRejected;
+        return;
+    }
+    ShotData shot = monitor.convertToShotData(data);
+    shot.conditions = weather::WeatherData();
+    shot.clubUsed = club;
+    shot.timestamp = timestamp;
+    result.shots.push_back(std::move(shot));
+}
+
+void parseCsvChunk(const char* begin, const char* end, const std::vector<Column>& columns, char delimiter,
+                   std::time_t fallback, ChunkResult& result) {
+    ExportFileMonitor monitor;
+    std::vector<std::string_view> cells;
+    std::string scratch;
+    const char* cursor = begin;
+    while (cursor < end) {
+        std::string_view line = nextLine(cursor, end);
+        if (isBlank(line)) {
+            continue;
+        }
+        splitCsvLine(line, delimiter, cells, scratch);
+
+        LaunchMonitorData data;
+        std::string club;
+        std::time_t timestamp = fallback;
+        for (size_t i = 0; i < cells.size() && i < columns.size(); ++i) {
+            const Column& column = columns[i];
+            if (column.field == Field::Club) {
+                club.assign(cells[i].begin(), cells[i].end());
+            } else if (column.field == Field::Date) {
+                timestamp = parseTimestamp(cells[i], fallback);
+            } else if (column.field != Field::Ignored) {
+                setField(data, column.field, parseNumber(cells[i]) * column.scale);
+            }
+        }
+        acceptRow(monitor, data, club, timestamp, result);
+    }
+}
+
+void parseJsonChunk(const std::vector<std::string_view>& records, size_t first, size_t last,
+                    std::time_t fallback, ChunkResult& result) {
+    ExportFileMonitor monitor;
+    for (size_t r = first; r < last; ++r) {
+        nlohmann::json object = nlohmann::json::parse(records[r].begin(), records[r].end(), nullptr, false);
+        if (!object.is_object()) {
+            ++result.rowsRead;
+            ++result.rowsRejected;
+            continue;
+        }
+
+        LaunchMonitorData data;
+        std::string club;
+        std::time_t timestamp = fallback;
+        for (const auto& item : object.items()) {
+            Column column = parseHeaderCell(item.key());
+            const auto& value = item.value();
+            if (column.field == Field::Club && value.is_string()) {
+                club = value.get<std::string>();
+            } else if (column.field == Field::Date) {
+                if (value.is_number()) {
+                    timestamp = value.get<std::time_t>();
+                } else if (value.is_string()) {
+                    timestamp = parseTimestamp(value.get_ref<const std::string&>(), fallback);
+                }
+            } else if (column.field != Field::Ignored) {
+                double number = value.is_number() ? value.get<double>()
+                              : value.is_string() ? parseNumber(value.get_ref<const std::string&>()) : 0.0;
+                setField(data, column.field, number * column.scale);
+            }
+        }
+        acceptRow(monitor, data, club, timestamp, result);
+    }
+}
+
+// Start and end of every top-level JSON object, whether the file is an
+// array of objects or one object per line
+std::vector<std::string_view> jsonRecords(const char* data, size_t size) {
+    std::vector<std::string_view> records;
+    int depth = 0;
+    bool inString = false;
+    size_t start = 0;
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (inString) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            if (depth++ == 0) {
+                start = i;
+            }
+        } else if (c == '}' && depth > 0) {
+            if (--depth == 0) {
+                records.emplace_back(data + start, i + 1 - start);
+            }
+        }
+    }
+    return records;
+}
+
+} // namespace
+
+SessionImporter::SessionImporter(SQLiteStorage& storage, const ImportOptions& options)
+    : storage_(storage)
+    , options_(options) {
+    if (options_.threads == 0) {
+        options_.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunkBytes = std::max<size_t>(options_.chunkBytes, 4096);
+}
+
+std::vector<ShotData> SessionImporter::parse(const char* data, size_t size, ImportReport& report) const {
+    auto started = Clock::now();
+    std::time_t fallback = options_.fallbackTimestamp ? options_.fallbackTimestamp : std::time(nullptr);
+    const char* end = data + size;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        data += 3;
+    }
+
+    ExportFormat format = options_.format;
+    if (format == ExportFormat::Auto) {
+        const char* first = data;
+        while (first < end && std::isspace(static_cast<unsigned char>(*first))) ++first;
+        format = (first < end && (*first == '[' || *first == '{')) ? ExportFormat::Json : ExportFormat::Csv;
+    }
+
+    std::vector<ChunkResult> results;
+    if (format == ExportFormat::Json) {
+        std::vector<std::string_view> records = jsonRecords(data, end - data);
+        // Group records into tasks of roughly chunkBytes each
+        std::vector<size_t> bounds{0};
+        size_t bytes = 0;
+        for (size_t r = 0; r < records.size(); ++r) {
+            bytes += records[r].size();
+            if (bytes >= options_.chunkBytes) {
+                bounds.push_back(r + 1);
+                bytes = 0;
+            }
+        }
+        if (bounds.back() != records.size()) {
+            bounds.push_back(records.size());
+        }
+
+        results.resize(bounds.size() - 1);
+        runParallel(results.size(), options_.threads, [&](size_t i) {
+            parseJsonChunk(records, bounds[i], bounds[i + 1], fallback, results[i]);
+        });
+    } else {
+        const char* cursor = data;
+        std::string_view header;
+        while (cursor < end && isBlank(header)) {
+            header = nextLine(cursor, end);
+        }
+        char delimiter = (header.find(',') == std::string_view::npos &&
+                          header.find(';') != std::string_view::npos) ? ';' : ',';
+
+        std::vector<std::string_view> cells;
+        std::string scratch;
+        splitCsvLine(header, delimiter, cells, scratch);
+        std::vector<Column> columns;
+        for (auto cell : cells) {
+            columns.push_back(parseHeaderCell(cell));
+        }
+        if (std::none_of(columns.begin(), columns.end(),
+                         [](const Column& c) { return c.field == Field::BallSpeed; })) {
+            report.error = "Export has no ball speed column";
+            report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+            return {};
+        }
+
+        // TrackMan puts units in a row of their own below the header
+        const char* afterUnits = cursor;
+        std::string_view units = nextLine(afterUnits, end);
+        splitCsvLine(units, delimiter, cells, scratch);
+        bool unitsRow = !isBlank(units) && std::all_of(cells.begin(), cells.end(), [](std::string_view cell) {
+            return cell.empty() || cell.front() == '[' || cell.front() == '(';
+        });
+        if (unitsRow) {
+            for (size_t i = 0; i < cells.size() && i < columns.size(); ++i) {
+                if (!cells[i].empty()) {
+                    columns[i].scale = unitScale(cells[i].substr(1, cells[i].size() - 2));
+                }
+            }
+            cursor = afterUnits;
+        }
+
+        // Cut the body at line ends; quoted cells must not contain newlines
+        std::vector<const char*> bounds{cursor};
+        while (bounds.back() < end) {
+            const char* next = bounds.back() + std::min<size_t>(options_.chunkBytes, end - bounds.back());
+            const char* newline = next < end ? static_cast<const char*>(std::memchr(next, '\n', end - next)) : nullptr;
+            bounds.push_back(newline ? newline + 1 : end);
+        }
+
+        results.resize(bounds.size() - 1);
+        runParallel(results.size(), options_.threads, [&](size_t i) {
+            parseCsvChunk(bounds[i], bounds[i + 1], columns, delimiter, fallback, results[i]);
+        });
+    }
+
+    std::vector<ShotData> shots;
+    size_t accepted = 0;
+    for (const auto& result : results) {
+        accepted += result.shots.size();
+    }
+    shots.reserve(accepted);
+    for (auto& result : results) {
+        report.rowsRead += result.rowsRead;
+        report.rowsRejected += result.rowsRejected;
+        std::move(result.shots.begin(), result.shots.end(), std::back_inserter(shots));
+    }
+    report.success = true;
+    report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    return shots;
+}
+
+ImportReport SessionImporter::importFile(const std::string& path) {
+    ImportReport report;
+    auto started = Clock::now();
+    MappedFile file;
+    if (!file.open(path)) {
+        report.error = "Cannot open export: " + path;
+        return report;
+    }
+    if (file.size() == 0) {
+        report.success = true;
+        return report;
+    }
+    // Parse tasks scan their chunk front to back once
+    file.adviseSequential();
+
+    std::vector<ShotData> shots = parse(file.data(), file.size(), report);
+    file.close();
+    report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    if (!report.success) {
+        return report;
+    }
+
+    started = Clock::now();
+    report.rowsImported = storage_.bulkInsertShots(shots, options_.transactionRows, options_.deferIndexes);
+    report.insertSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    if (report.rowsImported != shots.size()) {
+        report.success = false;
+        report.error = "Insert stopped after " + std::to_string(report.rowsImported) + " rows";
+    }
+    return report;
+}
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,520 @@
+#include "data/shot_log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[8] = {'G', 'G', 'S', 'H', 'T', 'L', 'O', 'G'};
+constexpr const char* CLUB_DICTIONARY = "clubs.dict";
+constexpr const char* SEGMENT_SEQUENCE = "segments.seq";
+constexpr const char* SEGMENT_PREFIX = "segment-";
+constexpr const char* SEGMENT_SUFFIX = ".log";
+
+size_t segmentBytes(std::uint64_t records) {
+    return sizeof(SegmentHeader) + records * sizeof(ShotRecord);
+}
+
+bool parseSegmentId(const std::string& fileName, std::uint64_t& segmentId) {
+    const size_t prefix = std::strlen(SEGMENT_PREFIX);
+    const size_t suffix = std::strlen(SEGMENT_SUFFIX);
+    if (fileName.size() <= prefix + suffix ||
+        fileName.compare(0, prefix, SEGMENT_PREFIX) != 0 ||
+        fileName.compare(fileName.size() - suffix, suffix, SEGMENT_SUFFIX) != 0) {
+        return false;
+    }
+    try {
+        segmentId = std::stoull(fileName.substr(prefix, fileName.size() - prefix - suffix));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+ShotRecord packShot(const ShotData& shot, std::uint32_t clubId) {
+    ShotRecord record{};
+    record.timestamp = shot.timestamp;
+    record.weatherTimestamp = shot.conditions.timestamp;
+    record.initialVelocity = shot.initialVelocity;
+    record.spinRate = shot.spinRate;
+    record.launchAngle = shot.launchAngle;
+    record.temperature = shot.conditions.temperature;
+    record.humidity = shot.conditions.humidity;
+    record.pressure = shot.conditions.pressure;
+    record.windSpeed = shot.conditions.windSpeed;
+    record.windDirection = shot.conditions.windDirection;
+    record.precipitation = shot.conditions.precipitation;
+    record.altitude = shot.conditions.altitude;
+    record.actualDistance = shot.actualDistance;
+    record.predictedDistance = shot.predictedDistance;
+    record.lateralDeviation = shot.lateralDeviation;
+    record.clubId = clubId;
+    return record;
+}
+
+} // namespace
+
+SegmentView::SegmentView(SegmentView&& other) noexcept {
+    *this = std::move(other);
+}
+
+SegmentView& SegmentView::operator=(SegmentView&& other) noexcept {
+    if (this != &other) {
+        file_ = std::move(other.file_);
+        records_ = other.records_;
+        count_ = other.count_;
+        segmentId_ = other.segmentId_;
+        sealed_ = other.sealed_;
+        other.records_ = nullptr;
+        other.count_ = 0;
+    }
+    return *this;
+}
+
+ShotLog::ShotLog(const std::string& directory, const ShotLogConfig& config)
+    : directory_(directory)
+    , config_(config)
+    , nextSegmentId_(1)
+    , activeId_(0)
+    , header_(nullptr)
+    , records_(nullptr)
+    , written_(0) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    if (ec) {
+        throw std::runtime_error("Cannot create shot log directory: " + ec.message());
+    }
+
+    // Drop a name torn by a crash while it was being appended; no committed
+    // record can refer to it because the name is synced before its first use
+    fs::path dictionary = fs::path(directory_) / CLUB_DICTIONARY;
+    if (fs::exists(dictionary)) {
+        std::ifstream in(dictionary, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        size_t complete = contents.rfind('\n');
+        complete = complete == std::string::npos ? 0 : complete + 1;
+        if (complete != contents.size()) {
+            fs::resize_file(dictionary, complete);
+        }
+        size_t start = 0;
+        while (start < complete) {
+            size_t end = contents.find('\n', start);
+            std::string name = contents.substr(start, end - start);
+            clubIds_.emplace(name, static_cast<std::uint32_t>(clubNames_.size()));
+            clubNames_.push_back(std::move(name));
+            start = end + 1;
+        }
+    }
+
+    std::vector<std::uint64_t> unsealed;
+    for (const auto& entry : fs::directory_iterator(directory_)) {
+        std::uint64_t segmentId;
+        if (!parseSegmentId(entry.path().filename().string(), segmentId)) {
+            continue;
+        }
+        nextSegmentId_ = std::max(nextSegmentId_, segmentId + 1);
+
+        alignas(SegmentHeader) char raw[sizeof(SegmentHeader)] = {};
+        std::ifstream in(entry.path(), std::ios::binary);
+        in.read(raw, sizeof(raw));
+        const auto& header = *reinterpret_cast<const SegmentHeader*>(raw);
+
+        if (std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+            // Crashed before the new segment's header reached disk; it holds
+            // no committed records
+            static const char zeros[sizeof(SEGMENT_MAGIC)] = {};
+            if (std::memcmp(header.magic, zeros, sizeof(zeros)) == 0) {
+                fs::remove(entry.path(), ec);
+                continue;
+            }
+            throw std::runtime_error("Not a shot log segment: " + entry.path().string());
+        }
+        if (header.version != FORMAT_VERSION || header.recordSize != sizeof(ShotRecord)) {
+            throw std::runtime_error("Unsupported shot log segment format: " + entry.path().string());
+        }
+
+        if (header.sealed.load()) {
+            sealed_.push_back(segmentId);
+        } else {
+            unsealed.push_back(segmentId);
+        }
+    }
+    std::sort(sealed_.begin(), sealed_.end());
+    std::sort(unsealed.begin(), unsealed.end());
+
+    // Segments compacted and deleted leave no file behind, so the highest
+    // id ever allocated comes from the sequence file
+    std::ifstream sequence(fs::path(directory_) / SEGMENT_SEQUENCE);
+    std::uint64_t allocated = 0;
+    if (sequence >> allocated) {
+        nextSegmentId_ = std::max(nextSegmentId_, allocated + 1);
+    }
+
+    // Only the newest unsealed segment stays active; older ones were left
+    // open by a crash during sealing
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < unsealed.size(); ++i) {
+        if (!recoverSegment(unsealed[i])) {
+            throw std::runtime_error("Cannot recover shot log segment " + segmentPath(unsealed[i]));
+        }
+        if (i + 1 < unsealed.size()) {
+            sealActive();
+        }
+    }
+    std::sort(sealed_.begin(), sealed_.end());
+}
+
+ShotLog::~ShotLog() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeActive();
+}
+
+bool ShotLog::append(const ShotData& shot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (header_) {
+        auto age = std::chrono::seconds(std::time(nullptr) - header_->createdAt);
+        if (written_ == header_->capacity || age >= config_.maxSegmentAge) {
+            if (!sealActive()) {
+                return false;
+            }
+        }
+    }
+    if (!header_ && !openNewSegment()) {
+        return false;
+    }
+
+    std::uint32_t clubId;
+    if (!internClub(shot.clubUsed, clubId)) {
+        return false;
+    }
+    records_[written_++] = packShot(shot, clubId);
+    return true;
+}
+
+bool ShotLog::commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commitLocked();
+}
+
+bool ShotLog::seal() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sealActive();
+}
+
+std::vector<std::uint64_t> ShotLog::sealedSegments() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sealed_;
+}
+
+std::vector<std::uint64_t> ShotLog::recentSegments(size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::uint64_t> segments = sealed_;
+    if (header_) {
+        segments.push_back(activeId_);
+    }
+    if (segments.size() > count) {
+        segments.erase(segments.begin(), segments.end() - count);
+    }
+    return segments;
+}
+
+SegmentView ShotLog::openSegment(std::uint64_t segmentId) const {
+    SegmentView view;
+    MappedFile file;
+    if (!file.open(segmentPath(segmentId)) || file.size() < sizeof(SegmentHeader)) {
+        return view;
+    }
+
+    const auto* header = reinterpret_cast<const SegmentHeader*>(file.data());
+    size_t slots = (file.size() - sizeof(SegmentHeader)) / sizeof(ShotRecord);
+    view.records_ = reinterpret_cast<const ShotRecord*>(file.data() + sizeof(SegmentHeader));
+    view.count_ = std::min<size_t>(header->committed.load(std::memory_order_acquire), slots);
+    view.segmentId_ = segmentId;
+    view.sealed_ = header->sealed.load(std::memory_order_acquire) != 0;
+    view.file_ = std::move(file);
+    return view;
+}
+
+bool ShotLog::removeSegment(std::uint64_t segmentId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(sealed_.begin(), sealed_.end(), segmentId);
+    if (it == sealed_.end()) {
+        return false;
+    }
+    std::error_code ec;
+    if (!std::filesystem::remove(segmentPath(segmentId), ec)) {
+        return false;
+    }
+    sealed_.erase(it);
+    return true;
+}
+
+void ShotLog::reserveSegmentIds(std::uint64_t through) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nextSegmentId_ = std::max(nextSegmentId_, through + 1);
+}
+
+ShotData ShotLog::toShotData(const ShotRecord& record) const {
+    ShotData shot;
+    shot.timestamp = static_cast<std::time_t>(record.timestamp);
+    shot.conditions.timestamp = static_cast<std::time_t>(record.weatherTimestamp);
+    shot.initialVelocity = record.initialVelocity;
+    shot.spinRate = record.spinRate;
+    shot.launchAngle = record.launchAngle;
+    shot.conditions.temperature = record.temperature;
+    shot.conditions.humidity = record.humidity;
+    shot.conditions.pressure = record.pressure;
+    shot.conditions.windSpeed = record.windSpeed;
+    shot.conditions.windDirection = record.windDirection;
+    shot.conditions.precipitation = record.precipitation;
+    shot.conditions.altitude = record.altitude;
+    shot.actualDistance = record.actualDistance;
+    shot.predictedDistance = record.predictedDistance;
+    shot.lateralDeviation = record.lateralDeviation;
+    shot.clubUsed = clubName(record.clubId);
+    return shot;
+}
+
+std::string ShotLog::clubName(std::uint32_t clubId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clubId < clubNames_.size() ? clubNames_[clubId] : std::string();
+}
+
+std::string ShotLog::segmentPath(std::uint64_t segmentId) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020llu%s", SEGMENT_PREFIX,
+                  static_cast<unsigned long long>(segmentId), SEGMENT_SUFFIX);
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+bool ShotLog::writeSequence(std::uint64_t segmentId) {
+    // Written aside and renamed into place so a crash never leaves it torn
+    namespace fs = std::filesystem;
+    fs::path path = fs::path(directory_) / SEGMENT_SEQUENCE;
+    std::string temporary = path.string() + ".tmp";
+    std::error_code ec;
+    fs::remove(temporary, ec);
+    if (!appendToFile(temporary, std::to_string(segmentId) + '\n', config_.syncOnCommit)) {
+        return false;
+    }
+    fs::rename(temporary, path, ec);
+    return !ec;
+}
+
+bool ShotLog::internClub(const std::string& name, std::uint32_t& clubId) {
+    auto it = clubIds_.find(name);
+    if (it != clubIds_.end()) {
+        clubId = it->second;
+        return true;
+    }
+    if (name.find('\n') != std::string::npos) {
+        return false;
+    }
+
+    // The name must be durable before any committed record refers to it
+    std::string path = (std::filesystem::path(directory_) / CLUB_DICTIONARY).string();
+    if (!appendToFile(path, name + '\n', config_.syncOnCommit)) {
+        return false;
+    }
+
+    clubId = static_cast<std::uint32_t>(clubNames_.size());
+    clubIds_.emplace(name, clubId);
+    clubNames_.push_back(name);
+    return true;
+}
+
+bool ShotLog::openNewSegment() {
+    std::uint64_t segmentId = nextSegmentId_;
+    if (!writeSequence(segmentId)) {
+        return false;
+    }
+    if (!active_.open(segmentPath(segmentId), MappedFile::Mode::CreateNew,
+                      segmentBytes(config_.recordsPerSegment))) {
+        return false;
+    }
+
+    // The file is zero-filled, which is a valid representation of both atomics
+    auto* header = reinterpret_cast<SegmentHeader*>(active_.data());
+    std::memcpy(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header->version = FORMAT_VERSION;
+    header->recordSize = sizeof(ShotRecord);
+    header->segmentId = segmentId;
+    header->capacity = config_.recordsPerSegment;
+    header->createdAt = std::time(nullptr);
+    if (config_.syncOnCommit) {
+        active_.flush(0, sizeof(SegmentHeader));
+    }
+
+    ++nextSegmentId_;
+    activeId_ = segmentId;
+    header_ = header;
+    records_ = reinterpret_cast<ShotRecord*>(active_.data() + sizeof(SegmentHeader));
+    written_ = 0;
+    return true;
+}
+
+bool ShotLog::recoverSegment(std::uint64_t segmentId) {
+    std::string path = segmentPath(segmentId);
+    alignas(SegmentHeader) char raw[sizeof(SegmentHeader)];
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read(raw, sizeof(raw))) {
+        return false;
+    }
+    in.close();
+
+    // A crash may have left the file shorter than its capacity
+    const auto& probe = *reinterpret_cast<const SegmentHeader*>(raw);
+    if (!active_.open(path, MappedFile::Mode::ReadWrite, segmentBytes(probe.capacity))) {
+        return false;
+    }
+
+    activeId_ = segmentId;
+    header_ = reinterpret_cast<SegmentHeader*>(active_.data());
+    records_ = reinterpret_cast<ShotRecord*>(active_.data() + sizeof(SegmentHeader));
+    // Records past the commit marker were never acknowledged and are overwritten
+    written_ = std::min<std::uint64_t>(header_->committed.load(), header_->capacity);
+    return true;
+}
+
+bool ShotLog::sealActive() {
+    if (!header_) {
+        return true;
+    }
+    if (!commitLocked()) {
+        return false;
+    }
+
+    header_->sealed.store(1, std::memory_order_release);
+    if (config_.syncOnCommit && !active_.flush(0, sizeof(SegmentHeader))) {
+        return false;
+    }
+
+    // Give back the unused slots; readers never look past the commit marker
+    std::uint64_t segmentId = activeId_;
+    active_.closeAndTruncate(segmentBytes(written_), config_.syncOnCommit);
+    closeActive();
+
+    sealed_.push_back(segmentId);
+    return true;
+}
+
+bool ShotLog::commitLocked() {
+    if (!header_) {
+        return true;
+    }
+    std::uint64_t committed = header_->committed.load(std::memory_order_relaxed);
+    if (written_ == committed) {
+        return true;
+    }
+
+    if (config_.syncOnCommit) {
+        size_t offset = sizeof(SegmentHeader) + committed * sizeof(ShotRecord);
+        if (!active_.flush(offset, (written_ - committed) * sizeof(ShotRecord))) {
+            return false;
+        }
+    }
+
+    // Publish only after the records themselves are on disk
+    header_->committed.store(written_, std::memory_order_release);
+    if (config_.syncOnCommit) {
+        return active_.flush(0, sizeof(SegmentHeader));
+    }
+    return true;
+}
+
+void ShotLog::closeActive() {
+    active_.close();
+    header_ = nullptr;
+    records_ = nullptr;
+    written_ = 0;
+}
+
+ShotLogCompactor::ShotLogCompactor(ShotLog& log, SQLiteStorage& storage,
+                                   const ShotLogCompactorConfig& config)
+    : log_(log)
+    , storage_(storage)
+    , config_(config)
+    , compactedThrough_(0)
+    , stopping_(false) {
+    try {
+        compactedThrough_ = std::stoull(storage_.getPreference(CHECKPOINT_KEY, "0"));
+    } catch (const std::exception&) {
+        compactedThrough_ = 0;
+    }
+    // Segments at or below the checkpoint on disk now were stored by an
+    // earlier compactor; new segments must never reuse their ids
+    log_.reserveSegmentIds(compactedThrough_);
+    for (std::uint64_t segmentId : log_.sealedSegments()) {
+        if (segmentId <= compactedThrough_) {
+            stored_.push_back(segmentId);
+        }
+    }
+    worker_ = std::thread(&ShotLogCompactor::run, this);
+}
+
+ShotLogCompactor::~ShotLogCompactor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+size_t ShotLogCompactor::compactNow() {
+    std::lock_guard<std::mutex> pass(passMutex_);
+    size_t compacted = 0;
+    std::vector<std::uint64_t> segments = log_.sealedSegments();
+
+    // Segments are stored strictly in id order so one checkpoint value
+    // describes everything already in SQLite
+    for (std::uint64_t segmentId : segments) {
+        if (segmentId <= compactedThrough_) {
+            continue;
+        }
+        SegmentView view = log_.openSegment(segmentId);
+
+        std::vector<ShotData> shots;
+        shots.reserve(view.size());
+        for (const ShotRecord& record : view) {
+            shots.push_back(log_.toShotData(record));
+        }
+        if (!storage_.saveShotBatch(shots, CHECKPOINT_KEY, std::to_string(segmentId))) {
+            break;
+        }
+        compactedThrough_ = segmentId;
+        stored_.push_back(segmentId);
+        ++compacted;
+    }
+
+    // Keep the newest stored segments around for zero-copy scans
+    while (stored_.size() > config_.retainSegments) {
+        log_.removeSegment(stored_.front());
+        stored_.erase(stored_.begin());
+    }
+    return compacted;
+}
+
+std::uint64_t ShotLogCompactor::compactedThrough() const {
+    return compactedThrough_;
+}
+
+void ShotLogCompactor::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, config_.interval, [this] { return stopping_; })) {
+        lock.unlock();
+        compactNow();
+        lock.lock();
+    }
+}
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,349 @@
+#include "data/shot_query.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+std::int32_t bandOf(double value, double width) {
+    double band = std::floor(value / width);
+    band = std::clamp(band, double(std::numeric_limits<std::int32_t>::min()),
+                      double(std::numeric_limits<std::int32_t>::max()));
+    return static_cast<std::int32_t>(band);
+}
+
+// Value at quantile q with linear interpolation between neighbouring ranks.
+// Reorders values.
+double percentile(std::vector<float>& values, double q) {
+    double position = q * (values.size() - 1);
+    size_t rank = static_cast<size_t>(position);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    double lower = values[rank];
+    double fraction = position - rank;
+    if (fraction == 0.0 || rank + 1 >= values.size()) {
+        return lower;
+    }
+    double upper = *std::min_element(values.begin() + rank + 1, values.end());
+    return lower + (upper - lower) * fraction;
+}
+
+} // namespace
+
+ShotQuality classifyShotQuality(const ShotData& shot) {
+    if (!(shot.actualDistance > 0.0) || !std::isfinite(shot.actualDistance)) {
+        return ShotQuality::Poor;
+    }
+    bool launchMeasured = shot.initialVelocity > 0.0 && shot.spinRate > 0.0 &&
+                          shot.launchAngle > 0.0 && shot.launchAngle < 90.0;
+    return launchMeasured ? ShotQuality::Good : ShotQuality::Partial;
+}
+
+ShotFilter ShotFilter::all() {
+    Node node;
+    node.kind = Kind::All;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::club(const std::string& name) {
+    Node node;
+    node.kind = Kind::Club;
+    node.club = name;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::dateRange(std::time_t since, std::time_t until) {
+    Node node;
+    node.kind = Kind::Date;
+    node.min = static_cast<double>(since);
+    node.max = static_cast<double>(until);
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::session(std::uint32_t id) {
+    Node node;
+    node.kind = Kind::Session;
+    node.min = id;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::windSpeed(double min, double max) {
+    Node node;
+    node.kind = Kind::Wind;
+    node.min = min;
+    node.max = max;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::temperature(double min, double max) {
+    Node node;
+    node.kind = Kind::Temperature;
+    node.min = min;
+    node.max = max;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::quality(ShotQuality grade) {
+    Node node;
+    node.kind = Kind::Quality;
+    node.min = static_cast<double>(grade);
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::operator&&(const ShotFilter& other) const {
+    Node node;
+    node.kind = Kind::And;
+    node.left = node_;
+    node.right = other.node_;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotFilter ShotFilter::operator||(const ShotFilter& other) const {
+    Node node;
+    node.kind = Kind::Or;
+    node.left = node_;
+    node.right = other.node_;
+    return ShotFilter(std::make_shared<const Node>(std::move(node)));
+}
+
+ShotQueryEngine::ShotQueryEngine(const ShotQueryConfig& config)
+    : config_(config) {}
+
+size_t ShotQueryEngine::load(SQLiteStorage& storage) {
+    size_t added = 0;
+    ShotCursor cursor = storage.openShotCursor();
+    ShotData shot;
+    while (cursor.next(shot)) {
+        added += append(shot) ? 1 : 0;
+    }
+    return added;
+}
+
+bool ShotQueryEngine::append(const ShotData& shot) {
+    if (!timestamps_.empty() && shot.timestamp < timestamps_.back()) {
+        return false;
+    }
+    if (timestamps_.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    std::uint32_t row = static_cast<std::uint32_t>(timestamps_.size());
+
+    if (timestamps_.empty() || shot.timestamp - timestamps_.back() > config_.sessionGap) {
+        sessionRows_.emplace_back();
+        sessionStarts_.push_back(shot.timestamp);
+    }
+    sessionRows_.back().add(row);
+
+    timestamps_.push_back(shot.timestamp);
+    carry_.push_back(static_cast<float>(shot.actualDistance));
+    lateral_.push_back(static_cast<float>(shot.lateralDeviation));
+    predictionError_.push_back(static_cast<float>(shot.actualDistance - shot.predictedDistance));
+    ballSpeed_.push_back(static_cast<float>(shot.initialVelocity));
+    spinRate_.push_back(static_cast<float>(shot.spinRate));
+    launchAngle_.push_back(static_cast<float>(shot.launchAngle));
+    windSpeed_.push_back(static_cast<float>(shot.conditions.windSpeed));
+    temperature_.push_back(static_cast<float>(shot.conditions.temperature));
+
+    auto club = clubIds_.find(shot.clubUsed);
+    if (club == clubIds_.end()) {
+        club = clubIds_.emplace(shot.clubUsed, static_cast<std::uint32_t>(clubNames_.size())).first;
+        clubNames_.push_back(shot.clubUsed);
+        clubRows_.emplace_back();
+    }
+    clubRows_[club->second].add(row);
+
+    // Bands are computed from the stored values so edge refinement agrees with them
+    if (std::isfinite(windSpeed_.back())) {
+        windBands_[bandOf(windSpeed_.back(), config_.windBandWidth)].add(row);
+    }
+    if (std::isfinite(temperature_.back())) {
+        temperatureBands_[bandOf(temperature_.back(), config_.temperatureBandWidth)].add(row);
+    }
+    qualityRows_[static_cast<size_t>(config_.classify(shot))].add(row);
+    return true;
+}
+
+RoaringBitmap ShotQueryEngine::select(const ShotFilter& filter) const {
+    return filter.node_ ? evaluate(*filter.node_) : RoaringBitmap();
+}
+
+RoaringBitmap ShotQueryEngine::evaluate(const ShotFilter::Node& node) const {
+    using Kind = ShotFilter::Kind;
+    switch (node.kind) {
+        case Kind::All:
+            return RoaringBitmap::range(0, static_cast<std::uint32_t>(timestamps_.size()));
+
+        case Kind::Club: {
+            auto club = clubIds_.find(node.club);
+            return club != clubIds_.end() ? clubRows_[club->second] : RoaringBitmap();
+        }
+
+        case Kind::Date: {
+            // Rows are chronological, so a date range is a contiguous run of rows
+            auto first = std::lower_bound(timestamps_.begin(), timestamps_.end(),
+                                          static_cast<std::int64_t>(node.min));
+            auto last = std::upper_bound(first, timestamps_.end(),
+                                         static_cast<std::int64_t>(node.max));
+            return RoaringBitmap::range(static_cast<std::uint32_t>(first - timestamps_.begin()),
+                                        static_cast<std::uint32_t>(last - timestamps_.begin()));
+        }
+
+        case Kind::Session: {
+            size_t id = static_cast<size_t>(node.min);
+            return id < sessionRows_.size() ? sessionRows_[id] : RoaringBitmap();
+        }
+
+        case Kind::Wind:
+            return bandRange(windBands_, config_.windBandWidth, windSpeed_, node.min, node.max);
+
+        case Kind::Temperature:
+            return bandRange(temperatureBands_, config_.temperatureBandWidth, temperature_,
+                             node.min, node.max);
+
+        case Kind::Quality:
+            return qualityRows_[static_cast<size_t>(node.min)];
+
+        case Kind::And: {
+            RoaringBitmap left = evaluate(*node.left);
+            if (left.empty()) {
+                return left;
+            }
+            return left & evaluate(*node.right);
+        }
+
+        case Kind::Or:
+            return evaluate(*node.left) | evaluate(*node.right);
+    }
+    return RoaringBitmap();
+}
+
+RoaringBitmap ShotQueryEngine::bandRange(const std::map<std::int32_t, RoaringBitmap>& bands,
+                                         double width, const std::vector<float>& column,
+                                         double min, double max) const {
+    RoaringBitmap result;
+    if (!(min <= max)) {
+        return result;
+    }
+
+    auto begin = std::isfinite(min) ? bands.lower_bound(bandOf(min, width)) : bands.begin();
+    auto end = std::isfinite(max) ? bands.upper_bound(bandOf(max, width)) : bands.end();
+    for (auto it = begin; it != end; ++it) {
+        double low = it->first * width;
+        double high = (it->first + 1) * width;
+        if (low >= min && high <= max) {
+            result |= it->second;
+            continue;
+        }
+
+        // Band straddles a bound: check its rows against the column
+        RoaringBitmap edge;
+        it->second.forEach([&](std::uint32_t row) {
+            double value = column[row];
+            if (value >= min && value <= max) {
+                edge.add(row);
+            }
+        });
+        result |= edge;
+    }
+    return result;
+}
+
+const std::vector<float>& ShotQueryEngine::column(ShotMetric metric) const {
+    switch (metric) {
+        case ShotMetric::Carry: return carry_;
+        case ShotMetric::Lateral: return lateral_;
+        case ShotMetric::PredictionError: return predictionError_;
+        case ShotMetric::BallSpeed: return ballSpeed_;
+        case ShotMetric::SpinRate: return spinRate_;
+        case ShotMetric::LaunchAngle: return launchAngle_;
+        case ShotMetric::WindSpeed: return windSpeed_;
+        case ShotMetric::Temperature: return temperature_;
+    }
+    return carry_;
+}
+
+ShotAggregate ShotQueryEngine::aggregate(const RoaringBitmap& rows, ShotMetric metric) const {
+    ShotAggregate result;
+    const std::vector<float>& source = column(metric);
+
+    std::vector<float> values;
+    values.reserve(rows.cardinality());
+    rows.forEach([&](std::uint32_t row) { values.push_back(source[row]); });
+    result.count = values.size();
+    if (values.empty()) {
+        return result;
+    }
+
+    // Independent accumulators let the loop pipeline and vectorize without
+    // relaxed floating-point semantics
+    const size_t n = values.size();
+    double sum[4] = {0.0, 0.0, 0.0, 0.0};
+    float low[4] = {values[0], values[0], values[0], values[0]};
+    float high[4] = {values[0], values[0], values[0], values[0]};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            float value = values[i + lane];
+            sum[lane] += value;
+            low[lane] = std::min(low[lane], value);
+            high[lane] = std::max(high[lane], value);
+        }
+    }
+    for (; i < n; ++i) {
+        sum[0] += values[i];
+        low[0] = std::min(low[0], values[i]);
+        high[0] = std::max(high[0], values[i]);
+    }
+    result.mean = (sum[0] + sum[1] + sum[2] + sum[3]) / n;
+    result.min = std::min({low[0], low[1], low[2], low[3]});
+    result.max = std::max({high[0], high[1], high[2], high[3]});
+
+    double squares[4] = {0.0, 0.0, 0.0, 0.0};
+    for (i = 0; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            double delta = values[i + lane] - result.mean;
+            squares[lane] += delta * delta;
+        }
+    }
+    for (; i < n; ++i) {
+        double delta = values[i] - result.mean;
+        squares[0] += delta * delta;
+    }
+    result.stdDev = std::sqrt((squares[0] + squares[1] + squares[2] + squares[3]) / n);
+
+    result.p10 = percentile(values, 0.1);
+    result.p50 = percentile(values, 0.5);
+    result.p90 = percentile(values, 0.9);
+    return result;
+}
+
+std::map<std::string, ShotAggregate> ShotQueryEngine::aggregateByClub(const ShotFilter& filter,
+                                                                      ShotMetric metric) const {
+    std::map<std::string, ShotAggregate> result;
+    RoaringBitmap rows = select(filter);
+    for (size_t id = 0; id < clubNames_.size(); ++id) {
+        RoaringBitmap clubRows = rows & clubRows_[id];
+        if (!clubRows.empty()) {
+            result[clubNames_[id]] = aggregate(clubRows, metric);
+        }
+    }
+    return result;
+}
+
+size_t ShotQueryEngine::sizeInBytes() const {
+    size_t bytes = timestamps_.capacity() * sizeof(std::int64_t);
+    for (const auto* values : {&carry_, &lateral_, &predictionError_, &ballSpeed_, &spinRate_,
+                               &launchAngle_, &windSpeed_, &temperature_}) {
+        bytes += values->capacity() * sizeof(float);
+    }
+    for (const auto& bitmap : clubRows_) bytes += bitmap.sizeInBytes();
+    for (const auto& bitmap : sessionRows_) bytes += bitmap.sizeInBytes();
+    for (const auto& band : windBands_) bytes += band.second.sizeInBytes();
+    for (const auto& band : temperatureBands_) bytes += band.second.sizeInBytes();
+    for (const auto& bitmap : qualityRows_) bytes += bitmap.sizeInBytes();
+    return bytes;
+}
+
+} // namespace data
+} // namespace gptgolf
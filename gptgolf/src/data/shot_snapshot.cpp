@@ -0,0 +1,407 @@
+#include "data/shot_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'G', 'G', 'S', 'H', 'T', 'C', 'O', 'L'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+constexpr const char* SNAPSHOT_PREFIX = "shots-";
+constexpr const char* SNAPSHOT_SUFFIX = ".col";
+
+size_t clubIdBytes(size_t rows) {
+    return (rows * sizeof(std::uint32_t) + 7) & ~static_cast<size_t>(7);
+}
+
+void columnValues(const ShotData& shot, double values[SNAPSHOT_COLUMN_COUNT]) {
+    values[static_cast<size_t>(SnapshotColumn::Timestamp)] = static_cast<double>(shot.timestamp);
+    values[static_cast<size_t>(SnapshotColumn::WeatherTimestamp)] = static_cast<double>(shot.conditions.timestamp);
+    values[static_cast<size_t>(SnapshotColumn::InitialVelocity)] = shot.initialVelocity;
+    values[static_cast<size_t>(SnapshotColumn::SpinRate)] = shot.spinRate;
+    values[static_cast<size_t>(SnapshotColumn::LaunchAngle)] = shot.launchAngle;
+    values[static_cast<size_t>(SnapshotColumn::Temperature)] = shot.conditions.temperature;
+    values[static_cast<size_t>(SnapshotColumn::Humidity)] = shot.conditions.humidity;
+    values[static_cast<size_t>(SnapshotColumn::Pressure)] = shot.conditions.pressure;
+    values[static_cast<size_t>(SnapshotColumn::WindSpeed)] = shot.conditions.windSpeed;
+    values[static_cast<size_t>(SnapshotColumn::WindDirection)] = shot.conditions.windDirection;
+    values[static_cast<size_t>(SnapshotColumn::Precipitation)] = shot.conditions.precipitation;
+    values[static_cast<size_t>(SnapshotColumn::Altitude)] = shot.conditions.altitude;
+    values[static_cast<size_t>(SnapshotColumn::ActualDistance)] = shot.actualDistance;
+    values[static_cast<size_t>(SnapshotColumn::PredictedDistance)] = shot.predictedDistance;
+    values[static_cast<size_t>(SnapshotColumn::LateralDeviation)] = shot.lateralDeviation;
+}
+
+} // namespace
+
+bool SnapshotBlock::matches(size_t row) const {
+    if (clubId_ >= 0 && clubIds_[row] != static_cast<std::uint32_t>(clubId_)) {
+        return false;
+    }
+    double timestamp = column(SnapshotColumn::Timestamp)[row];
+    double wind = column(SnapshotColumn::WindSpeed)[row];
+    return timestamp >= since_ && timestamp <= until_ && wind >= minWind_ && wind <= maxWind_;
+}
+
+ShotSnapshot::ShotSnapshot(const std::string& path)
+    : header_(nullptr) {
+    if (!file_.open(path)) {
+        throw std::runtime_error("Cannot open shot snapshot: " + path);
+    }
+    if (file_.size() < sizeof(SnapshotFileHeader)) {
+        throw std::runtime_error("Truncated shot snapshot: " + path);
+    }
+    const size_t size = file_.size();
+
+    const char* base = file_.data();
+    header_ = reinterpret_cast<const SnapshotFileHeader*>(base);
+    size_t tableBytes = header_->blockCount * sizeof(SnapshotBlockInfo);
+    if (std::memcmp(header_->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header_->version != SNAPSHOT_VERSION ||
+        header_->columnCount != SNAPSHOT_COLUMN_COUNT ||
+        header_->footerOffset % alignof(SnapshotBlockInfo) != 0 ||
+        header_->footerOffset > size ||
+        tableBytes > size - header_->footerOffset) {
+        throw std::runtime_error("Not a shot snapshot: " + path);
+    }
+
+    const auto* table = reinterpret_cast<const SnapshotBlockInfo*>(base + header_->footerOffset);
+    for (size_t i = 0; i < header_->blockCount; ++i) {
+        const SnapshotBlockInfo& block = table[i];
+        size_t blockBytes = clubIdBytes(block.rows) + block.rows * sizeof(double) * SNAPSHOT_COLUMN_COUNT;
+        if (block.offset % alignof(double) != 0 || block.offset + blockBytes > header_->footerOffset) {
+            throw std::runtime_error("Corrupt shot snapshot block table: " + path);
+        }
+        blocks_.push_back(&block);
+    }
+
+    size_t position = header_->footerOffset + tableBytes;
+    std::uint32_t clubCount = 0;
+    if (position + sizeof(clubCount) <= size) {
+        std::memcpy(&clubCount, base + position, sizeof(clubCount));
+        position += sizeof(clubCount);
+    }
+    for (std::uint32_t id = 0; id < clubCount; ++id) {
+        std::uint32_t length;
+        if (position + sizeof(length) > size) {
+            break;
+        }
+        std::memcpy(&length, base + position, sizeof(length));
+        position += sizeof(length);
+        if (position + length > size) {
+            break;
+        }
+        clubs_.emplace_back(base + position, length);
+        clubIds_.emplace(clubs_.back(), id);
+        position += length;
+    }
+    if (clubs_.size() != clubCount) {
+        throw std::runtime_error("Corrupt shot snapshot club dictionary: " + path);
+    }
+}
+
+std::vector<SnapshotBlock> ShotSnapshot::selectBlocks(const SnapshotPredicate& predicate) const {
+    std::vector<SnapshotBlock> selected;
+
+    std::int64_t clubId = -1;
+    if (!predicate.club.empty()) {
+        auto it = clubIds_.find(predicate.club);
+        if (it == clubIds_.end()) {
+            return selected;
+        }
+        clubId = it->second;
+    }
+
+    const double since = static_cast<double>(predicate.since);
+    const double until = static_cast<double>(predicate.until);
+    const size_t ts = static_cast<size_t>(SnapshotColumn::Timestamp);
+    const size_t wind = static_cast<size_t>(SnapshotColumn::WindSpeed);
+    const char* base = file_.data();
+
+    size_t firstRow = 0;
+    for (const SnapshotBlockInfo* info : blocks_) {
+        size_t blockFirstRow = firstRow;
+        firstRow += info->rows;
+
+        if (clubId >= 0) {
+            auto id = static_cast<std::uint32_t>(clubId);
+            if (id < info->minClubId || id > info->maxClubId ||
+                !(info->clubMask & (std::uint64_t(1) << (id % 64)))) {
+                continue;
+            }
+        }
+        if (info->max[ts] < since || info->min[ts] > until ||
+            info->max[wind] < predicate.minWindSpeed || info->min[wind] > predicate.maxWindSpeed) {
+            continue;
+        }
+
+        SnapshotBlock block;
+        block.firstRow = blockFirstRow;
+        block.rows = info->rows;
+        block.allMatch = (clubId < 0 || (info->minClubId == clubId && info->maxClubId == clubId)) &&
+                         info->min[ts] >= since && info->max[ts] <= until &&
+                         info->min[wind] >= predicate.minWindSpeed &&
+                         info->max[wind] <= predicate.maxWindSpeed;
+
+        const char* data = base + info->offset;
+        block.clubIds_ = reinterpret_cast<const std::uint32_t*>(data);
+        data += clubIdBytes(info->rows);
+        for (size_t c = 0; c < SNAPSHOT_COLUMN_COUNT; ++c) {
+            block.columns_[c] = reinterpret_cast<const double*>(data) + c * info->rows;
+        }
+        block.clubId_ = clubId;
+        block.since_ = since;
+        block.until_ = until;
+        block.minWind_ = predicate.minWindSpeed;
+        block.maxWind_ = predicate.maxWindSpeed;
+        selected.push_back(block);
+    }
+    return selected;
+}
+
+ShotData ShotSnapshot::shotAt(const SnapshotBlock& block, size_t row) const {
+    auto value = [&](SnapshotColumn column) { return block.column(column)[row]; };
+
+    ShotData shot;
+    shot.timestamp = static_cast<std::time_t>(value(SnapshotColumn::Timestamp));
+    shot.conditions.timestamp = static_cast<std::time_t>(value(SnapshotColumn::WeatherTimestamp));
+    shot.initialVelocity = value(SnapshotColumn::InitialVelocity);
+    shot.spinRate = value(SnapshotColumn::SpinRate);
+    shot.launchAngle = value(SnapshotColumn::LaunchAngle);
+    shot.conditions.temperature = value(SnapshotColumn::Temperature);
+    shot.conditions.humidity = value(SnapshotColumn::Humidity);
+    shot.conditions.pressure = value(SnapshotColumn::Pressure);
+    shot.conditions.windSpeed = value(SnapshotColumn::WindSpeed);
+    shot.conditions.windDirection = value(SnapshotColumn::WindDirection);
+    shot.conditions.precipitation = value(SnapshotColumn::Precipitation);
+    shot.conditions.altitude = value(SnapshotColumn::Altitude);
+    shot.actualDistance = value(SnapshotColumn::ActualDistance);
+    shot.predictedDistance = value(SnapshotColumn::PredictedDistance);
+    shot.lateralDeviation = value(SnapshotColumn::LateralDeviation);
+    std::uint32_t clubId = block.clubIds()[row];
+    shot.clubUsed = clubId < clubs_.size() ? clubs_[clubId] : std::string();
+    return shot;
+}
+
+ShotSnapshotWriter::ShotSnapshotWriter(const std::string& path, size_t blockRows)
+    : path_(path)
+    , tempPath_(path + ".tmp")
+    , blockRows_(std::max<size_t>(blockRows, 1))
+    , finished_(false)
+    , failed_(false)
+    , rowCount_(0) {
+    out_.open(tempPath_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        throw std::runtime_error("Cannot create shot snapshot: " + tempPath_);
+    }
+
+    // Placeholder, rewritten by finish() once the footer offset is known
+    SnapshotFileHeader header{};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    clubIds_.reserve(blockRows_);
+    for (auto& column : columns_) {
+        column.reserve(blockRows_);
+    }
+}
+
+ShotSnapshotWriter::~ShotSnapshotWriter() {
+    if (!finished_) {
+        out_.close();
+        std::remove(tempPath_.c_str());
+    }
+}
+
+bool ShotSnapshotWriter::append(const ShotData& shot) {
+    if (failed_ || finished_) {
+        return false;
+    }
+
+    auto it = clubLookup_.find(shot.clubUsed);
+    if (it == clubLookup_.end()) {
+        it = clubLookup_.emplace(shot.clubUsed, static_cast<std::uint32_t>(clubs_.size())).first;
+        clubs_.push_back(shot.clubUsed);
+    }
+    clubIds_.push_back(it->second);
+
+    double values[SNAPSHOT_COLUMN_COUNT];
+    columnValues(shot, values);
+    for (size_t c = 0; c < SNAPSHOT_COLUMN_COUNT; ++c) {
+        columns_[c].push_back(values[c]);
+    }
+    ++rowCount_;
+
+    if (clubIds_.size() == blockRows_) {
+        return flushBlock();
+    }
+    return true;
+}
+
+bool ShotSnapshotWriter::flushBlock() {
+    size_t rows = clubIds_.size();
+    if (rows == 0) {
+        return true;
+    }
+
+    SnapshotBlockInfo info{};
+    info.offset = static_cast<std::uint64_t>(out_.tellp());
+    info.rows = rows;
+    auto clubRange = std::minmax_element(clubIds_.begin(), clubIds_.end());
+    info.minClubId = *clubRange.first;
+    info.maxClubId = *clubRange.second;
+    for (std::uint32_t id : clubIds_) {
+        info.clubMask |= std::uint64_t(1) << (id % 64);
+    }
+    for (size_t c = 0; c < SNAPSHOT_COLUMN_COUNT; ++c) {
+        auto range = std::minmax_element(columns_[c].begin(), columns_[c].end());
+        info.min[c] = *range.first;
+        info.max[c] = *range.second;
+    }
+
+    static const char padding[8] = {};
+    out_.write(reinterpret_cast<const char*>(clubIds_.data()), rows * sizeof(std::uint32_t));
+    out_.write(padding, clubIdBytes(rows) - rows * sizeof(std::uint32_t));
+    for (auto& column : columns_) {
+        out_.write(reinterpret_cast<const char*>(column.data()), rows * sizeof(double));
+        column.clear();
+    }
+    clubIds_.clear();
+
+    if (!out_) {
+        failed_ = true;
+        return false;
+    }
+    blocks_.push_back(info);
+    return true;
+}
+
+bool ShotSnapshotWriter::finish() {
+    if (finished_ || failed_ || !flushBlock()) {
+        return false;
+    }
+
+    SnapshotFileHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.columnCount = SNAPSHOT_COLUMN_COUNT;
+    header.rowCount = rowCount_;
+    header.blockCount = blocks_.size();
+    header.blockRows = blockRows_;
+    header.footerOffset = static_cast<std::uint64_t>(out_.tellp());
+    header.createdAt = std::time(nullptr);
+
+    out_.write(reinterpret_cast<const char*>(blocks_.data()), blocks_.size() * sizeof(SnapshotBlockInfo));
+    auto clubCount = static_cast<std::uint32_t>(clubs_.size());
+    out_.write(reinterpret_cast<const char*>(&clubCount), sizeof(clubCount));
+    for (const auto& name : clubs_) {
+        auto length = static_cast<std::uint32_t>(name.size());
+        out_.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out_.write(name.data(), length);
+    }
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (!out_) {
+        failed_ = true;
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath_, path_, ec);
+    if (ec) {
+        failed_ = true;
+        return false;
+    }
+    finished_ = true;
+    return true;
+}
+
+SnapshotExporter::SnapshotExporter(SQLiteStorage& storage, const std::string& directory,
+                                   const SnapshotExporterConfig& config)
+    : storage_(storage)
+    , directory_(directory)
+    , config_(config)
+    , stopping_(false) {
+    std::filesystem::create_directories(directory_);
+    worker_ = std::thread(&SnapshotExporter::run, this);
+}
+
+SnapshotExporter::~SnapshotExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+std::string SnapshotExporter::exportNow() {
+    std::lock_guard<std::mutex> lock(exportMutex_);
+
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020lld%s", SNAPSHOT_PREFIX,
+                  static_cast<long long>(now), SNAPSHOT_SUFFIX);
+    std::string path = (std::filesystem::path(directory_) / name).string();
+
+    try {
+        ShotSnapshotWriter writer(path, config_.blockRows);
+        ShotCursor cursor = storage_.openShotCursor("", 0, ShotOrder::ByClub);
+        ShotData shot;
+        while (cursor.next(shot)) {
+            if (!writer.append(shot)) {
+                return "";
+            }
+        }
+        if (cursor.failed() || !writer.finish()) {
+            return "";
+        }
+    } catch (const std::exception&) {
+        return "";
+    }
+
+    std::vector<std::string> snapshots = listSnapshots();
+    for (size_t i = 0; i + config_.retainSnapshots < snapshots.size(); ++i) {
+        std::error_code ec;
+        std::filesystem::remove(snapshots[i], ec);
+    }
+    return path;
+}
+
+std::string SnapshotExporter::latestSnapshot() const {
+    std::vector<std::string> snapshots = listSnapshots();
+    return snapshots.empty() ? std::string() : snapshots.back();
+}
+
+std::vector<std::string> SnapshotExporter::listSnapshots() const {
+    std::vector<std::string> snapshots;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        std::string fileName = entry.path().filename().string();
+        if (fileName.rfind(SNAPSHOT_PREFIX, 0) == 0 &&
+            entry.path().extension() == SNAPSHOT_SUFFIX) {
+            snapshots.push_back(entry.path().string());
+        }
+    }
+    // Zero-padded timestamps sort chronologically
+    std::sort(snapshots.begin(), snapshots.end());
+    return snapshots;
+}
+
+void SnapshotExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, config_.interval, [this] { return stopping_; })) {
+        lock.unlock();
+        exportNow();
+        lock.lock();
+    }
+}
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,139 @@
+#include "data/shot_writer.h"
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+SQLiteOptions writerOptions(const ShotWriterConfig& config) {
+    SQLiteOptions options;
+    options.walMode = true;
+    options.synchronous = config.synchronous;
+    return options;
+}
+
+} // namespace
+
+ShotWriter::ShotWriter(const std::string& dbPath, const ShotWriterConfig& config)
+    : config_(config)
+    , storage_(dbPath, writerOptions(config))
+    , stopping_(false) {
+    worker_ = std::thread(&ShotWriter::run, this);
+}
+
+ShotWriter::~ShotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        sealOpenBatch();
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+std::shared_future<bool> ShotWriter::enqueue(const ShotData& shot) {
+    std::shared_future<bool> result;
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_) {
+            open_ = std::make_unique<Batch>();
+            open_->shots.reserve(config_.maxBatchSize);
+            open_->opened = std::chrono::steady_clock::now();
+            notify = true;  // Start the commit thread's batch timer
+        }
+        open_->shots.push_back(shot);
+        ++stats_.pendingShots;
+        result = open_->result;
+
+        if (open_->shots.size() >= config_.maxBatchSize) {
+            sealOpenBatch();
+            notify = true;
+        }
+    }
+
+    // Shots joining an existing partial batch need no wake-up
+    if (notify) {
+        wake_.notify_one();
+    }
+    return result;
+}
+
+bool ShotWriter::flush() {
+    std::vector<std::shared_future<bool>> outstanding;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sealOpenBatch();
+        if (inFlight_.valid()) {
+            outstanding.push_back(inFlight_);
+        }
+        for (const auto& batch : sealed_) {
+            outstanding.push_back(batch->result);
+        }
+    }
+    wake_.notify_one();
+
+    bool ok = true;
+    for (auto& result : outstanding) {
+        ok = result.get() && ok;
+    }
+    return ok;
+}
+
+ShotWriterStats ShotWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::unique_ptr<OnlineBackup> ShotWriter::startBackup(const std::string& destinationPath,
+                                                      const BackupOptions& options) {
+    return storage_.startBackup(destinationPath, options);
+}
+
+void ShotWriter::sealOpenBatch() {
+    if (open_) {
+        sealed_.push_back(std::move(open_));
+    }
+}
+
+void ShotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (sealed_.empty()) {
+            if (stopping_) {
+                break;
+            }
+            if (open_) {
+                // Commit a partial batch once it has waited maxBatchDelay
+                auto deadline = open_->opened + config_.maxBatchDelay;
+                if (!wake_.wait_until(lock, deadline, [this] { return !sealed_.empty() || stopping_; })) {
+                    sealOpenBatch();
+                }
+            } else {
+                wake_.wait(lock, [this] { return !sealed_.empty() || open_ || stopping_; });
+            }
+            continue;
+        }
+
+        std::unique_ptr<Batch> batch = std::move(sealed_.front());
+        sealed_.pop_front();
+        inFlight_ = batch->result;
+
+        lock.unlock();
+        bool ok = storage_.saveShotBatch(batch->shots);
+        lock.lock();
+
+        stats_.pendingShots -= batch->shots.size();
+        if (ok) {
+            stats_.shotsWritten += batch->shots.size();
+            ++stats_.batchesCommitted;
+        } else {
+            stats_.shotsFailed += batch->shots.size();
+        }
+        batch->committed.set_value(ok);
+        inFlight_ = std::shared_future<bool>();
+    }
+}
+
+} // namespace data
+} // namespace gptgolf
@@ -0,0 +1,119 @@
+#include "data/sqlite_reader_pool.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace gptgolf {
+namespace data {
+
+namespace {
+
+std::atomic<size_t> nextPoolId{0};
+
+// Connection index each thread last used, per pool
+thread_local std::unordered_map<size_t, size_t> lastConnection;
+
+} // namespace
+
+SQLiteReaderPool::SQLiteReaderPool(const std::string& dbPath, size_t size, int busyTimeoutMs)
+    : connections_(size)
+    , inUse_(size, false)
+    , available_(size)
+    , id_(nextPoolId++) {
+    for (auto& connection : connections_) {
+        // Each connection is only ever used by the thread holding its lease
+        int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+        int rc = sqlite3_open_v2(dbPath.c_str(), &connection.db, flags, nullptr);
+        if (rc != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(connection.db);
+            for (auto& opened : connections_) {
+                opened.statements.reset();
+                sqlite3_close(opened.db);
+                opened.db = nullptr;
+            }
+            throw std::runtime_error("Cannot open reader connection: " + error);
+        }
+        sqlite3_busy_timeout(connection.db, busyTimeoutMs);
+        connection.statements = std::make_unique<StatementCache>(connection.db);
+    }
+}
+
+SQLiteReaderPool::~SQLiteReaderPool() {
+    for (auto& connection : connections_) {
+        connection.statements.reset();
+        sqlite3_close(connection.db);
+    }
+}
+
+StatementCacheStats SQLiteReaderPool::statementStats() const {
+    StatementCacheStats stats;
+    for (const auto& connection : connections_) {
+        stats += connection.statements->stats();
+    }
+    return stats;
+}
+
+SQLiteReaderPool::Lease SQLiteReaderPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [this] { return available_ > 0; });
+
+    size_t index = connections_.size();
+    auto hint = lastConnection.find(id_);
+    if (hint != lastConnection.end() && !inUse_[hint->second]) {
+        index = hint->second;
+    } else {
+        for (size_t i = 0; i < inUse_.size(); ++i) {
+            if (!inUse_[i]) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    inUse_[index] = true;
+    --available_;
+    lastConnection[id_] = index;
+    return Lease(this, index);
+}
+
+void SQLiteReaderPool::release(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inUse_[index] = false;
+        ++available_;
+    }
+    released_.notify_one();
+}
+
+SQLiteReaderPool::Lease::Lease(SQLiteReaderPool* pool, size_t index)
+    : pool_(pool)
+    , index_(index)
+    , connection_(&pool->connections_[index]) {}
+
+SQLiteReaderPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_)
+    , index_(other.index_)
+    , connection_(other.connection_)
+    , used_(std::move(other.used_)) {
+    other.pool_ = nullptr;
+}
+
+SQLiteReaderPool::Lease::~Lease() {
+    if (!pool_) {
+        return;
+    }
+    for (auto* stmt : used_) {
+        sqlite3_reset(stmt);
+    }
+    pool_->release(index_);
+}
+
+sqlite3_stmt* SQLiteReaderPool::Lease::prepare(const std::string& sql) {
+    sqlite3_stmt* stmt = connection_->statements->prepare(sql);
+    if (stmt) {
+        used_.push_back(stmt);
+    }
+    return stmt;
+}
+
+} // namespace data
+} // namespace gptgolf
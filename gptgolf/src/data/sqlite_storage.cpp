@@ -1,12 +1,213 @@
 #include "../../include/data/sqlite_storage.h"
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <stdexcept>
 #include <sstream>
 
 namespace gptgolf {
 namespace data {
 
-using json = nlohmann::json;
+namespace {
+
+// Column list shared by every shot query; readShotRow depends on this order
+const int SHOT_COLUMN_COUNT = 16;
+const char* SHOT_COLUMNS = R"(
+    initial_velocity, spin_rate, launch_angle,
+    temperature, humidity, pressure, wind_speed, wind_direction,
+    precipitation, altitude, weather_timestamp,
+    club_used, actual_distance, predicted_distance,
+    lateral_deviation, timestamp
+)";
+
+// Typed weather columns added to legacy tables, with the JSON key they are
+// backfilled from. Keys the old format never wrote fall back to 0.
+struct WeatherColumn {
+    const char* name;
+    const char* type;
+    const char* jsonKey;
+};
+
+const WeatherColumn WEATHER_COLUMNS[] = {
+    {"temperature", "REAL", "$.temperature"},
+    {"humidity", "REAL", "$.humidity"},
+    {"pressure", "REAL", "$.pressure"},
+    {"wind_speed", "REAL", "$.windSpeed"},
+    {"wind_direction", "REAL", "$.windDirection"},
+    {"precipitation", "REAL", "$.precipitation"},
+    {"altitude", "REAL", "$.altitude"},
+    {"weather_timestamp", "INTEGER", "$.timestamp"}
+};
+
+const char* INSERT_SHOT_SQL = R"(
+    INSERT INTO shots (
+        initial_velocity, spin_rate, launch_angle,
+        temperature, humidity, pressure, wind_speed, wind_direction,
+        precipitation, altitude, weather_timestamp,
+        club_used, actual_distance, predicted_distance,
+        lateral_deviation, timestamp
+    ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+)";
+
+// Inverse of SQLiteStorage::SHOTS_INDEXES, used while bulk loading
+const char* DROP_SHOT_INDEXES_SQL = R"(
+    DROP INDEX IF EXISTS idx_shots_club_time;
+    DROP INDEX IF EXISTS idx_shots_timestamp;
+)";
+
+const char* UPSERT_PREFERENCE_SQL = "INSERT OR REPLACE INTO preferences (key, value) VALUES (?, ?)";
+
+// Binds every INSERT_SHOT_SQL parameter; the club name must outlive the step
+void bindShotRow(sqlite3_stmt* stmt, const ShotData& shot) {
+    sqlite3_bind_double(stmt, 1, shot.initialVelocity);
+    sqlite3_bind_double(stmt, 2, shot.spinRate);
+    sqlite3_bind_double(stmt, 3, shot.launchAngle);
+    sqlite3_bind_double(stmt, 4, shot.conditions.temperature);
+    sqlite3_bind_double(stmt, 5, shot.conditions.humidity);
+    sqlite3_bind_double(stmt, 6, shot.conditions.pressure);
+    sqlite3_bind_double(stmt, 7, shot.conditions.windSpeed);
+    sqlite3_bind_double(stmt, 8, shot.conditions.windDirection);
+    sqlite3_bind_double(stmt, 9, shot.conditions.precipitation);
+    sqlite3_bind_double(stmt, 10, shot.conditions.altitude);
+    sqlite3_bind_int64(stmt, 11, shot.conditions.timestamp);
+    sqlite3_bind_text(stmt, 12, shot.clubUsed.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt, 13, shot.actualDistance);
+    sqlite3_bind_double(stmt, 14, shot.predictedDistance);
+    sqlite3_bind_double(stmt, 15, shot.lateralDeviation);
+    sqlite3_bind_int64(stmt, 16, shot.timestamp);
+}
+
+// Column list shared by every club query; readClubRow depends on this order
+const char* CLUB_COLUMNS = R"(
+    name, avg_distance, avg_spin_rate, avg_launch_angle,
+    total_shots, last_updated, distance_deviation, direction_deviation,
+    distance_count, distance_mean, distance_m2, distance_recent_mean, distance_recent_variance,
+    lateral_count, lateral_mean, lateral_m2, lateral_recent_mean, lateral_recent_variance,
+    distance_sketch, lateral_sketch
+)";
+
+// Running statistics columns, added to clubs tables that predate them
+const char* CLUB_STATS_COLUMNS[] = {
+    "distance_count INTEGER", "distance_mean REAL", "distance_m2 REAL",
+    "distance_recent_mean REAL", "distance_recent_variance REAL",
+    "lateral_count INTEGER", "lateral_mean REAL", "lateral_m2 REAL",
+    "lateral_recent_mean REAL", "lateral_recent_variance REAL"
+};
+
+void bindRunningStats(sqlite3_stmt* stmt, int index, const RunningStats& stats) {
+    sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(stats.count));
+    sqlite3_bind_double(stmt, index + 1, stats.mean);
+    sqlite3_bind_double(stmt, index + 2, stats.m2);
+    sqlite3_bind_double(stmt, index + 3, stats.recentMean);
+    sqlite3_bind_double(stmt, index + 4, stats.recentVariance);
+}
+
+RunningStats readRunningStats(sqlite3_stmt* stmt, int index) {
+    RunningStats stats;
+    stats.count = static_cast<size_t>(sqlite3_column_int64(stmt, index));
+    stats.mean = sqlite3_column_double(stmt, index + 1);
+    stats.m2 = sqlite3_column_double(stmt, index + 2);
+    stats.recentMean = sqlite3_column_double(stmt, index + 3);
+    stats.recentVariance = sqlite3_column_double(stmt, index + 4);
+    return stats;
+}
+
+void bindSketch(sqlite3_stmt* stmt, int index, const QuantileSketch& sketch) {
+    if (sketch.empty()) {
+        sqlite3_bind_null(stmt, index);
+        return;
+    }
+    std::vector<std::uint8_t> data = sketch.serialize();
+    sqlite3_bind_blob(stmt, index, data.data(), static_cast<int>(data.size()), SQLITE_TRANSIENT);
+}
+
+QuantileSketch readSketch(sqlite3_stmt* stmt, int index) {
+    const void* data = sqlite3_column_blob(stmt, index);
+    auto sketch = QuantileSketch::deserialize(data, sqlite3_column_bytes(stmt, index));
+    return sketch ? *sketch : QuantileSketch();
+}
+
+ClubProfile readClubRow(sqlite3_stmt* stmt, int first = 0) {
+    ClubProfile club;
+    club.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, first));
+    club.avgDistance = sqlite3_column_double(stmt, first + 1);
+    club.avgSpinRate = sqlite3_column_double(stmt, first + 2);
+    club.avgLaunchAngle = sqlite3_column_double(stmt, first + 3);
+    club.totalShots = sqlite3_column_int64(stmt, first + 4);
+    club.lastUpdated = sqlite3_column_int64(stmt, first + 5);
+    club.distanceDeviation = sqlite3_column_double(stmt, first + 6);
+    club.directionDeviation = sqlite3_column_double(stmt, first + 7);
+    club.distanceStats = readRunningStats(stmt, first + 8);
+    club.lateralStats = readRunningStats(stmt, first + 13);
+    club.distanceSketch = readSketch(stmt, first + 18);
+    club.lateralSketch = readSketch(stmt, first + 19);
+    return club;
+}
+
+const char* synchronousPragma(SynchronousLevel level) {
+    switch (level) {
+        case SynchronousLevel::OFF: return "PRAGMA synchronous = OFF";
+        case SynchronousLevel::NORMAL: return "PRAGMA synchronous = NORMAL";
+        case SynchronousLevel::FULL: return "PRAGMA synchronous = FULL";
+    }
+    return "PRAGMA synchronous = FULL";
+}
+
+ShotData readShotRow(sqlite3_stmt* stmt, int first = 0) {
+    ShotData shot;
+    shot.initialVelocity = sqlite3_column_double(stmt, first);
+    shot.spinRate = sqlite3_column_double(stmt, first + 1);
+    shot.launchAngle = sqlite3_column_double(stmt, first + 2);
+    shot.conditions.temperature = sqlite3_column_double(stmt, first + 3);
+    shot.conditions.humidity = sqlite3_column_double(stmt, first + 4);
+    shot.conditions.pressure = sqlite3_column_double(stmt, first + 5);
+    shot.conditions.windSpeed = sqlite3_column_double(stmt, first + 6);
+    shot.conditions.windDirection = sqlite3_column_double(stmt, first + 7);
+    shot.conditions.precipitation = sqlite3_column_double(stmt, first + 8);
+    shot.conditions.altitude = sqlite3_column_double(stmt, first + 9);
+    shot.conditions.timestamp = sqlite3_column_int64(stmt, first + 10);
+    shot.clubUsed = reinterpret_cast<const char*>(sqlite3_column_text(stmt, first + 11));
+    shot.actualDistance = sqlite3_column_double(stmt, first + 12);
+    shot.predictedDistance = sqlite3_column_double(stmt, first + 13);
+    shot.lateralDeviation = sqlite3_column_double(stmt, first + 14);
+    shot.timestamp = sqlite3_column_int64(stmt, first + 15);
+    return shot;
+}
+
+} // namespace
+
+/**
+ * @brief Statement for a read query, on whichever connection serves reads
+ *
+ * With a reader pool the statement comes from the leased connection's cache
+ * and is reset when the lease ends. Without one it comes from the writer
+ * connection's cache, and the writer stays locked until it is reset.
+ */
+class SQLiteStorage::ReadStatement {
+public:
+    ReadStatement(SQLiteReaderPool::Lease lease, const std::string& sql)
+        : lease_(std::move(lease)), stmt_(lease_->prepare(sql)), owned_(false) {}
+
+    ReadStatement(std::unique_lock<std::mutex> lock, StatementCache& cache, const std::string& sql)
+        : lock_(std::move(lock)), stmt_(cache.prepare(sql)), owned_(true) {}
+
+    ~ReadStatement() {
+        if (owned_ && stmt_) {
+            sqlite3_reset(stmt_);
+        }
+    }
+
+    ReadStatement(const ReadStatement&) = delete;
+    ReadStatement& operator=(const ReadStatement&) = delete;
+
+    sqlite3_stmt* get() const { return stmt_; }
+
+private:
+    std::optional<SQLiteReaderPool::Lease> lease_;
+    std::unique_lock<std::mutex> lock_;
+    sqlite3_stmt* stmt_;
+    bool owned_;    // Writer statement, reset by this object
+};
 
 // SQL statements for table creation
 const char* SQLiteStorage::SHOTS_TABLE = R"(
@@ -15,7 +216,14 @@ const char* SQLiteStorage::SHOTS_TABLE = R"(
         initial_velocity REAL NOT NULL,
         spin_rate REAL NOT NULL,
         launch_angle REAL NOT NULL,
-        weather_data TEXT NOT NULL,
+        temperature REAL NOT NULL DEFAULT 0,
+        humidity REAL NOT NULL DEFAULT 0,
+        pressure REAL NOT NULL DEFAULT 0,
+        wind_speed REAL NOT NULL DEFAULT 0,
+        wind_direction REAL NOT NULL DEFAULT 0,
+        precipitation REAL NOT NULL DEFAULT 0,
+        altitude REAL NOT NULL DEFAULT 0,
+        weather_timestamp INTEGER NOT NULL DEFAULT 0,
         club_used TEXT NOT NULL,
         actual_distance REAL NOT NULL,
         predicted_distance REAL NOT NULL,
@@ -24,6 +232,11 @@ const char* SQLiteStorage::SHOTS_TABLE = R"(
     )
 )";
 
+const char* SQLiteStorage::SHOTS_INDEXES = R"(
+    CREATE INDEX IF NOT EXISTS idx_shots_club_time ON shots(club_used, timestamp);
+    CREATE INDEX IF NOT EXISTS idx_shots_timestamp ON shots(timestamp);
+)";
+
 const char* SQLiteStorage::CLUBS_TABLE = R"(
     CREATE TABLE IF NOT EXISTS clubs (
         name TEXT PRIMARY KEY,
@@ -33,7 +246,19 @@ const char* SQLiteStorage::CLUBS_TABLE = R"(
         total_shots INTEGER NOT NULL,
         last_updated INTEGER NOT NULL,
         distance_deviation REAL NOT NULL,
-        direction_deviation REAL NOT NULL
+        direction_deviation REAL NOT NULL,
+        distance_count INTEGER NOT NULL DEFAULT 0,
+        distance_mean REAL NOT NULL DEFAULT 0,
+        distance_m2 REAL NOT NULL DEFAULT 0,
+        distance_recent_mean REAL NOT NULL DEFAULT 0,
+        distance_recent_variance REAL NOT NULL DEFAULT 0,
+        lateral_count INTEGER NOT NULL DEFAULT 0,
+        lateral_mean REAL NOT NULL DEFAULT 0,
+        lateral_m2 REAL NOT NULL DEFAULT 0,
+        lateral_recent_mean REAL NOT NULL DEFAULT 0,
+        lateral_recent_variance REAL NOT NULL DEFAULT 0,
+        distance_sketch BLOB,
+        lateral_sketch BLOB
     )
 )";
 
@@ -44,17 +269,62 @@ const char* SQLiteStorage::PREFS_TABLE = R"(
     )
 )";
 
-SQLiteStorage::SQLiteStorage(const std::string& dbPath) : db_(nullptr) {
+// Change feed. AUTOINCREMENT keeps seq values from being reused after pruning.
+const char* SQLiteStorage::CHANGES_TABLE = R"(
+    CREATE TABLE IF NOT EXISTS changes (
+        seq INTEGER PRIMARY KEY AUTOINCREMENT,
+        entity INTEGER NOT NULL,
+        operation INTEGER NOT NULL,
+        shot_id INTEGER,
+        club_name TEXT,
+        changed_at INTEGER NOT NULL DEFAULT (strftime('%s', 'now'))
+    )
+)";
+
+// Entity and operation codes match ChangeEntity and ChangeOperation
+const char* SQLiteStorage::CHANGE_TRIGGERS = R"(
+    CREATE TRIGGER IF NOT EXISTS shots_change_insert AFTER INSERT ON shots BEGIN
+        INSERT INTO changes (entity, operation, shot_id) VALUES (0, 0, NEW.id);
+    END;
+    CREATE TRIGGER IF NOT EXISTS shots_change_update AFTER UPDATE ON shots BEGIN
+        INSERT INTO changes (entity, operation, shot_id) VALUES (0, 1, NEW.id);
+    END;
+    CREATE TRIGGER IF NOT EXISTS clubs_change_insert AFTER INSERT ON clubs BEGIN
+        INSERT INTO changes (entity, operation, club_name) VALUES (1, 0, NEW.name);
+    END;
+    CREATE TRIGGER IF NOT EXISTS clubs_change_update AFTER UPDATE ON clubs BEGIN
+        INSERT INTO changes (entity, operation, club_name) VALUES (1, 1, NEW.name);
+    END;
+)";
+
+SQLiteStorage::SQLiteStorage(const std::string& dbPath, const SQLiteOptions& options)
+    : db_(nullptr) {
     int rc = sqlite3_open(dbPath.c_str(), &db_);
     if (rc) {
         std::string error = sqlite3_errmsg(db_);
         sqlite3_close(db_);
         throw std::runtime_error("Cannot open database: " + error);
     }
+
+    sqlite3_busy_timeout(db_, options.busyTimeoutMs);
+    statements_ = std::make_unique<StatementCache>(db_);
+    if (options.walMode) {
+        // journal_mode returns a row, which sqlite3_exec simply discards
+        executeStatement("PRAGMA journal_mode = WAL");
+    }
+    executeStatement(synchronousPragma(options.synchronous));
     initializeTables();
+
+    // Read-only connections only run alongside the writer in WAL mode
+    if (options.walMode && options.readerConnections > 0) {
+        readers_ = std::make_unique<SQLiteReaderPool>(
+            dbPath, options.readerConnections, options.busyTimeoutMs);
+    }
 }
 
 SQLiteStorage::~SQLiteStorage() {
+    readers_.reset();
+    statements_.reset();
     if (db_) {
         sqlite3_close(db_);
     }
@@ -64,6 +334,232 @@ void SQLiteStorage::initializeTables() {
     executeStatement(SHOTS_TABLE);
     executeStatement(CLUBS_TABLE);
     executeStatement(PREFS_TABLE);
+    // A database already at the current shots layout has nothing to convert
+    if (schemaVersion() < SHOTS_SCHEMA_VERSION) {
+        migrateLegacyShots();
+    }
+    migrateClubStats();
+    migrateClubSketches();
+    // Triggers come after the migrations so that backfills are not fed as changes
+    executeStatement(CHANGES_TABLE);
+    executeStatement(CHANGE_TRIGGERS);
+    executeStatement(SHOTS_INDEXES);
+    executeStatement("PRAGMA user_version = " + std::to_string(SHOTS_SCHEMA_VERSION));
+}
+
+void SQLiteStorage::migrateClubStats() {
+    if (hasColumn("clubs", "distance_count")) {
+        return;
+    }
+
+    executeStatement("BEGIN IMMEDIATE");
+    try {
+        for (const char* column : CLUB_STATS_COLUMNS) {
+            executeStatement(std::string("ALTER TABLE clubs ADD COLUMN ") + column + " NOT NULL DEFAULT 0");
+        }
+
+        // Seed from the stored shots once; afterwards every shot is an O(1)
+        // update. Recent form starts out equal to the all-time figures.
+        executeStatement(R"(
+            UPDATE clubs SET
+                distance_count = s.n,
+                distance_mean = s.dm,
+                distance_m2 = s.n * MAX(0, s.dsq - s.dm * s.dm),
+                distance_recent_mean = s.dm,
+                distance_recent_variance = MAX(0, s.dsq - s.dm * s.dm),
+                lateral_count = s.n,
+                lateral_mean = s.lm,
+                lateral_m2 = s.n * MAX(0, s.lsq - s.lm * s.lm),
+                lateral_recent_mean = s.lm,
+                lateral_recent_variance = MAX(0, s.lsq - s.lm * s.lm)
+            FROM (
+                SELECT club_used,
+                       COUNT(*) AS n,
+                       AVG(actual_distance) AS dm,
+                       AVG(actual_distance * actual_distance) AS dsq,
+                       AVG(lateral_deviation) AS lm,
+                       AVG(lateral_deviation * lateral_deviation) AS lsq
+                FROM shots GROUP BY club_used
+            ) AS s
+            WHERE clubs.name = s.club_used
+        )");
+        executeStatement("COMMIT");
+    } catch (const std::exception&) {
+        sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+        throw;
+    }
+}
+
+void SQLiteStorage::migrateClubSketches() {
+    if (hasColumn("clubs", "distance_sketch")) {
+        return;
+    }
+
+    executeStatement("BEGIN IMMEDIATE");
+    sqlite3_stmt* stmt = nullptr;
+    try {
+        executeStatement("ALTER TABLE clubs ADD COLUMN distance_sketch BLOB");
+        executeStatement("ALTER TABLE clubs ADD COLUMN lateral_sketch BLOB");
+
+        // One pass over the shots builds every club's sketches
+        std::map<std::string, std::pair<QuantileSketch, QuantileSketch>> sketches;
+        if (sqlite3_prepare_v2(db_, "SELECT club_used, actual_distance, lateral_deviation FROM shots",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error("Failed to read shots: " + std::string(sqlite3_errmsg(db_)));
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto& club = sketches[reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0))];
+            club.first.add(sqlite3_column_double(stmt, 1));
+            club.second.add(sqlite3_column_double(stmt, 2));
+        }
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+
+        if (sqlite3_prepare_v2(db_, "UPDATE clubs SET distance_sketch = ?, lateral_sketch = ? WHERE name = ?",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error("Failed to seed sketches: " + std::string(sqlite3_errmsg(db_)));
+        }
+        for (const auto& [name, club] : sketches) {
+            bindSketch(stmt, 1, club.first);
+            bindSketch(stmt, 2, club.second);
+            sqlite3_bind_text(stmt, 3, name.c_str(), -1, SQLITE_STATIC);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                throw std::runtime_error("Failed to seed sketches: " + std::string(sqlite3_errmsg(db_)));
+            }
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+        executeStatement("COMMIT");
+    } catch (const std::exception&) {
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+        throw;
+    }
+}
+
+SQLiteStorage::ReadStatement SQLiteStorage::prepareRead(const std::string& sql) {
+    if (readers_) {
+        return ReadStatement(readers_->acquire(), sql);
+    }
+    return ReadStatement(std::unique_lock<std::mutex>(writeMutex_), *statements_, sql);
+}
+
+bool SQLiteStorage::hasColumn(const std::string& table, const std::string& column) {
+    std::string sql = "PRAGMA table_info(" + table + ")";
+
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        return false;
+    }
+
+    bool found = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (column == reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))) {
+            found = true;
+            break;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+void SQLiteStorage::migrateLegacyShots() {
+    if (!hasColumn("shots", "weather_data")) {
+        return;
+    }
+
+    // Adding a column with a constant default is a schema-only change
+    for (const auto& column : WEATHER_COLUMNS) {
+        if (!hasColumn("shots", column.name)) {
+            executeStatement(std::string("ALTER TABLE shots ADD COLUMN ") + column.name +
+                             " " + column.type + " NOT NULL DEFAULT 0");
+        }
+    }
+
+    std::stringstream update;
+    update << "UPDATE shots SET ";
+    for (const auto& column : WEATHER_COLUMNS) {
+        update << column.name << " = COALESCE(json_extract(weather_data, '"
+               << column.jsonKey << "'), "
+               << (std::string(column.name) == "weather_timestamp" ? "timestamp" : "0")
+               << "), ";
+    }
+    update << "weather_data = '' WHERE id > ? AND id <= ? AND weather_data <> ''";
+    std::string updateSql = update.str();
+
+    sqlite3_int64 maxId = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, "SELECT COALESCE(MAX(id), 0) FROM shots", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            maxId = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    int rc = sqlite3_prepare_v2(db_, updateSql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error(std::string("SQL error: ") + sqlite3_errmsg(db_));
+    }
+
+    // Rows already converted by an interrupted run have weather_data = ''
+    // and are skipped, so every batch is safe to repeat
+    for (sqlite3_int64 low = 0; low < maxId; low += MIGRATION_BATCH_SIZE) {
+        executeStatement("BEGIN IMMEDIATE");
+        sqlite3_bind_int64(stmt, 1, low);
+        sqlite3_bind_int64(stmt, 2, low + MIGRATION_BATCH_SIZE);
+        rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_finalize(stmt);
+            executeStatement("ROLLBACK");
+            throw std::runtime_error("Shot migration failed: " + error);
+        }
+        executeStatement("COMMIT");
+    }
+    sqlite3_finalize(stmt);
+
+    dropLegacyWeatherColumn();
+}
+
+void SQLiteStorage::dropLegacyWeatherColumn() {
+    if (sqlite3_libversion_number() >= 3035000) {
+        executeStatement("ALTER TABLE shots DROP COLUMN weather_data");
+        return;
+    }
+
+    // DROP COLUMN needs SQLite 3.35; older libraries copy the typed columns
+    // into a fresh table instead. Indexes and triggers are recreated after
+    // the migrations run.
+    std::string createSql = SHOTS_TABLE;
+    createSql.replace(createSql.find("shots"), 5, "shots_migrated");
+    std::string columns = std::string("id,") + SHOT_COLUMNS;
+    executeStatement("BEGIN IMMEDIATE");
+    try {
+        executeStatement(createSql);
+        executeStatement("INSERT INTO shots_migrated (" + columns + ") SELECT " + columns + " FROM shots");
+        executeStatement("DROP TABLE shots");
+        executeStatement("ALTER TABLE shots_migrated RENAME TO shots");
+    } catch (...) {
+        executeStatement("ROLLBACK");
+        throw;
+    }
+    executeStatement("COMMIT");
+}
+
+int SQLiteStorage::schemaVersion() {
+    int version = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, "PRAGMA user_version", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return version;
 }
 
 void SQLiteStorage::executeStatement(const std::string& sql) {
@@ -77,112 +573,348 @@ void SQLiteStorage::executeStatement(const std::string& sql) {
 }
 
 bool SQLiteStorage::saveShotData(const ShotData& shot) {
-    const char* sql = R"(
-        INSERT INTO shots (
-            initial_velocity, spin_rate, launch_angle, weather_data,
-            club_used, actual_distance, predicted_distance,
-            lateral_deviation, timestamp
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )";
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    CachedStatement stmt(*statements_, INSERT_SHOT_SQL);
+    if (!stmt) {
+        return false;
+    }
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    bindShotRow(stmt.get(), shot);
+    return sqlite3_step(stmt.get()) == SQLITE_DONE;
+}
+
+bool SQLiteStorage::saveShotBatch(const std::vector<ShotData>& shots,
+                                  const std::string& checkpointKey,
+                                  const std::string& checkpointValue) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (shots.empty() && checkpointKey.empty()) {
+        return true;
+    }
+
+    CachedStatement insert(*statements_, INSERT_SHOT_SQL);
+    if (!insert) {
         return false;
     }
 
-    sqlite3_bind_double(stmt, 1, shot.initialVelocity);
-    sqlite3_bind_double(stmt, 2, shot.spinRate);
-    sqlite3_bind_double(stmt, 3, shot.launchAngle);
-    sqlite3_bind_text(stmt, 4, weatherDataToJson(shot.conditions).c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, shot.clubUsed.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_double(stmt, 6, shot.actualDistance);
-    sqlite3_bind_double(stmt, 7, shot.predictedDistance);
-    sqlite3_bind_double(stmt, 8, shot.lateralDeviation);
-    sqlite3_bind_int64(stmt, 9, shot.timestamp);
-
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    if (sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+    }
+
+    for (const auto& shot : shots) {
+        bindShotRow(insert.get(), shot);
+        int rc = sqlite3_step(insert.get());
+        sqlite3_reset(insert.get());
+        if (rc != SQLITE_DONE) {
+            sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+
+    if (!checkpointKey.empty()) {
+        CachedStatement checkpoint(*statements_, UPSERT_PREFERENCE_SQL);
+        int rc = SQLITE_ERROR;
+        if (checkpoint) {
+            sqlite3_bind_text(checkpoint.get(), 1, checkpointKey.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(checkpoint.get(), 2, checkpointValue.c_str(), -1, SQLITE_STATIC);
+            rc = sqlite3_step(checkpoint.get());
+        }
+        if (rc != SQLITE_DONE) {
+            sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+
+    if (sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+size_t SQLiteStorage::bulkInsertShots(const std::vector<ShotData>& shots, size_t transactionRows,
+                                      bool deferIndexes) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (shots.empty()) {
+        return 0;
+    }
+    transactionRows = std::max<size_t>(transactionRows, 1);
+
+    CachedStatement insert(*statements_, INSERT_SHOT_SQL);
+    if (!insert) {
+        return 0;
+    }
+
+    size_t committed = 0;
+    bool indexesDropped = false;
+    while (committed < shots.size()) {
+        size_t end = std::min(shots.size(), committed + transactionRows);
+        bool last = end == shots.size();
+        if (sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            break;
+        }
+
+        bool ok = true;
+        if (deferIndexes && !indexesDropped) {
+            ok = sqlite3_exec(db_, DROP_SHOT_INDEXES_SQL, nullptr, nullptr, nullptr) == SQLITE_OK;
+        }
+        for (size_t i = committed; ok && i < end; ++i) {
+            bindShotRow(insert.get(), shots[i]);
+            ok = sqlite3_step(insert.get()) == SQLITE_DONE;
+            sqlite3_reset(insert.get());
+        }
+        // Building the indexes once over the loaded table is a sort rather
+        // than a B-tree insert per row
+        if (ok && deferIndexes && last) {
+            ok = sqlite3_exec(db_, SHOTS_INDEXES, nullptr, nullptr, nullptr) == SQLITE_OK;
+        }
+        if (!ok || sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+            break;
+        }
+        indexesDropped = deferIndexes;
+        committed = end;
+    }
+
+    if (indexesDropped && committed < shots.size()) {
+        sqlite3_exec(db_, SHOTS_INDEXES, nullptr, nullptr, nullptr);
+    }
+    return committed;
 }
 
 std::vector<ShotData> SQLiteStorage::getShotHistory(size_t limit) {
     std::vector<ShotData> shots;
-    const char* sql = R"(
-        SELECT * FROM shots ORDER BY timestamp DESC LIMIT ?
-    )";
+    std::string sql = std::string("SELECT") + SHOT_COLUMNS +
+                      "FROM shots ORDER BY timestamp DESC LIMIT ?";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
         return shots;
     }
 
     sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(limit));
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ShotData shot;
-        shot.initialVelocity = sqlite3_column_double(stmt, 1);
-        shot.spinRate = sqlite3_column_double(stmt, 2);
-        shot.launchAngle = sqlite3_column_double(stmt, 3);
-        shot.conditions = jsonToWeatherData(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
-        shot.clubUsed = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-        shot.actualDistance = sqlite3_column_double(stmt, 6);
-        shot.predictedDistance = sqlite3_column_double(stmt, 7);
-        shot.lateralDeviation = sqlite3_column_double(stmt, 8);
-        shot.timestamp = sqlite3_column_int64(stmt, 9);
-        shots.push_back(shot);
+        shots.push_back(readShotRow(stmt));
     }
 
-    sqlite3_finalize(stmt);
     return shots;
 }
 
 std::vector<ShotData> SQLiteStorage::getShotsByClub(const std::string& clubName) {
     std::vector<ShotData> shots;
-    const char* sql = R"(
-        SELECT * FROM shots WHERE club_used = ? ORDER BY timestamp DESC
-    )";
+    std::string sql = std::string("SELECT") + SHOT_COLUMNS +
+                      "FROM shots WHERE club_used = ? ORDER BY timestamp DESC";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
         return shots;
     }
 
     sqlite3_bind_text(stmt, 1, clubName.c_str(), -1, SQLITE_STATIC);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ShotData shot;
-        shot.initialVelocity = sqlite3_column_double(stmt, 1);
-        shot.spinRate = sqlite3_column_double(stmt, 2);
-        shot.launchAngle = sqlite3_column_double(stmt, 3);
-        shot.conditions = jsonToWeatherData(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
-        shot.clubUsed = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-        shot.actualDistance = sqlite3_column_double(stmt, 6);
-        shot.predictedDistance = sqlite3_column_double(stmt, 7);
-        shot.lateralDeviation = sqlite3_column_double(stmt, 8);
-        shot.timestamp = sqlite3_column_int64(stmt, 9);
-        shots.push_back(shot);
+        shots.push_back(readShotRow(stmt));
     }
 
-    sqlite3_finalize(stmt);
     return shots;
 }
 
+std::vector<ShotData> SQLiteStorage::getRecentShotsByClub(const std::string& clubName, size_t limit) {
+    return getShotsByClubPage(clubName, limit).shots;
+}
+
+ShotPage SQLiteStorage::getShotHistoryPage(size_t pageSize,
+                                           const std::optional<ShotPageKey>& after) {
+    std::string sql = std::string("SELECT") + SHOT_COLUMNS + ", id FROM shots " +
+                      (after ? "WHERE (timestamp, id) < (?, ?) " : "") +
+                      "ORDER BY timestamp DESC, id DESC LIMIT ?";
+
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
+        return ShotPage();
+    }
+
+    int index = 1;
+    if (after) {
+        sqlite3_bind_int64(stmt, index++, after->timestamp);
+        sqlite3_bind_int64(stmt, index++, after->id);
+    }
+    sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(pageSize));
+
+    return fetchShotPage(stmt, pageSize);
+}
+
+ShotPage SQLiteStorage::getShotsByClubPage(const std::string& clubName, size_t pageSize,
+                                           const std::optional<ShotPageKey>& after) {
+    std::string sql = std::string("SELECT") + SHOT_COLUMNS + ", id FROM shots " +
+                      "WHERE club_used = ? " +
+                      (after ? "AND (timestamp, id) < (?, ?) " : "") +
+                      "ORDER BY timestamp DESC, id DESC LIMIT ?";
+
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
+        return ShotPage();
+    }
+
+    int index = 1;
+    sqlite3_bind_text(stmt, index++, clubName.c_str(), -1, SQLITE_STATIC);
+    if (after) {
+        sqlite3_bind_int64(stmt, index++, after->timestamp);
+        sqlite3_bind_int64(stmt, index++, after->id);
+    }
+    sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(pageSize));
+
+    return fetchShotPage(stmt, pageSize);
+}
+
+ShotPage SQLiteStorage::fetchShotPage(sqlite3_stmt* stmt, size_t pageSize) {
+    ShotPage page;
+    page.shots.reserve(pageSize);
+
+    ShotPageKey last{0, 0};
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        page.shots.push_back(readShotRow(stmt));
+        last.timestamp = page.shots.back().timestamp;
+        last.id = sqlite3_column_int64(stmt, SHOT_COLUMN_COUNT);
+    }
+
+    // A short page means the range is exhausted
+    if (pageSize > 0 && page.shots.size() == pageSize) {
+        page.nextKey = last;
+    }
+    return page;
+}
+
+ShotCursor SQLiteStorage::openShotCursor(const std::string& clubName, std::time_t since,
+                                         ShotOrder order) {
+    std::string sql = std::string("SELECT") + SHOT_COLUMNS + "FROM shots WHERE " +
+                      (clubName.empty() ? "" : "club_used = ? AND ") +
+                      "timestamp >= ? ORDER BY " +
+                      (order == ShotOrder::ByClub ? "club_used ASC, " : "") +
+                      "timestamp ASC, id ASC";
+
+    // A cursor keeps its pooled connection, or the writer and its lock,
+    // and therefore its snapshot, until it is exhausted
+    std::unique_ptr<SQLiteReaderPool::Lease> lease;
+    std::unique_lock<std::mutex> lock;
+    sqlite3* db = db_;
+    if (readers_) {
+        lease = std::make_unique<SQLiteReaderPool::Lease>(readers_->acquire());
+        db = lease->db();
+    } else {
+        lock = std::unique_lock<std::mutex>(writeMutex_);
+    }
+
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return ShotCursor(nullptr);
+    }
+
+    int index = 1;
+    if (!clubName.empty()) {
+        // The cursor outlives this call, so SQLite must keep its own copy
+        sqlite3_bind_text(stmt, index++, clubName.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_int64(stmt, index, since);
+
+    if (lease) {
+        return ShotCursor(stmt, std::move(lease));
+    }
+    return ShotCursor(stmt, std::move(lock));
+}
+
+// A null statement is one that failed to prepare
+ShotCursor::ShotCursor(sqlite3_stmt* stmt, std::unique_ptr<SQLiteReaderPool::Lease> lease)
+    : lease_(std::move(lease))
+    , stmt_(stmt)
+    , done_(stmt == nullptr)
+    , failed_(stmt == nullptr) {}
+
+ShotCursor::ShotCursor(sqlite3_stmt* stmt, std::unique_lock<std::mutex> lock)
+    : lock_(std::move(lock))
+    , stmt_(stmt)
+    , done_(stmt == nullptr)
+    , failed_(stmt == nullptr) {}
+
+ShotCursor::~ShotCursor() {
+    release();
+}
+
+ShotCursor::ShotCursor(ShotCursor&& other) noexcept
+    : lease_(std::move(other.lease_))
+    , lock_(std::move(other.lock_))
+    , stmt_(other.stmt_)
+    , done_(other.done_)
+    , failed_(other.failed_) {
+    other.stmt_ = nullptr;
+    other.done_ = true;
+}
+
+ShotCursor& ShotCursor::operator=(ShotCursor&& other) noexcept {
+    if (this != &other) {
+        release();
+        lease_ = std::move(other.lease_);
+        lock_ = std::move(other.lock_);
+        stmt_ = other.stmt_;
+        done_ = other.done_;
+        failed_ = other.failed_;
+        other.stmt_ = nullptr;
+        other.done_ = true;
+    }
+    return *this;
+}
+
+bool ShotCursor::next(ShotData& shot) {
+    if (done_) {
+        return false;
+    }
+
+    int rc = sqlite3_step(stmt_);
+    if (rc == SQLITE_ROW) {
+        shot = readShotRow(stmt_);
+        return true;
+    }
+
+    // Release the statement, and with it the read snapshot, as soon as possible
+    failed_ = rc != SQLITE_DONE;
+    done_ = true;
+    release();
+    return false;
+}
+
+void ShotCursor::release() {
+    // Finalize while the connection is still leased or locked
+    if (stmt_) {
+        sqlite3_finalize(stmt_);
+        stmt_ = nullptr;
+    }
+    lease_.reset();
+    if (lock_.owns_lock()) {
+        lock_.unlock();
+    }
+}
+
 bool SQLiteStorage::saveClubProfile(const ClubProfile& club) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
     const char* sql = R"(
         INSERT INTO clubs (
             name, avg_distance, avg_spin_rate, avg_launch_angle,
-            total_shots, last_updated, distance_deviation, direction_deviation
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+            total_shots, last_updated, distance_deviation, direction_deviation,
+            distance_count, distance_mean, distance_m2, distance_recent_mean, distance_recent_variance,
+            lateral_count, lateral_mean, lateral_m2, lateral_recent_mean, lateral_recent_variance,
+            distance_sketch, lateral_sketch
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    CachedStatement cached(*statements_, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) {
         return false;
     }
 
@@ -194,13 +926,16 @@ bool SQLiteStorage::saveClubProfile(const ClubProfile& club) {
     sqlite3_bind_int64(stmt, 6, club.lastUpdated);
     sqlite3_bind_double(stmt, 7, club.distanceDeviation);
     sqlite3_bind_double(stmt, 8, club.directionDeviation);
+    bindRunningStats(stmt, 9, club.distanceStats);
+    bindRunningStats(stmt, 14, club.lateralStats);
+    bindSketch(stmt, 19, club.distanceSketch);
+    bindSketch(stmt, 20, club.lateralSketch);
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    return sqlite3_step(stmt) == SQLITE_DONE;
 }
 
 bool SQLiteStorage::updateClubProfile(const ClubProfile& club) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
     const char* sql = R"(
         UPDATE clubs SET
             avg_distance = ?,
@@ -209,13 +944,25 @@ bool SQLiteStorage::updateClubProfile(const ClubProfile& club) {
             total_shots = ?,
             last_updated = ?,
             distance_deviation = ?,
-            direction_deviation = ?
+            direction_deviation = ?,
+            distance_count = ?,
+            distance_mean = ?,
+            distance_m2 = ?,
+            distance_recent_mean = ?,
+            distance_recent_variance = ?,
+            lateral_count = ?,
+            lateral_mean = ?,
+            lateral_m2 = ?,
+            lateral_recent_mean = ?,
+            lateral_recent_variance = ?,
+            distance_sketch = ?,
+            lateral_sketch = ?
         WHERE name = ?
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    CachedStatement cached(*statements_, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) {
         return false;
     }
 
@@ -226,95 +973,70 @@ bool SQLiteStorage::updateClubProfile(const ClubProfile& club) {
     sqlite3_bind_int64(stmt, 5, club.lastUpdated);
     sqlite3_bind_double(stmt, 6, club.distanceDeviation);
     sqlite3_bind_double(stmt, 7, club.directionDeviation);
-    sqlite3_bind_text(stmt, 8, club.name.c_str(), -1, SQLITE_STATIC);
+    bindRunningStats(stmt, 8, club.distanceStats);
+    bindRunningStats(stmt, 13, club.lateralStats);
+    bindSketch(stmt, 18, club.distanceSketch);
+    bindSketch(stmt, 19, club.lateralSketch);
+    sqlite3_bind_text(stmt, 20, club.name.c_str(), -1, SQLITE_STATIC);
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    return sqlite3_step(stmt) == SQLITE_DONE;
 }
 
 std::optional<ClubProfile> SQLiteStorage::getClubProfile(const std::string& name) {
-    const char* sql = "SELECT * FROM clubs WHERE name = ?";
+    std::string sql = std::string("SELECT") + CLUB_COLUMNS + "FROM clubs WHERE name = ?";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
         return std::nullopt;
     }
 
     sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        ClubProfile club;
-        club.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        club.avgDistance = sqlite3_column_double(stmt, 1);
-        club.avgSpinRate = sqlite3_column_double(stmt, 2);
-        club.avgLaunchAngle = sqlite3_column_double(stmt, 3);
-        club.totalShots = sqlite3_column_int64(stmt, 4);
-        club.lastUpdated = sqlite3_column_int64(stmt, 5);
-        club.distanceDeviation = sqlite3_column_double(stmt, 6);
-        club.directionDeviation = sqlite3_column_double(stmt, 7);
-
-        sqlite3_finalize(stmt);
-        return club;
+        return readClubRow(stmt);
     }
 
-    sqlite3_finalize(stmt);
     return std::nullopt;
 }
 
 std::vector<ClubProfile> SQLiteStorage::getAllClubProfiles() {
     std::vector<ClubProfile> clubs;
-    const char* sql = "SELECT * FROM clubs ORDER BY name";
+    std::string sql = std::string("SELECT") + CLUB_COLUMNS + "FROM clubs ORDER BY name";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
         return clubs;
     }
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ClubProfile club;
-        club.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        club.avgDistance = sqlite3_column_double(stmt, 1);
-        club.avgSpinRate = sqlite3_column_double(stmt, 2);
-        club.avgLaunchAngle = sqlite3_column_double(stmt, 3);
-        club.totalShots = sqlite3_column_int64(stmt, 4);
-        club.lastUpdated = sqlite3_column_int64(stmt, 5);
-        club.distanceDeviation = sqlite3_column_double(stmt, 6);
-        club.directionDeviation = sqlite3_column_double(stmt, 7);
-        clubs.push_back(club);
+        clubs.push_back(readClubRow(stmt));
     }
 
-    sqlite3_finalize(stmt);
     return clubs;
 }
 
 bool SQLiteStorage::savePreference(const std::string& key, const std::string& value) {
-    const char* sql = R"(
-        INSERT OR REPLACE INTO preferences (key, value) VALUES (?, ?)
-    )";
-
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    CachedStatement cached(*statements_, UPSERT_PREFERENCE_SQL);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) {
         return false;
     }
 
     sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_STATIC);
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    return sqlite3_step(stmt) == SQLITE_DONE;
 }
 
 std::string SQLiteStorage::getPreference(const std::string& key, const std::string& defaultValue) {
     const char* sql = "SELECT value FROM preferences WHERE key = ?";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
         return defaultValue;
     }
 
@@ -322,33 +1044,137 @@ std::string SQLiteStorage::getPreference(const std::string& key, const std::stri
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         std::string value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        sqlite3_finalize(stmt);
         return value;
     }
 
-    sqlite3_finalize(stmt);
     return defaultValue;
 }
 
-std::string SQLiteStorage::weatherDataToJson(const weather::WeatherData& data) {
-    json j;
-    j["temperature"] = data.temperature;
-    j["humidity"] = data.humidity;
-    j["pressure"] = data.pressure;
-    j["windSpeed"] = data.windSpeed;
-    j["windDirection"] = data.windDirection;
-    return j.dump();
-}
-
-weather::WeatherData SQLiteStorage::jsonToWeatherData(const std::string& jsonStr) {
-    weather::WeatherData data;
-    json j = json::parse(jsonStr);
-    data.temperature = j["temperature"];
-    data.humidity = j["humidity"];
-    data.pressure = j["pressure"];
-    data.windSpeed = j["windSpeed"];
-    data.windDirection = j["windDirection"];
-    return data;
+ChangeBatch SQLiteStorage::readChangesSince(sqlite3_int64 seq, size_t maxBatch) {
+    ChangeBatch batch;
+    batch.lastSeq = seq;
+    if (maxBatch == 0) {
+        return batch;
+    }
+
+    // One extra row tells whether another batch follows
+    const int changeColumns = 6;
+    std::string sql = std::string("SELECT c.seq, c.entity, c.operation, c.changed_at, c.shot_id, c.club_name,") +
+                      SHOT_COLUMNS + "," + CLUB_COLUMNS +
+                      "FROM changes c "
+                      "LEFT JOIN shots ON c.entity = 0 AND shots.id = c.shot_id "
+                      "LEFT JOIN clubs ON c.entity = 1 AND clubs.name = c.club_name "
+                      "WHERE c.seq > ? ORDER BY c.seq LIMIT ?";
+
+    ReadStatement read = prepareRead(sql);
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt) {
+        return batch;
+    }
+
+    sqlite3_bind_int64(stmt, 1, seq);
+    size_t limit = std::min<size_t>(maxBatch, std::numeric_limits<int>::max());
+    sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(limit) + 1);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (batch.changes.size() == maxBatch) {
+            batch.hasMore = true;
+            break;
+        }
+
+        ChangeRecord change;
+        change.seq = sqlite3_column_int64(stmt, 0);
+        change.entity = static_cast<ChangeEntity>(sqlite3_column_int(stmt, 1));
+        change.operation = static_cast<ChangeOperation>(sqlite3_column_int(stmt, 2));
+        change.changedAt = sqlite3_column_int64(stmt, 3);
+        if (change.entity == ChangeEntity::Shot) {
+            change.shotId = sqlite3_column_int64(stmt, 4);
+            if (sqlite3_column_type(stmt, changeColumns) != SQLITE_NULL) {
+                change.shot = readShotRow(stmt, changeColumns);
+            }
+        } else {
+            change.clubName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+            if (sqlite3_column_type(stmt, changeColumns + SHOT_COLUMN_COUNT) != SQLITE_NULL) {
+                change.club = readClubRow(stmt, changeColumns + SHOT_COLUMN_COUNT);
+            }
+        }
+        batch.changes.push_back(std::move(change));
+    }
+
+    if (!batch.changes.empty()) {
+        // Seqs are contiguous apart from pruning, which always keeps the newest change.
+        // Seq 0 asks for whatever is retained, so a gap before it is expected.
+        batch.resyncRequired = seq > 0 && batch.changes.front().seq > seq + 1;
+        batch.lastSeq = batch.changes.back().seq;
+    }
+    return batch;
+}
+
+sqlite3_int64 SQLiteStorage::latestChangeSeq() {
+    ReadStatement read = prepareRead("SELECT COALESCE(MAX(seq), 0) FROM changes");
+    sqlite3_stmt* stmt = read.get();
+    if (!stmt || sqlite3_step(stmt) != SQLITE_ROW) {
+        return 0;
+    }
+    return sqlite3_column_int64(stmt, 0);
+}
+
+size_t SQLiteStorage::pruneChanges(const ChangeRetention& retention) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    // Changes are pruned as a prefix: find the highest seq any limit drops
+    const char* sql = R"(
+        SELECT MAX(
+            ?1,
+            CASE WHEN ?2 > 0 THEN COALESCE((SELECT MAX(seq) FROM changes) - ?2, 0) ELSE 0 END,
+            CASE WHEN ?3 > 0 THEN COALESCE((SELECT MAX(seq) FROM changes
+                                            WHERE changed_at < strftime('%s', 'now') - ?3), 0)
+                 ELSE 0 END
+        ),
+        COALESCE((SELECT MAX(seq) FROM changes), 0)
+    )";
+
+    sqlite3_int64 cutoff = 0;
+    {
+        CachedStatement stmt(*statements_, sql);
+        if (!stmt) {
+            return 0;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, retention.acknowledgedSeq);
+        sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(retention.maxChanges));
+        sqlite3_bind_int64(stmt.get(), 3, static_cast<sqlite3_int64>(retention.maxAge));
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return 0;
+        }
+        sqlite3_int64 newest = sqlite3_column_int64(stmt.get(), 1);
+        cutoff = std::min(sqlite3_column_int64(stmt.get(), 0), newest - 1);
+    }
+    if (cutoff <= 0) {
+        return 0;
+    }
+
+    CachedStatement prune(*statements_, "DELETE FROM changes WHERE seq <= ?");
+    if (!prune) {
+        return 0;
+    }
+    sqlite3_bind_int64(prune.get(), 1, cutoff);
+    if (sqlite3_step(prune.get()) != SQLITE_DONE) {
+        return 0;
+    }
+    return static_cast<size_t>(sqlite3_changes(db_));
+}
+
+StatementCacheStats SQLiteStorage::statementCacheStats() const {
+    StatementCacheStats stats = statements_->stats();
+    if (readers_) {
+        stats += readers_->statementStats();
+    }
+    return stats;
+}
+
+std::unique_ptr<OnlineBackup> SQLiteStorage::startBackup(const std::string& destinationPath,
+                                                         const BackupOptions& options) {
+    return std::make_unique<OnlineBackup>(db_, writeMutex_, destinationPath, options);
 }
 
 } // namespace data
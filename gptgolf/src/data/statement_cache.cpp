@@ -0,0 +1,53 @@
+#include "data/statement_cache.h"
+
+namespace gptgolf {
+namespace data {
+
+StatementCache::StatementCache(sqlite3* db)
+    : db_(db)
+    , hits_(0)
+    , misses_(0)
+    , size_(0) {}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+sqlite3_stmt* StatementCache::prepare(const std::string& sql) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        ++hits_;
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+
+    ++misses_;
+    sqlite3_stmt* stmt = nullptr;
+    if (!db_ || sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    statements_.emplace(sql, stmt);
+    size_ = statements_.size();
+    return stmt;
+}
+
+void StatementCache::clear() {
+    for (auto& entry : statements_) {
+        sqlite3_finalize(entry.second);
+    }
+    statements_.clear();
+    size_ = 0;
+}
+
+StatementCacheStats StatementCache::stats() const {
+    StatementCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.statements = size_;
+    return stats;
+}
+
+} // namespace data
+} // namespace gptgolf
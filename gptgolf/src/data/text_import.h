@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @file text_import.h
+ * @brief Text scanning helpers shared by the bulk file importers
+ *
+ * Line and CSV splitting over memory-mapped files, timestamp parsing and a
+ * small parallel-for. Internal to the library; not installed.
+ */
+
+namespace gptgolf {
+namespace data {
+namespace text_import {
+
+inline std::string_view trim(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+    return text;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+inline std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+// Month (1-12) of a Unix timestamp in UTC
+inline int monthFromTimestamp(std::time_t timestamp) {
+    std::int64_t days = static_cast<std::int64_t>(timestamp) / 86400;
+    if (static_cast<std::int64_t>(timestamp) % 86400 < 0) {
+        --days;
+    }
+    // Inverse of daysFromCivil, month part only; the year starts in March
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    return static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+}
+
+// Reads the unsigned integers of a date such as "2024-05-01 14:03:22" or
+// "5/1/2024 2:03 PM"; returns how many were found
+inline size_t dateNumbers(std::string_view text, int numbers[6], bool& pm, bool& am) {
+    size_t count = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (std::isdigit(static_cast<unsigned char>(text[i]))) {
+            int value = 0;
+            while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) {
+                value = value * 10 + (text[i++] - '0');
+            }
+            if (count < 6) {
+                numbers[count++] = value;
+            }
+        } else {
+            if ((text[i] == 'P' || text[i] == 'p') && i + 1 < text.size() && (text[i + 1] == 'M' || text[i + 1] == 'm')) pm = true;
+            if ((text[i] == 'A' || text[i] == 'a') && i + 1 < text.size() && (text[i + 1] == 'M' || text[i + 1] == 'm')) am = true;
+            ++i;
+        }
+    }
+    return count;
+}
+
+// Parses Unix seconds, ISO "YYYY-MM-DD[ T]HH:MM[:SS]" or US
+// "MM/DD/YYYY HH:MM[:SS] [AM|PM]" as UTC; returns fallback otherwise
+inline std::time_t parseTimestamp(std::string_view text, std::time_t fallback) {
+    text = trim(text);
+    if (text.empty()) {
+        return fallback;
+    }
+
+    bool allDigits = std::all_of(text.begin(), text.end(),
+                                 [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+    if (allDigits) {
+        std::int64_t seconds = 0;
+        std::from_chars(text.data(), text.data() + text.size(), seconds);
+        return static_cast<std::time_t>(seconds);
+    }
+
+    int numbers[6] = {0, 0, 0, 0, 0, 0};
+    bool pm = false;
+    bool am = false;
+    if (dateNumbers(text, numbers, pm, am) < 3) {
+        return fallback;
+    }
+    int year, month, day;
+    if (text.find('/') != std::string_view::npos) {
+        month = numbers[0];
+        day = numbers[1];
+        year = numbers[2];
+    } else {
+        year = numbers[0];
+        month = numbers[1];
+        day = numbers[2];
+    }
+    int hour = numbers[3];
+    if (pm && hour < 12) hour += 12;
+    if (am && hour == 12) hour = 0;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || numbers[4] > 59 || numbers[5] > 60) {
+        return fallback;
+    }
+
+    std::int64_t days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    return static_cast<std::time_t>(days * 86400 + hour * 3600 + numbers[4] * 60 + numbers[5]);
+}
+
+// Splits one CSV line into cells; quoted cells may contain the delimiter
+inline void splitCsvLine(std::string_view line, char delimiter, std::vector<std::string_view>& cells,
+                  std::string& scratch) {
+    cells.clear();
+    scratch.clear();
+    scratch.reserve(line.size());
+    size_t i = 0;
+    while (i <= line.size()) {
+        if (i < line.size() && line[i] == '"') {
+            // Unquote into scratch; cells point into it, so it must not reallocate
+            size_t start = scratch.size();
+            ++i;
+            while (i < line.size()) {
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        scratch += '"';
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                scratch += line[i++];
+            }
+            cells.emplace_back(scratch.data() + start, scratch.size() - start);
+            while (i < line.size() && line[i] != delimiter) ++i;
+            ++i;
+        } else {
+            size_t end = line.find(delimiter, i);
+            if (end == std::string_view::npos) end = line.size();
+            cells.push_back(line.substr(i, end - i));
+            i = end + 1;
+        }
+    }
+}
+
+inline std::string_view nextLine(const char*& cursor, const char* end) {
+    const char* start = cursor;
+    const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+    const char* lineEnd = newline ? newline : end;
+    cursor = newline ? newline + 1 : end;
+    if (lineEnd > start && lineEnd[-1] == '\r') {
+        --lineEnd;
+    }
+    return std::string_view(start, lineEnd - start);
+}
+
+inline bool isBlank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+}
+
+// Runs task(i) for i in [0, count) on up to threads workers
+template <typename Task>
+void runParallel(size_t count, size_t threads, Task task) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+    size_t workers = std::min(threads, count);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < workers; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+} // namespace text_import
+} // namespace data
+} // namespace gptgolf
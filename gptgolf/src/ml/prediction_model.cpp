@@ -81,34 +81,105 @@ void PredictionModel::train(const std::vector<data::ShotData>& trainingData) {
 
     // Train for each club
     for (const auto& [clubName, shots] : clubShots) {
-        std::vector<double> weights(5, 1.0); // Initialize weights
-        
-        // Simple gradient descent
-        for (size_t epoch = 0; epoch < 100; ++epoch) {
-            double totalError = 0.0;
-            
-            for (const auto& shot : shots) {
-                auto features = extractFeatures(clubName, shot.conditions, shot.initialVelocity);
-                double predicted = std::inner_product(
-                    weights.begin(), weights.end(),
-                    features.begin(), 0.0
-                );
-                
-                double error = shot.actualDistance - predicted;
-                totalError += error * error;
-
-                // Update weights
-                for (size_t i = 0; i < weights.size(); ++i) {
-                    weights[i] += learningRate_ * error * features[i];
+        std::vector<double> features;
+        std::vector<double> targets;
+        features.reserve(shots.size() * FEATURE_COUNT);
+        targets.reserve(shots.size());
+        for (const auto& shot : shots) {
+            auto shotFeatures = extractFeatures(clubName, shot.conditions, shot.initialVelocity);
+            features.insert(features.end(), shotFeatures.begin(), shotFeatures.end());
+            targets.push_back(shot.actualDistance);
+        }
+        clubWeights_[clubName] = fitClubWeights(features, targets);
+    }
+}
+
+void PredictionModel::train(const data::ShotSnapshot& snapshot, const data::SnapshotPredicate& predicate) {
+    using data::SnapshotColumn;
+
+    std::vector<std::string> clubs;
+    if (predicate.club.empty()) {
+        clubs = snapshot.clubs();
+    } else {
+        clubs.push_back(predicate.club);
+    }
+
+    // One row-major feature buffer per club
+    std::map<std::string, std::pair<std::vector<double>, std::vector<double>>> clubData;
+    size_t total = 0;
+    for (const auto& clubName : clubs) {
+        data::SnapshotPredicate clubPredicate = predicate;
+        clubPredicate.club = clubName;
+
+        // Snapshots are grouped by club, so this is a short run of blocks
+        auto& [features, targets] = clubData[clubName];
+        for (const auto& block : snapshot.selectBlocks(clubPredicate)) {
+            const double* velocity = block.column(SnapshotColumn::InitialVelocity);
+            const double* windSpeed = block.column(SnapshotColumn::WindSpeed);
+            const double* windDirection = block.column(SnapshotColumn::WindDirection);
+            const double* temperature = block.column(SnapshotColumn::Temperature);
+            const double* humidity = block.column(SnapshotColumn::Humidity);
+            const double* distance = block.column(SnapshotColumn::ActualDistance);
+
+            size_t first = targets.size();
+            features.resize((first + block.rows) * FEATURE_COUNT);
+            double* out = features.data() + first * FEATURE_COUNT;
+            for (size_t row = 0; row < block.rows; ++row) {
+                if (!block.allMatch && !block.matches(row)) {
+                    continue;
                 }
+                writeFeatures(out, windSpeed[row], windDirection[row], temperature[row],
+                              humidity[row], velocity[row]);
+                out += FEATURE_COUNT;
+                targets.push_back(distance[row]);
             }
+            features.resize(targets.size() * FEATURE_COUNT);
+        }
+        total += targets.size();
+    }
+
+    if (total < minTrainingSize_) {
+        throw std::runtime_error("Insufficient training data");
+    }
+
+    for (const auto& [clubName, data] : clubData) {
+        if (!data.second.empty()) {
+            clubWeights_[clubName] = fitClubWeights(data.first, data.second);
+        }
+    }
+}
 
-            // Early stopping if error is small enough
-            if (totalError / shots.size() < 0.01) break;
+std::vector<double> PredictionModel::fitClubWeights(
+    const std::vector<double>& features,
+    const std::vector<double>& targets
+) const {
+    std::vector<double> weights(FEATURE_COUNT, 1.0); // Initialize weights
+
+    // Simple gradient descent
+    for (size_t epoch = 0; epoch < 100; ++epoch) {
+        double totalError = 0.0;
+
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const double* shotFeatures = features.data() + i * FEATURE_COUNT;
+            double predicted = std::inner_product(
+                weights.begin(), weights.end(),
+                shotFeatures, 0.0
+            );
+
+            double error = targets[i] - predicted;
+            totalError += error * error;
+
+            // Update weights
+            for (size_t w = 0; w < weights.size(); ++w) {
+                weights[w] += learningRate_ * error * shotFeatures[w];
+            }
         }
 
-        clubWeights_[clubName] = weights;
+        // Early stopping if error is small enough
+        if (totalError / targets.size() < 0.01) break;
     }
+
+    return weights;
 }
 
 void PredictionModel::updateModel(const data::ShotData& newShot) {
@@ -271,17 +342,20 @@ std::vector<double> PredictionModel::extractFeatures(
     const weather::WeatherData& conditions,
     double swingSpeed
 ) {
-    std::vector<double> features;
-    features.reserve(5);
+    std::vector<double> features(FEATURE_COUNT);
+    writeFeatures(features.data(), conditions.windSpeed, conditions.windDirection,
+                  conditions.temperature, conditions.humidity, swingSpeed);
+    return features;
+}
 
+void PredictionModel::writeFeatures(double* out, double windSpeed, double windDirection,
+                                    double temperature, double humidity, double swingSpeed) {
     // Normalize features
-    features.push_back(conditions.windSpeed / 30.0);  // Normalize wind speed (0-30 mph range)
-    features.push_back(std::cos(conditions.windDirection));  // Wind direction as cosine
-    features.push_back((conditions.temperature - 10.0) / 30.0);  // Normalize temp (10-40°C range)
-    features.push_back(conditions.humidity / 100.0);  // Humidity already 0-100
-    features.push_back(swingSpeed / 120.0);  // Normalize swing speed (0-120 mph range)
-
-    return features;
+    out[0] = windSpeed / 30.0;  // Normalize wind speed (0-30 mph range)
+    out[1] = std::cos(windDirection);  // Wind direction as cosine
+    out[2] = (temperature - 10.0) / 30.0;  // Normalize temp (10-40°C range)
+    out[3] = humidity / 100.0;  // Humidity already 0-100
+    out[4] = swingSpeed / 120.0;  // Normalize swing speed (0-120 mph range)
 }
 
 } // namespace ml
@@ -0,0 +1,108 @@
+#include "weather/forecast_timeline.h"
+#include "data/text_import.h"
+#include <cmath>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+constexpr double DEGREES_TO_RADIANS = M_PI / 180.0;
+
+float lerp(float from, float to, double fraction) {
+    return static_cast<float>(from + (to - from) * fraction);
+}
+
+} // namespace
+
+std::optional<ForecastTimeline> ForecastTimeline::fromReadings(const std::vector<WeatherData>& readings) {
+    if (readings.empty()) {
+        return std::nullopt;
+    }
+
+    ForecastTimeline timeline;
+    timeline.start_ = readings.front().timestamp;
+    if (readings.size() > 1) {
+        timeline.step_ = readings[1].timestamp - readings[0].timestamp;
+        if (timeline.step_ <= 0) {
+            return std::nullopt;
+        }
+    }
+
+    timeline.samples_.reserve(readings.size());
+    for (size_t i = 0; i < readings.size(); ++i) {
+        const WeatherData& reading = readings[i];
+        if (reading.timestamp != timeline.start_ + static_cast<std::time_t>(i) * timeline.step_) {
+            return std::nullopt;
+        }
+        // Direction is where the wind blows from; only consistency matters here
+        double radians = reading.windDirection * DEGREES_TO_RADIANS;
+        timeline.samples_.push_back({
+            static_cast<float>(reading.temperature),
+            static_cast<float>(reading.humidity),
+            static_cast<float>(reading.pressure),
+            static_cast<float>(reading.windSpeed * std::sin(radians)),
+            static_cast<float>(reading.windSpeed * std::cos(radians)),
+            static_cast<float>(reading.precipitation)
+        });
+    }
+    return timeline;
+}
+
+std::optional<ForecastTimeline> ForecastTimeline::parse(const std::string& body) {
+    try {
+        json j = json::parse(body);
+        std::vector<WeatherData> readings;
+        for (const auto& entry : j.at("timelines").at("hourly")) {
+            const auto& values = entry.at("values");
+            WeatherData data{};
+            data.timestamp = data::text_import::parseTimestamp(entry.at("time").get<std::string>(), -1);
+            if (data.timestamp < 0) {
+                return std::nullopt;
+            }
+            data.temperature = values.at("temperature").get<double>();
+            data.humidity = values.at("humidity").get<double>();
+            data.pressure = values.at("pressureSeaLevel").get<double>();
+            data.windSpeed = values.at("windSpeed").get<double>();
+            data.windDirection = values.at("windDirection").get<double>();
+            data.precipitation = values.value("precipitationIntensity", 0.0);
+            readings.push_back(data);
+        }
+        return fromReadings(readings);
+    }
+    catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<WeatherData> ForecastTimeline::at(std::time_t time) const {
+    if (!covers(time)) {
+        return std::nullopt;
+    }
+
+    std::time_t offset = time - start_;
+    size_t index = static_cast<size_t>(offset / step_);
+    double fraction = static_cast<double>(offset - static_cast<std::time_t>(index) * step_) / step_;
+    const Sample& before = samples_[index];
+    const Sample& after = index + 1 < samples_.size() ? samples_[index + 1] : before;
+
+    float windEast = lerp(before.windEast, after.windEast, fraction);
+    float windNorth = lerp(before.windNorth, after.windNorth, fraction);
+    double direction = std::atan2(windEast, windNorth) / DEGREES_TO_RADIANS;
+
+    WeatherData data{};
+    data.temperature = lerp(before.temperature, after.temperature, fraction);
+    data.humidity = lerp(before.humidity, after.humidity, fraction);
+    data.pressure = lerp(before.pressure, after.pressure, fraction);
+    data.windSpeed = std::hypot(windEast, windNorth);
+    data.windDirection = direction < 0.0 ? direction + 360.0 : direction;
+    data.precipitation = lerp(before.precipitation, after.precipitation, fraction);
+    data.timestamp = time;
+    return data;
+}
+
+} // namespace weather
+} // namespace gptgolf
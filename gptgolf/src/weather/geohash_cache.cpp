@@ -0,0 +1,127 @@
+#include "weather/geohash_cache.h"
+#include <algorithm>
+#include <functional>
+
+namespace gptgolf {
+namespace weather {
+
+std::string encodeGeohash(double latitude, double longitude, int precision) {
+    static const char BASE32[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+    precision = std::clamp(precision, 1, 12);
+    double latRange[2] = {-90.0, 90.0};
+    double lonRange[2] = {-180.0, 180.0};
+
+    std::string hash;
+    hash.reserve(precision);
+    bool lonBit = true;     // Bits alternate, longitude first
+    int bits = 0;
+    int value = 0;
+    while (static_cast<int>(hash.size()) < precision) {
+        double* range = lonBit ? lonRange : latRange;
+        double coordinate = lonBit ? longitude : latitude;
+        double mid = (range[0] + range[1]) / 2.0;
+        value <<= 1;
+        if (coordinate >= mid) {
+            value |= 1;
+            range[0] = mid;
+        } else {
+            range[1] = mid;
+        }
+        lonBit = !lonBit;
+
+        if (++bits == 5) {
+            hash.push_back(BASE32[value]);
+            bits = 0;
+            value = 0;
+        }
+    }
+    return hash;
+}
+
+GeohashWeatherCache::GeohashWeatherCache(const GeohashCacheConfig& config)
+    : config_(config) {
+    config_.shardCount = std::max<size_t>(config_.shardCount, 1);
+    config_.shardCapacity = std::max<size_t>(config_.shardCapacity, 1);
+    for (size_t i = 0; i < config_.shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+GeohashWeatherCache::Shard& GeohashWeatherCache::shardFor(const std::string& cell) {
+    return *shards_[std::hash<std::string>()(cell) % shards_.size()];
+}
+
+std::optional<WeatherData> GeohashWeatherCache::get(double latitude, double longitude, std::time_t now) {
+    std::string cell = encodeGeohash(latitude, longitude, config_.precision);
+    Shard& shard = shardFor(cell);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.cells.find(cell);
+    if (it == shard.cells.end()) {
+        shard.stats.misses++;
+        return std::nullopt;
+    }
+    if (now - it->second.timestamp >= config_.ttlSeconds) {
+        shard.cells.erase(it);
+        shard.stats.expired++;
+        shard.stats.misses++;
+        return std::nullopt;
+    }
+    shard.stats.hits++;
+    return it->second;
+}
+
+void GeohashWeatherCache::put(double latitude, double longitude, const WeatherData& data) {
+    std::string cell = encodeGeohash(latitude, longitude, config_.precision);
+    Shard& shard = shardFor(cell);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.cells.find(cell);
+    if (it != shard.cells.end()) {
+        if (data.timestamp >= it->second.timestamp) {
+            it->second = data;
+        }
+        return;
+    }
+
+    if (shard.cells.size() >= config_.shardCapacity) {
+        // Shards are small, so a scan for the oldest reading is cheaper than an LRU list
+        auto oldest = std::min_element(shard.cells.begin(), shard.cells.end(),
+            [](const auto& a, const auto& b) { return a.second.timestamp < b.second.timestamp; });
+        shard.cells.erase(oldest);
+        shard.stats.evictions++;
+    }
+    shard.cells.emplace(std::move(cell), data);
+}
+
+void GeohashWeatherCache::invalidate(double latitude, double longitude) {
+    std::string cell = encodeGeohash(latitude, longitude, config_.precision);
+    Shard& shard = shardFor(cell);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.cells.erase(cell);
+}
+
+void GeohashWeatherCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->cells.clear();
+    }
+}
+
+GeohashCacheStats GeohashWeatherCache::getStats() const {
+    GeohashCacheStats total;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->stats.hits;
+        total.misses += shard->stats.misses;
+        total.expired += shard->stats.expired;
+        total.evictions += shard->stats.evictions;
+        total.entries += shard->cells.size();
+    }
+    return total;
+}
+
+} // namespace weather
+} // namespace gptgolf
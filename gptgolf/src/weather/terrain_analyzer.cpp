@@ -0,0 +1,165 @@
+#include "weather/terrain_analyzer.h"
+#include <algorithm>
+
+namespace gptgolf {
+namespace weather {
+
+TerrainAnalyzer::TerrainAnalyzer(WeatherStorage& weatherStorage, std::shared_ptr<TerrainTileStore> tileStore)
+    : storage(weatherStorage)
+    , tiles(std::move(tileStore)) {}
+
+TerrainAnalysis TerrainAnalyzer::analyzeTerrain(double latitude, double longitude) {
+    TerrainAnalysis analysis;
+    // One lookup rather than one per attribute
+    auto cell = tiles ? tiles->lookup(latitude, longitude) : std::nullopt;
+    if (cell) {
+        analysis.landUse = cell->landUse;
+        analysis.elevation = cell->elevation;
+        analysis.roughnessVariation = cell->roughness;
+        analysis.isComplex = cell->landUse == LandUseType::MOUNTAIN ||
+                             cell->roughness >= COMPLEX_TERRAIN_THRESHOLD;
+    }
+    analysis.params = deriveParameters(analysis);
+    return analysis;
+}
+
+WindProfile TerrainAnalyzer::recommendProfile(const TerrainAnalysis& terrain,
+                                              const WeatherData& weather) {
+    // Calm air has no meaningful shear
+    if (weather.windSpeed < 1.0) {
+        return WindProfile::CONSTANT;
+    }
+
+    // The log law describes flow over homogeneous, low roughness surfaces;
+    // obstacles and relief are better fitted by the power law
+    if (terrain.isComplex) {
+        return WindProfile::POWER_LAW;
+    }
+    switch (terrain.landUse) {
+        case LandUseType::WATER:
+        case LandUseType::COASTAL:
+        case LandUseType::GRASSLAND:
+        case LandUseType::UNKNOWN:
+            return WindProfile::LOGARITHMIC;
+        default:
+            return WindProfile::POWER_LAW;
+    }
+}
+
+LandUseType TerrainAnalyzer::detectLandUse(double latitude, double longitude) {
+    auto cell = tiles ? tiles->lookup(latitude, longitude) : std::nullopt;
+    return cell ? cell->landUse : LandUseType::UNKNOWN;
+}
+
+double TerrainAnalyzer::getElevation(double latitude, double longitude) {
+    auto cell = tiles ? tiles->lookup(latitude, longitude) : std::nullopt;
+    return cell ? cell->elevation : 0.0;
+}
+
+bool TerrainAnalyzer::isComplexTerrain(double latitude, double longitude) {
+    return analyzeTerrain(latitude, longitude).isComplex;
+}
+
+TerrainParameters TerrainAnalyzer::deriveParameters(const TerrainAnalysis& analysis) {
+    // Roughness lengths and power law exponents from the Davenport classification
+    TerrainParameters params;
+    switch (analysis.landUse) {
+        case LandUseType::WATER: params = TerrainParameters::Water(); break;
+        case LandUseType::COASTAL: params = {0.005, 0.11, 10.0}; break;
+        case LandUseType::FOREST: params = {0.8, 0.28, 10.0}; break;
+        case LandUseType::SUBURBAN: params = TerrainParameters::Suburban(); break;
+        case LandUseType::URBAN: params = TerrainParameters::Urban(); break;
+        case LandUseType::INDUSTRIAL: params = {0.5, 0.25, 10.0}; break;
+        case LandUseType::MOUNTAIN: params = {0.5, 0.25, 10.0}; break;
+        default: params = TerrainParameters::OpenTerrain(); break;
+    }
+
+    // Relief adds form drag on top of the surface cover
+    if (analysis.isComplex && params.roughnessLength < 0.5) {
+        params.roughnessLength = 0.5;
+        params.powerLawExponent = std::max(params.powerLawExponent, 0.25);
+    }
+    return params;
+}
+
+void TerrainAnalyzer::storeWindPattern(double latitude, double longitude,
+                                       const WeatherData& weather) {
+    WindPattern pattern;
+    pattern.speed = weather.windSpeed;
+    pattern.direction = weather.windDirection;
+    pattern.gustSpeed = weather.windSpeed;
+    pattern.temperature = weather.temperature;
+    pattern.pressure = weather.pressure;
+    pattern.timestamp = weather.timestamp;
+    storeWindPattern(latitude, longitude, pattern);
+}
+
+void TerrainAnalyzer::storeWindPattern(double latitude, double longitude,
+                                       const WindPattern& pattern) {
+    storage.storeWindPattern(latitude, longitude, pattern);
+}
+
+std::optional<WindStatistics> TerrainAnalyzer::getWindStats(double latitude, double longitude,
+                                                            int startHour, int endHour) {
+    if (startHour < 0 || startHour >= HOURS_IN_DAY || endHour < 0 || endHour >= HOURS_IN_DAY) {
+        return std::nullopt;
+    }
+
+    std::vector<WindAccumulator> hours = storage.getWindAccumulators(latitude, longitude);
+    WindAccumulator merged;
+    for (int hour = startHour;; hour = (hour + 1) % HOURS_IN_DAY) {
+        merged.merge(hours[hour]);
+        if (hour == endHour) {
+            break;
+        }
+    }
+
+    if (merged.count < MIN_PATTERNS_FOR_STATS) {
+        return std::nullopt;
+    }
+    return toStatistics(merged);
+}
+
+std::vector<WindPattern> TerrainAnalyzer::getTypicalPatterns(double latitude, double longitude,
+                                                             int hourOfDay) {
+    std::vector<WindPattern> patterns;
+    auto accumulator = storage.getWindAccumulator(latitude, longitude, hourOfDay);
+    if (accumulator && accumulator->count > 0) {
+        WindPattern typical;
+        typical.speed = accumulator->meanSpeed;
+        typical.direction = accumulator->prevailingDirection();
+        typical.gustSpeed = accumulator->meanGust;
+        typical.temperature = accumulator->meanTemperature;
+        typical.pressure = accumulator->meanPressure;
+        typical.timestamp = accumulator->lastTimestamp;
+        patterns.push_back(typical);
+    }
+    return patterns;
+}
+
+WindStatistics TerrainAnalyzer::calculateStats(const std::vector<WindPattern>& patterns) {
+    WindAccumulator accumulator;
+    for (const auto& pattern : patterns) {
+        accumulator.add(pattern);
+    }
+    return toStatistics(accumulator);
+}
+
+double TerrainAnalyzer::calculateTurbulenceIntensity(const std::vector<WindPattern>& patterns) {
+    return calculateStats(patterns).turbulenceIntensity;
+}
+
+WindStatistics TerrainAnalyzer::toStatistics(const WindAccumulator& accumulator) {
+    WindStatistics stats;
+    stats.meanSpeed = accumulator.meanSpeed;
+    stats.maxSpeed = accumulator.maxSpeed;
+    stats.speedVariation = accumulator.speedStdDev();
+    stats.prevailingDirection = accumulator.prevailingDirection();
+    stats.directionVariation = accumulator.directionStdDev();
+    stats.gustFactor = accumulator.gustRatio();
+    stats.turbulenceIntensity = accumulator.turbulenceIntensity();
+    return stats;
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,409 @@
+#include "weather/terrain_tiles.h"
+#include "data/mapped_file.h"
+#include "data/text_import.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+using namespace data::text_import;
+
+const char MAGIC[8] = {'G', 'T', 'T', 'I', 'L', 'E', 'S', '\0'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint8_t NO_DATA = 0xFF;
+constexpr uint32_t MAX_TILE_SIZE = 4096;   // Cells per tile edge, for writing and reading
+constexpr int LAND_USE_CLASSES = static_cast<int>(LandUseType::UNKNOWN) + 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t tileSize;
+    uint32_t tileCount;
+    double cellDegrees;
+};
+static_assert(sizeof(FileHeader) == 32, "tile file header must stay 32 bytes");
+
+struct IndexEntry {
+    int32_t row;
+    int32_t col;
+};
+
+struct RawCell {
+    float elevation;
+    uint16_t roughness;     // Decimetres
+    uint8_t landUse;
+    uint8_t reserved;
+};
+static_assert(sizeof(RawCell) == 8, "tile cells must stay 8 bytes");
+
+uint64_t tileKey(int64_t row, int64_t col) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(col);
+}
+
+// Global cell containing a location; rows count north from the south pole
+void cellOf(double latitude, double longitude, double cellDegrees, int64_t& row, int64_t& col) {
+    row = static_cast<int64_t>(std::floor((latitude + 90.0) / cellDegrees));
+    col = static_cast<int64_t>(std::floor((longitude + 180.0) / cellDegrees));
+}
+
+enum class Column { Latitude, Longitude, Elevation, LandUse, Roughness, Ignored };
+
+Column columnFor(std::string_view name) {
+    std::string key;
+    for (char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (key == "latitude" || key == "lat") return Column::Latitude;
+    if (key == "longitude" || key == "lon" || key == "lng") return Column::Longitude;
+    if (key == "elevation" || key == "altitude" || key == "elev") return Column::Elevation;
+    if (key == "landuse" || key == "landcover") return Column::LandUse;
+    if (key == "roughness") return Column::Roughness;
+    return Column::Ignored;
+}
+
+bool parseDouble(std::string_view text, double& value) {
+    text = trim(text);
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && std::isfinite(value);
+}
+
+// Sums for one cell while sources are read
+struct CellSums {
+    double elevation = 0.0;
+    double roughness = 0.0;
+    uint32_t count = 0;
+    uint32_t roughnessCount = 0;
+    uint32_t landUseVotes[LAND_USE_CLASSES] = {};
+};
+
+} // namespace
+
+LandUseType parseLandUse(const std::string& text) {
+    std::string key;
+    for (char c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (!key.empty() && std::all_of(key.begin(), key.end(), [](char c) { return std::isdigit(c); })) {
+        int value = std::atoi(key.c_str());
+        return value >= 0 && value < LAND_USE_CLASSES ? static_cast<LandUseType>(value) : LandUseType::UNKNOWN;
+    }
+    if (key == "water" || key == "ocean" || key == "lake" || key == "river") return LandUseType::WATER;
+    if (key == "coastal" || key == "beach" || key == "coast") return LandUseType::COASTAL;
+    if (key == "grassland" || key == "grass" || key == "meadow" || key == "golfcourse") return LandUseType::GRASSLAND;
+    if (key == "forest" || key == "wood") return LandUseType::FOREST;
+    if (key == "suburban" || key == "residential") return LandUseType::SUBURBAN;
+    if (key == "urban" || key == "commercial") return LandUseType::URBAN;
+    if (key == "industrial") return LandUseType::INDUSTRIAL;
+    if (key == "mountain") return LandUseType::MOUNTAIN;
+    return LandUseType::UNKNOWN;
+}
+
+TerrainTileBuildReport buildTerrainTiles(const std::vector<std::string>& sources,
+                                         const std::string& outputPath,
+                                         const TerrainTileOptions& options) {
+    TerrainTileBuildReport report;
+    if (options.tileSize == 0 || options.tileSize > MAX_TILE_SIZE || !(options.cellDegrees > 0.0)) {
+        report.error = "Invalid tile options";
+        return report;
+    }
+
+    const int64_t tileSize = options.tileSize;
+    const size_t cellsPerTile = static_cast<size_t>(tileSize * tileSize);
+    std::unordered_map<uint64_t, std::vector<CellSums>> tiles;
+    bool anyRoughness = false;
+
+    std::vector<std::string_view> cells;
+    std::string scratch;
+    for (const auto& source : sources) {
+        std::ifstream in(source);
+        std::string line;
+        if (!in || !std::getline(in, line)) {
+            report.error = "Cannot read " + source;
+            return report;
+        }
+
+        std::vector<Column> columns;
+        splitCsvLine(line, ',', cells, scratch);
+        for (auto cell : cells) {
+            columns.push_back(columnFor(cell));
+        }
+        auto has = [&columns](Column column) {
+            return std::find(columns.begin(), columns.end(), column) != columns.end();
+        };
+        if (!has(Column::Latitude) || !has(Column::Longitude) || !has(Column::Elevation)) {
+            report.error = source + " needs latitude, longitude and elevation columns";
+            return report;
+        }
+        anyRoughness = anyRoughness || has(Column::Roughness);
+
+        while (std::getline(in, line)) {
+            if (isBlank(line)) continue;
+            report.pointsRead++;
+            splitCsvLine(line, ',', cells, scratch);
+
+            double latitude = NAN, longitude = NAN, elevation = NAN, roughness = NAN;
+            LandUseType landUse = LandUseType::UNKNOWN;
+            for (size_t i = 0; i < cells.size() && i < columns.size(); ++i) {
+                double value;
+                switch (columns[i]) {
+                    case Column::Latitude: if (parseDouble(cells[i], value)) latitude = value; break;
+                    case Column::Longitude: if (parseDouble(cells[i], value)) longitude = value; break;
+                    case Column::Elevation: if (parseDouble(cells[i], value)) elevation = value; break;
+                    case Column::Roughness: if (parseDouble(cells[i], value)) roughness = value; break;
+                    case Column::LandUse: landUse = parseLandUse(std::string(trim(cells[i]))); break;
+                    case Column::Ignored: break;
+                }
+            }
+            if (!(latitude >= -90.0 && latitude < 90.0) || !(longitude >= -180.0 && longitude < 180.0) ||
+                std::isnan(elevation)) {
+                report.pointsRejected++;
+                continue;
+            }
+
+            int64_t row, col;
+            cellOf(latitude, longitude, options.cellDegrees, row, col);
+            auto& tile = tiles[tileKey(row / tileSize, col / tileSize)];
+            if (tile.empty()) {
+                tile.resize(cellsPerTile);
+            }
+            CellSums& sums = tile[static_cast<size_t>((row % tileSize) * tileSize + col % tileSize)];
+            sums.elevation += elevation;
+            sums.count++;
+            sums.landUseVotes[static_cast<int>(landUse)]++;
+            if (!std::isnan(roughness)) {
+                sums.roughness += roughness;
+                sums.roughnessCount++;
+            }
+        }
+    }
+
+    // Mean elevation of a global cell, or NaN where no point fell
+    auto meanElevation = [&](int64_t row, int64_t col) {
+        auto tile = tiles.find(tileKey(row / tileSize, col / tileSize));
+        if (row < 0 || col < 0 || tile == tiles.end()) return static_cast<double>(NAN);
+        const CellSums& sums = tile->second[static_cast<size_t>((row % tileSize) * tileSize + col % tileSize)];
+        return sums.count ? sums.elevation / sums.count : static_cast<double>(NAN);
+    };
+
+    std::vector<IndexEntry> index;
+    index.reserve(tiles.size());
+    for (const auto& tile : tiles) {
+        index.push_back({static_cast<int32_t>(tile.first >> 32), static_cast<int32_t>(tile.first & 0xFFFFFFFFu)});
+    }
+    std::sort(index.begin(), index.end(), [](const IndexEntry& a, const IndexEntry& b) {
+        return a.row != b.row ? a.row < b.row : a.col < b.col;
+    });
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        report.error = "Cannot write " + outputPath;
+        return report;
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.tileSize = options.tileSize;
+    header.tileCount = static_cast<uint32_t>(index.size());
+    header.cellDegrees = options.cellDegrees;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+
+    std::vector<RawCell> raw(cellsPerTile);
+    for (const IndexEntry& entry : index) {
+        const auto& sums = tiles[tileKey(entry.row, entry.col)];
+        for (size_t i = 0; i < cellsPerTile; ++i) {
+            RawCell& cell = raw[i];
+            cell = RawCell{0.0f, 0, NO_DATA, 0};
+            if (sums[i].count == 0) continue;
+
+            const uint32_t* votes = sums[i].landUseVotes;
+            cell.landUse = static_cast<uint8_t>(std::max_element(votes, votes + LAND_USE_CLASSES) - votes);
+            cell.elevation = static_cast<float>(sums[i].elevation / sums[i].count);
+
+            double roughness = 0.0;
+            if (sums[i].roughnessCount) {
+                roughness = sums[i].roughness / sums[i].roughnessCount;
+            } else if (!anyRoughness) {
+                int64_t row = static_cast<int64_t>(entry.row) * tileSize + static_cast<int64_t>(i) / tileSize;
+                int64_t col = static_cast<int64_t>(entry.col) * tileSize + static_cast<int64_t>(i) % tileSize;
+                double low = cell.elevation, high = cell.elevation;
+                for (int64_t dr = -1; dr <= 1; ++dr) {
+                    for (int64_t dc = -1; dc <= 1; ++dc) {
+                        double neighbour = meanElevation(row + dr, col + dc);
+                        if (std::isnan(neighbour)) continue;
+                        low = std::min(low, neighbour);
+                        high = std::max(high, neighbour);
+                    }
+                }
+                roughness = high - low;
+            }
+            cell.roughness = static_cast<uint16_t>(std::clamp(std::lround(roughness * 10.0), 0L, 65535L));
+        }
+        out.write(reinterpret_cast<const char*>(raw.data()), raw.size() * sizeof(RawCell));
+    }
+
+    if (!out.flush()) {
+        report.error = "Failed writing " + outputPath;
+        return report;
+    }
+    report.tilesWritten = index.size();
+    report.success = true;
+    return report;
+}
+
+class TerrainTileStore::Impl {
+public:
+    using Tile = std::vector<std::optional<TerrainCell>>;
+
+    explicit Impl(size_t cacheTiles) : capacity(std::max<size_t>(cacheTiles, 1)) {}
+
+    std::shared_ptr<const Tile> decode(uint32_t slot) const {
+        const size_t cellsPerTile = static_cast<size_t>(header.tileSize) * header.tileSize;
+        const RawCell* raw = reinterpret_cast<const RawCell*>(
+            file.data() + dataOffset + slot * cellsPerTile * sizeof(RawCell));
+        auto tile = std::make_shared<Tile>(cellsPerTile);
+        for (size_t i = 0; i < cellsPerTile; ++i) {
+            if (raw[i].landUse == NO_DATA) continue;
+            LandUseType landUse = raw[i].landUse < LAND_USE_CLASSES
+                ? static_cast<LandUseType>(raw[i].landUse) : LandUseType::UNKNOWN;
+            (*tile)[i] = TerrainCell{raw[i].elevation, raw[i].roughness / 10.0, landUse};
+        }
+        return tile;
+    }
+
+    mutable std::mutex mutex;           // Guards the LRU and stats
+    data::MappedFile file;
+    FileHeader header{};
+    size_t dataOffset = 0;
+    std::unordered_map<uint64_t, uint32_t> slots;   // Tile key to position in the file
+
+    size_t capacity;
+    std::list<std::pair<uint64_t, std::shared_ptr<const Tile>>> recent;    // Most recent first
+    std::unordered_map<uint64_t, decltype(recent)::iterator> decoded;
+    TerrainTileStats stats;
+};
+
+TerrainTileStore::TerrainTileStore(size_t cacheTiles) : pImpl(new Impl(cacheTiles)) {}
+
+TerrainTileStore::~TerrainTileStore() {
+    close();
+}
+
+bool TerrainTileStore::open(const std::string& path) {
+    close();
+
+    data::MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) {
+        return false;
+    }
+    size_t size = file.size();
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.tileSize == 0 || header.tileSize > MAX_TILE_SIZE ||
+        !(header.cellDegrees > 0.0)) {
+        return false;
+    }
+
+    // Compare counts against what the file can hold, so that a corrupt
+    // header cannot overflow the offsets computed from it
+    size_t tileBytes = static_cast<size_t>(header.tileSize) * header.tileSize * sizeof(RawCell);
+    if (header.tileCount > (size - sizeof(FileHeader)) / (sizeof(IndexEntry) + tileBytes)) {
+        return false;
+    }
+    size_t dataOffset = sizeof(FileHeader) + static_cast<size_t>(header.tileCount) * sizeof(IndexEntry);
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->file = std::move(file);
+    pImpl->header = header;
+    pImpl->dataOffset = dataOffset;
+    const IndexEntry* index = reinterpret_cast<const IndexEntry*>(pImpl->file.data() + sizeof(FileHeader));
+    pImpl->slots.reserve(header.tileCount);
+    for (uint32_t slot = 0; slot < header.tileCount; ++slot) {
+        pImpl->slots.emplace(tileKey(index[slot].row, index[slot].col), slot);
+    }
+    pImpl->stats = TerrainTileStats();
+    pImpl->stats.tiles = header.tileCount;
+    return true;
+}
+
+void TerrainTileStore::close() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->file.close();
+    pImpl->slots.clear();
+    pImpl->recent.clear();
+    pImpl->decoded.clear();
+    pImpl->stats.tiles = 0;
+}
+
+bool TerrainTileStore::isOpen() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->file.isOpen();
+}
+
+std::optional<TerrainCell> TerrainTileStore::lookup(double latitude, double longitude) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->stats.lookups++;
+    if (!pImpl->file.isOpen() || !(latitude >= -90.0 && latitude < 90.0) || !(longitude >= -180.0 && longitude < 180.0)) {
+        return std::nullopt;
+    }
+
+    const int64_t tileSize = pImpl->header.tileSize;
+    int64_t row, col;
+    cellOf(latitude, longitude, pImpl->header.cellDegrees, row, col);
+    uint64_t key = tileKey(row / tileSize, col / tileSize);
+    size_t cell = static_cast<size_t>((row % tileSize) * tileSize + col % tileSize);
+
+    auto cached = pImpl->decoded.find(key);
+    if (cached != pImpl->decoded.end()) {
+        pImpl->stats.tileHits++;
+        pImpl->recent.splice(pImpl->recent.begin(), pImpl->recent, cached->second);
+        return (*cached->second->second)[cell];
+    }
+
+    auto slot = pImpl->slots.find(key);
+    if (slot == pImpl->slots.end()) {
+        return std::nullopt;
+    }
+    auto tile = pImpl->decode(slot->second);
+    pImpl->stats.tileDecodes++;
+    pImpl->recent.emplace_front(key, tile);
+    pImpl->decoded[key] = pImpl->recent.begin();
+    if (pImpl->recent.size() > pImpl->capacity) {
+        pImpl->decoded.erase(pImpl->recent.back().first);
+        pImpl->recent.pop_back();
+        pImpl->stats.evictions++;
+    }
+    return (*tile)[cell];
+}
+
+TerrainTileStats TerrainTileStore::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->stats;
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -1,45 +1,60 @@
 #include "weather/weather_api.h"
-#include <curl/curl.h>
 #include <nlohmann/json.hpp>
+#include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
-// Callback function to write API response
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-    userp->append((char*)contents, size * nmemb);
-    return size * nmemb;
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+const char* const DEFAULT_ENDPOINT = "https://api.tomorrow.io/v4/weather/realtime";
+const char* const DEFAULT_FORECAST_ENDPOINT = "https://api.tomorrow.io/v4/weather/forecast";
+
+// Location as sent to the provider; also the key that identical requests share
+std::string formatLocation(double latitude, double longitude) {
+    std::ostringstream location;
+    location << std::fixed << std::setprecision(6) << latitude << "," << longitude;
+    return location.str();
+}
+
+GeohashCacheConfig cacheConfig() {
+    GeohashCacheConfig config;
+    config.ttlSeconds = WeatherAPI::MAX_CACHE_AGE_MINUTES * 60;
+    return config;
 }
 
+} // namespace
+
 class WeatherAPI::Impl {
 public:
-    Impl() : curl(nullptr) {
-        curl = curl_easy_init();
-    }
+    Impl() : endpoint(DEFAULT_ENDPOINT), forecastEndpoint(DEFAULT_FORECAST_ENDPOINT), cache(cacheConfig()) {}
 
+    // Completion callbacks use the members below, so fail outstanding
+    // requests while those are all still alive
     ~Impl() {
-        if (curl) curl_easy_cleanup(curl);
+        fetcher.stop();
     }
 
-    bool fetch(const std::string& apiKey, double lat, double lon, std::string& response) {
-        if (!curl) return false;
-
-        std::stringstream url;
-        url << "https://api.tomorrow.io/v4/weather/realtime"
-            << "?location=" << lat << "," << lon
-            << "&apikey=" << apiKey
-            << "&units=metric";
-
-        curl_easy_setopt(curl, CURLOPT_URL, url.str().c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    struct Forecast {
+        std::shared_ptr<const ForecastTimeline> timeline;
+        std::time_t fetchedAt;
+    };
 
-        CURLcode res = curl_easy_perform(curl);
-        return (res == CURLE_OK);
-    }
+    std::mutex mutex;                   // Guards everything up to cache
+    std::string endpoint;
+    std::string forecastEndpoint;
+    std::unordered_map<std::string, std::shared_future<std::optional<WeatherData>>> inFlight;
+    std::unordered_map<std::string, Forecast> forecasts;   // By geohash cell
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const ForecastTimeline>>> forecastsInFlight;
+    FetchStats stats;
+    GeohashWeatherCache cache;          // Latest reading per geohash cell; has its own locks
 
-private:
-    CURL* curl;
+    WeatherFetcher fetcher;
 };
 
 WeatherAPI::WeatherAPI(WeatherStorage& weatherStorage)
@@ -65,16 +80,39 @@ bool WeatherAPI::isOfflineMode() const {
     return offlineMode;
 }
 
+void WeatherAPI::setEndpoint(const std::string& url) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->endpoint = url;
+}
+
+void WeatherAPI::setForecastEndpoint(const std::string& url) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->forecastEndpoint = url;
+}
+
 bool WeatherAPI::getCurrentWeather(double latitude, double longitude, WeatherData& data) {
     if (!initialized) {
         if (errorCallback) errorCallback("API not initialized");
         return false;
     }
 
-    // Try to get data from storage first
-    if (storage.hasRecentData(latitude, longitude, MAX_CACHE_AGE_MINUTES)) {
-        auto storedData = storage.getWeatherData(latitude, longitude);
+    // Serve cached or stored data while it is within MAX_CACHE_AGE_MINUTES,
+    // refreshing it in the background once it passes REFRESH_AHEAD_MINUTES
+    auto storedData = pImpl->cache.get(latitude, longitude);
+    if (!storedData) {
+        storedData = storage.getWeatherData(latitude, longitude);
         if (storedData) {
+            pImpl->cache.put(latitude, longitude, *storedData);
+        }
+    }
+    if (storedData) {
+        std::time_t age = std::time(nullptr) - storedData->timestamp;
+        if (age < MAX_CACHE_AGE_MINUTES * 60) {
+            if (!offlineMode && age >= REFRESH_AHEAD_MINUTES * 60) {
+                fetchCurrentWeatherAsync(latitude, longitude);
+                std::lock_guard<std::mutex> lock(pImpl->mutex);
+                pImpl->stats.staleServed++;
+            }
             data = *storedData;
             return true;
         }
@@ -85,18 +123,174 @@ bool WeatherAPI::getCurrentWeather(double latitude, double longitude, WeatherDat
         return getOfflineWeather(latitude, longitude, data);
     }
 
-    // Fetch new data from API
-    if (!fetchFromAPI(latitude, longitude, data)) {
+    // Fetch new data from API; the fetch stores it
+    auto fetched = fetchCurrentWeatherAsync(latitude, longitude).get();
+    if (!fetched) {
         // If API fetch fails, fall back to offline data
         if (errorCallback) errorCallback("API request failed, falling back to offline data");
         return getOfflineWeather(latitude, longitude, data);
     }
 
-    // Store the new data
-    storage.storeWeatherData(latitude, longitude, data);
+    data = *fetched;
+    return true;
+}
+
+std::shared_future<std::optional<WeatherData>> WeatherAPI::fetchCurrentWeatherAsync(double latitude, double longitude) {
+    if (!initialized || offlineMode) {
+        std::promise<std::optional<WeatherData>> unavailable;
+        unavailable.set_value(std::nullopt);
+        return unavailable.get_future().share();
+    }
+
+    std::string location = formatLocation(latitude, longitude);
+    std::shared_ptr<std::promise<std::optional<WeatherData>>> promise;
+    std::shared_future<std::optional<WeatherData>> result;
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        auto existing = pImpl->inFlight.find(location);
+        if (existing != pImpl->inFlight.end()) {
+            pImpl->stats.coalesced++;
+            return existing->second;
+        }
+        promise = std::make_shared<std::promise<std::optional<WeatherData>>>();
+        result = promise->get_future().share();
+        pImpl->inFlight.emplace(location, result);
+        pImpl->stats.requests++;
+
+        url = pImpl->endpoint
+            + "?location=" + location
+            + "&apikey=" + apiKey
+            + "&units=metric";
+    }
+
+    // Callbacks can run while this object is being destroyed, so they hold
+    // Impl and the storage directly rather than this
+    Impl* impl = pImpl.get();
+    WeatherStorage& store = storage;
+    impl->fetcher.get(url, [impl, &store, promise, location, latitude, longitude](const HttpResponse& response) {
+        std::optional<WeatherData> fetched;
+        WeatherData data{};
+        if (response.ok && parseWeatherResponse(response.body, data)) {
+            store.storeWeatherData(latitude, longitude, data);
+            impl->cache.put(latitude, longitude, data);
+            fetched = data;
+        }
+
+        // Leave the in-flight table before waking waiters, so a request made after
+        // this one completes starts a new fetch rather than joining a finished one
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            impl->inFlight.erase(location);
+        }
+        promise->set_value(fetched);
+    });
+
+    return result;
+}
+
+bool WeatherAPI::getForecastWeather(double latitude, double longitude, std::time_t time, WeatherData& data) {
+    if (!initialized) {
+        if (errorCallback) errorCallback("API not initialized");
+        return false;
+    }
+
+    std::string cell = encodeGeohash(latitude, longitude, cacheConfig().precision);
+    std::shared_ptr<const ForecastTimeline> timeline;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        auto cached = pImpl->forecasts.find(cell);
+        if (cached != pImpl->forecasts.end() &&
+            std::time(nullptr) - cached->second.fetchedAt < FORECAST_MAX_AGE_MINUTES * 60) {
+            timeline = cached->second.timeline;
+            pImpl->stats.forecastHits++;
+        }
+    }
+    if (!timeline) {
+        timeline = fetchForecastAsync(latitude, longitude).get();
+    }
+
+    std::optional<WeatherData> forecast = timeline ? timeline->at(time) : std::nullopt;
+    if (!forecast) {
+        if (errorCallback) errorCallback("No forecast available for the requested time");
+        return false;
+    }
+    data = *forecast;
     return true;
 }
 
+std::shared_future<std::shared_ptr<const ForecastTimeline>> WeatherAPI::fetchForecastAsync(double latitude,
+                                                                                           double longitude) {
+    if (!initialized || offlineMode) {
+        std::promise<std::shared_ptr<const ForecastTimeline>> unavailable;
+        unavailable.set_value(nullptr);
+        return unavailable.get_future().share();
+    }
+
+    std::string cell = encodeGeohash(latitude, longitude, cacheConfig().precision);
+    std::shared_ptr<std::promise<std::shared_ptr<const ForecastTimeline>>> promise;
+    std::shared_future<std::shared_ptr<const ForecastTimeline>> result;
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        auto existing = pImpl->forecastsInFlight.find(cell);
+        if (existing != pImpl->forecastsInFlight.end()) {
+            pImpl->stats.coalesced++;
+            return existing->second;
+        }
+        promise = std::make_shared<std::promise<std::shared_ptr<const ForecastTimeline>>>();
+        result = promise->get_future().share();
+        pImpl->forecastsInFlight.emplace(cell, result);
+        pImpl->stats.forecastRequests++;
+
+        url = pImpl->forecastEndpoint
+            + "?location=" + formatLocation(latitude, longitude)
+            + "&apikey=" + apiKey
+            + "&units=metric&timesteps=1h";
+    }
+
+    Impl* impl = pImpl.get();
+    impl->fetcher.get(url, [impl, promise, cell](const HttpResponse& response) {
+        std::shared_ptr<const ForecastTimeline> timeline;
+        if (response.ok) {
+            if (auto parsed = ForecastTimeline::parse(response.body)) {
+                timeline = std::make_shared<const ForecastTimeline>(std::move(*parsed));
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            if (timeline) {
+                // Drop expired forecasts so cells no longer queried do not accumulate
+                std::time_t now = std::time(nullptr);
+                for (auto it = impl->forecasts.begin(); it != impl->forecasts.end();) {
+                    if (now - it->second.fetchedAt >= FORECAST_MAX_AGE_MINUTES * 60) {
+                        it = impl->forecasts.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                impl->forecasts[cell] = {timeline, now};
+            }
+            impl->forecastsInFlight.erase(cell);
+        }
+        promise->set_value(timeline);
+    });
+
+    return result;
+}
+
+WeatherAPI::FetchStats WeatherAPI::getFetchStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    FetchStats stats = pImpl->stats;
+    stats.transport = pImpl->fetcher.getStats();
+    return stats;
+}
+
+GeohashCacheStats WeatherAPI::getCacheStats() const {
+    return pImpl->cache.getStats();
+}
+
 bool WeatherAPI::getOfflineWeather(double latitude, double longitude, WeatherData& data) {
     // Try to get nearest recent data
     auto nearestData = storage.getNearestWeatherData(latitude, longitude, MAX_DISTANCE_KM);
@@ -116,24 +310,6 @@ bool WeatherAPI::getOfflineWeather(double latitude, double longitude, WeatherDat
     return false;
 }
 
-bool WeatherAPI::fetchFromAPI(double latitude, double longitude, WeatherData& data) {
-    std::string response;
-    if (!pImpl->fetch(apiKey, latitude, longitude, response)) {
-        return false;
-    }
-
-    try {
-        if (!parseWeatherResponse(response, data)) {
-            return false;
-        }
-        return true;
-    }
-    catch (const std::exception& e) {
-        if (errorCallback) errorCallback(std::string("Error processing weather data: ") + e.what());
-        return false;
-    }
-}
-
 bool WeatherAPI::parseWeatherResponse(const std::string& response, WeatherData& data) {
     try {
         json j = json::parse(response);
@@ -161,3 +337,6 @@ void WeatherAPI::setErrorCallback(std::function<void(const std::string&)> callba
 bool WeatherAPI::isInitialized() const {
     return initialized;
 }
+
+} // namespace weather
+} // namespace gptgolf
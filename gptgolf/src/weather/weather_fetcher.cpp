@@ -0,0 +1,172 @@
+#include "weather/weather_fetcher.h"
+#include <curl/curl.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+std::once_flag curlGlobalInit;
+
+// One request handed to curl, reached from its easy handle through CURLOPT_PRIVATE
+struct Transfer {
+    WeatherFetcher::Callback onComplete;
+    HttpResponse response;
+    char error[CURL_ERROR_SIZE] = {};
+};
+
+size_t writeBody(char* data, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(data, size * nmemb);
+    return size * nmemb;
+}
+
+} // namespace
+
+WeatherFetcher::WeatherFetcher(const WeatherFetcherConfig& config)
+    : config_(config)
+    , multi_(nullptr)
+    , stopping_(false) {
+    std::call_once(curlGlobalInit, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+    multi_ = curl_multi_init();
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, config_.maxHostConnections);
+    worker_ = std::thread(&WeatherFetcher::run, this);
+}
+
+WeatherFetcher::~WeatherFetcher() {
+    stop();
+    curl_multi_cleanup(multi_);
+}
+
+void WeatherFetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    curl_multi_wakeup(multi_);
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void WeatherFetcher::get(const std::string& url, Callback onComplete) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            queued_.push_back(Request{url, std::move(onComplete)});
+            onComplete = nullptr;
+        }
+    }
+    if (onComplete) {
+        HttpResponse stopped;
+        stopped.error = "fetcher stopped";
+        onComplete(stopped);
+        return;
+    }
+    curl_multi_wakeup(multi_);
+}
+
+WeatherFetcherStats WeatherFetcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void WeatherFetcher::run() {
+    std::vector<CURL*> idle;                                    // Finished handles kept for reuse
+    std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+
+    while (true) {
+        std::deque<Request> incoming;
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming.swap(queued_);
+            stopping = stopping_;
+        }
+        if (stopping) {
+            HttpResponse stopped;
+            stopped.error = "fetcher stopped";
+            for (auto& entry : active) {
+                curl_multi_remove_handle(multi_, entry.first);
+                curl_easy_cleanup(entry.first);
+                entry.second->onComplete(stopped);
+            }
+            for (Request& request : incoming) {
+                request.onComplete(stopped);
+            }
+            break;
+        }
+
+        for (Request& request : incoming) {
+            CURL* easy;
+            if (idle.empty()) {
+                easy = curl_easy_init();
+            } else {
+                // A reset handle keeps its DNS cache; connections live in the multi handle
+                easy = idle.back();
+                idle.pop_back();
+                curl_easy_reset(easy);
+            }
+            auto transfer = std::make_unique<Transfer>();
+            transfer->onComplete = std::move(request.onComplete);
+            curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeBody);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->response.body);
+            curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->error);
+            curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+            curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, config_.timeoutMs);
+            curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, config_.connectTimeoutMs);
+            curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+            curl_multi_add_handle(multi_, easy);
+            active.emplace(easy, std::move(transfer));
+        }
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+
+        int pending = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi_, &pending)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL* easy = message->easy_handle;
+            auto it = active.find(easy);
+            std::unique_ptr<Transfer> transfer = std::move(it->second);
+            active.erase(it);
+
+            HttpResponse& response = transfer->response;
+            long connects = 0;
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &response.status);
+            curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+            if (message->data.result != CURLE_OK) {
+                response.error = transfer->error[0] ? transfer->error : curl_easy_strerror(message->data.result);
+            } else if (response.status < 200 || response.status >= 300) {
+                response.error = "HTTP status " + std::to_string(response.status);
+            } else {
+                response.ok = true;
+            }
+            curl_multi_remove_handle(multi_, easy);
+            idle.push_back(easy);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.transfers++;
+                stats_.connectionsOpened += connects;
+                stats_.failures += response.ok ? 0 : 1;
+            }
+            transfer->onComplete(response);
+        }
+
+        curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+
+    for (CURL* easy : idle) {
+        curl_easy_cleanup(easy);
+    }
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,330 @@
+#include "weather/weather_history_loader.h"
+#include "data/mapped_file.h"
+#include "data/text_import.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <nlohmann/json.hpp>
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+using namespace data::text_import;
+using Clock = std::chrono::steady_clock;
+
+// History columns the loader understands
+enum class Field {
+    Latitude, Longitude, Timestamp, Temperature, Humidity, Pressure,
+    WindSpeed, WindDirection, Precipitation, Altitude, Ignored
+};
+
+// Column names, lowercased with everything but letters and digits removed
+Field fieldFor(std::string_view name) {
+    std::string key;
+    for (char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (key == "latitude" || key == "lat") return Field::Latitude;
+    if (key == "longitude" || key == "lon" || key == "lng") return Field::Longitude;
+    if (key == "timestamp" || key == "time" || key == "date" || key == "datetime") return Field::Timestamp;
+    if (key == "temperature" || key == "temp") return Field::Temperature;
+    if (key == "humidity") return Field::Humidity;
+    if (key == "pressure" || key == "pressuresealevel") return Field::Pressure;
+    if (key == "windspeed") return Field::WindSpeed;
+    if (key == "winddirection") return Field::WindDirection;
+    if (key == "precipitation" || key == "precipitationintensity") return Field::Precipitation;
+    if (key == "altitude" || key == "elevation") return Field::Altitude;
+    return Field::Ignored;
+}
+
+bool parseDouble(std::string_view text, double& value) {
+    text = trim(text);
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Fields of one row as they are read; location, time and temperature are required
+struct Row {
+    WeatherObservation observation{};
+    bool hasLatitude = false;
+    bool hasLongitude = false;
+    bool hasTimestamp = false;
+    bool hasTemperature = false;
+
+    Row() {
+        observation.data.pressure = 1013.25;    // Standard atmosphere when not recorded
+    }
+
+    void set(Field field, double value) {
+        WeatherData& data = observation.data;
+        switch (field) {
+            case Field::Latitude: observation.latitude = value; hasLatitude = true; break;
+            case Field::Longitude: observation.longitude = value; hasLongitude = true; break;
+            case Field::Timestamp: data.timestamp = static_cast<std::time_t>(value); hasTimestamp = true; break;
+            case Field::Temperature: data.temperature = value; hasTemperature = true; break;
+            case Field::Humidity: data.humidity = value; break;
+            case Field::Pressure: data.pressure = value; break;
+            case Field::WindSpeed: data.windSpeed = value; break;
+            case Field::WindDirection: data.windDirection = value; break;
+            case Field::Precipitation: data.precipitation = value; break;
+            case Field::Altitude: data.altitude = value; break;
+            case Field::Ignored: break;
+        }
+    }
+
+    void setText(Field field, std::string_view text) {
+        if (field == Field::Timestamp) {
+            std::time_t timestamp = parseTimestamp(text, -1);
+            if (timestamp != -1) {
+                observation.data.timestamp = timestamp;
+                hasTimestamp = true;
+            }
+            return;
+        }
+        double value;
+        if (parseDouble(text, value)) {
+            set(field, value);
+        }
+    }
+
+    bool valid() const {
+        return hasLatitude && hasLongitude && hasTimestamp && hasTemperature &&
+               observation.latitude >= -90.0 && observation.latitude <= 90.0 &&
+               observation.longitude >= -180.0 && observation.longitude <= 180.0 &&
+               observation.data.isValid();
+    }
+};
+
+using LocationMonth = std::tuple<double, double, int>;
+
+// One parse task's output
+struct ChunkResult {
+    std::vector<WeatherObservation> observations;
+    std::map<LocationMonth, TypicalWeatherSums> climatology;
+    size_t rowsRead = 0;
+    size_t rowsRejected = 0;
+};
+
+void acceptRow(const Row& row, bool climatology, ChunkResult& result) {
+    ++result.rowsRead;
+    if (!row.valid()) {
+        ++result.rowsRejected;
+        return;
+    }
+    const WeatherObservation& observation = row.observation;
+    if (climatology) {
+        LocationMonth key(observation.latitude, observation.longitude,
+                          monthFromTimestamp(observation.data.timestamp));
+        result.climatology[key].add(observation.data);
+    }
+    result.observations.push_back(observation);
+}
+
+void parseCsvChunk(const char* begin, const char* end, const std::vector<Field>& columns, char delimiter,
+                   bool climatology, ChunkResult& result) {
+    std::vector<std::string_view> cells;
+    std::string scratch;
+    const char* cursor = begin;
+    while (cursor < end) {
+        std::string_view line = nextLine(cursor, end);
+        if (isBlank(line)) {
+            continue;
+        }
+        splitCsvLine(line, delimiter, cells, scratch);
+
+        Row row;
+        for (size_t i = 0; i < cells.size() && i < columns.size(); ++i) {
+            if (columns[i] != Field::Ignored) {
+                row.setText(columns[i], cells[i]);
+            }
+        }
+        acceptRow(row, climatology, result);
+    }
+}
+
+void parseNdjsonChunk(const char* begin, const char* end, bool climatology, ChunkResult& result) {
+    const char* cursor = begin;
+    while (cursor < end) {
+        std::string_view line = nextLine(cursor, end);
+        if (isBlank(line)) {
+            continue;
+        }
+        nlohmann::json object = nlohmann::json::parse(line.begin(), line.end(), nullptr, false);
+        Row row;
+        if (object.is_object()) {
+            for (const auto& item : object.items()) {
+                Field field = fieldFor(item.key());
+                const auto& value = item.value();
+                if (field == Field::Ignored) {
+                    continue;
+                }
+                if (value.is_number()) {
+                    row.set(field, value.get<double>());
+                } else if (value.is_string()) {
+                    row.setText(field, value.get_ref<const std::string&>());
+                }
+            }
+        }
+        acceptRow(row, climatology, result);
+    }
+}
+
+} // namespace
+
+WeatherHistoryLoader::WeatherHistoryLoader(WeatherStorage& storage, const HistoryLoadOptions& options)
+    : storage_(storage)
+    , options_(options) {
+    if (options_.threads == 0) {
+        options_.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunkBytes = std::max<size_t>(options_.chunkBytes, 4096);
+}
+
+std::vector<WeatherObservation> WeatherHistoryLoader::parse(const char* data, size_t size,
+                                                            HistoryLoadReport& report,
+                                                            std::vector<TypicalWeatherRow>* climatology) const {
+    auto started = Clock::now();
+    const char* end = data + size;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        data += 3;
+    }
+
+    HistoryFormat format = options_.format;
+    if (format == HistoryFormat::Auto) {
+        const char* first = data;
+        while (first < end && std::isspace(static_cast<unsigned char>(*first))) ++first;
+        format = (first < end && *first == '{') ? HistoryFormat::Ndjson : HistoryFormat::Csv;
+    }
+
+    const char* cursor = data;
+    std::vector<Field> columns;
+    char delimiter = ',';
+    if (format == HistoryFormat::Csv) {
+        std::string_view header;
+        while (cursor < end && isBlank(header)) {
+            header = nextLine(cursor, end);
+        }
+        delimiter = (header.find(',') == std::string_view::npos &&
+                     header.find(';') != std::string_view::npos) ? ';' : ',';
+
+        std::vector<std::string_view> cells;
+        std::string scratch;
+        splitCsvLine(header, delimiter, cells, scratch);
+        for (auto cell : cells) {
+            columns.push_back(fieldFor(cell));
+        }
+        for (Field required : {Field::Latitude, Field::Longitude, Field::Timestamp, Field::Temperature}) {
+            if (std::find(columns.begin(), columns.end(), required) == columns.end()) {
+                report.error = "History file needs latitude, longitude, timestamp and temperature columns";
+                report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+                return {};
+            }
+        }
+    }
+
+    // Cut the body at line ends; every record is one line in both formats
+    std::vector<const char*> bounds{cursor};
+    while (bounds.back() < end) {
+        const char* next = bounds.back() + std::min<size_t>(options_.chunkBytes, end - bounds.back());
+        const char* newline = next < end ? static_cast<const char*>(std::memchr(next, '\n', end - next)) : nullptr;
+        bounds.push_back(newline ? newline + 1 : end);
+    }
+
+    bool sums = climatology != nullptr;
+    std::vector<ChunkResult> results(bounds.size() - 1);
+    runParallel(results.size(), options_.threads, [&](size_t i) {
+        if (format == HistoryFormat::Csv) {
+            parseCsvChunk(bounds[i], bounds[i + 1], columns, delimiter, sums, results[i]);
+        } else {
+            parseNdjsonChunk(bounds[i], bounds[i + 1], sums, results[i]);
+        }
+    });
+
+    std::vector<WeatherObservation> observations;
+    size_t accepted = 0;
+    for (const auto& result : results) {
+        accepted += result.observations.size();
+    }
+    observations.reserve(accepted);
+    std::map<LocationMonth, TypicalWeatherSums> merged;
+    for (auto& result : results) {
+        report.rowsRead += result.rowsRead;
+        report.rowsRejected += result.rowsRejected;
+        observations.insert(observations.end(), result.observations.begin(), result.observations.end());
+        for (const auto& entry : result.climatology) {
+            merged[entry.first].merge(entry.second);
+        }
+        result = ChunkResult();
+    }
+
+    if (climatology) {
+        climatology->clear();
+        climatology->reserve(merged.size());
+        for (const auto& entry : merged) {
+            climatology->push_back(TypicalWeatherRow{std::get<0>(entry.first), std::get<1>(entry.first),
+                                                     std::get<2>(entry.first), entry.second.mean(),
+                                                     entry.second});
+        }
+    }
+
+    report.success = true;
+    report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    return observations;
+}
+
+HistoryLoadReport WeatherHistoryLoader::loadFile(const std::string& path) {
+    HistoryLoadReport report;
+    auto started = Clock::now();
+    data::MappedFile file;
+    if (!file.open(path)) {
+        report.error = "Cannot open history file: " + path;
+        return report;
+    }
+    if (file.size() == 0) {
+        report.success = true;
+        return report;
+    }
+    // Parse tasks scan their chunk front to back once
+    file.adviseSequential();
+
+    std::vector<TypicalWeatherRow> climatology;
+    std::vector<WeatherObservation> observations =
+        parse(file.data(), file.size(), report,
+              options_.buildClimatology ? &climatology : nullptr);
+    file.close();
+    report.parseSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    if (!report.success) {
+        return report;
+    }
+
+    started = Clock::now();
+    report.rowsLoaded = storage_.bulkStoreWeatherData(observations, options_.transactionRows);
+    if (report.rowsLoaded == observations.size()) {
+        report.climatologyRows = storage_.bulkStoreTypicalWeather(climatology);
+    }
+    report.insertSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    if (report.rowsLoaded != observations.size()) {
+        report.success = false;
+        report.error = "Insert stopped after " + std::to_string(report.rowsLoaded) + " rows";
+    } else if (report.climatologyRows != climatology.size()) {
+        report.success = false;
+        report.error = "Typical weather rows could not be written";
+    }
+    return report;
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,164 @@
+#include "weather/weather_retention.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t INITIAL_ROWS_PER_STEP = 256;
+constexpr size_t MIN_ROWS_PER_STEP = 16;
+constexpr int INITIAL_PAGES_PER_STEP = 64;
+
+// Size the next step from this step's cost per unit, growing at most
+// twofold so one cheap step cannot overshoot the budget
+std::int64_t nextStep(std::int64_t step, std::chrono::microseconds held, std::chrono::microseconds budget) {
+    std::int64_t target = step * 2;
+    if (held.count() > 0) {
+        target = std::min(target, step * budget.count() / held.count());
+    }
+    return target;
+}
+
+} // namespace
+
+WeatherRetention::WeatherRetention(WeatherStorage& storage, const RetentionOptions& options, bool background)
+    : storage_(storage)
+    , options_(options)
+    , stopping_(false) {
+    progress_.rowsPerStep = INITIAL_ROWS_PER_STEP;
+    progress_.incrementalVacuum = storage_.incrementalVacuumEnabled();
+    if (background) {
+        worker_ = std::thread(&WeatherRetention::run, this);
+    }
+}
+
+WeatherRetention::~WeatherRetention() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+size_t WeatherRetention::runPass(std::time_t now) {
+    std::lock_guard<std::mutex> pass(passMutex_);
+    size_t rowsPerStep;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isActiveHour(now)) {
+            progress_.skippedPasses++;
+            return 0;
+        }
+        rowsPerStep = progress_.rowsPerStep;
+    }
+
+    auto record = [this](std::chrono::microseconds held) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.steps++;
+        progress_.longestStep = std::max(progress_.longestStep, held);
+    };
+
+    // Oldest observations first, each step its own transaction
+    std::time_t olderThan = now - static_cast<std::time_t>(options_.maxAge.count());
+    size_t deleted = 0;
+    bool more = true;
+    while (more && deleted < options_.maxRowsPerPass) {
+        size_t batch = std::min(rowsPerStep, options_.maxRowsPerPass - deleted);
+        auto start = Clock::now();
+        size_t removed = storage_.deleteObservationsBefore(olderThan, batch);
+        auto held = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        record(held);
+        deleted += removed;
+        more = removed == batch;
+
+        if (removed == batch && batch == rowsPerStep) {
+            rowsPerStep = std::max<std::int64_t>(MIN_ROWS_PER_STEP,
+                nextStep(static_cast<std::int64_t>(batch), held, options_.stepBudget));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.rowsDeleted += removed;
+            progress_.rowsPerStep = rowsPerStep;
+        }
+        if (more && !pause()) {
+            return deleted;
+        }
+    }
+
+    // Then hand the freed pages back, within the page budget
+    bool incrementalVacuum = storage_.incrementalVacuumEnabled();
+    int pagesPerStep = INITIAL_PAGES_PER_STEP;
+    int released = 0;
+    more = incrementalVacuum;
+    while (more && released < options_.maxPagesPerPass) {
+        int step = std::min(pagesPerStep, options_.maxPagesPerPass - released);
+        auto start = Clock::now();
+        int freed = storage_.releaseFreePages(step);
+        auto held = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        record(held);
+        released += freed;
+        more = freed == step;
+
+        pagesPerStep = static_cast<int>(std::max<std::int64_t>(1, nextStep(step, held, options_.stepBudget)));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.pagesReleased += freed;
+        }
+        if (more && !pause()) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    progress_.passes++;
+    progress_.incrementalVacuum = incrementalVacuum;
+    return deleted;
+}
+
+RetentionProgress WeatherRetention::progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_;
+}
+
+void WeatherRetention::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, options_.passInterval, [this] { return stopping_; })) {
+        lock.unlock();
+        runPass();
+        lock.lock();
+    }
+}
+
+bool WeatherRetention::isActiveHour(std::time_t now) const {
+    if (options_.activeFromHour <= 0 && options_.activeUntilHour >= 24) {
+        return true;
+    }
+    // std::localtime shares one buffer across threads
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    int hour = local.tm_hour;
+    if (options_.activeFromHour <= options_.activeUntilHour) {
+        return hour >= options_.activeFromHour && hour < options_.activeUntilHour;
+    }
+    // A window such as 22 to 6 wraps past midnight
+    return hour >= options_.activeFromHour || hour < options_.activeUntilHour;
+}
+
+bool WeatherRetention::pause() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !wake_.wait_for(lock, options_.stepInterval, [this] { return stopping_; });
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -1,21 +1,131 @@
 #include "weather/weather_storage.h"
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <vector>
 #include <iomanip>
+#include <mutex>
 #include <sqlite3.h>
+#include "data/statement_cache.h"
 
 namespace gptgolf {
 namespace weather {
 
+namespace {
+
+const char* const INSERT_WEATHER_SQL = R"(
+    INSERT OR REPLACE INTO weather_data 
+    (latitude, longitude, temperature, humidity, pressure, wind_speed, 
+     wind_direction, precipitation, altitude, timestamp)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+)";
+
+const char* const INSERT_TYPICAL_SQL = R"(
+    INSERT OR REPLACE INTO typical_weather 
+    (latitude, longitude, month, temperature, humidity, pressure, 
+     wind_speed, wind_direction, precipitation, altitude)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+)";
+
+void bindWeatherRow(sqlite3_stmt* stmt, double latitude, double longitude, const WeatherData& data) {
+    sqlite3_bind_double(stmt, 1, latitude);
+    sqlite3_bind_double(stmt, 2, longitude);
+    sqlite3_bind_double(stmt, 3, data.temperature);
+    sqlite3_bind_double(stmt, 4, data.humidity);
+    sqlite3_bind_double(stmt, 5, data.pressure);
+    sqlite3_bind_double(stmt, 6, data.windSpeed);
+    sqlite3_bind_double(stmt, 7, data.windDirection);
+    sqlite3_bind_double(stmt, 8, data.precipitation);
+    sqlite3_bind_double(stmt, 9, data.altitude);
+    sqlite3_bind_int64(stmt, 10, data.timestamp);
+}
+
+const char* const SELECT_TYPICAL_SUMS_SQL = R"(
+    SELECT count, temperature_sum, humidity_sum, pressure_sum, wind_speed_sum,
+           direction_sin_sum, direction_cos_sum, precipitation_sum, altitude_sum
+    FROM typical_weather_sums
+    WHERE latitude = ? AND longitude = ? AND month = ?;
+)";
+
+void bindTypicalRow(sqlite3_stmt* stmt, double latitude, double longitude, int month,
+                    const WeatherData& data) {
+    sqlite3_bind_double(stmt, 1, latitude);
+    sqlite3_bind_double(stmt, 2, longitude);
+    sqlite3_bind_int(stmt, 3, month);
+    sqlite3_bind_double(stmt, 4, data.temperature);
+    sqlite3_bind_double(stmt, 5, data.humidity);
+    sqlite3_bind_double(stmt, 6, data.pressure);
+    sqlite3_bind_double(stmt, 7, data.windSpeed);
+    sqlite3_bind_double(stmt, 8, data.windDirection);
+    sqlite3_bind_double(stmt, 9, data.precipitation);
+    sqlite3_bind_double(stmt, 10, data.altitude);
+}
+
+// Wind direction in degrees as a unit vector, for summing in triggers; SQLite's
+// own math functions are optional at build time
+void directionSin(sqlite3_context* context, int, sqlite3_value** argv) {
+    sqlite3_result_double(context, std::sin(sqlite3_value_double(argv[0]) * M_PI / 180.0));
+}
+
+void directionCos(sqlite3_context* context, int, sqlite3_value** argv) {
+    sqlite3_result_double(context, std::cos(sqlite3_value_double(argv[0]) * M_PI / 180.0));
+}
+
+} // namespace
+
+void TypicalWeatherSums::add(const WeatherData& data) {
+    double radians = data.windDirection * M_PI / 180.0;
+    ++count;
+    temperature += data.temperature;
+    humidity += data.humidity;
+    pressure += data.pressure;
+    windSpeed += data.windSpeed;
+    directionSin += std::sin(radians);
+    directionCos += std::cos(radians);
+    precipitation += data.precipitation;
+    altitude += data.altitude;
+}
+
+void TypicalWeatherSums::merge(const TypicalWeatherSums& other) {
+    count += other.count;
+    temperature += other.temperature;
+    humidity += other.humidity;
+    pressure += other.pressure;
+    windSpeed += other.windSpeed;
+    directionSin += other.directionSin;
+    directionCos += other.directionCos;
+    precipitation += other.precipitation;
+    altitude += other.altitude;
+}
+
+WeatherData TypicalWeatherSums::mean() const {
+    WeatherData data{};
+    if (count == 0) return data;
+    double n = static_cast<double>(count);
+    data.temperature = temperature / n;
+    data.humidity = humidity / n;
+    data.pressure = pressure / n;
+    data.windSpeed = windSpeed / n;
+    // Averaged as a unit vector so that 350° and 10° average to 0°
+    double direction = std::atan2(directionSin, directionCos) * 180.0 / M_PI;
+    data.windDirection = direction < 0.0 ? direction + 360.0 : direction;
+    data.precipitation = precipitation / n;
+    data.altitude = altitude / n;
+    data.timestamp = 0;
+    return data;
+}
+
 class WeatherStorage::Impl {
 public:
-    Impl() : db(nullptr) {}
+    Impl() : db(nullptr), statements(std::make_unique<data::StatementCache>(nullptr)) {}
     ~Impl() {
+        statements.reset();
         if (db) sqlite3_close(db);
     }
 
     sqlite3* db;
+    std::mutex mutex;                                   // Serializes use of db and statements
+    std::unique_ptr<data::StatementCache> statements;   // Prepared statements on db
 };
 
 WeatherStorage::WeatherStorage() : pImpl(new Impl()) {}
@@ -26,6 +136,14 @@ bool WeatherStorage::initialize(const std::string& dbPath) {
     if (rc) {
         return false;
     }
+    pImpl->statements = std::make_unique<data::StatementCache>(pImpl->db);
+
+    // The climatology triggers call these on every weather_data insert
+    int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+    if (sqlite3_create_function(pImpl->db, "direction_sin", 1, flags, nullptr, directionSin, nullptr, nullptr) ||
+        sqlite3_create_function(pImpl->db, "direction_cos", 1, flags, nullptr, directionCos, nullptr, nullptr)) {
+        return false;
+    }
     return initializeTables();
 }
 
@@ -59,6 +177,26 @@ bool WeatherStorage::initializeTables() {
             PRIMARY KEY (latitude, longitude, month)
         );
 
+        -- Sums of every observation written to weather_data per location and
+        -- UTC month, kept by the triggers below. Loads recompute typical_weather
+        -- from them, so each load adds to the climatology instead of replacing
+        -- it. Retention deletes observations but not their sums.
+        CREATE TABLE IF NOT EXISTS typical_weather_sums (
+            latitude REAL,
+            longitude REAL,
+            month INTEGER,
+            count INTEGER,
+            temperature_sum REAL,
+            humidity_sum REAL,
+            pressure_sum REAL,
+            wind_speed_sum REAL,
+            direction_sin_sum REAL,
+            direction_cos_sum REAL,
+            precipitation_sum REAL,
+            altitude_sum REAL,
+            PRIMARY KEY (latitude, longitude, month)
+        ) WITHOUT ROWID;
+
         CREATE TABLE IF NOT EXISTS wind_patterns (
             latitude REAL,
             longitude REAL,
@@ -72,6 +210,25 @@ bool WeatherStorage::initializeTables() {
             PRIMARY KEY (latitude, longitude, timestamp)
         );
 
+        -- Running wind statistics per location and UTC hour of day, one
+        -- row each, updated with every wind_patterns insert
+        CREATE TABLE IF NOT EXISTS wind_pattern_stats (
+            latitude REAL,
+            longitude REAL,
+            hour_of_day INTEGER,
+            count INTEGER,
+            mean_speed REAL,
+            m2_speed REAL,
+            sum_sin REAL,
+            sum_cos REAL,
+            max_speed REAL,
+            mean_gust REAL,
+            mean_temperature REAL,
+            mean_pressure REAL,
+            last_timestamp INTEGER,
+            PRIMARY KEY (latitude, longitude, hour_of_day)
+        ) WITHOUT ROWID;
+
         CREATE TABLE IF NOT EXISTS terrain_data (
             latitude REAL,
             longitude REAL,
@@ -95,43 +252,337 @@ bool WeatherStorage::initializeTables() {
 
         CREATE INDEX IF NOT EXISTS idx_weather_timestamp 
         ON weather_data(timestamp);
+
+        -- Bounding boxes of weather_data rows by rowid, for nearest-location lookups.
+        -- Time is a third dimension so recency is filtered inside the index.
+        CREATE VIRTUAL TABLE IF NOT EXISTS weather_location_rtree USING rtree(
+            id, min_lat, max_lat, min_lon, max_lon, min_time, max_time
+        );
+
+        -- Nearest lookups only consider the last hour, so rows observed more
+        -- than a day before they are written (historical loads) are not indexed
+        DROP TRIGGER IF EXISTS weather_data_rtree_insert;
+        CREATE TRIGGER IF NOT EXISTS weather_data_rtree_insert_recent
+        AFTER INSERT ON weather_data
+        WHEN new.timestamp > CAST(strftime('%s', 'now') AS INTEGER) - 86400 BEGIN
+            INSERT INTO weather_location_rtree VALUES (
+                new.rowid, new.latitude, new.latitude,
+                new.longitude, new.longitude, new.timestamp, new.timestamp);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS weather_data_rtree_delete
+        AFTER DELETE ON weather_data BEGIN
+            DELETE FROM weather_location_rtree WHERE id = old.rowid;
+        END;
+
+        -- Running sums of weather_data per location, UTC month and 10-degree
+        -- wind direction bin, so historical statistics never scan raw rows
+        CREATE TABLE IF NOT EXISTS weather_monthly_rollup (
+            latitude REAL,
+            longitude REAL,
+            month INTEGER,
+            direction_bin INTEGER,
+            count INTEGER,
+            temperature_sum REAL,
+            humidity_sum REAL,
+            pressure_sum REAL,
+            wind_speed_sum REAL,
+            PRIMARY KEY (latitude, longitude, month, direction_bin)
+        ) WITHOUT ROWID;
+
+        CREATE TRIGGER IF NOT EXISTS weather_data_rollup_insert
+        AFTER INSERT ON weather_data BEGIN
+            INSERT INTO weather_monthly_rollup VALUES (
+                new.latitude, new.longitude,
+                CAST(strftime('%m', new.timestamp, 'unixepoch') AS INTEGER),
+                CAST(new.wind_direction / 10 AS INTEGER) % 36,
+                1, new.temperature, new.humidity, new.pressure, new.wind_speed)
+            ON CONFLICT (latitude, longitude, month, direction_bin) DO UPDATE SET
+                count = count + 1,
+                temperature_sum = temperature_sum + excluded.temperature_sum,
+                humidity_sum = humidity_sum + excluded.humidity_sum,
+                pressure_sum = pressure_sum + excluded.pressure_sum,
+                wind_speed_sum = wind_speed_sum + excluded.wind_speed_sum;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS weather_data_rollup_delete
+        AFTER DELETE ON weather_data BEGIN
+            UPDATE weather_monthly_rollup SET
+                count = count - 1,
+                temperature_sum = temperature_sum - old.temperature,
+                humidity_sum = humidity_sum - old.humidity,
+                pressure_sum = pressure_sum - old.pressure,
+                wind_speed_sum = wind_speed_sum - old.wind_speed
+            WHERE latitude = old.latitude AND longitude = old.longitude
+            AND month = CAST(strftime('%m', old.timestamp, 'unixepoch') AS INTEGER)
+            AND direction_bin = CAST(old.wind_direction / 10 AS INTEGER) % 36;
+            DELETE FROM weather_monthly_rollup
+            WHERE latitude = old.latitude AND longitude = old.longitude AND count <= 0;
+        END;
+
+        -- An observation replaced by INSERT OR REPLACE leaves the sums before
+        -- its successor is added, so reloading a file counts it once
+        CREATE TRIGGER IF NOT EXISTS weather_data_climatology_replace
+        BEFORE INSERT ON weather_data BEGIN
+            UPDATE typical_weather_sums SET
+                (count, temperature_sum, humidity_sum, pressure_sum, wind_speed_sum,
+                 direction_sin_sum, direction_cos_sum, precipitation_sum, altitude_sum) = (
+                SELECT typical_weather_sums.count - 1,
+                       typical_weather_sums.temperature_sum - w.temperature,
+                       typical_weather_sums.humidity_sum - w.humidity,
+                       typical_weather_sums.pressure_sum - w.pressure,
+                       typical_weather_sums.wind_speed_sum - w.wind_speed,
+                       typical_weather_sums.direction_sin_sum - direction_sin(w.wind_direction),
+                       typical_weather_sums.direction_cos_sum - direction_cos(w.wind_direction),
+                       typical_weather_sums.precipitation_sum - w.precipitation,
+                       typical_weather_sums.altitude_sum - w.altitude
+                FROM weather_data w
+                WHERE w.latitude = new.latitude AND w.longitude = new.longitude
+                AND w.timestamp = new.timestamp)
+            WHERE latitude = new.latitude AND longitude = new.longitude
+            AND month = CAST(strftime('%m', new.timestamp, 'unixepoch') AS INTEGER)
+            AND EXISTS (SELECT 1 FROM weather_data w
+                        WHERE w.latitude = new.latitude AND w.longitude = new.longitude
+                        AND w.timestamp = new.timestamp);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS weather_data_climatology_insert
+        AFTER INSERT ON weather_data BEGIN
+            INSERT INTO typical_weather_sums VALUES (
+                new.latitude, new.longitude,
+                CAST(strftime('%m', new.timestamp, 'unixepoch') AS INTEGER),
+                1, new.temperature, new.humidity, new.pressure, new.wind_speed,
+                direction_sin(new.wind_direction), direction_cos(new.wind_direction),
+                new.precipitation, new.altitude)
+            ON CONFLICT (latitude, longitude, month) DO UPDATE SET
+                count = count + 1,
+                temperature_sum = temperature_sum + excluded.temperature_sum,
+                humidity_sum = humidity_sum + excluded.humidity_sum,
+                pressure_sum = pressure_sum + excluded.pressure_sum,
+                wind_speed_sum = wind_speed_sum + excluded.wind_speed_sum,
+                direction_sin_sum = direction_sin_sum + excluded.direction_sin_sum,
+                direction_cos_sum = direction_cos_sum + excluded.direction_cos_sum,
+                precipitation_sum = precipitation_sum + excluded.precipitation_sum,
+                altitude_sum = altitude_sum + excluded.altitude_sum;
+        END;
     )";
 
+    // INSERT OR REPLACE only fires the delete trigger for the replaced row
+    // when recursive triggers are on. Incremental auto-vacuum lets retention
+    // return freed pages a few at a time; it only takes effect on files
+    // created here, older ones need enableIncrementalVacuum.
     char* errMsg = nullptr;
-    int rc = sqlite3_exec(pImpl->db, sql, nullptr, nullptr, &errMsg);
+    int rc = sqlite3_exec(pImpl->db, "PRAGMA auto_vacuum = INCREMENTAL; PRAGMA recursive_triggers = ON;",
+                          nullptr, nullptr, &errMsg);
     if (rc != SQLITE_OK) {
         sqlite3_free(errMsg);
         return false;
     }
+
+    bool hadIndex = tableExists("weather_location_rtree");
+    bool hadRollup = tableExists("weather_monthly_rollup");
+    bool hadClimatologySums = tableExists("typical_weather_sums");
+    bool hadWindStats = tableExists("wind_pattern_stats");
+    rc = sqlite3_exec(pImpl->db, sql, nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    if (!hadIndex) {
+        // Index rows written before the spatial index existed
+        const char* backfill = R"(
+            INSERT INTO weather_location_rtree
+            SELECT rowid, latitude, latitude, longitude, longitude, timestamp, timestamp
+            FROM weather_data
+            WHERE timestamp > CAST(strftime('%s', 'now') AS INTEGER) - 86400;
+        )";
+        rc = sqlite3_exec(pImpl->db, backfill, nullptr, nullptr, &errMsg);
+        if (rc != SQLITE_OK) {
+            sqlite3_free(errMsg);
+            return false;
+        }
+    }
+
+    if (!hadRollup) {
+        // Summarize rows written before the rollup existed
+        const char* backfill = R"(
+            INSERT INTO weather_monthly_rollup
+            SELECT latitude, longitude,
+                   CAST(strftime('%m', timestamp, 'unixepoch') AS INTEGER) AS month,
+                   CAST(wind_direction / 10 AS INTEGER) % 36 AS direction_bin,
+                   COUNT(*), SUM(temperature), SUM(humidity), SUM(pressure), SUM(wind_speed)
+            FROM weather_data
+            GROUP BY latitude, longitude, month, direction_bin;
+        )";
+        rc = sqlite3_exec(pImpl->db, backfill, nullptr, nullptr, &errMsg);
+        if (rc != SQLITE_OK) {
+            sqlite3_free(errMsg);
+            return false;
+        }
+    }
+
+    if (!hadClimatologySums) {
+        // Sum the observations written before the climatology triggers existed
+        const char* backfill = R"(
+            INSERT INTO typical_weather_sums
+            SELECT latitude, longitude,
+                   CAST(strftime('%m', timestamp, 'unixepoch') AS INTEGER) AS month,
+                   COUNT(*), SUM(temperature), SUM(humidity), SUM(pressure), SUM(wind_speed),
+                   SUM(direction_sin(wind_direction)), SUM(direction_cos(wind_direction)),
+                   SUM(precipitation), SUM(altitude)
+            FROM weather_data
+            GROUP BY latitude, longitude, month;
+        )";
+        rc = sqlite3_exec(pImpl->db, backfill, nullptr, nullptr, &errMsg);
+        if (rc != SQLITE_OK) {
+            sqlite3_free(errMsg);
+            return false;
+        }
+    }
+
+    if (!hadWindStats) {
+        return backfillWindStats();
+    }
     return true;
 }
 
-bool WeatherStorage::storeWeatherData(double latitude, double longitude, const WeatherData& data) {
+bool WeatherStorage::backfillWindStats() {
+    // One pass over patterns stored before the statistics table existed
     const char* sql = R"(
-        INSERT OR REPLACE INTO weather_data 
-        (latitude, longitude, temperature, humidity, pressure, wind_speed, 
-         wind_direction, precipitation, altitude, timestamp)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+        SELECT latitude, longitude, hour_of_day, speed, direction, gust_speed,
+               temperature, pressure, timestamp
+        FROM wind_patterns
+        ORDER BY latitude, longitude, hour_of_day;
     )";
-
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return false;
+    if (sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    if (sqlite3_exec(pImpl->db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    bool ok = true;
+    bool pending = false;
+    double latitude = 0.0, longitude = 0.0;
+    int hour = 0;
+    WindAccumulator accumulator;
+    int rc;
+    while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        double rowLatitude = sqlite3_column_double(stmt, 0);
+        double rowLongitude = sqlite3_column_double(stmt, 1);
+        int rowHour = sqlite3_column_int(stmt, 2);
+        if (pending && (rowLatitude != latitude || rowLongitude != longitude || rowHour != hour)) {
+            ok = writeWindAccumulator(latitude, longitude, hour, accumulator);
+            accumulator = WindAccumulator();
+        }
+        latitude = rowLatitude;
+        longitude = rowLongitude;
+        hour = rowHour;
+        pending = true;
+
+        WindPattern pattern;
+        pattern.speed = sqlite3_column_double(stmt, 3);
+        pattern.direction = sqlite3_column_double(stmt, 4);
+        pattern.gustSpeed = sqlite3_column_double(stmt, 5);
+        pattern.temperature = sqlite3_column_double(stmt, 6);
+        pattern.pressure = sqlite3_column_double(stmt, 7);
+        pattern.timestamp = sqlite3_column_int64(stmt, 8);
+        accumulator.add(pattern);
+    }
+    sqlite3_finalize(stmt);
+    ok = ok && rc == SQLITE_DONE;
+    if (ok && pending) {
+        ok = writeWindAccumulator(latitude, longitude, hour, accumulator);
+    }
+
+    if (!ok || sqlite3_exec(pImpl->db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_exec(pImpl->db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+bool WeatherStorage::writeWindAccumulator(double latitude, double longitude, int hourOfDay,
+                                          const WindAccumulator& accumulator) {
+    const char* sql = R"(
+        INSERT OR REPLACE INTO wind_pattern_stats
+        (latitude, longitude, hour_of_day, count, mean_speed, m2_speed, sum_sin, sum_cos,
+         max_speed, mean_gust, mean_temperature, mean_pressure, last_timestamp)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )";
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return false;
 
     sqlite3_bind_double(stmt, 1, latitude);
     sqlite3_bind_double(stmt, 2, longitude);
-    sqlite3_bind_double(stmt, 3, data.temperature);
-    sqlite3_bind_double(stmt, 4, data.humidity);
-    sqlite3_bind_double(stmt, 5, data.pressure);
-    sqlite3_bind_double(stmt, 6, data.windSpeed);
-    sqlite3_bind_double(stmt, 7, data.windDirection);
-    sqlite3_bind_double(stmt, 8, data.precipitation);
-    sqlite3_bind_double(stmt, 9, data.altitude);
-    sqlite3_bind_int64(stmt, 10, data.timestamp);
+    sqlite3_bind_int(stmt, 3, hourOfDay);
+    sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(accumulator.count));
+    sqlite3_bind_double(stmt, 5, accumulator.meanSpeed);
+    sqlite3_bind_double(stmt, 6, accumulator.m2Speed);
+    sqlite3_bind_double(stmt, 7, accumulator.sumSin);
+    sqlite3_bind_double(stmt, 8, accumulator.sumCos);
+    sqlite3_bind_double(stmt, 9, accumulator.maxSpeed);
+    sqlite3_bind_double(stmt, 10, accumulator.meanGust);
+    sqlite3_bind_double(stmt, 11, accumulator.meanTemperature);
+    sqlite3_bind_double(stmt, 12, accumulator.meanPressure);
+    sqlite3_bind_int64(stmt, 13, accumulator.lastTimestamp);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
 
-    rc = sqlite3_step(stmt);
+bool WeatherStorage::tableExists(const std::string& name) {
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT 1 FROM sqlite_master WHERE name = ?;";
+    if (sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
     sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    return exists;
+}
+
+bool WeatherStorage::storeWeatherData(double latitude, double longitude, const WeatherData& data) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, INSERT_WEATHER_SQL);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return false;
+
+    bindWeatherRow(stmt, latitude, longitude, data);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+size_t WeatherStorage::bulkStoreWeatherData(const std::vector<WeatherObservation>& rows,
+                                            size_t transactionRows) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, INSERT_WEATHER_SQL);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return 0;
+    transactionRows = std::max<size_t>(transactionRows, 1);
+
+    size_t committed = 0;
+    while (committed < rows.size()) {
+        size_t end = std::min(rows.size(), committed + transactionRows);
+        if (sqlite3_exec(pImpl->db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            break;
+        }
+
+        bool ok = true;
+        for (size_t i = committed; ok && i < end; ++i) {
+            bindWeatherRow(stmt, rows[i].latitude, rows[i].longitude, rows[i].data);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+        if (!ok || sqlite3_exec(pImpl->db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            sqlite3_exec(pImpl->db, "ROLLBACK", nullptr, nullptr, nullptr);
+            break;
+        }
+        committed = end;
+    }
+    return committed;
 }
 
 std::optional<WeatherData> WeatherStorage::getWeatherData(double latitude, double longitude) {
@@ -141,9 +592,10 @@ std::optional<WeatherData> WeatherStorage::getWeatherData(double latitude, doubl
         ORDER BY timestamp DESC LIMIT 1;
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return std::nullopt;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return std::nullopt;
 
     sqlite3_bind_double(stmt, 1, latitude);
     sqlite3_bind_double(stmt, 2, longitude);
@@ -158,11 +610,9 @@ std::optional<WeatherData> WeatherStorage::getWeatherData(double latitude, doubl
         data.precipitation = sqlite3_column_double(stmt, 7);
         data.altitude = sqlite3_column_double(stmt, 8);
         data.timestamp = sqlite3_column_int64(stmt, 9);
-        sqlite3_finalize(stmt);
         return data;
     }
 
-    sqlite3_finalize(stmt);
     return std::nullopt;
 }
 
@@ -173,9 +623,10 @@ bool WeatherStorage::hasRecentData(double latitude, double longitude, int maxAge
         AND timestamp > ? LIMIT 1;
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return false;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return false;
 
     std::time_t cutoff = std::time(nullptr) - (maxAgeMinutes * 60);
     sqlite3_bind_double(stmt, 1, latitude);
@@ -187,7 +638,6 @@ bool WeatherStorage::hasRecentData(double latitude, double longitude, int maxAge
         hasRecent = sqlite3_column_int(stmt, 0) > 0;
     }
 
-    sqlite3_finalize(stmt);
     return hasRecent;
 }
 
@@ -203,34 +653,53 @@ double WeatherStorage::calculateDistance(double lat1, double lon1, double lat2,
 }
 
 std::optional<WeatherData> WeatherStorage::getNearestWeatherData(double latitude, double longitude, double maxDistanceKm) {
+    // The R*Tree narrows the search to recent rows inside a bounding box around
+    // the location; exact haversine distance then picks the nearest of those
     const char* sql = R"(
-        SELECT *, (
-            6371 * acos(
-                cos(radians(?)) * cos(radians(latitude)) *
-                cos(radians(longitude) - radians(?)) +
-                sin(radians(?)) * sin(radians(latitude))
-            )
-        ) as distance
-        FROM weather_data
-        WHERE timestamp > ?
-        HAVING distance < ?
-        ORDER BY distance, timestamp DESC
-        LIMIT 1;
+        SELECT w.latitude, w.longitude, w.temperature, w.humidity, w.pressure,
+               w.wind_speed, w.wind_direction, w.precipitation, w.altitude, w.timestamp
+        FROM weather_location_rtree r
+        JOIN weather_data w ON w.rowid = r.id
+        WHERE r.max_lat >= ? AND r.min_lat <= ?
+        AND r.max_lon >= ? AND r.min_lon <= ?
+        AND r.max_time >= ?
+        AND w.timestamp > ?;
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return std::nullopt;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return std::nullopt;
+
+    // One degree of latitude is about 111.2 km; a degree of longitude shrinks
+    // with cos(latitude). Boxes are not split at the antimeridian.
+    const double kmPerDegree = 111.195;
+    double latSpan = maxDistanceKm / kmPerDegree;
+    double lonScale = std::cos(latitude * M_PI / 180.0);
+    double lonSpan = lonScale > 1e-6 ? std::min(maxDistanceKm / (kmPerDegree * lonScale), 180.0) : 180.0;
 
     std::time_t cutoff = std::time(nullptr) - 3600; // Last hour
-    sqlite3_bind_double(stmt, 1, latitude);
-    sqlite3_bind_double(stmt, 2, longitude);
-    sqlite3_bind_double(stmt, 3, latitude);
-    sqlite3_bind_int64(stmt, 4, cutoff);
-    sqlite3_bind_double(stmt, 5, maxDistanceKm);
+    sqlite3_bind_double(stmt, 1, latitude - latSpan);
+    sqlite3_bind_double(stmt, 2, latitude + latSpan);
+    sqlite3_bind_double(stmt, 3, longitude - lonSpan);
+    sqlite3_bind_double(stmt, 4, longitude + lonSpan);
+    sqlite3_bind_int64(stmt, 5, cutoff);
+    sqlite3_bind_int64(stmt, 6, cutoff);
 
-    WeatherData data;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
+    std::optional<WeatherData> nearest;
+    double nearestDistance = maxDistanceKm;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        double distance = calculateDistance(latitude, longitude,
+                                            sqlite3_column_double(stmt, 0),
+                                            sqlite3_column_double(stmt, 1));
+        std::time_t timestamp = sqlite3_column_int64(stmt, 9);
+        bool closer = distance < nearestDistance;
+        bool newerAtSameDistance = nearest && distance == nearestDistance && timestamp > nearest->timestamp;
+        if (!closer && !newerAtSameDistance) {
+            continue;
+        }
+
+        WeatherData data;
         data.temperature = sqlite3_column_double(stmt, 2);
         data.humidity = sqlite3_column_double(stmt, 3);
         data.pressure = sqlite3_column_double(stmt, 4);
@@ -238,54 +707,151 @@ std::optional<WeatherData> WeatherStorage::getNearestWeatherData(double latitude
         data.windDirection = sqlite3_column_double(stmt, 6);
         data.precipitation = sqlite3_column_double(stmt, 7);
         data.altitude = sqlite3_column_double(stmt, 8);
-        data.timestamp = sqlite3_column_int64(stmt, 9);
-        sqlite3_finalize(stmt);
-        return data;
+        data.timestamp = timestamp;
+        nearest = data;
+        nearestDistance = distance;
     }
 
-    sqlite3_finalize(stmt);
-    return std::nullopt;
+    return nearest;
 }
 
 void WeatherStorage::clearOldData(std::time_t olderThan) {
-    const char* sql = "DELETE FROM weather_data WHERE timestamp < ?;";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return;
+    // Short transactions let writers in between batches
+    while (deleteObservationsBefore(olderThan, CLEAR_BATCH_ROWS) == CLEAR_BATCH_ROWS) {
+    }
+    while (releaseFreePages(CLEAR_BATCH_PAGES) == CLEAR_BATCH_PAGES) {
+    }
+}
+
+size_t WeatherStorage::deleteObservationsBefore(std::time_t olderThan, size_t maxRows) {
+    // Oldest first through idx_weather_timestamp, so each batch is one
+    // contiguous run of the index
+    const char* sql = R"(
+        DELETE FROM weather_data WHERE rowid IN (
+            SELECT rowid FROM weather_data WHERE timestamp < ?
+            ORDER BY timestamp LIMIT ?
+        );
+    )";
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt || maxRows == 0) return 0;
 
     sqlite3_bind_int64(stmt, 1, olderThan);
-    sqlite3_step(stmt);
+    sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(maxRows));
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        return 0;
+    }
+    // Only rows of weather_data itself; trigger changes are not counted
+    return static_cast<size_t>(sqlite3_changes(pImpl->db));
+}
+
+int WeatherStorage::releaseFreePages(int maxPages) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (!pImpl->db || maxPages <= 0) return 0;
+
+    int before = pragmaInt("freelist_count");
+    std::string sql = "PRAGMA incremental_vacuum(" + std::to_string(maxPages) + ");";
+    if (sqlite3_exec(pImpl->db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return 0;
+    }
+    return std::max(0, before - pragmaInt("freelist_count"));
+}
+
+int WeatherStorage::freePageCount() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->db ? pragmaInt("freelist_count") : 0;
+}
+
+bool WeatherStorage::incrementalVacuumEnabled() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->db && pragmaInt("auto_vacuum") == 2;   // 2 is INCREMENTAL
+}
+
+bool WeatherStorage::enableIncrementalVacuum() {
+    if (incrementalVacuumEnabled()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (!pImpl->db) return false;
+    return sqlite3_exec(pImpl->db, "PRAGMA auto_vacuum = INCREMENTAL; VACUUM;",
+                        nullptr, nullptr, nullptr) == SQLITE_OK &&
+           pragmaInt("auto_vacuum") == 2;
+}
+
+int WeatherStorage::pragmaInt(const char* name) {
+    std::string sql = std::string("PRAGMA ") + name + ";";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(pImpl->db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return 0;
+    }
+    int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
     sqlite3_finalize(stmt);
+    return value;
 }
 
 bool WeatherStorage::storeTypicalWeather(double latitude, double longitude, 
                                        int month, const WeatherData& data) {
-    const char* sql = R"(
-        INSERT OR REPLACE INTO typical_weather 
-        (latitude, longitude, month, temperature, humidity, pressure, 
-         wind_speed, wind_direction, precipitation, altitude)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-    )";
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, INSERT_TYPICAL_SQL);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return false;
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return false;
+    bindTypicalRow(stmt, latitude, longitude, month, data);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
 
-    sqlite3_bind_double(stmt, 1, latitude);
-    sqlite3_bind_double(stmt, 2, longitude);
-    sqlite3_bind_int(stmt, 3, month);
-    sqlite3_bind_double(stmt, 4, data.temperature);
-    sqlite3_bind_double(stmt, 5, data.humidity);
-    sqlite3_bind_double(stmt, 6, data.pressure);
-    sqlite3_bind_double(stmt, 7, data.windSpeed);
-    sqlite3_bind_double(stmt, 8, data.windDirection);
-    sqlite3_bind_double(stmt, 9, data.precipitation);
-    sqlite3_bind_double(stmt, 10, data.altitude);
+size_t WeatherStorage::bulkStoreTypicalWeather(const std::vector<TypicalWeatherRow>& rows) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement insert(*pImpl->statements, INSERT_TYPICAL_SQL);
+    data::CachedStatement selectSums(*pImpl->statements, SELECT_TYPICAL_SUMS_SQL);
+    sqlite3_stmt* stmt = insert.get();
+    if (!stmt || !selectSums.get() || rows.empty()) return 0;
+    if (sqlite3_exec(pImpl->db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return 0;
+    }
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE;
+    bool ok = true;
+    for (size_t i = 0; ok && i < rows.size(); ++i) {
+        const TypicalWeatherRow& row = rows[i];
+        WeatherData typical = row.data;
+        if (row.sums.count > 0) {
+            ok = readTypicalSums(selectSums.get(), row, typical);
+        }
+        if (ok) {
+            bindTypicalRow(stmt, row.latitude, row.longitude, row.month, typical);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+        }
+    }
+    if (!ok || sqlite3_exec(pImpl->db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_exec(pImpl->db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return 0;
+    }
+    return rows.size();
+}
+
+bool WeatherStorage::readTypicalSums(sqlite3_stmt* select, const TypicalWeatherRow& row, WeatherData& typical) {
+    sqlite3_bind_double(select, 1, row.latitude);
+    sqlite3_bind_double(select, 2, row.longitude);
+    sqlite3_bind_int(select, 3, row.month);
+    bool ok = sqlite3_step(select) == SQLITE_ROW;
+    if (ok) {
+        TypicalWeatherSums stored;
+        stored.count = static_cast<uint64_t>(sqlite3_column_int64(select, 0));
+        stored.temperature = sqlite3_column_double(select, 1);
+        stored.humidity = sqlite3_column_double(select, 2);
+        stored.pressure = sqlite3_column_double(select, 3);
+        stored.windSpeed = sqlite3_column_double(select, 4);
+        stored.directionSin = sqlite3_column_double(select, 5);
+        stored.directionCos = sqlite3_column_double(select, 6);
+        stored.precipitation = sqlite3_column_double(select, 7);
+        stored.altitude = sqlite3_column_double(select, 8);
+        typical = stored.mean();
+    }
+    sqlite3_reset(select);
+    return ok;
 }
 
 std::optional<WeatherData> WeatherStorage::getTypicalWeather(double latitude, double longitude) {
@@ -295,9 +861,10 @@ std::optional<WeatherData> WeatherStorage::getTypicalWeather(double latitude, do
         AND month = ?;
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return std::nullopt;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return std::nullopt;
 
     // Get current month (1-12)
     std::time_t now = std::time(nullptr);
@@ -318,79 +885,196 @@ std::optional<WeatherData> WeatherStorage::getTypicalWeather(double latitude, do
         data.precipitation = sqlite3_column_double(stmt, 8);
         data.altitude = sqlite3_column_double(stmt, 9);
         data.timestamp = now;
-        sqlite3_finalize(stmt);
         return data;
     }
 
-    sqlite3_finalize(stmt);
     return std::nullopt;
 }
 
 std::optional<WeatherStorage::WeatherStats> WeatherStorage::getHistoricalStats(
     double latitude, double longitude, int month) {
+    // At most one rollup row per direction bin, read through the primary key
     const char* sql = R"(
-        SELECT 
-            AVG(temperature) as avg_temp,
-            AVG(humidity) as avg_hum,
-            AVG(pressure) as avg_press,
-            AVG(wind_speed) as avg_wind
-        FROM weather_data 
-        WHERE latitude = ? AND longitude = ?
-        AND strftime('%m', datetime(timestamp, 'unixepoch')) = ?;
+        SELECT direction_bin, count, temperature_sum, humidity_sum, pressure_sum, wind_speed_sum
+        FROM weather_monthly_rollup
+        WHERE latitude = ? AND longitude = ? AND month = ?;
     )";
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(pImpl->db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return std::nullopt;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return std::nullopt;
 
-    std::stringstream monthStr;
-    monthStr << std::setw(2) << std::setfill('0') << month;
-    
     sqlite3_bind_double(stmt, 1, latitude);
     sqlite3_bind_double(stmt, 2, longitude);
-    sqlite3_bind_text(stmt, 3, monthStr.str().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, month);
 
     WeatherStats stats;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        stats.avgTemperature = sqlite3_column_double(stmt, 0);
-        stats.avgHumidity = sqlite3_column_double(stmt, 1);
-        stats.avgPressure = sqlite3_column_double(stmt, 2);
-        stats.avgWindSpeed = sqlite3_column_double(stmt, 3);
-        
-        // Initialize wind direction frequency bins
-        stats.windDirectionFrequency.resize(36, 0.0); // 36 bins of 10 degrees each
-        sqlite3_finalize(stmt);
-        
-        // Get wind direction distribution in separate query
-        const char* windSql = R"(
-            SELECT wind_direction, COUNT(*) as freq
-            FROM weather_data
-            WHERE latitude = ? AND longitude = ?
-            AND strftime('%m', datetime(timestamp, 'unixepoch')) = ?
-            GROUP BY CAST((wind_direction / 10) AS INT);
-        )";
-        
-        rc = sqlite3_prepare_v2(pImpl->db, windSql, -1, &stmt, nullptr);
-        if (rc != SQLITE_OK) return stats;
-        
-        sqlite3_bind_double(stmt, 1, latitude);
-        sqlite3_bind_double(stmt, 2, longitude);
-        sqlite3_bind_text(stmt, 3, monthStr.str().c_str(), -1, SQLITE_STATIC);
-        
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            double direction = sqlite3_column_double(stmt, 0);
-            int freq = sqlite3_column_int(stmt, 1);
-            int bin = static_cast<int>(direction / 10.0) % 36;
-            stats.windDirectionFrequency[bin] = freq;
+    stats.windDirectionFrequency.resize(36, 0.0); // 36 bins of 10 degrees each
+    sqlite3_int64 count = 0;
+    double temperature = 0.0, humidity = 0.0, pressure = 0.0, windSpeed = 0.0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int bin = sqlite3_column_int(stmt, 0);
+        sqlite3_int64 binCount = sqlite3_column_int64(stmt, 1);
+        if (bin >= 0 && bin < 36) {
+            stats.windDirectionFrequency[bin] = static_cast<double>(binCount);
         }
-        
-        sqlite3_finalize(stmt);
-        return stats;
+        count += binCount;
+        temperature += sqlite3_column_double(stmt, 2);
+        humidity += sqlite3_column_double(stmt, 3);
+        pressure += sqlite3_column_double(stmt, 4);
+        windSpeed += sqlite3_column_double(stmt, 5);
     }
 
-    sqlite3_finalize(stmt);
+    if (count == 0) {
+        return std::nullopt;
+    }
+    stats.avgTemperature = temperature / count;
+    stats.avgHumidity = humidity / count;
+    stats.avgPressure = pressure / count;
+    stats.avgWindSpeed = windSpeed / count;
+    return stats;
+}
+
+namespace {
+
+const char* const SELECT_WIND_STATS_SQL = R"(
+    SELECT hour_of_day, count, mean_speed, m2_speed, sum_sin, sum_cos, max_speed,
+           mean_gust, mean_temperature, mean_pressure, last_timestamp
+    FROM wind_pattern_stats
+    WHERE latitude = ? AND longitude = ?
+)";
+
+WindAccumulator readWindAccumulator(sqlite3_stmt* stmt) {
+    WindAccumulator accumulator;
+    accumulator.count = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 1));
+    accumulator.meanSpeed = sqlite3_column_double(stmt, 2);
+    accumulator.m2Speed = sqlite3_column_double(stmt, 3);
+    accumulator.sumSin = sqlite3_column_double(stmt, 4);
+    accumulator.sumCos = sqlite3_column_double(stmt, 5);
+    accumulator.maxSpeed = sqlite3_column_double(stmt, 6);
+    accumulator.meanGust = sqlite3_column_double(stmt, 7);
+    accumulator.meanTemperature = sqlite3_column_double(stmt, 8);
+    accumulator.meanPressure = sqlite3_column_double(stmt, 9);
+    accumulator.lastTimestamp = sqlite3_column_int64(stmt, 10);
+    return accumulator;
+}
+
+int utcHourOfDay(std::time_t timestamp) {
+    return static_cast<int>(((timestamp % 86400) + 86400) % 86400 / 3600);
+}
+
+} // namespace
+
+bool WeatherStorage::storeWindPattern(double latitude, double longitude, const WindPattern& pattern) {
+    const char* insertSql = R"(
+        INSERT OR IGNORE INTO wind_patterns
+        (latitude, longitude, speed, direction, gust_speed, temperature, pressure,
+         timestamp, hour_of_day)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )";
+    const std::string selectSql = std::string(SELECT_WIND_STATS_SQL) + " AND hour_of_day = ?;";
+    int hour = utcHourOfDay(pattern.timestamp);
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (sqlite3_exec(pImpl->db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+    }
+
+    bool inserted = false;
+    {
+        data::CachedStatement cached(*pImpl->statements, insertSql);
+        sqlite3_stmt* stmt = cached.get();
+        if (stmt) {
+            sqlite3_bind_double(stmt, 1, latitude);
+            sqlite3_bind_double(stmt, 2, longitude);
+            sqlite3_bind_double(stmt, 3, pattern.speed);
+            sqlite3_bind_double(stmt, 4, pattern.direction);
+            sqlite3_bind_double(stmt, 5, pattern.gustSpeed);
+            sqlite3_bind_double(stmt, 6, pattern.temperature);
+            sqlite3_bind_double(stmt, 7, pattern.pressure);
+            sqlite3_bind_int64(stmt, 8, pattern.timestamp);
+            sqlite3_bind_int(stmt, 9, hour);
+            inserted = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(pImpl->db) == 1;
+        }
+    }
+
+    // Only a new observation changes the statistics
+    bool ok = inserted;
+    WindAccumulator accumulator;
+    if (ok) {
+        data::CachedStatement cached(*pImpl->statements, selectSql);
+        sqlite3_stmt* stmt = cached.get();
+        ok = stmt != nullptr;
+        if (ok) {
+            sqlite3_bind_double(stmt, 1, latitude);
+            sqlite3_bind_double(stmt, 2, longitude);
+            sqlite3_bind_int(stmt, 3, hour);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                accumulator = readWindAccumulator(stmt);
+            }
+        }
+    }
+    if (ok) {
+        accumulator.add(pattern);
+        ok = writeWindAccumulator(latitude, longitude, hour, accumulator);
+    }
+
+    if (!ok || sqlite3_exec(pImpl->db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_exec(pImpl->db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+std::optional<WindAccumulator> WeatherStorage::getWindAccumulator(double latitude, double longitude,
+                                                                  int hourOfDay) {
+    const std::string sql = std::string(SELECT_WIND_STATS_SQL) + " AND hour_of_day = ?;";
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, sql);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return std::nullopt;
+
+    sqlite3_bind_double(stmt, 1, latitude);
+    sqlite3_bind_double(stmt, 2, longitude);
+    sqlite3_bind_int(stmt, 3, hourOfDay);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        return readWindAccumulator(stmt);
+    }
     return std::nullopt;
 }
 
+std::vector<WindAccumulator> WeatherStorage::getWindAccumulators(double latitude, double longitude) {
+    std::vector<WindAccumulator> hours(24);
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    data::CachedStatement cached(*pImpl->statements, SELECT_WIND_STATS_SQL);
+    sqlite3_stmt* stmt = cached.get();
+    if (!stmt) return hours;
+
+    sqlite3_bind_double(stmt, 1, latitude);
+    sqlite3_bind_double(stmt, 2, longitude);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int hour = sqlite3_column_int(stmt, 0);
+        if (hour >= 0 && hour < 24) {
+            hours[hour] = readWindAccumulator(stmt);
+        }
+    }
+    return hours;
+}
+
+data::StatementCacheStats WeatherStorage::statementCacheStats() const {
+    return pImpl->statements->stats();
+}
+
+std::unique_ptr<data::OnlineBackup> WeatherStorage::startBackup(const std::string& destinationPath,
+                                                                const data::BackupOptions& options) {
+    if (!pImpl->db) {
+        return nullptr;
+    }
+    return std::make_unique<data::OnlineBackup>(pImpl->db, pImpl->mutex, destinationPath, options);
+}
+
 } // namespace weather
 } // namespace gptgolf
@@ -0,0 +1,95 @@
+#include "weather/wind_accumulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gptgolf {
+namespace weather {
+
+namespace {
+
+constexpr double DEGREES_TO_RADIANS = M_PI / 180.0;
+
+// Weighted combination of two running means
+double combineMeans(double mean, double otherMean, double otherShare) {
+    return mean + (otherMean - mean) * otherShare;
+}
+
+} // namespace
+
+void WindAccumulator::add(const WindPattern& pattern) {
+    count++;
+    double share = 1.0 / count;
+
+    double delta = pattern.speed - meanSpeed;
+    meanSpeed += delta * share;
+    m2Speed += delta * (pattern.speed - meanSpeed);
+
+    double radians = pattern.direction * DEGREES_TO_RADIANS;
+    sumSin += std::sin(radians);
+    sumCos += std::cos(radians);
+
+    maxSpeed = std::max({maxSpeed, pattern.speed, pattern.gustSpeed});
+    meanGust = combineMeans(meanGust, pattern.gustSpeed, share);
+    meanTemperature = combineMeans(meanTemperature, pattern.temperature, share);
+    meanPressure = combineMeans(meanPressure, pattern.pressure, share);
+    lastTimestamp = std::max(lastTimestamp, pattern.timestamp);
+}
+
+void WindAccumulator::merge(const WindAccumulator& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al.'s pairwise update of the squared deviations
+    double total = static_cast<double>(count + other.count);
+    double share = other.count / total;
+    double delta = other.meanSpeed - meanSpeed;
+    m2Speed += other.m2Speed + delta * delta * count * share;
+    meanSpeed = combineMeans(meanSpeed, other.meanSpeed, share);
+
+    sumSin += other.sumSin;
+    sumCos += other.sumCos;
+    maxSpeed = std::max(maxSpeed, other.maxSpeed);
+    meanGust = combineMeans(meanGust, other.meanGust, share);
+    meanTemperature = combineMeans(meanTemperature, other.meanTemperature, share);
+    meanPressure = combineMeans(meanPressure, other.meanPressure, share);
+    lastTimestamp = std::max(lastTimestamp, other.lastTimestamp);
+    count += other.count;
+}
+
+double WindAccumulator::speedStdDev() const {
+    return count > 1 ? std::sqrt(std::max(m2Speed, 0.0) / (count - 1)) : 0.0;
+}
+
+double WindAccumulator::prevailingDirection() const {
+    double degrees = std::atan2(sumSin, sumCos) / DEGREES_TO_RADIANS;
+    return degrees < 0.0 ? degrees + 360.0 : degrees;
+}
+
+double WindAccumulator::directionStdDev() const {
+    if (count == 0) {
+        return 0.0;
+    }
+    // Capped at 180 where directions cancel and R vanishes
+    double resultant = std::hypot(sumSin, sumCos) / count;
+    if (resultant <= 0.0) {
+        return 180.0;
+    }
+    double degrees = std::sqrt(-2.0 * std::log(std::min(resultant, 1.0))) / DEGREES_TO_RADIANS;
+    return std::min(degrees, 180.0);
+}
+
+double WindAccumulator::gustRatio() const {
+    return meanSpeed > 0.0 ? meanGust / meanSpeed : 0.0;
+}
+
+double WindAccumulator::turbulenceIntensity() const {
+    return meanSpeed > 0.0 ? speedStdDev() / meanSpeed : 0.0;
+}
+
+} // namespace weather
+} // namespace gptgolf
@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+#include "data/cached_storage.h"
+#include "data/sqlite_storage.h"
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <thread>
+
+using namespace gptgolf::data;
+
+namespace {
+
+// Forwards to another store, holding club reads (or, once gateWrites is
+// set, finished shot writes) until released
+class GatedStorage : public IStorage {
+public:
+    explicit GatedStorage(IStorage& inner) : inner_(inner) {}
+
+    bool saveShotData(const ShotData& shot) override {
+        bool saved = inner_.saveShotData(shot);
+        if (gateWrites) {
+            wait();
+        }
+        return saved;
+    }
+    std::vector<ShotData> getShotHistory(size_t limit) override { return inner_.getShotHistory(limit); }
+    std::vector<ShotData> getShotsByClub(const std::string& clubName) override {
+        clubReads++;
+        if (!gateWrites) {
+            wait();
+        }
+        return inner_.getShotsByClub(clubName);
+    }
+    bool saveClubProfile(const ClubProfile& club) override { return inner_.saveClubProfile(club); }
+    bool updateClubProfile(const ClubProfile& club) override { return inner_.updateClubProfile(club); }
+    std::optional<ClubProfile> getClubProfile(const std::string& name) override { return inner_.getClubProfile(name); }
+    std::vector<ClubProfile> getAllClubProfiles() override { return inner_.getAllClubProfiles(); }
+    bool savePreference(const std::string& key, const std::string& value) override {
+        return inner_.savePreference(key, value);
+    }
+    std::string getPreference(const std::string& key, const std::string& defaultValue) override {
+        return inner_.getPreference(key, defaultValue);
+    }
+
+    void waitUntilEntered() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return entered_; });
+    }
+
+    void setOpen(bool open) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = open;
+        entered_ = false;
+        changed_.notify_all();
+    }
+
+    std::atomic<int> clubReads{0};
+    std::atomic<bool> gateWrites{false};
+
+private:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        entered_ = true;
+        changed_.notify_all();
+        changed_.wait(lock, [this] { return open_; });
+    }
+
+    IStorage& inner_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool open_ = true;
+    bool entered_ = false;
+};
+
+} // namespace
+
+class CachedStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_cached.db";
+        std::filesystem::remove(dbPath);
+        backing = std::make_unique<SQLiteStorage>(dbPath);
+    }
+
+    void TearDown() override {
+        backing.reset();
+        std::filesystem::remove(dbPath);
+    }
+
+    ShotData createTestShot(const std::string& club, double distance, std::time_t when) {
+        ShotData shot;
+        shot.initialVelocity = 60.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.conditions.timestamp = when;
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.timestamp = when;
+        return shot;
+    }
+
+    std::string dbPath;
+    std::unique_ptr<SQLiteStorage> backing;
+};
+
+TEST_F(CachedStorageTest, WritesGoThroughToBackingStore) {
+    CachedStorage cache(*backing);
+    ASSERT_TRUE(cache.saveShotData(createTestShot("Driver", 230.0, 1700000000)));
+
+    ClubProfile club;
+    club.name = "Driver";
+    club.avgDistance = 230.0;
+    ASSERT_TRUE(cache.saveClubProfile(club));
+
+    EXPECT_EQ(backing->getShotsByClub("Driver").size(), 1u);
+    EXPECT_DOUBLE_EQ(backing->getClubProfile("Driver")->avgDistance, 230.0);
+}
+
+TEST_F(CachedStorageTest, RepeatedClubReadsServedFromMemory) {
+    CachedStorage cache(*backing);
+    cache.saveShotData(createTestShot("7 Iron", 150.0, 1700000000));
+    cache.saveShotData(createTestShot("7 Iron", 152.0, 1700000200));
+
+    auto first = cache.getShotsByClub("7 Iron");
+    // Out-of-order arrival is placed by timestamp
+    cache.saveShotData(createTestShot("7 Iron", 151.0, 1700000100));
+    auto second = cache.getShotsByClub("7 Iron");
+
+    ASSERT_EQ(first.size(), 2u);
+    ASSERT_EQ(second.size(), 3u);
+    EXPECT_DOUBLE_EQ(second[0].actualDistance, 152.0);
+    EXPECT_DOUBLE_EQ(second[1].actualDistance, 151.0);
+    EXPECT_DOUBLE_EQ(second[2].actualDistance, 150.0);
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.cachedShots, 3u);
+}
+
+TEST_F(CachedStorageTest, RecentHistoryTracksNewShots) {
+    CacheConfig config;
+    config.recentShotCapacity = 3;
+    CachedStorage cache(*backing, config);
+    for (int i = 0; i < 5; ++i) {
+        cache.saveShotData(createTestShot("Driver", 200.0 + i, 1700000000 + i));
+    }
+
+    auto recent = cache.getShotHistory(3);
+    ASSERT_EQ(recent.size(), 3u);
+    EXPECT_DOUBLE_EQ(recent[0].actualDistance, 204.0);
+
+    cache.saveShotData(createTestShot("Driver", 210.0, 1700000010));
+    recent = cache.getShotHistory(2);
+    ASSERT_EQ(recent.size(), 2u);
+    EXPECT_DOUBLE_EQ(recent[0].actualDistance, 210.0);
+    EXPECT_DOUBLE_EQ(recent[1].actualDistance, 204.0);
+
+    // Larger requests than the cached window go to the backing store
+    EXPECT_EQ(cache.getShotHistory(10).size(), 6u);
+}
+
+TEST_F(CachedStorageTest, ProfilesCachedAndUnknownUpdatesIgnored) {
+    CachedStorage cache(*backing);
+    ClubProfile club;
+    club.name = "5 Iron";
+    club.avgDistance = 170.0;
+    cache.saveClubProfile(club);
+
+    club.avgDistance = 172.0;
+    ASSERT_TRUE(cache.updateClubProfile(club));
+    EXPECT_DOUBLE_EQ(cache.getClubProfile("5 Iron")->avgDistance, 172.0);
+
+    ClubProfile ghost;
+    ghost.name = "Ghost";
+    cache.updateClubProfile(ghost);
+    EXPECT_EQ(cache.getAllClubProfiles().size(), 1u);
+    EXPECT_FALSE(cache.getClubProfile("Ghost").has_value());
+}
+
+TEST_F(CachedStorageTest, EvictsLeastRecentlyUsedClubs) {
+    for (int i = 0; i < 100; ++i) {
+        backing->saveShotData(createTestShot("Driver", 230.0, 1700000000 + i));
+        backing->saveShotData(createTestShot("7 Iron", 150.0, 1700000000 + i));
+        backing->saveShotData(createTestShot("PW", 110.0, 1700000000 + i));
+    }
+
+    CacheConfig config;
+    config.memoryBudgetBytes = 250 * sizeof(ShotData);
+    CachedStorage cache(*backing, config);
+
+    cache.getShotsByClub("Driver");
+    cache.getShotsByClub("7 Iron");
+    cache.getShotsByClub("PW");  // Pushes out Driver
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.cachedClubs, 2u);
+    EXPECT_LE(stats.memoryBytes, config.memoryBudgetBytes);
+
+    // Evicted clubs reload in full
+    EXPECT_EQ(cache.getShotsByClub("Driver").size(), 100u);
+}
+
+TEST_F(CachedStorageTest, ColdReadDoesNotBlockHotReadsAndLoadsOnce) {
+    for (int i = 0; i < 10; ++i) {
+        backing->saveShotData(createTestShot("Driver", 230.0, 1700000000 + i));
+        backing->saveShotData(createTestShot("7 Iron", 150.0, 1700000000 + i));
+    }
+    GatedStorage gated(*backing);
+    CachedStorage cache(gated);
+    ASSERT_EQ(cache.getShotsByClub("7 Iron").size(), 10u);
+
+    gated.setOpen(false);
+    std::thread first([&] { EXPECT_EQ(cache.getShotsByClub("Driver").size(), 10u); });
+    gated.waitUntilEntered();
+    std::thread second([&] { EXPECT_EQ(cache.getShotsByClub("Driver").size(), 10u); });
+
+    // The Driver load is stuck in the backing store; cached clubs still answer
+    EXPECT_EQ(cache.getShotsByClub("7 Iron").size(), 10u);
+    EXPECT_EQ(cache.getRecentShotsByClub("7 Iron", 3).size(), 3u);
+
+    gated.setOpen(true);
+    first.join();
+    second.join();
+    EXPECT_EQ(gated.clubReads.load(), 2);  // 7 Iron once, Driver once
+    EXPECT_EQ(cache.getStats().cachedClubs, 2u);
+}
+
+TEST_F(CachedStorageTest, WritesDoNotBlockReadsOrCacheTheirShotTwice) {
+    for (int i = 0; i < 5; ++i) {
+        backing->saveShotData(createTestShot("Driver", 230.0, 1700000000 + i));
+        backing->saveShotData(createTestShot("7 Iron", 150.0, 1700000000 + i));
+    }
+    GatedStorage gated(*backing);
+    CachedStorage cache(gated);
+    ASSERT_EQ(cache.getShotsByClub("7 Iron").size(), 5u);
+
+    gated.gateWrites = true;
+    gated.setOpen(false);
+    std::thread writer([&] { EXPECT_TRUE(cache.saveShotData(createTestShot("Driver", 235.0, 1700000010))); });
+    gated.waitUntilEntered();
+
+    // The shot is stored but the write has not returned; reads still answer,
+    // and the Driver load that already sees the shot is not cached
+    EXPECT_EQ(cache.getShotsByClub("7 Iron").size(), 5u);
+    EXPECT_EQ(cache.getShotsByClub("Driver").size(), 6u);
+    EXPECT_EQ(cache.getStats().cachedClubs, 1u);
+
+    gated.setOpen(true);
+    writer.join();
+    EXPECT_EQ(cache.getShotsByClub("Driver").size(), 6u);
+    EXPECT_EQ(cache.getShotsByClub("Driver").size(), 6u);
+    EXPECT_EQ(cache.getStats().cachedClubs, 2u);
+}
+
+TEST_F(CachedStorageTest, UnknownClubsAreNotCached) {
+    CachedStorage cache(*backing);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(cache.getShotsByClub("Club " + std::to_string(i)).empty());
+    }
+    EXPECT_TRUE(cache.getShotsByClub("Club 0").empty());
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.cachedClubs, 0u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.memoryBytes, 0u);
+
+    // The first shot makes the club worth caching
+    cache.saveShotData(createTestShot("Club 0", 100.0, 1700000000));
+    EXPECT_EQ(cache.getShotsByClub("Club 0").size(), 1u);
+    EXPECT_EQ(cache.getStats().cachedClubs, 1u);
+}
+
+TEST_F(CachedStorageTest, BudgetCountsRecentShotsAndProfiles) {
+    for (int i = 0; i < 100; ++i) {
+        backing->saveShotData(createTestShot("Driver", 230.0, 1700000000 + i));
+    }
+    ClubProfile club;
+    club.name = "Driver";
+    backing->saveClubProfile(club);
+
+    CacheConfig config;
+    config.memoryBudgetBytes = 150 * sizeof(ShotData);
+    config.recentShotCapacity = 100;
+    CachedStorage cache(*backing, config);
+
+    cache.getShotHistory(10);
+    cache.getAllClubProfiles();
+    size_t windowAndProfiles = cache.getStats().memoryBytes;
+    EXPECT_GE(windowAndProfiles, 100 * sizeof(ShotData) + sizeof(ClubProfile));
+
+    // The club history does not fit next to them, so they give way
+    EXPECT_EQ(cache.getShotsByClub("Driver").size(), 100u);
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.cachedClubs, 1u);
+    EXPECT_LE(stats.memoryBytes, config.memoryBudgetBytes);
+    EXPECT_EQ(cache.getShotHistory(10).size(), 10u);
+}
@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+#include "data/club_analysis.h"
+#include "data/sqlite_storage.h"
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+using namespace gptgolf::data;
+
+namespace {
+
+// Forwards to SQLite and counts shot-history reads
+class CountingStorage : public IStorage {
+public:
+    explicit CountingStorage(IStorage& backing) : backing_(backing) {}
+
+    bool saveShotData(const ShotData& shot) override { return backing_.saveShotData(shot); }
+    std::vector<ShotData> getShotHistory(size_t limit) override {
+        ++historyReads;
+        return backing_.getShotHistory(limit);
+    }
+    std::vector<ShotData> getShotsByClub(const std::string& clubName) override {
+        ++historyReads;
+        return backing_.getShotsByClub(clubName);
+    }
+    std::vector<ShotData> getRecentShotsByClub(const std::string& clubName, size_t limit) override {
+        ++historyReads;
+        return backing_.getRecentShotsByClub(clubName, limit);
+    }
+    bool saveClubProfile(const ClubProfile& club) override { return backing_.saveClubProfile(club); }
+    bool updateClubProfile(const ClubProfile& club) override { return backing_.updateClubProfile(club); }
+    std::optional<ClubProfile> getClubProfile(const std::string& name) override {
+        return backing_.getClubProfile(name);
+    }
+    std::vector<ClubProfile> getAllClubProfiles() override {
+        ++profileScans;
+        return backing_.getAllClubProfiles();
+    }
+    bool savePreference(const std::string& key, const std::string& value) override {
+        return backing_.savePreference(key, value);
+    }
+    std::string getPreference(const std::string& key, const std::string& defaultValue) override {
+        return backing_.getPreference(key, defaultValue);
+    }
+
+    size_t historyReads = 0;
+    size_t profileScans = 0;
+
+private:
+    IStorage& backing_;
+};
+
+} // namespace
+
+class ClubAnalysisTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_club_analysis.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    ShotData createTestShot(const std::string& club, double distance, double lateral) {
+        ShotData shot;
+        shot.initialVelocity = 60.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.lateralDeviation = lateral;
+        return shot;
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(ClubAnalysisTest, RunningStatisticsMatchBatchComputation) {
+    SQLiteStorage storage(dbPath);
+    ClubAnalysis analysis(storage);
+
+    std::vector<double> distances;
+    for (int i = 0; i < 200; ++i) {
+        double distance = 150.0 + std::sin(i * 0.7) * 8.0;
+        distances.push_back(distance);
+        analysis.updateClubStatistics(createTestShot("7 Iron", distance, i % 5 - 2.0));
+    }
+
+    double mean = 0.0;
+    for (double d : distances) mean += d;
+    mean /= distances.size();
+    double variance = 0.0;
+    for (double d : distances) variance += (d - mean) * (d - mean);
+    variance /= distances.size();
+
+    auto profile = storage.getClubProfile("7 Iron");
+    ASSERT_TRUE(profile.has_value());
+    EXPECT_EQ(profile->distanceStats.count, 200u);
+    EXPECT_NEAR(profile->distanceStats.mean, mean, 1e-9);
+    EXPECT_NEAR(profile->distanceDeviation, std::sqrt(variance), 1e-9);
+    EXPECT_NEAR(profile->lateralStats.mean, 0.0, 1e-9);
+
+    auto stats = analysis.analyzeClubPerformance("7 Iron");
+    EXPECT_EQ(stats.sampleSize, 200u);
+    EXPECT_NEAR(stats.distanceStdDev, std::sqrt(variance), 1e-9);
+}
+
+TEST_F(ClubAnalysisTest, UpdatesNeverReadShotHistory) {
+    SQLiteStorage sqlite(dbPath);
+    CountingStorage storage(sqlite);
+    ClubAnalysis analysis(storage);
+
+    for (int i = 0; i < 50; ++i) {
+        ShotData shot = createTestShot(i % 2 ? "Driver" : "PW", i % 2 ? 230.0 : 110.0, 1.0);
+        storage.saveShotData(shot);
+        analysis.updateClubStatistics(shot);
+    }
+    gptgolf::weather::WeatherData calm{};
+    calm.pressure = 1013.25;
+    calm.temperature = 20.0;
+    auto recommendation = analysis.recommendClub(225.0, calm);
+    analysis.getOptimalDistanceRanges();
+
+    EXPECT_EQ(recommendation.clubName, "Driver");
+    EXPECT_EQ(storage.historyReads, 0u);
+}
+
+TEST_F(ClubAnalysisTest, RecentFormFollowsChangesFasterThanMean) {
+    SQLiteStorage storage(dbPath);
+    ClubAnalysis analysis(storage);
+    for (int i = 0; i < 100; ++i) {
+        analysis.updateClubStatistics(createTestShot("5 Iron", 170.0, 0.0));
+    }
+    for (int i = 0; i < 30; ++i) {
+        analysis.updateClubStatistics(createTestShot("5 Iron", 180.0, 4.0));
+    }
+
+    auto stats = analysis.analyzeClubPerformance("5 Iron");
+    EXPECT_NEAR(stats.meanDistance, 170.0 + 300.0 / 130.0, 1e-9);
+    EXPECT_GT(stats.recentDistance, 179.0);
+    EXPECT_GT(stats.recentAccuracy, 3.8);
+}
+
+TEST_F(ClubAnalysisTest, LegacyClubsAreSeededFromShots) {
+    {
+        sqlite3* db;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        sqlite3_exec(db, R"(
+            CREATE TABLE clubs (
+                name TEXT PRIMARY KEY,
+                avg_distance REAL NOT NULL,
+                avg_spin_rate REAL NOT NULL,
+                avg_launch_angle REAL NOT NULL,
+                total_shots INTEGER NOT NULL,
+                last_updated INTEGER NOT NULL,
+                distance_deviation REAL NOT NULL,
+                direction_deviation REAL NOT NULL
+            );
+            INSERT INTO clubs VALUES ('PW', 110, 8000, 28, 4, 0, 0, 0);
+        )", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+    }
+    {
+        SQLiteStorage storage(dbPath);
+        storage.saveShotBatch({createTestShot("PW", 100.0, -2.0), createTestShot("PW", 110.0, 0.0),
+                               createTestShot("PW", 120.0, 2.0)});
+    }
+
+    // Drop the stats columns again to simulate an upgrade with existing shots
+    {
+        sqlite3* db;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        for (const char* column : {"distance_count", "distance_mean", "distance_m2",
+                                   "distance_recent_mean", "distance_recent_variance",
+                                   "lateral_count", "lateral_mean", "lateral_m2",
+                                   "lateral_recent_mean", "lateral_recent_variance"}) {
+            std::string sql = std::string("ALTER TABLE clubs DROP COLUMN ") + column;
+            ASSERT_EQ(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+        }
+        sqlite3_close(db);
+    }
+
+    SQLiteStorage storage(dbPath);
+    auto profile = storage.getClubProfile("PW");
+    ASSERT_TRUE(profile.has_value());
+    EXPECT_EQ(profile->distanceStats.count, 3u);
+    EXPECT_NEAR(profile->distanceStats.mean, 110.0, 1e-9);
+    EXPECT_NEAR(profile->distanceStats.variance(), 200.0 / 3.0, 1e-6);
+    EXPECT_NEAR(profile->lateralStats.stdDev(), std::sqrt(8.0 / 3.0), 1e-6);
+}
+
+TEST_F(ClubAnalysisTest, RecentShotsQueryHonorsLimit) {
+    SQLiteStorage storage(dbPath);
+    for (int i = 0; i < 30; ++i) {
+        ShotData shot = createTestShot("SW", 80.0 + i, 0.0);
+        shot.timestamp = 1700000000 + i;
+        storage.saveShotData(shot);
+    }
+
+    auto recent = storage.getRecentShotsByClub("SW", 5);
+    ASSERT_EQ(recent.size(), 5u);
+    EXPECT_DOUBLE_EQ(recent[0].actualDistance, 109.0);
+}
+
+TEST_F(ClubAnalysisTest, RecommendationIndexMatchesLinearScan) {
+    SQLiteStorage storage(dbPath);
+    ClubAnalysis analysis(storage);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> spread(0.0, 1.0);
+
+    const char* clubs[] = {"Driver", "3 Wood", "5 Wood", "4 Iron", "5 Iron", "6 Iron",
+                           "7 Iron", "8 Iron", "9 Iron", "PW", "GW", "SW", "LW"};
+    for (int c = 0; c < 13; ++c) {
+        for (int i = 0; i < 40; ++i) {
+            double carry = 240.0 - c * 14.0 + spread(rng) * (3.0 + c);
+            analysis.updateClubStatistics(createTestShot(clubs[c], carry, spread(rng) * (2.0 + c % 4)));
+        }
+    }
+
+    auto profiles = storage.getAllClubProfiles();
+    std::uniform_real_distribution<double> target(20.0, 300.0);
+    std::uniform_real_distribution<double> wind(0.0, 12.0);
+    std::uniform_real_distribution<double> direction(0.0, 360.0);
+    for (int i = 0; i < 500; ++i) {
+        gptgolf::weather::WeatherData conditions{};
+        conditions.windSpeed = wind(rng);
+        conditions.windDirection = direction(rng);
+        conditions.temperature = 10.0 + i % 20;
+        conditions.pressure = 1013.25;
+        double distance = target(rng);
+
+        // Reference: the original scan over profiles in name order
+        double offset = conditions.windSpeed * std::cos(conditions.windDirection * M_PI / 180.0) * 0.9 +
+                        (conditions.temperature - 20.0) * 0.2;
+        std::string expected;
+        double bestConfidence = 0.0;
+        for (const auto& profile : profiles) {
+            double adjusted = profile.avgDistance + offset;
+            double consistency = analysis.analyzeClubPerformance(profile.name).consistencyScore;
+            double confidence = 0.7 * std::max(0.0, 1.0 - std::abs(distance - adjusted) / adjusted) +
+                                0.3 * consistency;
+            if (confidence > bestConfidence) {
+                bestConfidence = confidence;
+                expected = profile.name;
+            }
+        }
+
+        auto recommendation = analysis.recommendClub(distance, conditions);
+        EXPECT_EQ(recommendation.clubName, expected) << "target " << distance;
+        EXPECT_NEAR(recommendation.confidenceScore, bestConfidence, 1e-12);
+    }
+}
+
+TEST_F(ClubAnalysisTest, RecommendationIndexFollowsUpdates) {
+    SQLiteStorage sqlite(dbPath);
+    CountingStorage storage(sqlite);
+    ClubAnalysis analysis(storage);
+    gptgolf::weather::WeatherData calm{};
+    calm.pressure = 1013.25;
+    calm.temperature = 20.0;
+
+    for (int i = 0; i < 10; ++i) {
+        analysis.updateClubStatistics(createTestShot("8 Iron", 140.0, 0.0));
+        analysis.updateClubStatistics(createTestShot("9 Iron", 128.0, 0.0));
+    }
+    EXPECT_EQ(analysis.recommendClub(130.0, calm).clubName, "9 Iron");
+    EXPECT_EQ(storage.profileScans, 1u);
+
+    // Shots moving the 9 Iron's average above 130 reposition it in the index
+    for (int i = 0; i < 10; ++i) {
+        analysis.updateClubStatistics(createTestShot("9 Iron", 145.0, 0.0));
+    }
+    analysis.updateClubStatistics(createTestShot("PW", 131.0, 0.0));
+    auto recommendation = analysis.recommendClub(131.0, calm);
+    EXPECT_EQ(recommendation.clubName, "PW");
+    EXPECT_NEAR(recommendation.expectedDistance, 131.0, 1e-9);
+    EXPECT_EQ(storage.profileScans, 1u);
+
+    // Profiles written behind the analysis' back need an explicit invalidation
+    auto profile = sqlite.getClubProfile("8 Iron");
+    profile->avgDistance = 131.0;
+    sqlite.updateClubProfile(*profile);
+    EXPECT_EQ(analysis.recommendClub(131.0, calm).clubName, "PW");
+    analysis.invalidateRecommendationIndex();
+    EXPECT_EQ(analysis.recommendClub(131.0, calm).clubName, "8 Iron");
+    EXPECT_EQ(storage.profileScans, 2u);
+}
+
+TEST_F(ClubAnalysisTest, GappingComesFromPersistedSketches) {
+    {
+        SQLiteStorage storage(dbPath);
+        ClubAnalysis analysis(storage);
+        for (int i = 0; i <= 100; ++i) {
+            analysis.updateClubStatistics(createTestShot("7 Iron", 100.0 + i, i % 2 ? 3.0 : -3.0));
+            analysis.updateClubStatistics(createTestShot("9 Iron", 80.0 + i * 0.2, 0.0));
+        }
+    }
+
+    SQLiteStorage storage(dbPath);
+    ClubAnalysis analysis(storage);
+    auto gapping = analysis.getDistanceGapping();
+    ASSERT_EQ(gapping.size(), 2u);
+    EXPECT_EQ(gapping[0].clubName, "9 Iron");
+    EXPECT_EQ(gapping[1].sampleSize, 101u);
+    EXPECT_NEAR(gapping[1].carryP10, 110.0, 0.5);
+    EXPECT_NEAR(gapping[1].carryP50, 150.0, 0.5);
+    EXPECT_NEAR(gapping[1].carryP90, 190.0, 0.5);
+    EXPECT_NEAR(gapping[1].lateralP10, -3.0, 1e-6);
+    EXPECT_NEAR(gapping[1].lateralP90, 3.0, 1e-6);
+
+    auto ranges = analysis.getOptimalDistanceRanges();
+    EXPECT_NEAR(ranges["7 Iron"].second, 190.0, 0.5);
+    EXPECT_NEAR(ranges["9 Iron"].first, 82.0, 0.5);
+    EXPECT_NEAR(ranges["7 Iron"].first, (gapping[0].carryP50 + gapping[1].carryP50) / 2, 1e-9);
+}
+
+TEST_F(ClubAnalysisTest, GappingMergesAcrossPlayers) {
+    SQLiteStorage first(dbPath);
+    SQLiteStorage second("test_club_analysis_second.db");
+    ClubAnalysis firstAnalysis(first);
+    ClubAnalysis secondAnalysis(second);
+    for (int i = 0; i < 100; ++i) {
+        firstAnalysis.updateClubStatistics(createTestShot("Driver", 200.0 + i * 0.1, 0.0));
+        secondAnalysis.updateClubStatistics(createTestShot("Driver", 240.0 + i * 0.1, 0.0));
+    }
+    secondAnalysis.updateClubStatistics(createTestShot("PW", 105.0, 0.0));
+
+    auto profiles = first.getAllClubProfiles();
+    auto more = second.getAllClubProfiles();
+    profiles.insert(profiles.end(), more.begin(), more.end());
+    auto venue = ClubAnalysis::gappingFromProfiles(profiles);
+    std::filesystem::remove("test_club_analysis_second.db");
+
+    ASSERT_EQ(venue.size(), 2u);
+    EXPECT_EQ(venue[0].clubName, "PW");
+    EXPECT_EQ(venue[1].sampleSize, 200u);
+    EXPECT_NEAR(venue[1].carryP10, 202.0, 0.5);
+    EXPECT_NEAR(venue[1].carryP90, 248.0, 0.5);
+}
+
+TEST_F(ClubAnalysisTest, LegacyClubsGetSketchesFromShots) {
+    {
+        SQLiteStorage storage(dbPath);
+        ClubProfile club;
+        club.name = "SW";
+        storage.saveClubProfile(club);
+        std::vector<ShotData> shots;
+        for (int i = 0; i < 50; ++i) {
+            shots.push_back(createTestShot("SW", 60.0 + i, 0.0));
+        }
+        storage.saveShotBatch(shots);
+    }
+    {
+        sqlite3* db;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        for (const char* column : {"distance_sketch", "lateral_sketch"}) {
+            std::string sql = std::string("ALTER TABLE clubs DROP COLUMN ") + column;
+            ASSERT_EQ(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+        }
+        sqlite3_close(db);
+    }
+
+    SQLiteStorage storage(dbPath);
+    auto profile = storage.getClubProfile("SW");
+    ASSERT_TRUE(profile.has_value());
+    EXPECT_EQ(profile->distanceSketch.count(), 50u);
+    EXPECT_NEAR(profile->distanceSketch.quantile(0.5), 85.0, 0.5);
+}
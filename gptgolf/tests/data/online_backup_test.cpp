@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "data/sqlite_storage.h"
+#include "weather/weather_storage.h"
+#include <sqlite3.h>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+using namespace gptgolf::data;
+
+class OnlineBackupTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_backup_source.db";
+        backupPath = "test_backup_copy.db";
+        removeFiles();
+    }
+
+    void TearDown() override {
+        removeFiles();
+    }
+
+    void removeFiles() {
+        for (const std::string& path : {dbPath, backupPath, backupPath + ".partial"}) {
+            std::filesystem::remove(path);
+            std::filesystem::remove(path + "-wal");
+            std::filesystem::remove(path + "-shm");
+        }
+    }
+
+    static ShotData createTestShot(int i) {
+        ShotData shot;
+        shot.clubUsed = i % 2 ? "7 Iron" : "Driver";
+        shot.initialVelocity = 40.0 + i % 30;
+        shot.spinRate = 3000.0 + i % 4000;
+        shot.launchAngle = 12.0;
+        shot.actualDistance = 150.0 + i % 100;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.timestamp = 1700000000 + i;
+        return shot;
+    }
+
+    static int countShots(const std::string& path) {
+        sqlite3* db;
+        if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+            sqlite3_close(db);
+            return -1;
+        }
+        sqlite3_stmt* stmt;
+        int count = -1;
+        if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM shots", -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                count = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+        return count;
+    }
+
+    std::string dbPath;
+    std::string backupPath;
+};
+
+TEST_F(OnlineBackupTest, CopiesWhileWritesContinue) {
+    SQLiteStorage storage(dbPath);
+    std::vector<ShotData> shots;
+    for (int i = 0; i < 5000; ++i) {
+        shots.push_back(createTestShot(i));
+    }
+    ASSERT_EQ(storage.bulkInsertShots(shots), shots.size());
+
+    BackupOptions options;
+    options.initialPagesPerStep = 4;
+    options.maxPagesPerStep = 16;
+    options.stepInterval = std::chrono::milliseconds(1);
+    auto backup = storage.startBackup(backupPath, options);
+
+    // Writes through the same storage go on between steps
+    int written = 0;
+    while (!backup->progress().finished() && written < 200) {
+        ASSERT_TRUE(storage.saveShotData(createTestShot(5000 + written)));
+        ++written;
+    }
+    ASSERT_TRUE(backup->wait()) << backup->progress().error;
+
+    BackupProgress progress = backup->progress();
+    EXPECT_EQ(progress.state, BackupState::Completed);
+    EXPECT_TRUE(progress.verified);
+    EXPECT_GT(progress.steps, 1u);
+    EXPECT_EQ(progress.pagesRemaining, 0);
+    EXPECT_DOUBLE_EQ(progress.fraction(), 1.0);
+    EXPECT_LE(progress.pagesPerStep, 16);
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".partial"));
+
+    int copied = countShots(backupPath);
+    EXPECT_GE(copied, 5000);
+    EXPECT_LE(copied, 5000 + written);
+
+    SQLiteStorage restored(backupPath);
+    EXPECT_FALSE(restored.getShotsByClub("Driver").empty());
+}
+
+TEST_F(OnlineBackupTest, ShrinksStepsToFitBudget) {
+    SQLiteStorage storage(dbPath);
+    std::vector<ShotData> shots;
+    for (int i = 0; i < 20000; ++i) {
+        shots.push_back(createTestShot(i));
+    }
+    ASSERT_EQ(storage.bulkInsertShots(shots), shots.size());
+
+    BackupOptions options;
+    options.stepBudget = std::chrono::microseconds(1);
+    options.initialPagesPerStep = 256;
+    options.stepInterval = std::chrono::milliseconds(0);
+    auto backup = storage.startBackup(backupPath, options);
+    ASSERT_TRUE(backup->wait()) << backup->progress().error;
+
+    BackupProgress progress = backup->progress();
+    EXPECT_LT(progress.pagesPerStep, 256);
+    EXPECT_GT(progress.steps, 2u);
+    EXPECT_EQ(countShots(backupPath), 20000);
+}
+
+TEST_F(OnlineBackupTest, CancelRemovesPartialCopy) {
+    SQLiteStorage storage(dbPath);
+    std::vector<ShotData> shots;
+    for (int i = 0; i < 5000; ++i) {
+        shots.push_back(createTestShot(i));
+    }
+    ASSERT_EQ(storage.bulkInsertShots(shots), shots.size());
+
+    BackupOptions options;
+    options.initialPagesPerStep = 1;
+    options.maxPagesPerStep = 1;
+    options.stepInterval = std::chrono::milliseconds(10000);
+    auto backup = storage.startBackup(backupPath, options);
+    while (backup->progress().steps == 0) {
+        std::this_thread::yield();
+    }
+    backup->cancel();
+
+    EXPECT_FALSE(backup->wait());
+    EXPECT_EQ(backup->progress().state, BackupState::Cancelled);
+    EXPECT_FALSE(std::filesystem::exists(backupPath));
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".partial"));
+    EXPECT_TRUE(storage.saveShotData(createTestShot(5000)));
+}
+
+TEST_F(OnlineBackupTest, ReportsUnwritableDestination) {
+    SQLiteStorage storage(dbPath);
+    ASSERT_TRUE(storage.saveShotData(createTestShot(0)));
+
+    auto backup = storage.startBackup("missing_directory/backup.db");
+    EXPECT_FALSE(backup->wait());
+    BackupProgress progress = backup->progress();
+    EXPECT_EQ(progress.state, BackupState::Failed);
+    EXPECT_FALSE(progress.error.empty());
+}
+
+TEST_F(OnlineBackupTest, BacksUpWeatherStorage) {
+    using gptgolf::weather::WeatherData;
+    using gptgolf::weather::WeatherStorage;
+
+    WeatherStorage uninitialized;
+    EXPECT_EQ(uninitialized.startBackup(backupPath), nullptr);
+
+    WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(dbPath));
+    WeatherData data{};
+    data.temperature = 21.5;
+    data.humidity = 40.0;
+    data.pressure = 1013.0;
+    data.windSpeed = 3.0;
+    data.windDirection = 270.0;
+    data.timestamp = std::time(nullptr);
+    ASSERT_TRUE(weather.storeWeatherData(36.1, -115.2, data));
+
+    auto backup = weather.startBackup(backupPath);
+    ASSERT_NE(backup, nullptr);
+    ASSERT_TRUE(backup->wait()) << backup->progress().error;
+
+    WeatherStorage restored;
+    ASSERT_TRUE(restored.initialize(backupPath));
+    auto copy = restored.getWeatherData(36.1, -115.2);
+    ASSERT_TRUE(copy.has_value());
+    EXPECT_DOUBLE_EQ(copy->temperature, 21.5);
+    EXPECT_DOUBLE_EQ(copy->windDirection, 270.0);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "data/packed_shot.h"
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <thread>
+
+using namespace gptgolf::data;
+
+class PackedShotTest : public ::testing::Test {
+protected:
+    static ShotData createTestShot(const std::string& club, std::mt19937& rng) {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        ShotData shot;
+        shot.initialVelocity = 40.0 + 40.0 * unit(rng);
+        shot.spinRate = 2000.0 + 8000.0 * unit(rng);
+        shot.launchAngle = 8.0 + 20.0 * unit(rng);
+        shot.clubUsed = club;
+        shot.actualDistance = 80.0 + 200.0 * unit(rng);
+        shot.predictedDistance = shot.actualDistance - 3.0 * unit(rng);
+        shot.lateralDeviation = -10.0 + 20.0 * unit(rng);
+        shot.timestamp = 1700000000 + static_cast<std::time_t>(unit(rng) * 1e7);
+        shot.conditions.temperature = -5.0 + 40.0 * unit(rng);
+        shot.conditions.humidity = 100.0 * unit(rng);
+        shot.conditions.pressure = 950.0 + 100.0 * unit(rng);
+        shot.conditions.windSpeed = 15.0 * unit(rng);
+        shot.conditions.windDirection = 360.0 * unit(rng);
+        shot.conditions.precipitation = 2.0 * unit(rng);
+        shot.conditions.altitude = 1500.0 * unit(rng);
+        shot.conditions.timestamp = shot.timestamp - 300;
+        return shot;
+    }
+
+    // Largest error float rounding may introduce for a value
+    static double floatTolerance(double value) {
+        return std::abs(value) * 6e-8 + 1e-30;
+    }
+};
+
+TEST_F(PackedShotTest, ShotRoundTripKeepsFloatPrecision) {
+    std::mt19937 rng(7);
+    ClubNameTable clubs;
+    for (const char* club : {"Driver", "7 Iron", "Custom Forged Pitching Wedge 46 degrees"}) {
+        ShotData shot = createTestShot(club, rng);
+        PackedShot packed = PackedShot::pack(shot, clubs);
+        ShotData restored = packed.unpack(clubs);
+
+        EXPECT_EQ(restored.clubUsed, shot.clubUsed);
+        EXPECT_EQ(restored.timestamp, shot.timestamp);
+        EXPECT_EQ(restored.conditions.timestamp, shot.conditions.timestamp);
+        EXPECT_NEAR(restored.initialVelocity, shot.initialVelocity, floatTolerance(shot.initialVelocity));
+        EXPECT_NEAR(restored.spinRate, shot.spinRate, floatTolerance(shot.spinRate));
+        EXPECT_NEAR(restored.actualDistance, shot.actualDistance, floatTolerance(shot.actualDistance));
+        EXPECT_NEAR(restored.lateralDeviation, shot.lateralDeviation, floatTolerance(shot.lateralDeviation));
+        EXPECT_NEAR(restored.conditions.pressure, shot.conditions.pressure, floatTolerance(shot.conditions.pressure));
+        EXPECT_NEAR(restored.conditions.altitude, shot.conditions.altitude, floatTolerance(shot.conditions.altitude));
+
+        // Unpacked values are floats already, so repacking is exact
+        PackedShot repacked = PackedShot::pack(restored, clubs);
+        EXPECT_EQ(std::memcmp(&repacked.initialVelocity, &packed.initialVelocity,
+                              offsetof(PackedShot, club) - offsetof(PackedShot, initialVelocity)), 0);
+        EXPECT_EQ(repacked.club, packed.club);
+    }
+    EXPECT_EQ(clubs.size(), 3u);
+}
+
+TEST_F(PackedShotTest, LaunchDataRoundTripsQuality) {
+    for (const char* rating : {"Good", "Partial", "Poor", ""}) {
+        LaunchMonitorData data;
+        data.ballSpeed = 67.3;
+        data.spinAxis = -4.25;
+        data.carryDistance = 162.8;
+        data.dynamicLoft = 27.1;
+        data.confidence = 0.93;
+        data.quality = rating;
+
+        PackedLaunchData packed = PackedLaunchData::pack(data);
+        LaunchMonitorData restored = packed.unpack();
+        EXPECT_EQ(restored.quality, rating);
+        EXPECT_FLOAT_EQ(restored.ballSpeed, 67.3f);
+        EXPECT_FLOAT_EQ(restored.spinAxis, -4.25f);
+        EXPECT_FLOAT_EQ(restored.carryDistance, 162.8f);
+        EXPECT_FLOAT_EQ(restored.dynamicLoft, 27.1f);
+        EXPECT_FLOAT_EQ(restored.confidence, 0.93f);
+    }
+    EXPECT_EQ(parseShotQuality("Excellent"), ShotQuality::Unknown);
+}
+
+TEST_F(PackedShotTest, ClubTableInternsConcurrently) {
+    ClubNameTable clubs;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<ClubId>> seen(4);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                seen[t].push_back(clubs.intern("Club " + std::to_string(i % 50)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(clubs.size(), 50u);
+    for (int t = 1; t < 4; ++t) {
+        EXPECT_EQ(seen[t], seen[0]);
+    }
+    EXPECT_EQ(clubs.name(seen[0][7]), "Club 7");
+    EXPECT_FALSE(clubs.find("Putter").has_value());
+    EXPECT_THROW(clubs.name(50), std::out_of_range);
+}
+
+TEST_F(PackedShotTest, StoreIsSmallerThanShotData) {
+    std::mt19937 rng(3);
+    PackedShotStore store;
+    size_t unpackedBytes = 0;
+    const char* clubs[] = {"Driver", "3 Wood", "7 Iron", "Pitching Wedge 46 degrees"};
+    store.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+        ShotData shot = createTestShot(clubs[i % 4], rng);
+        unpackedBytes += shotDataFootprint(shot);
+        store.append(shot);
+    }
+
+    ASSERT_EQ(store.size(), 1000u);
+    EXPECT_EQ(store.clubs().size(), 4u);
+    EXPECT_EQ(store.at(3).clubUsed, "Pitching Wedge 46 degrees");
+    EXPECT_LT(store.sizeInBytes() * 2, unpackedBytes);
+}
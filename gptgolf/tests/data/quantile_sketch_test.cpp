@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "data/quantile_sketch.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace gptgolf::data;
+
+class QuantileSketchTest : public ::testing::Test {
+protected:
+    static double exactQuantile(std::vector<double> values, double q) {
+        std::sort(values.begin(), values.end());
+        double index = q * (values.size() - 1);
+        size_t lower = static_cast<size_t>(index);
+        size_t upper = std::min(lower + 1, values.size() - 1);
+        return values[lower] + (values[upper] - values[lower]) * (index - lower);
+    }
+};
+
+TEST_F(QuantileSketchTest, TracksPercentilesOfSkewedData) {
+    std::mt19937 rng(11);
+    std::normal_distribution<double> strike(150.0, 5.0);
+    std::uniform_real_distribution<double> mishit(0.0, 1.0);
+
+    // Mostly solid strikes plus a long tail of thin and heavy contacts
+    QuantileSketch sketch;
+    std::vector<double> values;
+    for (int i = 0; i < 50000; ++i) {
+        double carry = strike(rng);
+        if (mishit(rng) < 0.15) {
+            carry -= 20.0 + 40.0 * mishit(rng);
+        }
+        values.push_back(carry);
+        sketch.add(carry);
+    }
+
+    EXPECT_EQ(sketch.count(), 50000u);
+    EXPECT_LT(sketch.centroidCount(), 200u);
+    for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99}) {
+        EXPECT_NEAR(sketch.quantile(q), exactQuantile(values, q), 0.5) << "q=" << q;
+    }
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.0), *std::min_element(values.begin(), values.end()));
+    EXPECT_DOUBLE_EQ(sketch.quantile(1.0), *std::max_element(values.begin(), values.end()));
+}
+
+TEST_F(QuantileSketchTest, SmallSamplesAreExact) {
+    QuantileSketch sketch;
+    EXPECT_TRUE(std::isnan(sketch.quantile(0.5)));
+    for (double value : {110.0, 100.0, 120.0}) {
+        sketch.add(value);
+    }
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.5), 110.0);
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.0), 100.0);
+    EXPECT_DOUBLE_EQ(sketch.quantile(1.0), 120.0);
+}
+
+TEST_F(QuantileSketchTest, MergedSketchesMatchCombinedStream) {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> first(140.0, 4.0);
+    std::normal_distribution<double> second(155.0, 6.0);
+
+    QuantileSketch a, b, combined;
+    std::vector<double> values;
+    for (int i = 0; i < 20000; ++i) {
+        double x = first(rng);
+        double y = second(rng);
+        a.add(x);
+        b.add(y);
+        combined.add(x);
+        combined.add(y);
+        values.push_back(x);
+        values.push_back(y);
+    }
+
+    a.merge(b);
+    EXPECT_EQ(a.count(), combined.count());
+    for (double q : {0.1, 0.5, 0.9}) {
+        EXPECT_NEAR(a.quantile(q), exactQuantile(values, q), 0.3) << "q=" << q;
+        EXPECT_NEAR(a.quantile(q), combined.quantile(q), 0.3) << "q=" << q;
+    }
+}
+
+TEST_F(QuantileSketchTest, MergingWithItselfDoublesEveryWeight) {
+    QuantileSketch sketch;
+    for (int i = 0; i < 5000; ++i) {
+        sketch.add(100.0 + i % 50);
+    }
+    sketch.add(175.0);  // Left in the buffer
+
+    QuantileSketch doubled(sketch);
+    doubled.merge(QuantileSketch(sketch));
+    sketch.merge(sketch);
+    EXPECT_EQ(sketch.count(), 10002u);
+    for (double q : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+        EXPECT_DOUBLE_EQ(sketch.quantile(q), doubled.quantile(q)) << "q=" << q;
+    }
+}
+
+TEST_F(QuantileSketchTest, SerializationIsCompactAndRoundTrips) {
+    QuantileSketch sketch;
+    for (int i = 0; i < 100000; ++i) {
+        sketch.add(100.0 + (i * 7919 % 1000) / 10.0);
+    }
+
+    auto data = sketch.serialize();
+    EXPECT_LT(data.size(), 2048u);
+
+    auto restored = QuantileSketch::deserialize(data.data(), data.size());
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->count(), sketch.count());
+    EXPECT_DOUBLE_EQ(restored->min(), sketch.min());
+    EXPECT_DOUBLE_EQ(restored->max(), sketch.max());
+    for (double q : {0.1, 0.5, 0.9}) {
+        EXPECT_NEAR(restored->quantile(q), sketch.quantile(q), 1e-4);
+    }
+
+    EXPECT_FALSE(QuantileSketch::deserialize(data.data(), data.size() - 1).has_value());
+    EXPECT_FALSE(QuantileSketch::deserialize(nullptr, 0).has_value());
+}
+
+TEST_F(QuantileSketchTest, ConstReadsLeaveSharedSketchUnchanged) {
+    std::mt19937 rng(5);
+    std::normal_distribution<double> carry(150.0, 5.0);
+
+    // Fewer values than the buffer holds, so every read sees pending values
+    QuantileSketch sketch;
+    for (int i = 0; i < 300; ++i) {
+        sketch.add(carry(rng));
+    }
+    QuantileSketch flushed = sketch;
+    flushed.flush();
+    double median = flushed.quantile(0.5);
+    std::vector<std::uint8_t> bytes = flushed.serialize();
+
+    const QuantileSketch& shared = sketch;
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < 50; ++i) {
+                if (shared.quantile(0.5) != median || shared.serialize() != bytes ||
+                    shared.centroidCount() != flushed.centroidCount()) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
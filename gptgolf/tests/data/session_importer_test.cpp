@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "data/session_importer.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace gptgolf::data;
+
+class SessionImporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_import.db";
+        exportPath = "test_import_export.txt";
+        std::filesystem::remove(dbPath);
+        storage = std::make_unique<SQLiteStorage>(dbPath);
+    }
+
+    void TearDown() override {
+        storage.reset();
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(exportPath);
+    }
+
+    void writeExport(const std::string& contents) {
+        std::ofstream out(exportPath, std::ios::binary);
+        out << contents;
+    }
+
+    static std::string largeCsv(size_t rows) {
+        std::string csv = "Date,Club,Ball Speed,Launch Angle,Spin Rate,Carry,Side\n";
+        for (size_t i = 0; i < rows; ++i) {
+            csv += std::to_string(1700000000 + i) + ",\"" + (i % 2 ? "7 Iron" : "Driver") + "\"," +
+                   std::to_string(40 + i % 40) + "," + std::to_string(10 + i % 20) + "," +
+                   std::to_string(2000 + i % 5000) + "," + std::to_string(100 + i % 150) + ",-1.5\n";
+        }
+        return csv;
+    }
+
+    std::string dbPath;
+    std::string exportPath;
+    std::unique_ptr<SQLiteStorage> storage;
+};
+
+TEST_F(SessionImporterTest, ImportsTrackManCsvWithUnitsRow) {
+    writeExport(
+        "\xEF\xBB\xBF" "Date,Player,Club,Ball Speed,Launch Angle,Launch Direction,Spin Rate,Carry,Side\r\n"
+        ",,,[mph],[deg],[deg],[rpm],[yds],[yds]\r\n"
+        "5/1/2024 2:03:22 PM,Sam,\"7 Iron, Forged\",120.0,17.5,-1.2,6800,165.0,-3.0\r\n"
+        "5/1/2024 2:04:10 PM,Sam,Driver,250.0,11.0,0.5,2600,270.0,4.0\r\n"
+        "5/1/2024 2:05:00 PM,Sam,Driver,0,0,0,0,0,0\r\n");
+
+    SessionImporter importer(*storage);
+    ImportReport report = importer.importFile(exportPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsRead, 3u);
+    // A 250 mph ball speed and an empty reading fail ball data validation
+    EXPECT_EQ(report.rowsImported, 1u);
+    EXPECT_EQ(report.rowsRejected, 2u);
+    EXPECT_GT(report.rowsPerSecond(), 0.0);
+
+    auto shots = storage->getShotsByClub("7 Iron, Forged");
+    ASSERT_EQ(shots.size(), 1u);
+    EXPECT_NEAR(shots[0].initialVelocity, 120.0 * 0.44704, 1e-9);
+    EXPECT_NEAR(shots[0].actualDistance, 165.0 * 0.9144, 1e-9);
+    EXPECT_NEAR(shots[0].lateralDeviation, -3.0 * 0.9144, 1e-9);
+    EXPECT_DOUBLE_EQ(shots[0].spinRate, 6800.0);
+    EXPECT_DOUBLE_EQ(shots[0].launchAngle, 17.5);
+    // 2024-05-01 14:03:22 UTC
+    EXPECT_EQ(shots[0].timestamp, 1714572202);
+}
+
+TEST_F(SessionImporterTest, ImportsGcQuadCsvWithUnitsInHeader) {
+    writeExport(
+        "Club;Ball Speed (mph);VLA (deg);Total Spin (rpm);Carry (yds);Offline (yds);Date\n"
+        "PW;85.2;28.1;9100;118.4;2.1 L;2024-05-02T09:15:00\n"
+        "PW;86.0;27.4;8900;120.2;R 1.0;2024-05-02T09:16:00\n");
+
+    SessionImporter importer(*storage);
+    ImportReport report = importer.importFile(exportPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsImported, 2u);
+
+    auto shots = storage->getShotsByClub("PW");
+    ASSERT_EQ(shots.size(), 2u);
+    // Newest first
+    EXPECT_NEAR(shots[1].lateralDeviation, -2.1 * 0.9144, 1e-9);
+    EXPECT_NEAR(shots[0].lateralDeviation, 1.0 * 0.9144, 1e-9);
+    EXPECT_DOUBLE_EQ(shots[1].launchAngle, 28.1);
+    EXPECT_EQ(shots[1].timestamp, 1714641300);
+}
+
+TEST_F(SessionImporterTest, ImportsJsonArraysAndLines) {
+    writeExport(R"([
+        {"club": "Driver", "ballSpeed": 70.5, "launchAngle": 12.0, "spinRate": 2500, "carry": 240.0,
+         "timestamp": 1714641300, "notes": {"text": "windy {gusts}"}},
+        {"club": "Driver", "Ball Speed [mph]": "160", "launchAngle": 11.0, "spinRate": 2400, "carry": 250.0}
+    ])");
+    ImportOptions options;
+    options.fallbackTimestamp = 1714000000;
+    SessionImporter importer(*storage, options);
+    ImportReport report = importer.importFile(exportPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsImported, 2u);
+
+    auto shots = storage->getShotsByClub("Driver");
+    ASSERT_EQ(shots.size(), 2u);
+    EXPECT_EQ(shots[0].timestamp, 1714641300);
+    EXPECT_NEAR(shots[1].initialVelocity, 160.0 * 0.44704, 1e-9);
+    EXPECT_EQ(shots[1].timestamp, 1714000000);
+
+    writeExport("{\"club\": \"SW\", \"ballSpeed\": 30.0, \"spinRate\": 9000, \"carry\": 70}\n"
+                "not json\n"
+                "{\"club\": \"SW\", \"ballSpeed\": 31.0, \"spinRate\": 9100, \"carry\": 72}\n");
+    report = importer.importFile(exportPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsImported, 2u);
+    EXPECT_EQ(storage->getShotsByClub("SW").size(), 2u);
+}
+
+TEST_F(SessionImporterTest, ParallelChunksMatchSingleThreadedParse) {
+    std::string csv = largeCsv(20000);
+
+    ImportOptions serialOptions;
+    serialOptions.threads = 1;
+    serialOptions.chunkBytes = csv.size();
+    ImportReport serialReport;
+    auto serial = SessionImporter(*storage, serialOptions).parse(csv.data(), csv.size(), serialReport);
+
+    ImportOptions parallelOptions;
+    parallelOptions.threads = 4;
+    parallelOptions.chunkBytes = 4096;
+    ImportReport parallelReport;
+    auto parallel = SessionImporter(*storage, parallelOptions).parse(csv.data(), csv.size(), parallelReport);
+
+    ASSERT_EQ(serial.size(), 20000u);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        ASSERT_EQ(parallel[i].timestamp, serial[i].timestamp) << i;
+        ASSERT_EQ(parallel[i].clubUsed, serial[i].clubUsed) << i;
+        ASSERT_DOUBLE_EQ(parallel[i].actualDistance, serial[i].actualDistance) << i;
+    }
+    EXPECT_EQ(parallelReport.rowsRead, serialReport.rowsRead);
+}
+
+TEST_F(SessionImporterTest, RebuildsDeferredIndexes) {
+    writeExport(largeCsv(5000));
+    ImportOptions options;
+    options.transactionRows = 1000;
+    SessionImporter importer(*storage, options);
+    ImportReport report = importer.importFile(exportPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsImported, 5000u);
+    EXPECT_EQ(storage->getRecentShotsByClub("Driver", 10).size(), 10u);
+
+    sqlite3* db;
+    ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_shots_%'",
+                       -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 2);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    EXPECT_FALSE(importer.importFile("missing_export.csv").success);
+}
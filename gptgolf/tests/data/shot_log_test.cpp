@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include "data/shot_log.h"
+#include <filesystem>
+
+using namespace gptgolf::data;
+
+class ShotLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        logDir = "test_shot_log";
+        dbPath = "test_shot_log.db";
+        std::filesystem::remove_all(logDir);
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(logDir);
+        std::filesystem::remove(dbPath);
+    }
+
+    ShotData createTestShot(const std::string& club, double distance, std::time_t when) {
+        ShotData shot;
+        shot.initialVelocity = 60.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.predictedDistance = distance - 2.0;
+        shot.lateralDeviation = 1.5;
+        shot.timestamp = when;
+        shot.conditions.temperature = 21.5;
+        shot.conditions.humidity = 55.0;
+        shot.conditions.pressure = 1009.0;
+        shot.conditions.windSpeed = 4.2;
+        shot.conditions.windDirection = 270.0;
+        shot.conditions.precipitation = 0.4;
+        shot.conditions.altitude = 320.0;
+        shot.conditions.timestamp = when - 60;
+        return shot;
+    }
+
+    ShotLogConfig smallSegments(size_t records) {
+        ShotLogConfig config;
+        config.recordsPerSegment = records;
+        return config;
+    }
+
+    std::string logDir;
+    std::string dbPath;
+};
+
+TEST_F(ShotLogTest, CommittedRecordsRoundTrip) {
+    ShotLog log(logDir);
+    ASSERT_TRUE(log.append(createTestShot("Driver", 230.0, 1700000000)));
+    ASSERT_TRUE(log.append(createTestShot("7 Iron", 150.0, 1700000100)));
+    ASSERT_TRUE(log.commit());
+
+    auto segments = log.recentSegments(1);
+    ASSERT_EQ(segments.size(), 1u);
+    SegmentView view = log.openSegment(segments[0]);
+    ASSERT_EQ(view.size(), 2u);
+    EXPECT_FALSE(view.sealed());
+
+    ShotData shot = log.toShotData(view[1]);
+    EXPECT_EQ(shot.clubUsed, "7 Iron");
+    EXPECT_DOUBLE_EQ(shot.actualDistance, 150.0);
+    EXPECT_DOUBLE_EQ(shot.conditions.windDirection, 270.0);
+    EXPECT_EQ(shot.conditions.timestamp, 1700000040);
+}
+
+TEST_F(ShotLogTest, UncommittedRecordsAreInvisibleAndDiscarded) {
+    {
+        ShotLog log(logDir);
+        log.append(createTestShot("Driver", 230.0, 1700000000));
+        log.commit();
+        log.append(createTestShot("Driver", 231.0, 1700000001));
+
+        SegmentView view = log.openSegment(log.recentSegments(1)[0]);
+        EXPECT_EQ(view.size(), 1u);
+    }
+
+    // Reopening is recovery: only the committed record survives
+    ShotLog log(logDir);
+    log.append(createTestShot("PW", 110.0, 1700000002));
+    log.commit();
+
+    SegmentView view = log.openSegment(log.recentSegments(1)[0]);
+    ASSERT_EQ(view.size(), 2u);
+    EXPECT_EQ(log.toShotData(view[0]).clubUsed, "Driver");
+    EXPECT_EQ(log.toShotData(view[1]).clubUsed, "PW");
+}
+
+TEST_F(ShotLogTest, FullSegmentsAreSealed) {
+    ShotLog log(logDir, smallSegments(4));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(log.append(createTestShot("Driver", 200.0 + i, 1700000000 + i)));
+    }
+    log.commit();
+
+    auto sealed = log.sealedSegments();
+    ASSERT_EQ(sealed.size(), 2u);
+    SegmentView first = log.openSegment(sealed[0]);
+    EXPECT_TRUE(first.sealed());
+    EXPECT_EQ(first.size(), 4u);
+
+    auto recent = log.recentSegments(3);
+    ASSERT_EQ(recent.size(), 3u);
+    size_t total = 0;
+    for (auto segmentId : recent) {
+        total += log.openSegment(segmentId).size();
+    }
+    EXPECT_EQ(total, 10u);
+
+    // Sealed files are trimmed to their records
+    EXPECT_EQ(std::filesystem::file_size(logDir + "/segment-00000000000000000001.log"),
+              sizeof(SegmentHeader) + 4 * sizeof(ShotRecord));
+}
+
+TEST_F(ShotLogTest, ClubIdsSurviveReopen) {
+    {
+        ShotLog log(logDir);
+        log.append(createTestShot("Driver", 230.0, 1700000000));
+        log.append(createTestShot("Sand Wedge", 80.0, 1700000001));
+        log.commit();
+    }
+
+    ShotLog log(logDir);
+    log.append(createTestShot("Sand Wedge", 82.0, 1700000002));
+    log.commit();
+
+    SegmentView view = log.openSegment(log.recentSegments(1)[0]);
+    ASSERT_EQ(view.size(), 3u);
+    EXPECT_EQ(view[1].clubId, view[2].clubId);
+    EXPECT_EQ(log.clubName(view[2].clubId), "Sand Wedge");
+}
+
+TEST_F(ShotLogTest, CompactorStoresEachSegmentOnce) {
+    SQLiteStorage storage(dbPath);
+    {
+        ShotLog log(logDir, smallSegments(5));
+        for (int i = 0; i < 12; ++i) {
+            log.append(createTestShot(i % 2 ? "Driver" : "7 Iron", 150.0 + i, 1700000000 + i));
+        }
+        log.commit();
+
+        ShotLogCompactorConfig config;
+        config.retainSegments = 1;
+        ShotLogCompactor compactor(log, storage, config);
+        EXPECT_EQ(compactor.compactNow(), 2u);
+        EXPECT_EQ(compactor.compactedThrough(), 2u);
+        EXPECT_EQ(log.sealedSegments().size(), 1u);
+        EXPECT_EQ(compactor.compactNow(), 0u);
+    }
+    EXPECT_EQ(storage.getShotHistory(100).size(), 10u);
+
+    // A restarted compactor resumes from the stored checkpoint
+    ShotLog log(logDir, smallSegments(5));
+    log.seal();
+    ShotLogCompactor compactor(log, storage);
+    EXPECT_EQ(compactor.compactNow(), 1u);
+    EXPECT_EQ(storage.getShotHistory(100).size(), 12u);
+    EXPECT_EQ(storage.getShotsByClub("Driver").size(), 6u);
+}
+
+TEST_F(ShotLogTest, RestartNeverReusesCompactedSegmentIds) {
+    SQLiteStorage storage(dbPath);
+    ShotLogCompactorConfig config;
+    config.retainSegments = 0;
+    {
+        ShotLog log(logDir);
+        for (int i = 0; i < 3; ++i) {
+            log.append(createTestShot("Driver", 200.0 + i, 1700000000 + i));
+        }
+        log.seal();
+        ShotLogCompactor compactor(log, storage, config);
+        EXPECT_EQ(compactor.compactNow(), 1u);
+        EXPECT_TRUE(log.sealedSegments().empty());
+    }
+
+    // Every segment file is gone; the next segment must still get a new id
+    {
+        ShotLog log(logDir);
+        ShotLogCompactor compactor(log, storage, config);
+        log.append(createTestShot("Driver", 250.0, 1700000100));
+        log.seal();
+        ASSERT_EQ(log.sealedSegments().size(), 1u);
+        EXPECT_GT(log.sealedSegments()[0], 1u);
+        EXPECT_EQ(compactor.compactNow(), 1u);
+        EXPECT_TRUE(log.sealedSegments().empty());
+    }
+    EXPECT_EQ(storage.getShotHistory(100).size(), 4u);
+
+    // Without the sequence file the compactor's checkpoint still guards the ids
+    std::filesystem::remove(std::filesystem::path(logDir) / "segments.seq");
+    {
+        ShotLog log(logDir);
+        ShotLogCompactor compactor(log, storage, config);
+        log.append(createTestShot("7 Iron", 150.0, 1700000200));
+        log.seal();
+        EXPECT_EQ(compactor.compactNow(), 1u);
+    }
+    EXPECT_EQ(storage.getShotHistory(100).size(), 5u);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "data/shot_query.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <set>
+
+using namespace gptgolf::data;
+
+class ShotQueryTest : public ::testing::Test {
+protected:
+    static ShotData createTestShot(const std::string& club, double carry, std::time_t when,
+                                   double wind, double temperature) {
+        ShotData shot;
+        shot.initialVelocity = 60.0 + carry / 10.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.clubUsed = club;
+        shot.actualDistance = carry;
+        shot.predictedDistance = carry - 2.0;
+        shot.lateralDeviation = 1.5;
+        shot.timestamp = when;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.conditions.temperature = temperature;
+        shot.conditions.windSpeed = wind;
+        return shot;
+    }
+
+    // Random history: sessions of 40 shots, three hours apart
+    static std::vector<ShotData> randomHistory(size_t count, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> carry(80.0, 220.0);
+        std::uniform_real_distribution<double> wind(0.0, 12.0);
+        std::uniform_real_distribution<double> temperature(-5.0, 35.0);
+        std::uniform_int_distribution<int> club(0, 3);
+        std::uniform_int_distribution<int> quality(0, 9);
+        const char* clubs[] = {"Driver", "5 Iron", "7 Iron", "PW"};
+
+        std::vector<ShotData> shots;
+        std::time_t when = 1700000000;
+        for (size_t i = 0; i < count; ++i) {
+            when += (i % 40 == 0) ? 3 * 3600 : 30;
+            ShotData shot = createTestShot(clubs[club(rng)], carry(rng), when, wind(rng), temperature(rng));
+            int grade = quality(rng);
+            if (grade == 0) {
+                shot.actualDistance = 0.0;
+            } else if (grade == 1) {
+                shot.spinRate = 0.0;
+            }
+            shots.push_back(shot);
+        }
+        return shots;
+    }
+
+    static std::vector<std::uint32_t> bruteForce(const std::vector<ShotData>& shots,
+                                                 const std::function<bool(const ShotData&)>& match) {
+        std::vector<std::uint32_t> rows;
+        for (size_t i = 0; i < shots.size(); ++i) {
+            if (match(shots[i])) {
+                rows.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        return rows;
+    }
+
+    static double exactQuantile(std::vector<double> values, double q) {
+        std::sort(values.begin(), values.end());
+        double index = q * (values.size() - 1);
+        size_t lower = static_cast<size_t>(index);
+        size_t upper = std::min(lower + 1, values.size() - 1);
+        return values[lower] + (values[upper] - values[lower]) * (index - lower);
+    }
+};
+
+TEST_F(ShotQueryTest, RoaringBitmapMatchesSetOperations) {
+    std::mt19937 rng(5);
+    // Sparse ids spread over many containers, and a dense block inside one
+    std::uniform_int_distribution<std::uint32_t> sparse(0, 1u << 22);
+    std::uniform_int_distribution<std::uint32_t> dense(200000, 260000);
+
+    RoaringBitmap a, b;
+    std::set<std::uint32_t> setA, setB;
+    for (int i = 0; i < 20000; ++i) {
+        std::uint32_t x = sparse(rng);
+        std::uint32_t y = dense(rng);
+        a.add(x);
+        setA.insert(x);
+        a.add(y);
+        setA.insert(y);
+        std::uint32_t z = (i % 2) ? sparse(rng) : dense(rng);
+        b.add(z);
+        setB.insert(z);
+    }
+    b |= RoaringBitmap::range(230000, 240000);
+    for (std::uint32_t v = 230000; v < 240000; ++v) {
+        setB.insert(v);
+    }
+
+    EXPECT_EQ(a.cardinality(), setA.size());
+    EXPECT_EQ(a.toVector(), std::vector<std::uint32_t>(setA.begin(), setA.end()));
+
+    std::vector<std::uint32_t> expectedAnd, expectedOr;
+    std::set_intersection(setA.begin(), setA.end(), setB.begin(), setB.end(),
+                          std::back_inserter(expectedAnd));
+    std::set_union(setA.begin(), setA.end(), setB.begin(), setB.end(),
+                   std::back_inserter(expectedOr));
+    EXPECT_EQ((a & b).toVector(), expectedAnd);
+    EXPECT_EQ((a | b).toVector(), expectedOr);
+    EXPECT_EQ((a & b).cardinality(), expectedAnd.size());
+    EXPECT_EQ((a | b).cardinality(), expectedOr.size());
+
+    EXPECT_TRUE(b.contains(235000));
+    EXPECT_FALSE(RoaringBitmap::range(10, 20).contains(20));
+    EXPECT_EQ(RoaringBitmap::range(65530, 200000).cardinality(), 200000u - 65530u);
+    EXPECT_TRUE((RoaringBitmap::range(0, 100) & RoaringBitmap::range(100, 200)).empty());
+}
+
+TEST_F(ShotQueryTest, FiltersMatchBruteForce) {
+    std::vector<ShotData> shots = randomHistory(20000, 17);
+    ShotQueryEngine engine;
+    for (const auto& shot : shots) {
+        ASSERT_TRUE(engine.append(shot));
+    }
+    ASSERT_EQ(engine.rowCount(), shots.size());
+    EXPECT_EQ(engine.sessionCount(), 500u);
+
+    std::time_t since = shots[5000].timestamp;
+    std::time_t until = shots[15000].timestamp;
+    ShotFilter filter = ShotFilter::club("7 Iron") && ShotFilter::windSpeed(3.3, 7.1) &&
+                        ShotFilter::dateRange(since, until);
+    auto expected = bruteForce(shots, [&](const ShotData& s) {
+        float wind = static_cast<float>(s.conditions.windSpeed);
+        return s.clubUsed == "7 Iron" && wind >= 3.3 && wind <= 7.1 &&
+               s.timestamp >= since && s.timestamp <= until;
+    });
+    EXPECT_EQ(engine.select(filter).toVector(), expected);
+
+    ShotFilter either = (ShotFilter::club("Driver") || ShotFilter::temperature(30.0, 100.0)) &&
+                        ShotFilter::quality(ShotQuality::Good);
+    expected = bruteForce(shots, [&](const ShotData& s) {
+        float temperature = static_cast<float>(s.conditions.temperature);
+        return (s.clubUsed == "Driver" || temperature >= 30.0) &&
+               classifyShotQuality(s) == ShotQuality::Good;
+    });
+    EXPECT_EQ(engine.select(either).toVector(), expected);
+
+    expected = bruteForce(shots, [](const ShotData& s) { return classifyShotQuality(s) == ShotQuality::Poor; });
+    EXPECT_EQ(engine.select(ShotFilter::quality(ShotQuality::Poor)).toVector(), expected);
+
+    EXPECT_TRUE(engine.select(ShotFilter::club("Putter")).empty());
+    EXPECT_TRUE(engine.select(ShotFilter::windSpeed(5.0, 4.0)).empty());
+    EXPECT_EQ(engine.select(ShotFilter::all()).cardinality(), shots.size());
+}
+
+TEST_F(ShotQueryTest, SessionsSplitOnGaps) {
+    ShotQueryEngine engine;
+    std::time_t start = 1700000000;
+    ASSERT_TRUE(engine.append(createTestShot("7 Iron", 150.0, start, 1.0, 20.0)));
+    ASSERT_TRUE(engine.append(createTestShot("7 Iron", 152.0, start + 600, 1.0, 20.0)));
+    ASSERT_TRUE(engine.append(createTestShot("7 Iron", 148.0, start + 86400, 1.0, 20.0)));
+    EXPECT_FALSE(engine.append(createTestShot("7 Iron", 148.0, start + 60, 1.0, 20.0)));
+
+    ASSERT_EQ(engine.sessionCount(), 2u);
+    EXPECT_EQ(engine.sessionStart(1), start + 86400);
+    EXPECT_EQ(engine.select(ShotFilter::session(0)).toVector(), (std::vector<std::uint32_t>{0, 1}));
+    EXPECT_EQ(engine.select(ShotFilter::session(1)).toVector(), (std::vector<std::uint32_t>{2}));
+    EXPECT_TRUE(engine.select(ShotFilter::session(7)).empty());
+}
+
+TEST_F(ShotQueryTest, AggregatesMatchExactStatistics) {
+    std::vector<ShotData> shots = randomHistory(5000, 23);
+    ShotQueryEngine engine;
+    for (const auto& shot : shots) {
+        engine.append(shot);
+    }
+
+    auto byClub = engine.aggregateByClub(ShotFilter::quality(ShotQuality::Good), ShotMetric::Carry);
+    ASSERT_EQ(byClub.size(), 4u);
+    for (const auto& [club, aggregate] : byClub) {
+        std::vector<double> values;
+        for (const auto& shot : shots) {
+            if (shot.clubUsed == club && classifyShotQuality(shot) == ShotQuality::Good) {
+                values.push_back(static_cast<float>(shot.actualDistance));
+            }
+        }
+        ASSERT_EQ(aggregate.count, values.size()) << club;
+        double mean = 0.0;
+        for (double v : values) mean += v;
+        mean /= values.size();
+        double variance = 0.0;
+        for (double v : values) variance += (v - mean) * (v - mean);
+
+        EXPECT_NEAR(aggregate.mean, mean, 1e-6) << club;
+        EXPECT_NEAR(aggregate.stdDev, std::sqrt(variance / values.size()), 1e-6) << club;
+        EXPECT_DOUBLE_EQ(aggregate.min, *std::min_element(values.begin(), values.end()));
+        EXPECT_DOUBLE_EQ(aggregate.max, *std::max_element(values.begin(), values.end()));
+        EXPECT_NEAR(aggregate.p10, exactQuantile(values, 0.1), 1e-9) << club;
+        EXPECT_NEAR(aggregate.p50, exactQuantile(values, 0.5), 1e-9) << club;
+        EXPECT_NEAR(aggregate.p90, exactQuantile(values, 0.9), 1e-9) << club;
+    }
+
+    ShotAggregate none = engine.aggregate(ShotFilter::club("Putter"), ShotMetric::Carry);
+    EXPECT_EQ(none.count, 0u);
+    EXPECT_TRUE(std::isnan(none.mean));
+    EXPECT_TRUE(std::isnan(none.p50));
+}
+
+TEST_F(ShotQueryTest, LoadsFromStorage) {
+    const std::string dbPath = "test_shot_query.db";
+    std::filesystem::remove(dbPath);
+    {
+        SQLiteStorage storage(dbPath);
+        std::vector<ShotData> shots = randomHistory(300, 31);
+        ASSERT_TRUE(storage.saveShotBatch(shots));
+
+        ShotQueryEngine engine;
+        EXPECT_EQ(engine.load(storage), shots.size());
+        EXPECT_EQ(engine.sessionCount(), 8u);
+        auto expected = bruteForce(shots, [](const ShotData& s) { return s.clubUsed == "PW"; });
+        EXPECT_EQ(engine.select(ShotFilter::club("PW")).cardinality(), expected.size());
+        EXPECT_GT(engine.sizeInBytes(), 300u * 8u * sizeof(float));
+    }
+    std::filesystem::remove(dbPath);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "data/shot_snapshot.h"
+#include "ml/prediction_model.h"
+#include <filesystem>
+
+using namespace gptgolf::data;
+
+namespace {
+
+// Exposes fitted weights for comparison
+class InspectableModel : public gptgolf::ml::PredictionModel {
+public:
+    using PredictionModel::PredictionModel;
+    const std::map<std::string, std::vector<double>>& weights() const { return clubWeights_; }
+};
+
+} // namespace
+
+class ShotSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_snapshot.db";
+        snapshotDir = "test_snapshots";
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove_all(snapshotDir);
+        storage = std::make_unique<SQLiteStorage>(dbPath);
+    }
+
+    void TearDown() override {
+        storage.reset();
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove_all(snapshotDir);
+    }
+
+    ShotData createTestShot(const std::string& club, double distance, std::time_t when, double wind) {
+        ShotData shot;
+        shot.initialVelocity = 60.0 + distance / 10.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.predictedDistance = distance - 2.0;
+        shot.lateralDeviation = 1.5;
+        shot.timestamp = when;
+        shot.conditions.temperature = 21.5;
+        shot.conditions.humidity = 55.0;
+        shot.conditions.pressure = 1009.0;
+        shot.conditions.windSpeed = wind;
+        shot.conditions.windDirection = 270.0;
+        shot.conditions.precipitation = 0.0;
+        shot.conditions.altitude = 320.0;
+        shot.conditions.timestamp = when - 60;
+        return shot;
+    }
+
+    // 3 clubs x 300 shots, one per hour, wind cycling 0-9 m/s
+    std::vector<ShotData> populate() {
+        std::vector<ShotData> shots;
+        const char* clubs[] = {"Driver", "7 Iron", "PW"};
+        for (int c = 0; c < 3; ++c) {
+            for (int i = 0; i < 300; ++i) {
+                shots.push_back(createTestShot(clubs[c], 100.0 + 50.0 * c + (i % 20),
+                                               1700000000 + i * 3600, i % 10));
+            }
+        }
+        storage->saveShotBatch(shots);
+        return shots;
+    }
+
+    std::string dbPath;
+    std::string snapshotDir;
+    std::unique_ptr<SQLiteStorage> storage;
+};
+
+TEST_F(ShotSnapshotTest, ExportRoundTripsEveryShot) {
+    populate();
+    SnapshotExporterConfig config;
+    config.blockRows = 128;
+    SnapshotExporter exporter(*storage, snapshotDir, config);
+    std::string path = exporter.exportNow();
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(exporter.latestSnapshot(), path);
+
+    ShotSnapshot snapshot(path);
+    EXPECT_EQ(snapshot.rowCount(), 900u);
+    EXPECT_EQ(snapshot.blockCount(), 8u);
+    EXPECT_EQ(snapshot.clubs().size(), 3u);
+
+    size_t rows = 0;
+    for (const auto& block : snapshot.selectBlocks()) {
+        EXPECT_TRUE(block.allMatch);
+        rows += block.rows;
+    }
+    EXPECT_EQ(rows, 900u);
+
+    auto first = snapshot.selectBlocks().front();
+    ShotData shot = snapshot.shotAt(first, 0);
+    EXPECT_EQ(shot.clubUsed, "7 Iron");  // Grouped by club name
+    EXPECT_EQ(shot.timestamp, 1700000000);
+    EXPECT_DOUBLE_EQ(shot.conditions.pressure, 1009.0);
+    EXPECT_EQ(shot.conditions.timestamp, 1700000000 - 60);
+}
+
+TEST_F(ShotSnapshotTest, ZoneMapsSkipBlocks) {
+    populate();
+    SnapshotExporterConfig config;
+    config.blockRows = 100;
+    SnapshotExporter exporter(*storage, snapshotDir, config);
+    ShotSnapshot snapshot(exporter.exportNow());
+    ASSERT_EQ(snapshot.blockCount(), 9u);
+
+    // Each club fills exactly three blocks
+    SnapshotPredicate byClub;
+    byClub.club = "PW";
+    auto blocks = snapshot.selectBlocks(byClub);
+    ASSERT_EQ(blocks.size(), 3u);
+    EXPECT_TRUE(blocks[0].allMatch);
+
+    // The last 50 hours of every club fall in one block each
+    SnapshotPredicate recent;
+    recent.since = 1700000000 + 250 * 3600;
+    blocks = snapshot.selectBlocks(recent);
+    ASSERT_EQ(blocks.size(), 3u);
+    size_t matching = 0;
+    for (const auto& block : blocks) {
+        for (size_t row = 0; row < block.rows; ++row) {
+            matching += block.matches(row) ? 1 : 0;
+        }
+    }
+    EXPECT_EQ(matching, 150u);
+
+    SnapshotPredicate calm;
+    calm.maxWindSpeed = 2.0;
+    calm.club = "Driver";
+    matching = 0;
+    for (const auto& block : snapshot.selectBlocks(calm)) {
+        EXPECT_FALSE(block.allMatch);
+        for (size_t row = 0; row < block.rows; ++row) {
+            matching += block.matches(row) ? 1 : 0;
+        }
+    }
+    EXPECT_EQ(matching, 90u);
+
+    SnapshotPredicate unknown;
+    unknown.club = "Putter";
+    EXPECT_TRUE(snapshot.selectBlocks(unknown).empty());
+}
+
+TEST_F(ShotSnapshotTest, ExporterKeepsNewestSnapshots) {
+    populate();
+    SnapshotExporterConfig config;
+    config.retainSnapshots = 2;
+    SnapshotExporter exporter(*storage, snapshotDir, config);
+    std::vector<std::string> paths;
+    for (int i = 0; i < 3; ++i) {
+        paths.push_back(exporter.exportNow());
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_FALSE(std::filesystem::exists(paths[0]));
+    EXPECT_TRUE(std::filesystem::exists(paths[1]));
+    EXPECT_EQ(exporter.latestSnapshot(), paths[2]);
+}
+
+TEST_F(ShotSnapshotTest, TrainingFromSnapshotMatchesShotVectors) {
+    auto shots = populate();
+    gptgolf::ml::DataCollector collector(*storage);
+
+    InspectableModel fromShots(*storage, collector);
+    fromShots.train(shots);
+
+    SnapshotExporter exporter(*storage, snapshotDir);
+    ShotSnapshot snapshot(exporter.exportNow());
+    InspectableModel fromSnapshot(*storage, collector);
+    fromSnapshot.train(snapshot);
+
+    ASSERT_EQ(fromSnapshot.weights().size(), 3u);
+    for (const auto& [club, weights] : fromShots.weights()) {
+        ASSERT_EQ(fromSnapshot.weights().count(club), 1u);
+        const auto& other = fromSnapshot.weights().at(club);
+        for (size_t i = 0; i < weights.size(); ++i) {
+            EXPECT_DOUBLE_EQ(weights[i], other[i]) << club << " weight " << i;
+        }
+    }
+
+    SnapshotPredicate tooNarrow;
+    tooNarrow.club = "PW";
+    tooNarrow.until = 1700000000 + 5 * 3600;
+    EXPECT_THROW(fromSnapshot.train(snapshot, tooNarrow), std::runtime_error);
+}
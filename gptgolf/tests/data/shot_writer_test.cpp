@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "data/shot_writer.h"
+#include <filesystem>
+#include <thread>
+
+using namespace gptgolf::data;
+
+class ShotWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_writer.db";
+        removeDatabase();
+    }
+
+    void TearDown() override {
+        removeDatabase();
+    }
+
+    void removeDatabase() {
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(dbPath + "-wal");
+        std::filesystem::remove(dbPath + "-shm");
+    }
+
+    ShotData createTestShot(const std::string& club, double distance) {
+        ShotData shot;
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.initialVelocity = 55.0;
+        shot.spinRate = 5000.0;
+        shot.launchAngle = 18.0;
+        return shot;
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(ShotWriterTest, BatchesAreAcknowledgedWhenDurable) {
+    ShotWriterConfig config;
+    config.maxBatchSize = 10;
+    config.maxBatchDelay = std::chrono::milliseconds(1000);
+    ShotWriter writer(dbPath, config);
+
+    std::vector<std::shared_future<bool>> acks;
+    for (int i = 0; i < 10; ++i) {
+        acks.push_back(writer.enqueue(createTestShot("7 Iron", 150.0 + i)));
+    }
+    // A full batch commits without waiting for the delay
+    ASSERT_EQ(acks.back().wait_for(std::chrono::milliseconds(500)), std::future_status::ready);
+    for (auto& ack : acks) {
+        EXPECT_TRUE(ack.get());
+    }
+
+    SQLiteStorage reader(dbPath);
+    EXPECT_EQ(reader.getShotsByClub("7 Iron").size(), 10u);
+
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.shotsWritten, 10u);
+    EXPECT_EQ(stats.batchesCommitted, 1u);
+    EXPECT_EQ(stats.pendingShots, 0u);
+}
+
+TEST_F(ShotWriterTest, PartialBatchCommitsAfterDelay) {
+    ShotWriterConfig config;
+    config.maxBatchSize = 1000;
+    config.maxBatchDelay = std::chrono::milliseconds(10);
+    ShotWriter writer(dbPath, config);
+
+    auto ack = writer.enqueue(createTestShot("Driver", 240.0));
+    ASSERT_EQ(ack.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_TRUE(ack.get());
+}
+
+TEST_F(ShotWriterTest, ConcurrentProducersAndFlush) {
+    ShotWriterConfig config;
+    config.maxBatchSize = 256;
+    ShotWriter writer(dbPath, config);
+
+    const int producers = 4;
+    const int perProducer = 2500;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                writer.enqueue(createTestShot("Club " + std::to_string(p), i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(writer.flush());
+    EXPECT_EQ(writer.getStats().shotsWritten, static_cast<size_t>(producers * perProducer));
+
+    SQLiteStorage reader(dbPath);
+    EXPECT_EQ(reader.getShotHistory(producers * perProducer + 1).size(),
+              static_cast<size_t>(producers * perProducer));
+}
+
+TEST_F(ShotWriterTest, DestructorDrainsQueue) {
+    {
+        ShotWriterConfig config;
+        config.maxBatchDelay = std::chrono::milliseconds(10000);
+        ShotWriter writer(dbPath, config);
+        for (int i = 0; i < 5; ++i) {
+            writer.enqueue(createTestShot("9 Iron", 120.0 + i));
+        }
+    }
+
+    SQLiteStorage reader(dbPath);
+    EXPECT_EQ(reader.getShotsByClub("9 Iron").size(), 5u);
+}
@@ -0,0 +1,457 @@
+#include <gtest/gtest.h>
+#include "data/sqlite_storage.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+using namespace gptgolf::data;
+
+class SQLiteStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_shots.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(dbPath + "-wal");
+        std::filesystem::remove(dbPath + "-shm");
+    }
+
+    SQLiteOptions pooledOptions(size_t readers) {
+        SQLiteOptions options;
+        options.walMode = true;
+        options.synchronous = SynchronousLevel::NORMAL;
+        options.readerConnections = readers;
+        return options;
+    }
+
+    ShotData createTestShot(const std::string& club, double distance, std::time_t when) {
+        ShotData shot;
+        shot.initialVelocity = 60.0;
+        shot.spinRate = 3000.0;
+        shot.launchAngle = 14.0;
+        shot.clubUsed = club;
+        shot.actualDistance = distance;
+        shot.predictedDistance = distance - 2.0;
+        shot.lateralDeviation = 1.5;
+        shot.timestamp = when;
+        shot.conditions.temperature = 21.5;
+        shot.conditions.humidity = 55.0;
+        shot.conditions.pressure = 1009.0;
+        shot.conditions.windSpeed = 4.2;
+        shot.conditions.windDirection = 270.0;
+        shot.conditions.precipitation = 0.4;
+        shot.conditions.altitude = 320.0;
+        shot.conditions.timestamp = when - 60;
+        return shot;
+    }
+
+    // Builds a database in the pre-migration layout with JSON weather blobs
+    void createLegacyDatabase(int rows) {
+        sqlite3* db;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        sqlite3_exec(db, R"(
+            CREATE TABLE shots (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                initial_velocity REAL NOT NULL,
+                spin_rate REAL NOT NULL,
+                launch_angle REAL NOT NULL,
+                weather_data TEXT NOT NULL,
+                club_used TEXT NOT NULL,
+                actual_distance REAL NOT NULL,
+                predicted_distance REAL NOT NULL,
+                lateral_deviation REAL NOT NULL,
+                timestamp INTEGER NOT NULL
+            );
+            BEGIN;
+        )", nullptr, nullptr, nullptr);
+
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, R"(
+            INSERT INTO shots (initial_velocity, spin_rate, launch_angle, weather_data,
+                               club_used, actual_distance, predicted_distance,
+                               lateral_deviation, timestamp)
+            VALUES (50, 2500, 12, ?, '7 Iron', ?, 150, 1, ?)
+        )", -1, &stmt, nullptr);
+        for (int i = 0; i < rows; ++i) {
+            std::string weather = R"({"temperature":18.0,"humidity":60.0,"pressure":1012.0,)"
+                                  R"("windSpeed":3.0,"windDirection":90.0})";
+            sqlite3_bind_text(stmt, 1, weather.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(stmt, 2, 140.0 + i);
+            sqlite3_bind_int64(stmt, 3, 1700000000 + i);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(SQLiteStorageTest, RoundTripsAllWeatherFields) {
+    SQLiteStorage storage(dbPath);
+    ShotData shot = createTestShot("Driver", 230.0, 1700000000);
+    ASSERT_TRUE(storage.saveShotData(shot));
+
+    auto shots = storage.getShotHistory(10);
+    ASSERT_EQ(shots.size(), 1u);
+    const auto& loaded = shots.front();
+    EXPECT_EQ(loaded.clubUsed, "Driver");
+    EXPECT_DOUBLE_EQ(loaded.actualDistance, 230.0);
+    EXPECT_DOUBLE_EQ(loaded.conditions.temperature, 21.5);
+    EXPECT_DOUBLE_EQ(loaded.conditions.windDirection, 270.0);
+    EXPECT_DOUBLE_EQ(loaded.conditions.precipitation, 0.4);
+    EXPECT_DOUBLE_EQ(loaded.conditions.altitude, 320.0);
+    EXPECT_EQ(loaded.conditions.timestamp, shot.conditions.timestamp);
+    EXPECT_EQ(loaded.timestamp, shot.timestamp);
+}
+
+TEST_F(SQLiteStorageTest, ShotsByClubNewestFirst) {
+    SQLiteStorage storage(dbPath);
+    storage.saveShotData(createTestShot("7 Iron", 150.0, 1700000000));
+    storage.saveShotData(createTestShot("Driver", 230.0, 1700000100));
+    storage.saveShotData(createTestShot("7 Iron", 155.0, 1700000200));
+
+    auto shots = storage.getShotsByClub("7 Iron");
+    ASSERT_EQ(shots.size(), 2u);
+    EXPECT_DOUBLE_EQ(shots[0].actualDistance, 155.0);
+    EXPECT_DOUBLE_EQ(shots[1].actualDistance, 150.0);
+}
+
+TEST_F(SQLiteStorageTest, MigratesLegacyJsonWeather) {
+    createLegacyDatabase(12000);
+
+    SQLiteStorage storage(dbPath);
+    auto shots = storage.getShotsByClub("7 Iron");
+    ASSERT_EQ(shots.size(), 12000u);
+
+    const auto& newest = shots.front();
+    EXPECT_DOUBLE_EQ(newest.actualDistance, 140.0 + 11999);
+    EXPECT_DOUBLE_EQ(newest.conditions.temperature, 18.0);
+    EXPECT_DOUBLE_EQ(newest.conditions.humidity, 60.0);
+    EXPECT_DOUBLE_EQ(newest.conditions.pressure, 1012.0);
+    EXPECT_DOUBLE_EQ(newest.conditions.windSpeed, 3.0);
+    EXPECT_DOUBLE_EQ(newest.conditions.windDirection, 90.0);
+    // Fields the legacy format never stored
+    EXPECT_DOUBLE_EQ(newest.conditions.precipitation, 0.0);
+    EXPECT_DOUBLE_EQ(newest.conditions.altitude, 0.0);
+    EXPECT_EQ(newest.conditions.timestamp, newest.timestamp);
+
+    // New shots go into the typed layout alongside migrated rows
+    EXPECT_TRUE(storage.saveShotData(createTestShot("7 Iron", 160.0, 1800000000)));
+    EXPECT_DOUBLE_EQ(storage.getShotHistory(1).front().conditions.altitude, 320.0);
+}
+
+TEST_F(SQLiteStorageTest, MigrationIsIdempotentOnReopen) {
+    createLegacyDatabase(10);
+    { SQLiteStorage first(dbPath); }
+
+    SQLiteStorage second(dbPath);
+    EXPECT_EQ(second.getShotHistory(100).size(), 10u);
+}
+
+TEST_F(SQLiteStorageTest, MigrationRecordsSchemaVersion) {
+    createLegacyDatabase(10);
+    { SQLiteStorage storage(dbPath); }
+
+    sqlite3* db;
+    ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 1);
+    sqlite3_finalize(stmt);
+    ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM pragma_table_info('shots') "
+                                     "WHERE name = 'weather_data'", -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+TEST_F(SQLiteStorageTest, KeysetPaginationCoversEveryShotOnce) {
+    SQLiteStorage storage(dbPath);
+    // Duplicate timestamps exercise the id tie-breaker
+    for (int i = 0; i < 25; ++i) {
+        storage.saveShotData(createTestShot(i % 2 ? "7 Iron" : "Driver", 100.0 + i,
+                                            1700000000 + i / 2));
+    }
+
+    std::vector<double> seen;
+    std::optional<ShotPageKey> key;
+    size_t pages = 0;
+    do {
+        auto page = storage.getShotHistoryPage(10, key);
+        for (const auto& shot : page.shots) {
+            seen.push_back(shot.actualDistance);
+        }
+        key = page.nextKey;
+        ++pages;
+    } while (key);
+
+    EXPECT_EQ(pages, 3u);
+    ASSERT_EQ(seen.size(), 25u);
+    std::sort(seen.begin(), seen.end());
+    EXPECT_TRUE(std::adjacent_find(seen.begin(), seen.end()) == seen.end());
+
+    auto ironPage = storage.getShotsByClubPage("7 Iron", 5);
+    ASSERT_EQ(ironPage.shots.size(), 5u);
+    ASSERT_TRUE(ironPage.nextKey.has_value());
+    auto ironRest = storage.getShotsByClubPage("7 Iron", 20, ironPage.nextKey);
+    EXPECT_EQ(ironRest.shots.size(), 7u);
+    EXPECT_FALSE(ironRest.nextKey.has_value());
+    EXPECT_GE(ironPage.shots.back().timestamp, ironRest.shots.front().timestamp);
+}
+
+TEST_F(SQLiteStorageTest, CursorStreamsChronologically) {
+    SQLiteStorage storage(dbPath);
+    for (int i = 0; i < 10; ++i) {
+        storage.saveShotData(createTestShot(i % 2 ? "7 Iron" : "Driver", 100.0 + i,
+                                            1700000000 + i));
+    }
+
+    ShotCursor cursor = storage.openShotCursor("7 Iron", 1700000004);
+    ShotData shot;
+    std::vector<std::time_t> times;
+    while (cursor.next(shot)) {
+        EXPECT_EQ(shot.clubUsed, "7 Iron");
+        times.push_back(shot.timestamp);
+    }
+    EXPECT_EQ(times, (std::vector<std::time_t>{1700000005, 1700000007, 1700000009}));
+    EXPECT_FALSE(cursor.next(shot));
+
+    size_t all = 0;
+    for (ShotCursor everything = storage.openShotCursor(); everything.next(shot);) {
+        ++all;
+    }
+    EXPECT_EQ(all, 10u);
+}
+
+TEST_F(SQLiteStorageTest, CursorOnWriterHoldsWriteLockUntilDone) {
+    SQLiteStorage storage(dbPath);
+    for (int i = 0; i < 3; ++i) {
+        storage.saveShotData(createTestShot("7 Iron", 150.0 + i, 1700000000 + i));
+    }
+
+    ShotCursor cursor = storage.openShotCursor();
+    ShotData shot;
+    ASSERT_TRUE(cursor.next(shot));
+
+    // Without a reader pool the cursor shares the writer connection, so
+    // writes wait for it instead of stepping the connection underneath it
+    std::atomic<bool> saved{false};
+    std::thread writer([&] {
+        EXPECT_TRUE(storage.saveShotData(createTestShot("7 Iron", 170.0, 1700000100)));
+        saved = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(saved.load());
+
+    size_t streamed = 1;
+    while (cursor.next(shot)) {
+        ++streamed;
+    }
+    writer.join();
+    EXPECT_EQ(streamed, 3u);
+    EXPECT_FALSE(cursor.failed());
+    EXPECT_TRUE(saved.load());
+    EXPECT_EQ(storage.getShotsByClub("7 Iron").size(), 4u);
+}
+
+TEST_F(SQLiteStorageTest, ClubQueriesUseCompositeIndex) {
+    { SQLiteStorage storage(dbPath); }
+
+    sqlite3* db;
+    ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(db, R"(
+        EXPLAIN QUERY PLAN SELECT * FROM shots
+        WHERE club_used = 'Driver' ORDER BY timestamp DESC
+    )", -1, &stmt, nullptr), SQLITE_OK);
+
+    std::string plan;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        plan += reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        plan += "\n";
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    EXPECT_NE(plan.find("idx_shots_club_time"), std::string::npos) << plan;
+    EXPECT_EQ(plan.find("TEMP B-TREE"), std::string::npos) << plan;
+}
+
+TEST_F(SQLiteStorageTest, PooledReadersSeeCommittedWrites) {
+    SQLiteStorage storage(dbPath, pooledOptions(2));
+    storage.saveShotData(createTestShot("Driver", 230.0, 1700000000));
+
+    ClubProfile club;
+    club.name = "Driver";
+    club.avgDistance = 230.0;
+    ASSERT_TRUE(storage.saveClubProfile(club));
+    ASSERT_TRUE(storage.savePreference("units", "metric"));
+
+    EXPECT_EQ(storage.getShotsByClub("Driver").size(), 1u);
+    EXPECT_DOUBLE_EQ(storage.getClubProfile("Driver")->avgDistance, 230.0);
+    EXPECT_EQ(storage.getAllClubProfiles().size(), 1u);
+    EXPECT_EQ(storage.getPreference("units"), "metric");
+
+    // Reusing cached statements must not carry over bindings or results
+    EXPECT_FALSE(storage.getClubProfile("Putter").has_value());
+    EXPECT_EQ(storage.getPreference("missing", "none"), "none");
+}
+
+TEST_F(SQLiteStorageTest, CursorHoldsSnapshotWhileWritesContinue) {
+    SQLiteStorage storage(dbPath, pooledOptions(2));
+    for (int i = 0; i < 5; ++i) {
+        storage.saveShotData(createTestShot("7 Iron", 150.0 + i, 1700000000 + i));
+    }
+
+    ShotCursor cursor = storage.openShotCursor();
+    ShotData shot;
+    ASSERT_TRUE(cursor.next(shot));
+
+    // Writer is not blocked by the open cursor, which keeps its snapshot
+    EXPECT_TRUE(storage.saveShotData(createTestShot("7 Iron", 170.0, 1700000100)));
+    size_t streamed = 1;
+    while (cursor.next(shot)) {
+        ++streamed;
+    }
+    EXPECT_EQ(streamed, 5u);
+    EXPECT_EQ(storage.getShotsByClub("7 Iron").size(), 6u);
+}
+
+TEST_F(SQLiteStorageTest, ConcurrentReadersDuringIngest) {
+    SQLiteStorage storage(dbPath, pooledOptions(4));
+    std::atomic<bool> writing{true};
+    std::atomic<size_t> reads{0};
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 500; ++i) {
+            storage.saveShotData(createTestShot(i % 2 ? "7 Iron" : "Driver", i, 1700000000 + i));
+        }
+        writing = false;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (writing) {
+                auto page = storage.getShotsByClubPage("Driver", 20);
+                EXPECT_LE(page.shots.size(), 20u);
+                ++reads;
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(storage.getShotHistory(1000).size(), 500u);
+}
+
+TEST_F(SQLiteStorageTest, ChangeFeedReadsWritesInBatches) {
+    SQLiteStorage storage(dbPath);
+    std::time_t now = std::time(nullptr);
+    ASSERT_TRUE(storage.saveShotData(createTestShot("7 Iron", 150.0, now)));
+    ASSERT_TRUE(storage.saveShotBatch({createTestShot("Driver", 230.0, now + 1),
+                                       createTestShot("PW", 110.0, now + 2)}));
+
+    ClubProfile club;
+    club.name = "7 Iron";
+    club.avgDistance = 150.0;
+    club.lastUpdated = now;
+    ASSERT_TRUE(storage.saveClubProfile(club));
+    club.avgDistance = 152.0;
+    ASSERT_TRUE(storage.updateClubProfile(club));
+    EXPECT_EQ(storage.latestChangeSeq(), 5);
+
+    ChangeBatch first = storage.readChangesSince(0, 3);
+    ASSERT_EQ(first.changes.size(), 3u);
+    EXPECT_TRUE(first.hasMore);
+    EXPECT_FALSE(first.resyncRequired);
+    EXPECT_EQ(first.lastSeq, 3);
+    EXPECT_EQ(first.changes[0].entity, ChangeEntity::Shot);
+    EXPECT_EQ(first.changes[0].operation, ChangeOperation::Insert);
+    ASSERT_TRUE(first.changes[1].shot.has_value());
+    EXPECT_EQ(first.changes[1].shot->clubUsed, "Driver");
+    EXPECT_EQ(first.changes[2].shot->timestamp, now + 2);
+    EXPECT_GE(first.changes[0].changedAt, now - 1);
+
+    ChangeBatch second = storage.readChangesSince(first.lastSeq, 3);
+    ASSERT_EQ(second.changes.size(), 2u);
+    EXPECT_FALSE(second.hasMore);
+    EXPECT_EQ(second.changes[0].entity, ChangeEntity::Club);
+    EXPECT_EQ(second.changes[0].operation, ChangeOperation::Insert);
+    EXPECT_EQ(second.changes[1].operation, ChangeOperation::Update);
+    EXPECT_EQ(second.changes[1].clubName, "7 Iron");
+    // Payloads reflect the row at read time
+    ASSERT_TRUE(second.changes[0].club.has_value());
+    EXPECT_DOUBLE_EQ(second.changes[0].club->avgDistance, 152.0);
+
+    ChangeBatch caughtUp = storage.readChangesSince(second.lastSeq, 3);
+    EXPECT_TRUE(caughtUp.changes.empty());
+    EXPECT_EQ(caughtUp.lastSeq, second.lastSeq);
+}
+
+TEST_F(SQLiteStorageTest, ChangeFeedPruningSignalsResync) {
+    {
+        SQLiteStorage storage(dbPath);
+        std::time_t now = std::time(nullptr);
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(storage.saveShotData(createTestShot("7 Iron", 150.0 + i, now + i)));
+        }
+
+        ChangeRetention retention;
+        retention.acknowledgedSeq = 4;
+        EXPECT_EQ(storage.pruneChanges(retention), 4u);
+        EXPECT_FALSE(storage.readChangesSince(4, 10).resyncRequired);
+        EXPECT_TRUE(storage.readChangesSince(2, 10).resyncRequired);
+
+        // Starting from 0 reads from the oldest retained change
+        ChangeBatch fromStart = storage.readChangesSince(0, 10);
+        EXPECT_FALSE(fromStart.resyncRequired);
+        ASSERT_EQ(fromStart.changes.size(), 6u);
+        EXPECT_EQ(fromStart.changes.front().seq, 5);
+
+        retention = ChangeRetention();
+        retention.maxChanges = 3;
+        EXPECT_EQ(storage.pruneChanges(retention), 3u);
+        ChangeBatch lagging = storage.readChangesSince(4, 10);
+        EXPECT_TRUE(lagging.resyncRequired);
+        ASSERT_EQ(lagging.changes.size(), 3u);
+        EXPECT_EQ(lagging.changes.front().seq, 8);
+
+        // The newest change survives so that the gap stays visible
+        retention.acknowledgedSeq = 10;
+        EXPECT_EQ(storage.pruneChanges(retention), 2u);
+        EXPECT_EQ(storage.latestChangeSeq(), 10);
+        EXPECT_TRUE(storage.readChangesSince(10, 10).changes.empty());
+    }
+
+    // Seqs are never reused after pruning
+    SQLiteStorage reopened(dbPath);
+    ASSERT_TRUE(reopened.saveShotData(createTestShot("PW", 110.0, std::time(nullptr))));
+    EXPECT_EQ(reopened.latestChangeSeq(), 11);
+}
+
+TEST_F(SQLiteStorageTest, ChangeFeedSkipsMigrationBackfill) {
+    createLegacyDatabase(50);
+    SQLiteStorage storage(dbPath);
+    EXPECT_EQ(storage.latestChangeSeq(), 0);
+
+    ASSERT_TRUE(storage.saveShotData(createTestShot("7 Iron", 150.0, std::time(nullptr))));
+    ChangeBatch batch = storage.readChangesSince(0, 10);
+    ASSERT_EQ(batch.changes.size(), 1u);
+    EXPECT_EQ(batch.changes[0].shotId, 51);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "data/statement_cache.h"
+#include "data/sqlite_storage.h"
+#include "weather/weather_storage.h"
+#include <filesystem>
+
+using namespace gptgolf::data;
+
+class StatementCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_statement_cache.db";
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(dbPath + "-wal");
+        std::filesystem::remove(dbPath + "-shm");
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(dbPath + "-wal");
+        std::filesystem::remove(dbPath + "-shm");
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(StatementCacheTest, ReusesStatementsWithFreshBindings) {
+    sqlite3* db;
+    ASSERT_EQ(sqlite3_open(":memory:", &db), SQLITE_OK);
+    {
+        StatementCache cache(db);
+        const std::string sql = "SELECT ?1 IS NULL, ?1";
+
+        sqlite3_stmt* first = cache.prepare(sql);
+        ASSERT_NE(first, nullptr);
+        sqlite3_bind_int(first, 1, 42);
+        ASSERT_EQ(sqlite3_step(first), SQLITE_ROW);
+        EXPECT_EQ(sqlite3_column_int(first, 1), 42);
+
+        // Handed out again mid-row: reset, and the old binding is gone
+        sqlite3_stmt* second = cache.prepare(sql);
+        EXPECT_EQ(second, first);
+        ASSERT_EQ(sqlite3_step(second), SQLITE_ROW);
+        EXPECT_EQ(sqlite3_column_int(second, 0), 1);
+
+        EXPECT_EQ(cache.prepare("SELEC nonsense"), nullptr);
+
+        auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 1u);
+        EXPECT_EQ(stats.misses, 2u);
+        EXPECT_EQ(stats.statements, 1u);
+
+        cache.clear();
+        EXPECT_EQ(cache.stats().statements, 0u);
+        EXPECT_NE(cache.prepare(sql), nullptr);
+    }
+    // Every statement was finalized with the cache, so the close succeeds
+    EXPECT_EQ(sqlite3_close(db), SQLITE_OK);
+}
+
+TEST_F(StatementCacheTest, StorageCompilesEachStatementOnce) {
+    SQLiteStorage storage(dbPath);
+    auto before = storage.statementCacheStats();
+
+    ShotData shot;
+    shot.conditions = gptgolf::weather::WeatherData();
+    shot.clubUsed = "PW";
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(storage.saveShotData(shot));
+        ASSERT_TRUE(storage.savePreference("last", std::to_string(i)));
+        EXPECT_EQ(storage.getPreference("last"), std::to_string(i));
+    }
+
+    auto after = storage.statementCacheStats();
+    EXPECT_EQ(after.misses - before.misses, 3u);
+    EXPECT_EQ(after.hits - before.hits, 147u);
+    EXPECT_EQ(storage.getShotsByClub("PW").size(), 50u);
+}
+
+TEST_F(StatementCacheTest, ReaderConnectionsKeepTheirOwnStatements) {
+    SQLiteOptions options;
+    options.walMode = true;
+    options.readerConnections = 2;
+    SQLiteStorage storage(dbPath, options);
+    storage.savePreference("units", "metric");
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(storage.getPreference("units"), "metric");
+    }
+
+    // Read statements on the readers never block the writer afterwards
+    EXPECT_TRUE(storage.savePreference("units", "imperial"));
+    EXPECT_EQ(storage.getPreference("units"), "imperial");
+
+    auto stats = storage.statementCacheStats();
+    EXPECT_GE(stats.hits, 19u);
+    EXPECT_LE(stats.statements, 3u);
+}
+
+TEST_F(StatementCacheTest, WeatherStorageReusesStatements) {
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(dbPath));
+    gptgolf::weather::WeatherData conditions{};
+    conditions.temperature = 18.0;
+    conditions.timestamp = std::time(nullptr);
+
+    for (int i = 0; i < 10; ++i) {
+        conditions.timestamp += 60;
+        ASSERT_TRUE(weather.storeWeatherData(40.0, -74.0, conditions));
+        auto stored = weather.getWeatherData(40.0, -74.0);
+        ASSERT_TRUE(stored.has_value());
+        EXPECT_EQ(stored->timestamp, conditions.timestamp);
+    }
+
+    auto stats = weather.statementCacheStats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.hits, 18u);
+}
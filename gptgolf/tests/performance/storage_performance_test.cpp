@@ -0,0 +1,1019 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <sqlite3.h>
+#include <nlohmann/json.hpp>
+#include "data/sqlite_storage.h"
+#include "data/shot_writer.h"
+#include "data/shot_log.h"
+#include "data/shot_snapshot.h"
+#include "data/club_analysis.h"
+#include "weather/weather_storage.h"
+#include "weather/weather_history_loader.h"
+#include "weather/terrain_tiles.h"
+#include "weather/terrain_analyzer.h"
+#include "weather/weather_retention.h"
+#include "data/statement_cache.h"
+#include "data/shot_query.h"
+#include "data/packed_shot.h"
+#include "data/session_importer.h"
+#include "data/online_backup.h"
+
+using namespace gptgolf::data;
+using json = nlohmann::json;
+
+class StoragePerformanceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "perf_shots.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    // Helper function to measure execution time
+    template<typename Func>
+    double measureExecutionTime(Func func, int iterations = 1) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            func();
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> duration = end - start;
+        return duration.count() / iterations;  // Average time per iteration in milliseconds
+    }
+
+    // Fills the pre-migration layout with JSON weather blobs
+    void createLegacyDatabase(int rows) {
+        sqlite3* db;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        sqlite3_exec(db, R"(
+            CREATE TABLE shots (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                initial_velocity REAL NOT NULL,
+                spin_rate REAL NOT NULL,
+                launch_angle REAL NOT NULL,
+                weather_data TEXT NOT NULL,
+                club_used TEXT NOT NULL,
+                actual_distance REAL NOT NULL,
+                predicted_distance REAL NOT NULL,
+                lateral_deviation REAL NOT NULL,
+                timestamp INTEGER NOT NULL
+            );
+            BEGIN;
+        )", nullptr, nullptr, nullptr);
+
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, R"(
+            INSERT INTO shots (initial_velocity, spin_rate, launch_angle, weather_data,
+                               club_used, actual_distance, predicted_distance,
+                               lateral_deviation, timestamp)
+            VALUES (50, 2500, 12, ?, ?, 150, 148, 1, ?)
+        )", -1, &stmt, nullptr);
+        for (int i = 0; i < rows; ++i) {
+            json weather;
+            weather["temperature"] = 15.0 + (i % 20);
+            weather["humidity"] = 40.0 + (i % 50);
+            weather["pressure"] = 1000.0 + (i % 30);
+            weather["windSpeed"] = (i % 12) * 1.0;
+            weather["windDirection"] = (i * 7) % 360;
+            std::string text = weather.dump();
+            sqlite3_bind_text(stmt, 1, text.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, i % 2 ? "7 Iron" : "Driver", -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 3, 1600000000 + i);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+    }
+
+    // The pre-migration read path: SELECT * plus a json::parse per row
+    size_t readLegacyShots(size_t limit) {
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, "SELECT * FROM shots ORDER BY timestamp DESC LIMIT ?",
+                           -1, &stmt, nullptr);
+        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(limit));
+
+        std::vector<ShotData> shots;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ShotData shot;
+            shot.initialVelocity = sqlite3_column_double(stmt, 1);
+            shot.spinRate = sqlite3_column_double(stmt, 2);
+            shot.launchAngle = sqlite3_column_double(stmt, 3);
+            json j = json::parse(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
+            shot.conditions.temperature = j["temperature"];
+            shot.conditions.humidity = j["humidity"];
+            shot.conditions.pressure = j["pressure"];
+            shot.conditions.windSpeed = j["windSpeed"];
+            shot.conditions.windDirection = j["windDirection"];
+            shot.clubUsed = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+            shot.actualDistance = sqlite3_column_double(stmt, 6);
+            shot.predictedDistance = sqlite3_column_double(stmt, 7);
+            shot.lateralDeviation = sqlite3_column_double(stmt, 8);
+            shot.timestamp = sqlite3_column_int64(stmt, 9);
+            shots.push_back(shot);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return shots.size();
+    }
+
+    std::string dbPath;
+    const int SHOT_COUNT = 100000;
+};
+
+// Reading 100k shots through the JSON blob layout vs. typed weather columns
+TEST_F(StoragePerformanceTest, TypedWeatherColumnsRead) {
+    createLegacyDatabase(SHOT_COUNT);
+
+    size_t legacyRows = 0;
+    double legacyTime = measureExecutionTime([&]() {
+        legacyRows = readLegacyShots(SHOT_COUNT);
+    }, 3);
+    ASSERT_EQ(legacyRows, static_cast<size_t>(SHOT_COUNT));
+
+    std::unique_ptr<SQLiteStorage> storage;
+    double migrationTime = measureExecutionTime([&]() {
+        storage = std::make_unique<SQLiteStorage>(dbPath);
+    });
+
+    size_t typedRows = 0;
+    double typedTime = measureExecutionTime([&]() {
+        typedRows = storage->getShotHistory(SHOT_COUNT).size();
+    }, 3);
+    ASSERT_EQ(typedRows, static_cast<size_t>(SHOT_COUNT));
+
+    std::cout << "Read " << SHOT_COUNT << " shots: JSON blob " << legacyTime
+              << "ms, typed columns " << typedTime << "ms ("
+              << legacyTime / typedTime << "x); one-time migration "
+              << migrationTime << "ms" << std::endl;
+
+    EXPECT_LT(typedTime, legacyTime);
+}
+
+// Per-shot synchronous inserts vs. the group-commit write-behind queue
+TEST_F(StoragePerformanceTest, GroupCommitIngest) {
+    auto makeShot = [](int i) {
+        ShotData shot;
+        shot.clubUsed = i % 2 ? "7 Iron" : "Driver";
+        shot.actualDistance = 150.0 + (i % 50);
+        shot.timestamp = 1600000000 + i;
+        return shot;
+    };
+
+    const int syncShots = 500;
+    double syncTime = 0.0;
+    {
+        SQLiteStorage storage(dbPath);
+        syncTime = measureExecutionTime([&]() {
+            for (int i = 0; i < syncShots; ++i) {
+                storage.saveShotData(makeShot(i));
+            }
+        });
+    }
+    std::filesystem::remove(dbPath);
+
+    const int asyncShots = 50000;
+    double enqueueTime = 0.0;
+    double durableTime = 0.0;
+    {
+        ShotWriter writer(dbPath);
+        durableTime = measureExecutionTime([&]() {
+            enqueueTime = measureExecutionTime([&]() {
+                for (int i = 0; i < asyncShots; ++i) {
+                    writer.enqueue(makeShot(i));
+                }
+            });
+            ASSERT_TRUE(writer.flush());
+        });
+        EXPECT_EQ(writer.getStats().shotsWritten, static_cast<size_t>(asyncShots));
+    }
+    std::filesystem::remove(dbPath + "-wal");
+    std::filesystem::remove(dbPath + "-shm");
+
+    double syncRate = syncShots / (syncTime / 1000.0);
+    double asyncRate = asyncShots / (durableTime / 1000.0);
+    std::cout << "Ingest: saveShotData " << static_cast<int>(syncRate)
+              << " shots/s, ShotWriter " << static_cast<int>(asyncRate)
+              << " shots/s durable (" << enqueueTime * 1000.0 / asyncShots
+              << "us per enqueue on the caller)" << std::endl;
+
+    EXPECT_GT(asyncRate, 10000.0);
+    EXPECT_GT(asyncRate, syncRate);
+}
+
+// Durable ingest through the mmap shot log versus ShotWriter group commits,
+// both committing every 1000 shots, plus a zero-copy scan of the log
+TEST_F(StoragePerformanceTest, ShotLogIngest) {
+    auto makeShot = [](int i) {
+        ShotData shot;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.clubUsed = i % 2 ? "7 Iron" : "Driver";
+        shot.actualDistance = 150.0 + (i % 50);
+        shot.timestamp = 1600000000 + i;
+        return shot;
+    };
+    const int shots = 200000;
+    const int batch = 1000;
+
+    double writerTime = 0.0;
+    {
+        ShotWriterConfig config;
+        config.maxBatchSize = batch;
+        ShotWriter writer(dbPath, config);
+        writerTime = measureExecutionTime([&]() {
+            for (int i = 0; i < shots; ++i) {
+                writer.enqueue(makeShot(i));
+            }
+            ASSERT_TRUE(writer.flush());
+        });
+    }
+    std::filesystem::remove(dbPath + "-wal");
+    std::filesystem::remove(dbPath + "-shm");
+
+    const std::string logDir = "perf_shot_log";
+    std::filesystem::remove_all(logDir);
+    double logTime = 0.0;
+    double scanTime = 0.0;
+    {
+        ShotLog log(logDir);
+        logTime = measureExecutionTime([&]() {
+            for (int i = 0; i < shots; ++i) {
+                log.append(makeShot(i));
+                if ((i + 1) % batch == 0) {
+                    ASSERT_TRUE(log.commit());
+                }
+            }
+            ASSERT_TRUE(log.commit());
+        });
+
+        double total = 0.0;
+        size_t scanned = 0;
+        scanTime = measureExecutionTime([&]() {
+            for (auto segmentId : log.recentSegments(8)) {
+                SegmentView view = log.openSegment(segmentId);
+                for (const ShotRecord& record : view) {
+                    total += record.actualDistance;
+                }
+                scanned += view.size();
+            }
+        });
+        EXPECT_EQ(scanned, static_cast<size_t>(shots));
+        EXPECT_GT(total, 0.0);
+    }
+    std::filesystem::remove_all(logDir);
+
+    double writerRate = shots / (writerTime / 1000.0);
+    double logRate = shots / (logTime / 1000.0);
+    std::cout << "Durable ingest: ShotWriter " << static_cast<int>(writerRate)
+              << " shots/s, ShotLog " << static_cast<int>(logRate)
+              << " shots/s; log scan of " << shots << " shots "
+              << scanTime << "ms" << std::endl;
+
+    EXPECT_GT(logRate, writerRate);
+}
+
+// Read throughput by thread count while ShotWriter ingests, single
+// connection vs. a pool of read-only WAL connections
+TEST_F(StoragePerformanceTest, ReaderPoolScaling) {
+    const int seedShots = 20000;
+    {
+        ShotWriter seed(dbPath);
+        for (int i = 0; i < seedShots; ++i) {
+            ShotData shot;
+            shot.clubUsed = "Club " + std::to_string(i % 12);
+            shot.actualDistance = 100.0 + (i % 150);
+            shot.timestamp = 1600000000 + i;
+            seed.enqueue(shot);
+        }
+        ASSERT_TRUE(seed.flush());
+    }
+
+    auto measureReads = [&](SQLiteStorage& storage, int threads) {
+        ShotWriter ingest(dbPath);
+        std::atomic<bool> running{true};
+        std::atomic<size_t> reads{0};
+
+        std::thread producer([&]() {
+            for (int i = 0; running; ++i) {
+                ShotData shot;
+                shot.clubUsed = "Club " + std::to_string(i % 12);
+                shot.timestamp = 1700000000 + i;
+                ingest.enqueue(shot);
+                if (i % 100 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                while (running) {
+                    storage.getShotsByClubPage("Club " + std::to_string(t % 12), 50);
+                    storage.getClubProfile("Club " + std::to_string(t % 12));
+                    ++reads;
+                }
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        running = false;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        producer.join();
+        return reads.load() * 2.0;  // reads per second
+    };
+
+    SQLiteOptions single;
+    single.walMode = true;
+    SQLiteOptions pooled = single;
+    pooled.readerConnections = 8;
+
+    SQLiteStorage singleStorage(dbPath, single);
+    SQLiteStorage pooledStorage(dbPath, pooled);
+
+    std::cout << "Reader throughput during ingest (" << std::thread::hardware_concurrency()
+              << " hardware threads):" << std::endl;
+    for (int threads : {1, 2, 4, 8}) {
+        double singleRate = measureReads(singleStorage, threads);
+        double pooledRate = measureReads(pooledStorage, threads);
+        std::cout << "  " << threads << " threads: single connection "
+                  << static_cast<int>(singleRate) << " reads/s, reader pool "
+                  << static_cast<int>(pooledRate) << " reads/s" << std::endl;
+        EXPECT_GT(pooledRate, 0.0);
+    }
+
+    std::filesystem::remove(dbPath + "-wal");
+    std::filesystem::remove(dbPath + "-shm");
+}
+
+// Mean carry for one club over the full history: row cursor over SQLite
+// versus the columnar snapshot's zone-map-pruned column spans
+TEST_F(StoragePerformanceTest, ColumnarSnapshotScan) {
+    const char* clubs[] = {"Driver", "3 Wood", "5 Iron", "7 Iron", "9 Iron", "PW", "SW", "LW"};
+    {
+        SQLiteStorage storage(dbPath);
+        std::vector<ShotData> shots;
+        shots.reserve(SHOT_COUNT);
+        for (int i = 0; i < SHOT_COUNT; ++i) {
+            ShotData shot;
+            shot.conditions = gptgolf::weather::WeatherData();
+            shot.conditions.windSpeed = i % 12;
+            shot.clubUsed = clubs[i % 8];
+            shot.actualDistance = 100.0 + (i % 150);
+            shot.timestamp = 1600000000 + i;
+            shots.push_back(shot);
+        }
+        ASSERT_TRUE(storage.saveShotBatch(shots));
+    }
+
+    SQLiteStorage storage(dbPath);
+    double cursorMean = 0.0;
+    double cursorTime = measureExecutionTime([&]() {
+        double total = 0.0;
+        size_t count = 0;
+        ShotCursor cursor = storage.openShotCursor("7 Iron");
+        ShotData shot;
+        while (cursor.next(shot)) {
+            total += shot.actualDistance;
+            ++count;
+        }
+        cursorMean = total / count;
+    }, 5);
+
+    const std::string snapshotDir = "perf_snapshots";
+    std::filesystem::remove_all(snapshotDir);
+    double snapshotMean = 0.0;
+    double exportTime = 0.0;
+    double scanTime = 0.0;
+    {
+        SnapshotExporter exporter(storage, snapshotDir);
+        std::string path;
+        exportTime = measureExecutionTime([&]() { path = exporter.exportNow(); });
+        ShotSnapshot snapshot(path);
+
+        SnapshotPredicate predicate;
+        predicate.club = "7 Iron";
+        scanTime = measureExecutionTime([&]() {
+            double total = 0.0;
+            size_t count = 0;
+            for (const auto& block : snapshot.selectBlocks(predicate)) {
+                const double* distance = block.column(SnapshotColumn::ActualDistance);
+                for (size_t row = 0; row < block.rows; ++row) {
+                    if (block.allMatch || block.matches(row)) {
+                        total += distance[row];
+                        ++count;
+                    }
+                }
+            }
+            snapshotMean = total / count;
+        }, 5);
+    }
+    std::filesystem::remove_all(snapshotDir);
+
+    std::cout << "Club scan of " << SHOT_COUNT << " shots: cursor " << cursorTime
+              << "ms, snapshot " << scanTime << "ms (export " << exportTime << "ms)" << std::endl;
+
+    EXPECT_DOUBLE_EQ(cursorMean, snapshotMean);
+    EXPECT_LT(scanTime, cursorTime);
+}
+
+TEST_F(StoragePerformanceTest, ClubRecommendationLatency) {
+    SQLiteStorage storage(dbPath);
+    ClubAnalysis analysis(storage);
+    const char* clubs[] = {"Driver", "3 Wood", "5 Wood", "4 Iron", "5 Iron", "6 Iron",
+                           "7 Iron", "8 Iron", "9 Iron", "PW", "GW", "SW", "LW"};
+    for (int c = 0; c < 13; ++c) {
+        for (int i = 0; i < 20; ++i) {
+            ShotData shot;
+            shot.initialVelocity = 60.0;
+            shot.spinRate = 3000.0;
+            shot.launchAngle = 14.0;
+            shot.conditions = gptgolf::weather::WeatherData();
+            shot.clubUsed = clubs[c];
+            shot.actualDistance = 240.0 - c * 14.0 + (i % 5);
+            shot.lateralDeviation = (i % 7) - 3.0;
+            analysis.updateClubStatistics(shot);
+        }
+    }
+
+    gptgolf::weather::WeatherData conditions{};
+    conditions.temperature = 18.0;
+    conditions.pressure = 1010.0;
+    conditions.windSpeed = 4.0;
+    conditions.windDirection = 200.0;
+
+    const int iterations = 10000;
+    std::string indexed;
+    double indexedTime = measureExecutionTime([&]() {
+        indexed = analysis.recommendClub(100.0 + (indexed.size() % 7) * 20.0, conditions).clubName;
+    }, iterations);
+
+    std::string rebuilt;
+    double rebuiltTime = measureExecutionTime([&]() {
+        analysis.invalidateRecommendationIndex();
+        rebuilt = analysis.recommendClub(100.0 + (rebuilt.size() % 7) * 20.0, conditions).clubName;
+    }, 100);
+
+    std::cout << "Club recommendation: indexed " << indexedTime * 1000.0
+              << "us, reloading profiles " << rebuiltTime * 1000.0 << "us" << std::endl;
+
+    EXPECT_FALSE(indexed.empty());
+    EXPECT_LT(indexedTime, rebuiltTime);
+}
+
+TEST_F(StoragePerformanceTest, StatementCacheLatency) {
+    const int iterations = 20000;
+    SQLiteOptions options;
+    options.synchronous = SynchronousLevel::OFF;
+    SQLiteStorage storage(dbPath, options);
+    ShotData shot;
+    shot.initialVelocity = 60.0;
+    shot.spinRate = 3000.0;
+    shot.launchAngle = 14.0;
+    shot.conditions = gptgolf::weather::WeatherData();
+    shot.clubUsed = "7 Iron";
+    shot.actualDistance = 150.0;
+
+    // Without fsync the timing is dominated by statement handling
+    double insertTime = measureExecutionTime([&]() {
+        for (int i = 0; i < iterations; ++i) {
+            storage.saveShotData(shot);
+        }
+    }) * 1000.0 / iterations;
+
+    storage.savePreference("units", "metric");
+    double lookupTime = measureExecutionTime([&]() {
+        for (int i = 0; i < iterations; ++i) {
+            storage.getPreference("units");
+        }
+    }) * 1000.0 / iterations;
+
+    const std::string weatherPath = "perf_weather.db";
+    std::filesystem::remove(weatherPath);
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(weatherPath));
+    gptgolf::weather::WeatherData conditions{};
+    conditions.timestamp = std::time(nullptr);
+    weather.storeWeatherData(40.0, -74.0, conditions);
+    double weatherTime = measureExecutionTime([&]() {
+        for (int i = 0; i < iterations; ++i) {
+            weather.getWeatherData(40.0, -74.0);
+        }
+    }) * 1000.0 / iterations;
+
+    auto weatherStats = weather.statementCacheStats();
+    std::filesystem::remove(weatherPath);
+
+    auto stats = storage.statementCacheStats();
+    std::cout << "Statement latency: shot insert " << insertTime << "us, preference lookup "
+              << lookupTime << "us, weather lookup " << weatherTime << "us ("
+              << stats.hits + weatherStats.hits << " cache hits, "
+              << stats.misses + weatherStats.misses << " misses)" << std::endl;
+
+    EXPECT_GE(stats.hits, 2u * iterations - 2);
+    EXPECT_GE(weatherStats.hits, static_cast<std::uint64_t>(iterations - 1));
+}
+
+TEST_F(StoragePerformanceTest, ShotQueryFilterLatency) {
+    const size_t shotCount = 2000000;
+    const char* clubs[] = {"Driver", "3 Wood", "5 Iron", "7 Iron", "9 Iron", "PW", "SW"};
+    std::vector<ShotData> shots(shotCount);
+    std::time_t when = 1600000000;
+    for (size_t i = 0; i < shotCount; ++i) {
+        ShotData& shot = shots[i];
+        when += (i % 60 == 0) ? 86400 : 45;
+        shot.timestamp = when;
+        shot.clubUsed = clubs[i % 7];
+        shot.initialVelocity = 50.0 + (i % 30);
+        shot.spinRate = (i % 25 == 0) ? 0.0 : 2500.0 + (i % 3000);
+        shot.launchAngle = 10.0 + (i % 15);
+        shot.actualDistance = 80.0 + (i * 7919 % 15000) / 100.0;
+        shot.predictedDistance = shot.actualDistance - 2.0;
+        shot.conditions = gptgolf::weather::WeatherData();
+        shot.conditions.windSpeed = (i * 104729 % 1500) / 100.0;
+        shot.conditions.temperature = -5.0 + (i * 1299709 % 4000) / 100.0;
+    }
+
+    ShotQueryEngine engine;
+    double buildTime = measureExecutionTime([&]() {
+        for (const auto& shot : shots) {
+            engine.append(shot);
+        }
+    });
+
+    std::time_t since = shots[shotCount / 4].timestamp;
+    std::time_t until = shots[3 * shotCount / 4].timestamp;
+    ShotFilter filter = ShotFilter::club("7 Iron") && ShotFilter::windSpeed(3.0, 6.5) &&
+                        ShotFilter::dateRange(since, until) && ShotFilter::quality(ShotQuality::Good);
+
+    ShotAggregate indexed;
+    double indexedTime = measureExecutionTime([&]() {
+        indexed = engine.aggregate(filter, ShotMetric::Carry);
+    }, 10);
+
+    // Row-at-a-time scan over the same shots for comparison
+    size_t scanned = 0;
+    double scanTime = measureExecutionTime([&]() {
+        std::vector<float> values;
+        for (const auto& shot : shots) {
+            float wind = static_cast<float>(shot.conditions.windSpeed);
+            if (shot.clubUsed == "7 Iron" && wind >= 3.0 && wind <= 6.5 &&
+                shot.timestamp >= since && shot.timestamp <= until &&
+                classifyShotQuality(shot) == ShotQuality::Good) {
+                values.push_back(static_cast<float>(shot.actualDistance));
+            }
+        }
+        std::sort(values.begin(), values.end());
+        scanned = values.size();
+    }, 3);
+
+    std::cout << "Shot query over " << shotCount << " shots: build " << buildTime
+              << "ms, filter+aggregate " << indexedTime << "ms vs scan " << scanTime << "ms ("
+              << indexed.count << " rows, " << engine.sizeInBytes() / (1024 * 1024) << " MB)"
+              << std::endl;
+
+    EXPECT_EQ(indexed.count, scanned);
+    EXPECT_LT(indexedTime, scanTime);
+}
+
+TEST_F(StoragePerformanceTest, PackedShotFootprint) {
+    const size_t shotCount = 1000000;
+    const char* clubs[] = {"Driver", "3 Wood", "5 Iron", "7 Iron", "9 Iron", "Pitching Wedge", "Sand Wedge 56 degrees"};
+    std::vector<ShotData> shots(shotCount);
+    size_t unpackedBytes = 0;
+    for (size_t i = 0; i < shotCount; ++i) {
+        ShotData& shot = shots[i];
+        shot.clubUsed = clubs[i % 7];
+        shot.initialVelocity = 50.0 + (i % 30);
+        shot.spinRate = 2500.0 + (i % 3000);
+        shot.actualDistance = 80.0 + (i * 7919 % 15000) / 100.0;
+        shot.conditions = gptgolf::weather::WeatherData();
+        unpackedBytes += shotDataFootprint(shot);
+    }
+
+    PackedShotStore store;
+    double packTime = measureExecutionTime([&]() {
+        store.reserve(shotCount);
+        for (const auto& shot : shots) {
+            store.append(shot);
+        }
+    });
+
+    double unpackedSum = 0.0;
+    double unpackedTime = measureExecutionTime([&]() {
+        unpackedSum = 0.0;
+        for (const auto& shot : shots) {
+            unpackedSum += shot.actualDistance;
+        }
+    }, 5);
+    double packedSum = 0.0;
+    double packedTime = measureExecutionTime([&]() {
+        packedSum = 0.0;
+        for (size_t i = 0; i < store.size(); ++i) {
+            packedSum += store[i].actualDistance;
+        }
+    }, 5);
+
+    std::cout << "Shot memory: ShotData " << static_cast<double>(unpackedBytes) / shotCount
+              << " B/shot, PackedShot " << static_cast<double>(store.sizeInBytes()) / shotCount
+              << " B/shot; pack " << packTime << "ms, carry scan " << unpackedTime << "ms -> "
+              << packedTime << "ms" << std::endl;
+
+    EXPECT_NEAR(packedSum / shotCount, unpackedSum / shotCount, 1e-3);
+    EXPECT_LT(store.sizeInBytes() * 2, unpackedBytes);
+}
+
+TEST_F(StoragePerformanceTest, SessionImportThroughput) {
+    const size_t rows = 200000;
+    const std::string exportPath = "perf_session_export.csv";
+    {
+        std::ofstream out(exportPath);
+        out << "Date,Club,Ball Speed,Launch Angle,Launch Direction,Spin Rate,Spin Axis,Carry,Total,Side\n"
+            << ",,[mph],[deg],[deg],[rpm],[deg],[yds],[yds],[yds]\n";
+        const char* clubs[] = {"Driver", "3 Wood", "5 Iron", "7 Iron", "9 Iron", "PW", "SW"};
+        for (size_t i = 0; i < rows; ++i) {
+            out << 1700000000 + i * 30 << ',' << clubs[i % 7] << ',' << 90 + i % 80 << ".4,"
+                << 10 + i % 20 << ".2,-1.5," << 2500 + i % 6000 << ",3.1," << 100 + i % 180 << ".7,"
+                << 110 + i % 190 << ".1," << (i % 2 ? "-" : "") << i % 15 << ".3\n";
+        }
+    }
+
+    auto run = [&](size_t threads, bool deferIndexes) {
+        std::filesystem::remove(dbPath);
+        SQLiteStorage storage(dbPath);
+        ImportOptions options;
+        options.threads = threads;
+        options.deferIndexes = deferIndexes;
+        return SessionImporter(storage, options).importFile(exportPath);
+    };
+
+    ImportReport serial = run(1, false);
+    ImportReport parallel = run(0, true);
+    std::filesystem::remove(exportPath);
+
+    std::cout << "Session import of " << rows << " rows: 1 thread, live indexes "
+              << serial.rowsPerSecond() << " rows/s (parse " << serial.parseSeconds * 1000.0
+              << "ms, insert " << serial.insertSeconds * 1000.0 << "ms); parallel, deferred indexes "
+              << parallel.rowsPerSecond() << " rows/s (parse " << parallel.parseSeconds * 1000.0
+              << "ms, insert " << parallel.insertSeconds * 1000.0 << "ms)" << std::endl;
+
+    ASSERT_TRUE(parallel.success) << parallel.error;
+    EXPECT_EQ(parallel.rowsImported, serial.rowsImported);
+    EXPECT_EQ(parallel.rowsRead, rows);
+    EXPECT_LT(parallel.insertSeconds, serial.insertSeconds);
+}
+
+TEST_F(StoragePerformanceTest, OnlineBackupWriterLatency) {
+    const size_t shotCount = 200000;
+    const std::string backupPath = "perf_backup.db";
+    SQLiteStorage storage(dbPath);
+    {
+        std::vector<ShotData> shots;
+        shots.reserve(shotCount);
+        for (size_t i = 0; i < shotCount; ++i) {
+            ShotData shot;
+            shot.clubUsed = "Club " + std::to_string(i % 13);
+            shot.initialVelocity = 40.0 + i % 40;
+            shot.spinRate = 2000.0 + i % 7000;
+            shot.launchAngle = 10.0 + i % 25;
+            shot.actualDistance = 100.0 + i % 180;
+            shot.conditions = gptgolf::weather::WeatherData();
+            shot.timestamp = 1700000000 + i;
+            shots.push_back(shot);
+        }
+        ASSERT_EQ(storage.bulkInsertShots(shots), shotCount);
+    }
+
+    // Longest single write while a backup runs, plus the backup's own duration
+    auto run = [&](const BackupOptions& options, BackupProgress& progress) {
+        ShotData shot;
+        shot.clubUsed = "Driver";
+        shot.initialVelocity = 70.0;
+        shot.spinRate = 2500.0;
+        shot.launchAngle = 12.0;
+        shot.actualDistance = 240.0;
+        shot.conditions = gptgolf::weather::WeatherData();
+
+        double longestWrite = 0.0;
+        auto backup = storage.startBackup(backupPath, options);
+        while (!backup->progress().finished()) {
+            longestWrite = std::max(longestWrite, measureExecutionTime([&]() { storage.saveShotData(shot); }));
+        }
+        backup->wait();
+        progress = backup->progress();
+        std::filesystem::remove(backupPath);
+        return longestWrite;
+    };
+
+    BackupOptions wholeFile;
+    wholeFile.initialPagesPerStep = 1 << 30;
+    wholeFile.maxPagesPerStep = 1 << 30;
+    BackupProgress wholeProgress;
+    double wholeLatency = run(wholeFile, wholeProgress);
+
+    BackupProgress incrementalProgress;
+    double incrementalLatency = run(BackupOptions(), incrementalProgress);
+
+    std::cout << "Backup of " << shotCount << " shots (" << incrementalProgress.pagesTotal << " pages): "
+              << "single step held the writer " << wholeProgress.longestStep.count() / 1000.0
+              << "ms, longest write " << wholeLatency << "ms; incremental " << incrementalProgress.steps << " steps in "
+              << incrementalProgress.elapsedSeconds * 1000.0 << "ms, longest step "
+              << incrementalProgress.longestStep.count() / 1000.0 << "ms, longest write "
+              << incrementalLatency << "ms" << std::endl;
+
+    ASSERT_EQ(wholeProgress.state, BackupState::Completed) << wholeProgress.error;
+    ASSERT_EQ(incrementalProgress.state, BackupState::Completed) << incrementalProgress.error;
+    EXPECT_LT(incrementalProgress.longestStep, wholeProgress.longestStep);
+    EXPECT_GT(incrementalProgress.steps, 1u);
+}
+
+TEST_F(StoragePerformanceTest, NearestWeatherLookup) {
+    const int stationCount = 1000000;
+    const std::string weatherPath = "perf_weather_nearest.db";
+    std::filesystem::remove(weatherPath);
+
+    // Bulk load stations spread over the continental US
+    std::vector<gptgolf::weather::WeatherObservation> stations;
+    stations.reserve(stationCount);
+    std::time_t now = std::time(nullptr);
+    for (int i = 0; i < stationCount; ++i) {
+        gptgolf::weather::WeatherData data{};
+        data.temperature = 15.0 + i % 20;
+        data.humidity = 50;
+        data.pressure = 1013;
+        data.windSpeed = 3;
+        data.windDirection = 180;
+        data.altitude = 100;
+        data.timestamp = now - i % 1800;
+        stations.push_back({25.0 + (i % 1000) * 0.024, -125.0 + (i / 1000) * 0.058, data});
+    }
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(weatherPath));
+    ASSERT_EQ(weather.bulkStoreWeatherData(stations), stations.size());
+
+    const int lookups = 2000;
+    int found = 0;
+    double lookupTime = measureExecutionTime([&]() {
+        for (int i = 0; i < lookups; ++i) {
+            double lat = 26.0 + (i % 97) * 0.2;
+            double lon = -120.0 + (i % 89) * 0.5;
+            found += weather.getNearestWeatherData(lat, lon, 10.0).has_value() ? 1 : 0;
+        }
+    }) * 1000.0 / lookups;
+
+    std::filesystem::remove(weatherPath);
+
+    std::cout << "Nearest weather lookup over " << stationCount << " stations: "
+              << lookupTime << "us per lookup, " << found << "/" << lookups << " found" << std::endl;
+
+    EXPECT_EQ(found, lookups);
+    EXPECT_LT(lookupTime, 1000.0);
+}
+
+TEST_F(StoragePerformanceTest, WeatherHistoryLoadThroughput) {
+    const size_t hours = 24 * 365 * 5;
+    const int stations = 20;
+    const std::string historyPath = "perf_weather_history.csv";
+    const std::string weatherPath = "perf_weather_history.db";
+    {
+        std::ofstream out(historyPath);
+        out << "timestamp,latitude,longitude,temperature,humidity,pressure,windSpeed,windDirection,precipitation\n";
+        for (size_t h = 0; h < hours; ++h) {
+            for (int s = 0; s < stations; ++s) {
+                out << 1577836800 + h * 3600 << ',' << 30.0 + s * 0.5 << ',' << -100.0 + s * 0.5 << ','
+                    << 5 + (h + s) % 25 << ".5," << 40 + h % 50 << ',' << 1000 + h % 25 << ','
+                    << h % 12 << ".2," << (h * 7 + s) % 360 << ",0\n";
+            }
+        }
+    }
+
+    std::filesystem::remove(weatherPath);
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(weatherPath));
+    gptgolf::weather::HistoryLoadReport report =
+        gptgolf::weather::WeatherHistoryLoader(weather).loadFile(historyPath);
+    std::filesystem::remove(historyPath);
+    std::filesystem::remove(weatherPath);
+
+    std::cout << "Weather history load of " << report.rowsRead << " rows: " << report.rowsPerSecond()
+              << " rows/s (parse " << report.parseSeconds * 1000.0 << "ms, insert "
+              << report.insertSeconds * 1000.0 << "ms), " << report.climatologyRows
+              << " climatology rows" << std::endl;
+
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsLoaded, hours * stations);
+    EXPECT_EQ(report.climatologyRows, static_cast<size_t>(stations * 12));
+}
+
+TEST_F(StoragePerformanceTest, HistoricalStatsLookup) {
+    const size_t hours = 24 * 365 * 5;
+    const int stations = 20;
+    const std::string weatherPath = "perf_weather_stats.db";
+    std::filesystem::remove(weatherPath);
+
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(weatherPath));
+    std::vector<gptgolf::weather::WeatherObservation> rows;
+    rows.reserve(hours * stations);
+    for (size_t h = 0; h < hours; ++h) {
+        for (int s = 0; s < stations; ++s) {
+            gptgolf::weather::WeatherData data{};
+            data.temperature = 5.0 + (h + s) % 25;
+            data.humidity = 40.0 + h % 50;
+            data.pressure = 1000.0 + h % 25;
+            data.windSpeed = h % 12;
+            data.windDirection = (h * 7 + s) % 360;
+            data.timestamp = 1577836800 + h * 3600;
+            rows.push_back({30.0 + s * 0.5, -100.0 + s * 0.5, data});
+        }
+    }
+    double insertTime = measureExecutionTime([&]() {
+        ASSERT_EQ(weather.bulkStoreWeatherData(rows), rows.size());
+    });
+
+    const int lookups = 2000;
+    int found = 0;
+    double lookupTime = measureExecutionTime([&]() {
+        for (int i = 0; i < lookups; ++i) {
+            int s = i % stations;
+            found += weather.getHistoricalStats(30.0 + s * 0.5, -100.0 + s * 0.5, 1 + i % 12)
+                         .has_value() ? 1 : 0;
+        }
+    }) * 1000.0 / lookups;
+
+    std::filesystem::remove(weatherPath);
+
+    std::cout << "Historical stats over " << rows.size() << " observations: " << lookupTime
+              << "us per lookup (bulk insert " << insertTime << "ms)" << std::endl;
+
+    EXPECT_EQ(found, lookups);
+    EXPECT_LT(lookupTime, 500.0);
+}
+
+TEST_F(StoragePerformanceTest, TerrainTileLookup) {
+    const int gridSize = 512;
+    const std::string sourcePath = "perf_terrain_points.csv";
+    const std::string tilePath = "perf_terrain.tiles";
+    {
+        std::ofstream out(sourcePath);
+        out << "lat,lon,elevation,land_use\n";
+        for (int r = 0; r < gridSize; ++r) {
+            for (int c = 0; c < gridSize; ++c) {
+                out << 35.0 + (r + 0.5) * 0.001 << ',' << -80.0 + (c + 0.5) * 0.001 << ','
+                    << (r * 7 + c * 3) % 400 << ',' << (r + c) % 8 << '\n';
+            }
+        }
+    }
+
+    gptgolf::weather::TerrainTileBuildReport report;
+    double buildTime = measureExecutionTime([&]() {
+        report = gptgolf::weather::buildTerrainTiles({sourcePath}, tilePath);
+    });
+    ASSERT_TRUE(report.success) << report.error;
+
+    // A round's worth of locality: most lookups stay within a few tiles
+    gptgolf::weather::TerrainTileStore store(16);
+    ASSERT_TRUE(store.open(tilePath));
+    const int lookups = 1000000;
+    int found = 0;
+    double lookupTime = measureExecutionTime([&]() {
+        for (int i = 0; i < lookups; ++i) {
+            double lat = 35.0 + ((i / 1000) % gridSize + 0.5) * 0.001;
+            double lon = -80.0 + (i % gridSize + 0.5) * 0.001;
+            found += store.lookup(lat, lon).has_value() ? 1 : 0;
+        }
+    }) * 1e6 / lookups;
+    gptgolf::weather::TerrainTileStats stats = store.getStats();
+
+    std::filesystem::remove(sourcePath);
+    std::filesystem::remove(tilePath);
+
+    std::cout << "Terrain tiles from " << report.pointsRead << " points: build " << buildTime
+              << "ms, " << lookupTime << "ns per lookup, " << stats.tileDecodes << " decodes for "
+              << stats.tiles << " tiles" << std::endl;
+
+    EXPECT_EQ(found, lookups);
+    EXPECT_LT(lookupTime, 2000.0);
+}
+
+TEST_F(StoragePerformanceTest, WindStatsLookup) {
+    const int days = 30;
+    const std::string weatherPath = "perf_wind_stats.db";
+    std::filesystem::remove(weatherPath);
+
+    gptgolf::weather::WeatherStorage weather;
+    ASSERT_TRUE(weather.initialize(weatherPath));
+    gptgolf::weather::TerrainAnalyzer analyzer(weather);
+
+    // Hourly observations for a month at one course; each store is its own
+    // transaction, so this measures commit cost more than the accumulator
+    const std::time_t start = 1640995200;
+    double storeTime = measureExecutionTime([&]() {
+        for (int h = 0; h < days * 24; ++h) {
+            gptgolf::weather::WindPattern pattern;
+            pattern.speed = 2.0 + h % 9;
+            pattern.direction = (h * 13) % 360;
+            pattern.gustSpeed = pattern.speed * 1.3;
+            pattern.temperature = 15.0;
+            pattern.pressure = 1013.0;
+            pattern.timestamp = start + h * 3600;
+            analyzer.storeWindPattern(36.5686, -121.9508, pattern);
+        }
+    }) * 1000.0 / (days * 24);
+
+    const int lookups = 2000;
+    int found = 0;
+    double lookupTime = measureExecutionTime([&]() {
+        for (int i = 0; i < lookups; ++i) {
+            int teeHour = i % 24;
+            found += analyzer.getWindStats(36.5686, -121.9508, teeHour, (teeHour + 4) % 24).has_value() ? 1 : 0;
+        }
+    }) * 1000.0 / lookups;
+
+    std::filesystem::remove(weatherPath);
+
+    std::cout << "Wind stats over " << days * 24 << " observations: " << storeTime
+              << "us per store, " << lookupTime << "us per lookup" << std::endl;
+
+    EXPECT_EQ(found, lookups);
+    EXPECT_LT(lookupTime, 1000.0);
+}
+
+TEST_F(StoragePerformanceTest, WeatherRetentionStepLatency) {
+    const int observations = 100000;
+    const std::time_t start = 1640995200;
+    const std::time_t cutoff = start + observations / 2 * 600;
+    const std::string weatherPath = "perf_weather_retention.db";
+
+    // Ten-minute observations spread over a few courses, half of them expired
+    auto load = [&](gptgolf::weather::WeatherStorage& weather) {
+        std::filesystem::remove(weatherPath);
+        ASSERT_TRUE(weather.initialize(weatherPath));
+        std::vector<gptgolf::weather::WeatherObservation> rows;
+        rows.reserve(observations);
+        for (int i = 0; i < observations; ++i) {
+            gptgolf::weather::WeatherData data{};
+            data.temperature = 15.0 + i % 10;
+            data.humidity = 60.0;
+            data.pressure = 1013.0;
+            data.windSpeed = 2.0 + i % 9;
+            data.windDirection = (i * 13) % 360;
+            data.timestamp = start + i * 600;
+            rows.push_back({36.5 + (i % 5) * 0.1, -121.9, data});
+        }
+        ASSERT_EQ(weather.bulkStoreWeatherData(rows), rows.size());
+    };
+
+    double singleDelete;
+    {
+        gptgolf::weather::WeatherStorage weather;
+        load(weather);
+        singleDelete = measureExecutionTime([&]() {
+            weather.deleteObservationsBefore(cutoff, observations);
+            weather.releaseFreePages(1 << 30);
+        });
+    }
+
+    gptgolf::weather::RetentionProgress progress;
+    double elapsed;
+    {
+        gptgolf::weather::WeatherStorage weather;
+        load(weather);
+        gptgolf::weather::RetentionOptions options;
+        options.maxAge = std::chrono::seconds(0);
+        options.stepInterval = std::chrono::milliseconds(0);
+        gptgolf::weather::WeatherRetention retention(weather, options, false);
+        elapsed = measureExecutionTime([&]() {
+            while (retention.runPass(cutoff) > 0) {
+            }
+        });
+        progress = retention.progress();
+    }
+    std::filesystem::remove(weatherPath);
+
+    std::cout << "Retention of " << observations / 2 << " observations: one delete held the storage "
+              << singleDelete << "ms; " << progress.steps << " budgeted steps over " << progress.passes
+              << " passes took " << elapsed << "ms, longest step " << progress.longestStep.count() / 1000.0
+              << "ms, " << progress.pagesReleased << " pages released" << std::endl;
+
+    EXPECT_EQ(progress.rowsDeleted, static_cast<size_t>(observations / 2));
+    EXPECT_LT(progress.longestStep.count() / 1000.0, singleDelete);
+    EXPECT_GT(progress.pagesReleased, 0u);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "weather/forecast_timeline.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace gptgolf::weather;
+
+namespace {
+
+const std::time_t START = 1686830400;   // 2023-06-15 12:00:00 UTC
+
+WeatherData sample(int hour, double temperature, double windSpeed, double windDirection) {
+    WeatherData data{};
+    data.temperature = temperature;
+    data.humidity = 50.0 + hour * 10.0;
+    data.pressure = 1010.0 + hour;
+    data.windSpeed = windSpeed;
+    data.windDirection = windDirection;
+    data.precipitation = 0.0;
+    data.timestamp = START + hour * 3600;
+    return data;
+}
+
+} // namespace
+
+TEST(ForecastTimelineTest, InterpolatesScalarsLinearly) {
+    auto timeline = ForecastTimeline::fromReadings({
+        sample(0, 10.0, 4.0, 90.0), sample(1, 14.0, 4.0, 90.0), sample(2, 20.0, 4.0, 90.0)});
+    ASSERT_TRUE(timeline.has_value());
+    EXPECT_EQ(timeline->size(), 3u);
+    EXPECT_EQ(timeline->stepSeconds(), 3600);
+    EXPECT_EQ(timeline->endTime(), START + 7200);
+
+    auto quarter = timeline->at(START + 900);
+    ASSERT_TRUE(quarter.has_value());
+    EXPECT_EQ(quarter->timestamp, START + 900);
+    EXPECT_NEAR(quarter->temperature, 11.0, 1e-4);
+    EXPECT_NEAR(quarter->humidity, 52.5, 1e-4);
+    EXPECT_NEAR(quarter->pressure, 1010.25, 1e-3);
+
+    auto exact = timeline->at(START + 3600);
+    ASSERT_TRUE(exact.has_value());
+    EXPECT_NEAR(exact->temperature, 14.0, 1e-4);
+    EXPECT_NEAR(exact->windSpeed, 4.0, 1e-4);
+    EXPECT_NEAR(exact->windDirection, 90.0, 1e-3);
+
+    EXPECT_NEAR(timeline->at(START + 7200)->temperature, 20.0, 1e-4);
+    EXPECT_FALSE(timeline->at(START - 1).has_value());
+    EXPECT_FALSE(timeline->at(START + 7201).has_value());
+}
+
+TEST(ForecastTimelineTest, InterpolatesWindAsAVector) {
+    auto veer = ForecastTimeline::fromReadings({sample(0, 15.0, 5.0, 350.0), sample(1, 15.0, 5.0, 10.0)});
+    ASSERT_TRUE(veer.has_value());
+    auto midway = veer->at(START + 1800);
+    ASSERT_TRUE(midway.has_value());
+    // Through north, not south
+    EXPECT_NEAR(std::min(midway->windDirection, 360.0 - midway->windDirection), 0.0, 1e-3);
+    EXPECT_NEAR(midway->windSpeed, 5.0 * std::cos(10.0 * M_PI / 180.0), 1e-4);
+
+    // Opposing winds cancel instead of swinging through 90°
+    auto reversal = ForecastTimeline::fromReadings({sample(0, 15.0, 6.0, 0.0), sample(1, 15.0, 2.0, 180.0)});
+    ASSERT_TRUE(reversal.has_value());
+    auto quarter = reversal->at(START + 900);
+    EXPECT_NEAR(quarter->windSpeed, 4.0, 1e-4);
+    EXPECT_NEAR(quarter->windDirection, 0.0, 1e-3);
+}
+
+TEST(ForecastTimelineTest, RejectsUnevenOrEmptyReadings) {
+    EXPECT_FALSE(ForecastTimeline::fromReadings({}).has_value());
+    EXPECT_FALSE(ForecastTimeline::fromReadings({
+        sample(0, 10.0, 1.0, 0.0), sample(1, 10.0, 1.0, 0.0), sample(3, 10.0, 1.0, 0.0)}).has_value());
+    EXPECT_FALSE(ForecastTimeline::fromReadings({sample(1, 10.0, 1.0, 0.0), sample(0, 10.0, 1.0, 0.0)})
+                     .has_value());
+
+    auto single = ForecastTimeline::fromReadings({sample(0, 10.0, 1.0, 0.0)});
+    ASSERT_TRUE(single.has_value());
+    EXPECT_TRUE(single->at(START).has_value());
+    EXPECT_FALSE(single->at(START + 1).has_value());
+}
+
+TEST(ForecastTimelineTest, ParsesProviderResponse) {
+    auto timeline = ForecastTimeline::parse(R"({"timelines": {"hourly": [
+        {"time": "2023-06-15T12:00:00Z", "values": {"temperature": 18.0, "humidity": 60,
+         "pressureSeaLevel": 1012.0, "windSpeed": 3.0, "windDirection": 270, "precipitationIntensity": 0.5}},
+        {"time": "2023-06-15T13:00:00Z", "values": {"temperature": 20.0, "humidity": 55,
+         "pressureSeaLevel": 1011.0, "windSpeed": 3.0, "windDirection": 270}}
+    ]}})");
+    ASSERT_TRUE(timeline.has_value());
+    EXPECT_EQ(timeline->startTime(), START);
+    auto midway = timeline->at(START + 1800);
+    ASSERT_TRUE(midway.has_value());
+    EXPECT_NEAR(midway->temperature, 19.0, 1e-4);
+    EXPECT_NEAR(midway->precipitation, 0.25, 1e-4);
+    EXPECT_NEAR(midway->windDirection, 270.0, 1e-3);
+
+    EXPECT_FALSE(ForecastTimeline::parse("not json").has_value());
+    EXPECT_FALSE(ForecastTimeline::parse(R"({"timelines": {"hourly": [{"time": "soon", "values": {}}]}})")
+                     .has_value());
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "weather/geohash_cache.h"
+#include "weather/weather_api.h"
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace gptgolf::weather;
+
+namespace {
+
+WeatherData reading(double temp, std::time_t timestamp) {
+    WeatherData data{};
+    data.temperature = temp;
+    data.humidity = 65.0;
+    data.pressure = 1013.25;
+    data.windSpeed = 5.0;
+    data.windDirection = 180.0;
+    data.timestamp = timestamp;
+    return data;
+}
+
+} // namespace
+
+TEST(GeohashTest, EncodesKnownLocations) {
+    EXPECT_EQ(encodeGeohash(57.64911, 10.40744, 11), "u4pruydqqvj");
+    EXPECT_EQ(encodeGeohash(42.6, -5.6, 5), "ezs42");
+    EXPECT_EQ(encodeGeohash(40.7128, -74.0060, 6).size(), 6u);
+}
+
+TEST(GeohashWeatherCacheTest, NearbyCoordinatesShareACell) {
+    GeohashWeatherCache cache;
+    std::time_t now = std::time(nullptr);
+    cache.put(40.71280, -74.00600, reading(20.0, now));
+
+    // About 100 m away, same course
+    auto nearby = cache.get(40.71350, -74.00550, now);
+    ASSERT_TRUE(nearby.has_value());
+    EXPECT_DOUBLE_EQ(nearby->temperature, 20.0);
+
+    EXPECT_FALSE(cache.get(40.80000, -74.00600, now).has_value());
+
+    GeohashCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST(GeohashWeatherCacheTest, ExpiresReadingsByObservationTime) {
+    GeohashCacheConfig config;
+    config.ttlSeconds = 600;
+    GeohashWeatherCache cache(config);
+    std::time_t now = std::time(nullptr);
+    cache.put(40.7128, -74.0060, reading(20.0, now - 300));
+
+    EXPECT_TRUE(cache.get(40.7128, -74.0060, now).has_value());
+    EXPECT_FALSE(cache.get(40.7128, -74.0060, now + 300).has_value());
+
+    GeohashCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.expired, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST(GeohashWeatherCacheTest, KeepsTheNewestReading) {
+    GeohashWeatherCache cache;
+    std::time_t now = std::time(nullptr);
+    cache.put(40.7128, -74.0060, reading(22.0, now));
+    cache.put(40.7128, -74.0060, reading(18.0, now - 60));
+
+    auto cached = cache.get(40.7128, -74.0060, now);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_DOUBLE_EQ(cached->temperature, 22.0);
+
+    cache.put(40.7128, -74.0060, reading(24.0, now + 60));
+    EXPECT_DOUBLE_EQ(cache.get(40.7128, -74.0060, now + 60)->temperature, 24.0);
+}
+
+TEST(GeohashWeatherCacheTest, EvictsOldestWhenShardIsFull) {
+    GeohashCacheConfig config;
+    config.shardCount = 1;
+    config.shardCapacity = 3;
+    GeohashWeatherCache cache(config);
+    std::time_t now = std::time(nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        cache.put(10.0 * i, 10.0 * i, reading(10.0 + i, now - 100 + i));
+    }
+
+    EXPECT_FALSE(cache.get(0.0, 0.0, now).has_value());
+    EXPECT_TRUE(cache.get(30.0, 30.0, now).has_value());
+    GeohashCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 3u);
+}
+
+TEST(GeohashWeatherCacheTest, InvalidateAndClear) {
+    GeohashWeatherCache cache;
+    std::time_t now = std::time(nullptr);
+    cache.put(40.7128, -74.0060, reading(20.0, now));
+    cache.put(51.5074, -0.1278, reading(15.0, now));
+
+    cache.invalidate(40.7128, -74.0060);
+    EXPECT_FALSE(cache.get(40.7128, -74.0060, now).has_value());
+    EXPECT_TRUE(cache.get(51.5074, -0.1278, now).has_value());
+
+    cache.clear();
+    EXPECT_EQ(cache.getStats().entries, 0u);
+}
+
+TEST(GeohashWeatherCacheTest, ConcurrentReadersAndWriters) {
+    GeohashWeatherCache cache;
+    std::time_t now = std::time(nullptr);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, t, now]() {
+            for (int i = 0; i < 1000; ++i) {
+                double lat = (i % 50) * 0.5;
+                cache.put(lat, t * 2.0, reading(i, now));
+                cache.get(lat, t * 2.0, now);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    GeohashCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 8000u);
+    EXPECT_EQ(stats.hits, 8000u);
+}
+
+TEST(GeohashWeatherCacheTest, WeatherAPIServesRepeatReadsFromMemory) {
+    const std::string dbPath = "test_weather_cache.db";
+    std::filesystem::remove(dbPath);
+    {
+        WeatherStorage storage;
+        storage.initialize(dbPath);
+        WeatherAPI api(storage);
+        api.initialize("test_api_key", true);
+
+        storage.storeWeatherData(40.7128, -74.0060, reading(20.0, std::time(nullptr)));
+
+        WeatherData data;
+        ASSERT_TRUE(api.getCurrentWeather(40.7128, -74.0060, data));
+
+        // Once cached, the reading no longer depends on the table
+        storage.clearOldData(std::time(nullptr) + 1);
+        ASSERT_TRUE(api.getCurrentWeather(40.7128, -74.0060, data));
+        EXPECT_DOUBLE_EQ(data.temperature, 20.0);
+        ASSERT_TRUE(api.getCurrentWeather(40.71330, -74.00570, data));
+        EXPECT_DOUBLE_EQ(data.temperature, 20.0);
+
+        GeohashCacheStats stats = api.getCacheStats();
+        EXPECT_EQ(stats.hits, 2u);
+        EXPECT_EQ(stats.misses, 1u);
+    }
+    std::filesystem::remove(dbPath);
+}
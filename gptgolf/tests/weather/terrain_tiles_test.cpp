@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "weather/terrain_analyzer.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace gptgolf::weather;
+
+class TerrainTilesTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sourcePath = "test_terrain_points.csv";
+        tilePath = "test_terrain.tiles";
+        dbPath = "test_terrain_weather.db";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(sourcePath);
+        std::filesystem::remove(tilePath);
+        std::filesystem::remove(dbPath);
+    }
+
+    void writeSource(const std::string& contents) {
+        std::ofstream out(sourcePath);
+        out << contents;
+    }
+
+    // A 40 x 40 cell course: water to the west, a 600 m ridge to the east,
+    // open grass in between
+    void writeCourse() {
+        std::string csv = "lat,lon,elevation,land_use\n";
+        for (int r = 0; r < 40; ++r) {
+            for (int c = 0; c < 40; ++c) {
+                double lat = 40.0 + (r + 0.5) * 0.001;
+                double lon = -74.0 + (c + 0.5) * 0.001;
+                double elevation = c < 30 ? 10.0 : 10.0 + (c - 29) * 60.0;
+                std::string landUse = c < 5 ? "water" : c < 30 ? "golf_course" : "forest";
+                csv += std::to_string(lat) + "," + std::to_string(lon) + "," +
+                       std::to_string(elevation) + "," + landUse + "\n";
+            }
+        }
+        writeSource(csv);
+    }
+
+    std::string sourcePath;
+    std::string tilePath;
+    std::string dbPath;
+};
+
+TEST_F(TerrainTilesTest, BuildsAndLooksUpCells) {
+    writeSource(
+        "Latitude,Longitude,Elevation,Land Use,Roughness,Source\n"
+        "40.0005,-74.0005,12.0,grassland,0.5,survey\n"
+        "40.0006,-74.0004,14.0,grassland,1.5,survey\n"    // Same cell
+        "40.0015,-74.0005,3.0,water,0.0,survey\n"
+        "95.0,-74.0,1.0,water,0.0,survey\n"               // Off the globe
+        "40.0025,-74.0005,,water,0.0,survey\n");          // No elevation
+
+    TerrainTileOptions options;
+    options.tileSize = 16;
+    TerrainTileBuildReport report = buildTerrainTiles({sourcePath}, tilePath, options);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.pointsRead, 5u);
+    EXPECT_EQ(report.pointsRejected, 2u);
+    EXPECT_GE(report.tilesWritten, 1u);
+
+    TerrainTileStore store;
+    ASSERT_TRUE(store.open(tilePath));
+    auto grass = store.lookup(40.0002, -74.0009);
+    ASSERT_TRUE(grass.has_value());
+    EXPECT_EQ(grass->landUse, LandUseType::GRASSLAND);
+    EXPECT_NEAR(grass->elevation, 13.0, 1e-4);
+    EXPECT_NEAR(grass->roughness, 1.0, 1e-9);
+
+    auto water = store.lookup(40.0019, -74.0001);
+    ASSERT_TRUE(water.has_value());
+    EXPECT_EQ(water->landUse, LandUseType::WATER);
+
+    EXPECT_FALSE(store.lookup(40.0035, -74.0005).has_value());  // Same tile, no data
+    EXPECT_FALSE(store.lookup(10.0, 10.0).has_value());         // No tile
+}
+
+TEST_F(TerrainTilesTest, DerivesRoughnessAcrossTileEdges) {
+    writeCourse();
+    TerrainTileOptions options;
+    options.tileSize = 16;
+    ASSERT_TRUE(buildTerrainTiles({sourcePath}, tilePath, options).success);
+
+    TerrainTileStore store;
+    ASSERT_TRUE(store.open(tilePath));
+    EXPECT_EQ(store.getStats().tiles, 9u);
+
+    // Flat grass
+    EXPECT_NEAR(store.lookup(40.0105, -73.9895)->roughness, 0.0, 1e-9);
+    // Cell 32 spans 130-250 m over its neighbours, across the tile edge at 32
+    EXPECT_NEAR(store.lookup(40.0105, -73.9675)->roughness, 120.0, 1e-9);
+}
+
+TEST_F(TerrainTilesTest, KeepsRecentTilesDecoded) {
+    writeCourse();
+    TerrainTileOptions options;
+    options.tileSize = 16;
+    ASSERT_TRUE(buildTerrainTiles({sourcePath}, tilePath, options).success);
+
+    TerrainTileStore store(2);
+    ASSERT_TRUE(store.open(tilePath));
+    for (int i = 0; i < 10; ++i) {
+        store.lookup(40.0005, -73.9995);    // Tile A
+        store.lookup(40.0005, -73.9795);    // Tile B
+    }
+    TerrainTileStats stats = store.getStats();
+    EXPECT_EQ(stats.lookups, 20u);
+    EXPECT_EQ(stats.tileDecodes, 2u);
+    EXPECT_EQ(stats.tileHits, 18u);
+
+    store.lookup(40.0205, -73.9995);        // Tile C evicts A
+    store.lookup(40.0005, -73.9995);        // A decodes again
+    stats = store.getStats();
+    EXPECT_EQ(stats.tileDecodes, 4u);
+    EXPECT_EQ(stats.evictions, 2u);
+}
+
+TEST_F(TerrainTilesTest, RejectsForeignFiles) {
+    writeSource("not a tile file at all, just some text that is long enough\n");
+    TerrainTileStore store;
+    EXPECT_FALSE(store.open(sourcePath));
+    EXPECT_FALSE(store.open("missing.tiles"));
+    EXPECT_FALSE(store.isOpen());
+    EXPECT_FALSE(store.lookup(40.0, -74.0).has_value());
+
+    writeSource("lat,lon,land_use\n40.0,-74.0,water\n");
+    EXPECT_FALSE(buildTerrainTiles({sourcePath}, tilePath).success);
+}
+
+TEST_F(TerrainTilesTest, RejectsCorruptHeaders) {
+    writeCourse();
+    ASSERT_TRUE(buildTerrainTiles({sourcePath}, tilePath).success);
+
+    // tileSize and tileCount follow the magic, version and byte order mark
+    auto patchHeader = [&](std::streamoff offset, uint32_t value) {
+        std::fstream file(tilePath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    TerrainTileStore store;
+    ASSERT_TRUE(store.open(tilePath));
+    uint32_t tiles = static_cast<uint32_t>(store.getStats().tiles);
+
+    patchHeader(16, 8192);
+    EXPECT_FALSE(store.open(tilePath));
+    patchHeader(16, 64);
+    patchHeader(20, 0xFFFFFFFF);
+    EXPECT_FALSE(store.open(tilePath));
+    patchHeader(20, tiles + 1);
+    EXPECT_FALSE(store.open(tilePath));
+    patchHeader(20, tiles);
+    EXPECT_TRUE(store.open(tilePath));
+}
+
+TEST_F(TerrainTilesTest, AnalyzerReadsTerrainFromTiles) {
+    writeCourse();
+    ASSERT_TRUE(buildTerrainTiles({sourcePath}, tilePath).success);
+    auto store = std::make_shared<TerrainTileStore>();
+    ASSERT_TRUE(store->open(tilePath));
+
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    TerrainAnalyzer analyzer(storage, store);
+
+    TerrainAnalysis lake = analyzer.analyzeTerrain(40.0105, -73.9985);
+    EXPECT_EQ(lake.landUse, LandUseType::WATER);
+    EXPECT_DOUBLE_EQ(lake.params.roughnessLength, TerrainParameters::Water().roughnessLength);
+    EXPECT_FALSE(lake.isComplex);
+
+    TerrainAnalysis fairway = analyzer.analyzeTerrain(40.0105, -73.9895);
+    EXPECT_EQ(fairway.landUse, LandUseType::GRASSLAND);
+    EXPECT_NEAR(fairway.elevation, 10.0, 1e-4);
+
+    TerrainAnalysis ridge = analyzer.analyzeTerrain(40.0105, -73.9615);
+    EXPECT_EQ(ridge.landUse, LandUseType::FOREST);
+    EXPECT_TRUE(ridge.isComplex);
+    EXPECT_GT(ridge.elevation, 200.0);
+
+    WeatherData breeze{};
+    breeze.windSpeed = 5.0;
+    EXPECT_EQ(analyzer.recommendProfile(fairway, breeze), WindProfile::LOGARITHMIC);
+    EXPECT_EQ(analyzer.recommendProfile(ridge, breeze), WindProfile::POWER_LAW);
+
+    // Without tiles everything is open terrain
+    TerrainAnalyzer untiled(storage);
+    TerrainAnalysis unknown = untiled.analyzeTerrain(40.0105, -73.9615);
+    EXPECT_EQ(unknown.landUse, LandUseType::UNKNOWN);
+    EXPECT_DOUBLE_EQ(unknown.params.roughnessLength, TerrainParameters::OpenTerrain().roughnessLength);
+}
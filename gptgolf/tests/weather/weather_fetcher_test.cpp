@@ -0,0 +1,375 @@
+#include <gtest/gtest.h>
+#include "weather/weather_api.h"
+#include "weather/weather_fetcher.h"
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <thread>
+
+using namespace gptgolf::weather;
+using boost::asio::ip::tcp;
+
+// Local stand-in for the weather provider: HTTP/1.1 with keep-alive, an
+// optional delay before each reply, 500 for any path under /fail, and six
+// hourly samples from the current hour for any path under /forecast
+class MockWeatherServer {
+public:
+    MockWeatherServer() : acceptor_(io_context_, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        start_accept();
+        serverThread_ = std::thread([this]() {
+            io_context_.run();
+        });
+    }
+
+    ~MockWeatherServer() {
+        io_context_.stop();
+        serverThread_.join();
+    }
+
+    std::string url(const std::string& path = "/v4/weather/realtime") const {
+        return "http://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + path;
+    }
+
+    std::atomic<int> requests{0};
+    std::atomic<int> connections{0};
+    std::atomic<int> delayMs{0};
+    std::atomic<double> temperature{25.0};
+    std::atomic<int> forecastRequests{0};
+
+private:
+    struct Connection {
+        explicit Connection(boost::asio::io_context& io) : socket(io), timer(io) {}
+        tcp::socket socket;
+        boost::asio::steady_timer timer;
+        boost::asio::streambuf buffer;
+        std::string reply;
+    };
+
+    void start_accept() {
+        auto connection = std::make_shared<Connection>(io_context_);
+        acceptor_.async_accept(connection->socket,
+            [this, connection](boost::system::error_code ec) {
+                if (!ec) {
+                    connections++;
+                    start_read(connection);
+                }
+                start_accept();
+            });
+    }
+
+    void start_read(std::shared_ptr<Connection> connection) {
+        boost::asio::async_read_until(connection->socket, connection->buffer, "\r\n\r\n",
+            [this, connection](boost::system::error_code ec, std::size_t length) {
+                if (ec) return;
+                std::string head(boost::asio::buffers_begin(connection->buffer.data()),
+                                 boost::asio::buffers_begin(connection->buffer.data()) + length);
+                connection->buffer.consume(length);
+                requests++;
+
+                if (head.find("GET /forecast") == 0) {
+                    forecastRequests++;
+                    connection->reply = makeForecastReply();
+                } else {
+                    connection->reply = makeReply(head.find("GET /fail") == 0);
+                }
+                connection->timer.expires_after(std::chrono::milliseconds(delayMs.load()));
+                connection->timer.async_wait([this, connection](boost::system::error_code) {
+                    boost::asio::async_write(connection->socket, boost::asio::buffer(connection->reply),
+                        [this, connection](boost::system::error_code ec, std::size_t) {
+                            if (!ec) start_read(connection);
+                        });
+                });
+            });
+    }
+
+    std::string makeReply(bool fail) const {
+        std::string status = fail ? "500 Internal Server Error" : "200 OK";
+        std::string body = fail ? "{}" :
+            "{\"data\":{\"values\":{\"temperature\":" + std::to_string(temperature.load()) +
+            ",\"humidity\":55.0,\"pressureSeaLevel\":1015.0,\"windSpeed\":4.0"
+            ",\"windDirection\":270.0,\"precipitationIntensity\":0.0}}}";
+        return wrapReply(status, body);
+    }
+
+    // Temperature rises 2° an hour from 10°; wind is 4 m/s from the west
+    std::string makeForecastReply() const {
+        std::time_t hour = std::time(nullptr) / 3600 * 3600;
+        std::string body = "{\"timelines\":{\"hourly\":[";
+        for (int i = 0; i < 6; ++i) {
+            std::time_t time = hour + i * 3600;
+            char iso[32];
+            std::strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&time));
+            body += std::string(i ? "," : "") + "{\"time\":\"" + iso + "\",\"values\":{\"temperature\":" +
+                    std::to_string(10 + 2 * i) + ",\"humidity\":50,\"pressureSeaLevel\":1013"
+                    ",\"windSpeed\":4.0,\"windDirection\":270}}";
+        }
+        body += "]}}";
+        return wrapReply("200 OK", body);
+    }
+
+    static std::string wrapReply(const std::string& status, const std::string& body) {
+        return "HTTP/1.1 " + status + "\r\n"
+               "Content-Type: application/json\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+               "\r\n" + body;
+    }
+
+    boost::asio::io_context io_context_;
+    tcp::acceptor acceptor_;
+    std::thread serverThread_;
+};
+
+HttpResponse getAndWait(WeatherFetcher& fetcher, const std::string& url) {
+    std::promise<HttpResponse> done;
+    fetcher.get(url, [&done](const HttpResponse& response) { done.set_value(response); });
+    return done.get_future().get();
+}
+
+TEST(WeatherFetcherTest, ReusesConnectionAcrossRequests) {
+    MockWeatherServer server;
+    WeatherFetcher fetcher;
+
+    for (int i = 0; i < 3; ++i) {
+        HttpResponse response = getAndWait(fetcher, server.url());
+        EXPECT_TRUE(response.ok) << response.error;
+        EXPECT_EQ(response.status, 200);
+        EXPECT_NE(response.body.find("temperature"), std::string::npos);
+    }
+
+    EXPECT_EQ(server.requests, 3);
+    EXPECT_EQ(server.connections, 1);
+    WeatherFetcherStats stats = fetcher.getStats();
+    EXPECT_EQ(stats.transfers, 3u);
+    EXPECT_EQ(stats.connectionsOpened, 1u);
+    EXPECT_EQ(stats.failures, 0u);
+}
+
+TEST(WeatherFetcherTest, ReportsHttpErrors) {
+    MockWeatherServer server;
+    WeatherFetcher fetcher;
+
+    HttpResponse response = getAndWait(fetcher, server.url("/fail"));
+    EXPECT_FALSE(response.ok);
+    EXPECT_EQ(response.status, 500);
+    EXPECT_FALSE(response.error.empty());
+    EXPECT_EQ(fetcher.getStats().failures, 1u);
+}
+
+TEST(WeatherFetcherTest, RunsRequestsConcurrently) {
+    MockWeatherServer server;
+    server.delayMs = 300;
+    WeatherFetcher fetcher;
+
+    std::atomic<int> completed{0};
+    std::promise<void> allDone;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        fetcher.get(server.url(), [&](const HttpResponse& response) {
+            EXPECT_TRUE(response.ok);
+            if (++completed == 4) allDone.set_value();
+        });
+    }
+    allDone.get_future().wait();
+
+    // Four delayed replies in parallel take about one delay, not four
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+}
+
+class WeatherAPIAsyncTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_weather_async.db";
+        std::filesystem::remove(dbPath);
+        storage.initialize(dbPath);
+        api = std::make_unique<WeatherAPI>(storage);
+        api->initialize("test_api_key");
+        api->setEndpoint(server.url());
+        api->setForecastEndpoint(server.url("/forecast"));
+    }
+
+    void TearDown() override {
+        api.reset();
+        std::filesystem::remove(dbPath);
+    }
+
+    WeatherData createStoredData(double temp, int ageMinutes) {
+        WeatherData data{};
+        data.temperature = temp;
+        data.humidity = 65.0;
+        data.pressure = 1013.25;
+        data.windSpeed = 5.0;
+        data.windDirection = 180.0;
+        data.timestamp = std::time(nullptr) - ageMinutes * 60;
+        return data;
+    }
+
+    MockWeatherServer server;
+    std::string dbPath;
+    WeatherStorage storage;
+    std::unique_ptr<WeatherAPI> api;
+    const double testLat = 40.7128;
+    const double testLon = -74.0060;
+};
+
+TEST_F(WeatherAPIAsyncTest, FetchesAndStoresWhenNothingStored) {
+    WeatherData data;
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 25.0);
+
+    auto stored = storage.getWeatherData(testLat, testLon);
+    ASSERT_TRUE(stored.has_value());
+    EXPECT_DOUBLE_EQ(stored->temperature, 25.0);
+    EXPECT_EQ(server.requests, 1);
+}
+
+TEST_F(WeatherAPIAsyncTest, CoalescesConcurrentRequestsForSameLocation) {
+    server.delayMs = 200;
+
+    std::vector<std::shared_future<std::optional<WeatherData>>> futures;
+    for (int i = 0; i < 5; ++i) {
+        futures.push_back(api->fetchCurrentWeatherAsync(testLat, testLon));
+    }
+    auto other = api->fetchCurrentWeatherAsync(testLat + 1.0, testLon);
+
+    for (auto& future : futures) {
+        auto result = future.get();
+        ASSERT_TRUE(result.has_value());
+        EXPECT_DOUBLE_EQ(result->temperature, 25.0);
+    }
+    EXPECT_TRUE(other.get().has_value());
+
+    EXPECT_EQ(server.requests, 2);
+    WeatherAPI::FetchStats stats = api->getFetchStats();
+    EXPECT_EQ(stats.requests, 2u);
+    EXPECT_EQ(stats.coalesced, 4u);
+
+    // Once the call completes, a new request fetches again
+    EXPECT_TRUE(api->fetchCurrentWeatherAsync(testLat, testLon).get().has_value());
+    EXPECT_EQ(server.requests, 3);
+}
+
+TEST_F(WeatherAPIAsyncTest, FreshDataSkipsTheAPI) {
+    storage.storeWeatherData(testLat, testLon, createStoredData(10.0, 5));
+
+    WeatherData data;
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 10.0);
+    EXPECT_EQ(server.requests, 0);
+}
+
+TEST_F(WeatherAPIAsyncTest, ServesStaleDataWhileRevalidating) {
+    server.delayMs = 200;
+    storage.storeWeatherData(testLat, testLon,
+                             createStoredData(10.0, WeatherAPI::REFRESH_AHEAD_MINUTES + 5));
+
+    auto start = std::chrono::steady_clock::now();
+    WeatherData data;
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 10.0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+    EXPECT_EQ(api->getFetchStats().staleServed, 1u);
+
+    // The refresh is in flight; joining it waits for the new reading
+    auto refreshed = api->fetchCurrentWeatherAsync(testLat, testLon).get();
+    ASSERT_TRUE(refreshed.has_value());
+    EXPECT_DOUBLE_EQ(refreshed->temperature, 25.0);
+    EXPECT_EQ(server.requests, 1);
+
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 25.0);
+}
+
+TEST_F(WeatherAPIAsyncTest, ExpiredDataWaitsForTheAPI) {
+    storage.storeWeatherData(testLat, testLon,
+                             createStoredData(10.0, WeatherAPI::MAX_CACHE_AGE_MINUTES + 5));
+
+    WeatherData data;
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 25.0);
+    EXPECT_EQ(api->getFetchStats().staleServed, 0u);
+}
+
+TEST_F(WeatherAPIAsyncTest, FallsBackToOfflineDataWhenTheAPIFails) {
+    api->setEndpoint(server.url("/fail"));
+    std::time_t now = std::time(nullptr);
+    storage.storeTypicalWeather(testLat, testLon, std::localtime(&now)->tm_mon + 1,
+                                createStoredData(10.0, 0));
+
+    WeatherData data;
+    ASSERT_TRUE(api->getCurrentWeather(testLat, testLon, data));
+    EXPECT_DOUBLE_EQ(data.temperature, 10.0);
+    EXPECT_EQ(api->getFetchStats().transport.failures, 1u);
+}
+
+TEST_F(WeatherAPIAsyncTest, ForecastIsFetchedOnceAndInterpolated) {
+    std::time_t hour = std::time(nullptr) / 3600 * 3600;
+
+    // Tee times every ten minutes for the next four hours
+    for (int minutes = 0; minutes <= 240; minutes += 10) {
+        WeatherData data;
+        ASSERT_TRUE(api->getForecastWeather(testLat, testLon, hour + minutes * 60, data));
+        EXPECT_NEAR(data.temperature, 10.0 + 2.0 * minutes / 60.0, 1e-4);
+        EXPECT_NEAR(data.windSpeed, 4.0, 1e-4);
+        EXPECT_NEAR(data.windDirection, 270.0, 1e-3);
+        EXPECT_EQ(data.timestamp, hour + minutes * 60);
+    }
+
+    // A tee box a few metres away shares the cell and the forecast
+    WeatherData data;
+    ASSERT_TRUE(api->getForecastWeather(testLat + 0.0001, testLon, hour + 1800, data));
+
+    EXPECT_EQ(server.forecastRequests, 1);
+    WeatherAPI::FetchStats stats = api->getFetchStats();
+    EXPECT_EQ(stats.forecastRequests, 1u);
+    EXPECT_EQ(stats.forecastHits, 25u);
+
+    // Beyond the forecast horizon
+    EXPECT_FALSE(api->getForecastWeather(testLat, testLon, hour + 6 * 3600, data));
+    EXPECT_EQ(server.forecastRequests, 1);
+}
+
+TEST_F(WeatherAPIAsyncTest, CoalescesConcurrentForecastRequests) {
+    server.delayMs = 200;
+    std::vector<std::shared_future<std::shared_ptr<const ForecastTimeline>>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(api->fetchForecastAsync(testLat, testLon));
+    }
+    for (auto& future : futures) {
+        auto timeline = future.get();
+        ASSERT_TRUE(timeline);
+        EXPECT_EQ(timeline->size(), 6u);
+    }
+    EXPECT_EQ(server.forecastRequests, 1);
+    EXPECT_EQ(api->getFetchStats().coalesced, 3u);
+}
+
+TEST_F(WeatherAPIAsyncTest, ForecastFailsCleanlyWhenTheAPIFails) {
+    api->setForecastEndpoint(server.url("/fail"));
+    WeatherData data;
+    EXPECT_FALSE(api->getForecastWeather(testLat, testLon, std::time(nullptr), data));
+    EXPECT_FALSE(api->fetchForecastAsync(testLat, testLon).get());
+}
+
+TEST_F(WeatherAPIAsyncTest, DestroyingWithRequestsInFlightFailsThem) {
+    server.delayMs = 2000;
+    auto current = api->fetchCurrentWeatherAsync(testLat, testLon);
+    auto forecast = api->fetchForecastAsync(testLat, testLon);
+    while (server.requests < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    api.reset();
+    ASSERT_EQ(current.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_FALSE(current.get().has_value());
+    EXPECT_FALSE(forecast.get());
+}
+
+TEST(WeatherFetcherTest, RequestsAfterStopFailAtOnce) {
+    WeatherFetcher fetcher;
+    fetcher.stop();
+    std::string error;
+    fetcher.get("http://127.0.0.1:1/", [&](const HttpResponse& response) { error = response.error; });
+    EXPECT_EQ(error, "fetcher stopped");
+}
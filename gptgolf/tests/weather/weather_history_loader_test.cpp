@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "weather/weather_history_loader.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace gptgolf::weather;
+
+class WeatherHistoryLoaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_weather_history.db";
+        historyPath = "test_weather_history.txt";
+        std::filesystem::remove(dbPath);
+        ASSERT_TRUE(storage.initialize(dbPath));
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove(historyPath);
+    }
+
+    void writeHistory(const std::string& contents) {
+        std::ofstream out(historyPath, std::ios::binary);
+        out << contents;
+    }
+
+    // Hourly readings for two stations over January and February 2023
+    static std::string largeCsv(size_t hours) {
+        std::string csv = "timestamp,lat,lon,temp,humidity,pressure,wind_speed,wind_direction\n";
+        for (size_t i = 0; i < hours; ++i) {
+            for (int station = 0; station < 2; ++station) {
+                csv += std::to_string(1672531200 + i * 3600) + "," +
+                       (station ? "36.5686,-121.9508," : "33.5031,-82.0206,") +
+                       std::to_string(5 + i % 10) + ",60,1012," + std::to_string(i % 8) + "," +
+                       std::to_string((i * 15) % 360) + "\n";
+            }
+        }
+        return csv;
+    }
+
+    int countRows(const std::string& table) {
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_stmt* stmt;
+        std::string sql = "SELECT COUNT(*) FROM " + table;
+        sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return count;
+    }
+
+    std::string dbPath;
+    std::string historyPath;
+    WeatherStorage storage;
+};
+
+TEST_F(WeatherHistoryLoaderTest, LoadsCsvAndBuildsMonthlyClimatology) {
+    writeHistory(
+        "Date,Latitude,Longitude,Temperature,Humidity,Pressure,Wind Speed,Wind Direction,Station\n"
+        "2023-06-01 12:00:00,40.0,-74.0,20.0,50,1010,4.0,350,KNYC\n"
+        "2023-06-15 12:00:00,40.0,-74.0,24.0,70,1014,6.0,10,KNYC\n"
+        "2023-07-01 12:00:00,40.0,-74.0,30.0,80,1008,2.0,180,KNYC\n"
+        "2023-07-02 12:00:00,40.0,-74.0,99.0,80,1008,2.0,180,KNYC\n"     // Too hot to be real
+        "2023-07-03 12:00:00,,-74.0,25.0,80,1008,2.0,180,KNYC\n");       // No latitude
+
+    WeatherHistoryLoader loader(storage);
+    HistoryLoadReport report = loader.loadFile(historyPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsRead, 5u);
+    EXPECT_EQ(report.rowsLoaded, 3u);
+    EXPECT_EQ(report.rowsRejected, 2u);
+    EXPECT_EQ(report.climatologyRows, 2u);
+    EXPECT_GT(report.rowsPerSecond(), 0.0);
+    EXPECT_EQ(countRows("weather_data"), 3);
+
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "SELECT temperature, humidity, pressure, wind_speed, wind_direction "
+                           "FROM typical_weather WHERE month = 6", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 0), 22.0);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 1), 60.0);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 2), 1012.0);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 3), 5.0);
+    // 350° and 10° average to north, not south
+    double direction = sqlite3_column_double(stmt, 4);
+    EXPECT_NEAR(std::min(direction, 360.0 - direction), 0.0, 1e-6);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+TEST_F(WeatherHistoryLoaderTest, LoadsNdjson) {
+    writeHistory(
+        "{\"time\": 1672531200, \"lat\": 51.5, \"lng\": -0.12, \"temperature\": 7.5, \"windSpeed\": 3}\n"
+        "{\"time\": \"2023-01-01T01:00:00\", \"lat\": 51.5, \"lng\": -0.12, \"temperature\": 6.5}\n"
+        "not json\n");
+
+    WeatherHistoryLoader loader(storage);
+    HistoryLoadReport report = loader.loadFile(historyPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.rowsLoaded, 2u);
+    EXPECT_EQ(report.rowsRejected, 1u);
+
+    auto latest = storage.getWeatherData(51.5, -0.12);
+    ASSERT_TRUE(latest.has_value());
+    EXPECT_EQ(latest->timestamp, 1672534800);
+    EXPECT_DOUBLE_EQ(latest->temperature, 6.5);
+    EXPECT_DOUBLE_EQ(latest->pressure, 1013.25);
+}
+
+TEST_F(WeatherHistoryLoaderTest, ParallelChunksMatchSingleThreadedParse) {
+    std::string csv = largeCsv(24 * 59);
+
+    HistoryLoadOptions serialOptions;
+    serialOptions.threads = 1;
+    HistoryLoadReport serialReport;
+    std::vector<TypicalWeatherRow> serialClimatology;
+    auto serial = WeatherHistoryLoader(storage, serialOptions)
+                      .parse(csv.data(), csv.size(), serialReport, &serialClimatology);
+
+    HistoryLoadOptions parallelOptions;
+    parallelOptions.threads = 4;
+    parallelOptions.chunkBytes = 4096;
+    HistoryLoadReport parallelReport;
+    std::vector<TypicalWeatherRow> parallelClimatology;
+    auto parallel = WeatherHistoryLoader(storage, parallelOptions)
+                        .parse(csv.data(), csv.size(), parallelReport, &parallelClimatology);
+
+    ASSERT_EQ(serial.size(), 24u * 59 * 2);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].data.timestamp, serial[i].data.timestamp);
+        EXPECT_DOUBLE_EQ(parallel[i].latitude, serial[i].latitude);
+    }
+
+    // Two stations, January and February
+    ASSERT_EQ(serialClimatology.size(), 4u);
+    ASSERT_EQ(parallelClimatology.size(), 4u);
+    for (size_t i = 0; i < serialClimatology.size(); ++i) {
+        EXPECT_EQ(parallelClimatology[i].month, serialClimatology[i].month);
+        EXPECT_NEAR(parallelClimatology[i].data.temperature, serialClimatology[i].data.temperature, 1e-9);
+        EXPECT_NEAR(parallelClimatology[i].data.windSpeed, serialClimatology[i].data.windSpeed, 1e-9);
+    }
+}
+
+TEST_F(WeatherHistoryLoaderTest, RejectsFilesWithoutRequiredColumns) {
+    writeHistory("timestamp,temperature\n1672531200,5.0\n");
+    WeatherHistoryLoader loader(storage);
+    HistoryLoadReport report = loader.loadFile(historyPath);
+    EXPECT_FALSE(report.success);
+    EXPECT_FALSE(report.error.empty());
+    EXPECT_FALSE(loader.loadFile("missing_history.csv").success);
+}
+
+TEST_F(WeatherHistoryLoaderTest, ClimatologyAccumulatesAcrossFiles) {
+    WeatherHistoryLoader loader(storage);
+    writeHistory(
+        "timestamp,lat,lon,temp,humidity,wind_speed,wind_direction\n"
+        "2021-06-10 12:00:00,40.0,-74.0,20.0,50,2.0,350\n"
+        "2021-06-20 12:00:00,40.0,-74.0,22.0,50,4.0,350\n");
+    ASSERT_TRUE(loader.loadFile(historyPath).success);
+
+    writeHistory(
+        "timestamp,lat,lon,temp,humidity,wind_speed,wind_direction\n"
+        "2022-06-10 12:00:00,40.0,-74.0,30.0,80,6.0,10\n");
+    HistoryLoadReport report = loader.loadFile(historyPath);
+    ASSERT_TRUE(report.success) << report.error;
+    EXPECT_EQ(report.climatologyRows, 1u);
+    EXPECT_EQ(countRows("typical_weather"), 1);
+
+    // Means over all three Junes, not just the last file
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "SELECT temperature, humidity, wind_speed, wind_direction "
+                           "FROM typical_weather WHERE month = 6", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 0), 24.0);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 1), 60.0);
+    EXPECT_DOUBLE_EQ(sqlite3_column_double(stmt, 2), 4.0);
+    double direction = sqlite3_column_double(stmt, 3);
+    EXPECT_GT(direction, 350.0);
+    EXPECT_LT(direction, 360.0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+TEST_F(WeatherHistoryLoaderTest, ReloadingHistoryCountsObservationsOnce) {
+    WeatherHistoryLoader loader(storage);
+    writeHistory(
+        "timestamp,lat,lon,temp,humidity,wind_speed,wind_direction\n"
+        "2021-06-10 12:00:00,40.0,-74.0,10.0,50,2.0,90\n"
+        "2021-06-20 12:00:00,40.0,-74.0,20.0,50,2.0,90\n");
+    ASSERT_TRUE(loader.loadFile(historyPath).success);
+    ASSERT_TRUE(loader.loadFile(historyPath).success);
+
+    // A corrected reading replaces the one stored for the same hour
+    writeHistory(
+        "timestamp,lat,lon,temp,humidity,wind_speed,wind_direction\n"
+        "2021-06-20 12:00:00,40.0,-74.0,26.0,50,2.0,90\n"
+        "2022-06-10 12:00:00,40.0,-74.0,30.0,50,2.0,90\n");
+    ASSERT_TRUE(loader.loadFile(historyPath).success);
+    EXPECT_EQ(countRows("weather_data"), 3);
+
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "SELECT temperature, wind_direction FROM typical_weather WHERE month = 6",
+                       -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_NEAR(sqlite3_column_double(stmt, 0), 22.0, 1e-9);
+    EXPECT_NEAR(sqlite3_column_double(stmt, 1), 90.0, 1e-9);
+    sqlite3_finalize(stmt);
+    sqlite3_prepare_v2(db, "SELECT count FROM typical_weather_sums WHERE month = 6", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 3);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
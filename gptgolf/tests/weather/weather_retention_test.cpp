@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "weather/weather_retention.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <thread>
+
+using namespace gptgolf::weather;
+
+class WeatherRetentionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_weather_retention.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    // One reading per hour for the given number of hours, ending at NOW
+    static std::vector<WeatherObservation> history(int hours) {
+        std::vector<WeatherObservation> rows;
+        for (int hour = 0; hour < hours; ++hour) {
+            WeatherData data{};
+            data.temperature = 20.0;
+            data.humidity = 60.0;
+            data.pressure = 1012.0;
+            data.windSpeed = 4.0;
+            data.windDirection = (hour % 36) * 10.0;
+            data.timestamp = NOW - (hours - 1 - hour) * 3600;
+            rows.push_back({40.0 + (hour % 7) * 0.01, -74.0, data});
+        }
+        return rows;
+    }
+
+    int countRows(const std::string& sql) {
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return count;
+    }
+
+    static constexpr std::time_t NOW = 1686830400;    // 2023-06-15 12:00:00 UTC
+    static constexpr std::time_t DAY = 24 * 3600;
+    std::string dbPath;
+};
+
+TEST_F(WeatherRetentionTest, ClearOldDataReleasesPages) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    EXPECT_TRUE(storage.incrementalVacuumEnabled());
+
+    auto rows = history(24 * 60);
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 512), rows.size());
+    auto sizeBefore = std::filesystem::file_size(dbPath);
+
+    storage.clearOldData(NOW - 10 * DAY);
+    EXPECT_EQ(countRows("SELECT COUNT(*) FROM weather_data"), 24 * 10 + 1);
+    EXPECT_EQ(countRows("SELECT COUNT(*) FROM weather_data WHERE timestamp < " +
+                        std::to_string(NOW - 10 * DAY)), 0);
+    EXPECT_EQ(storage.freePageCount(), 0);
+    EXPECT_LT(std::filesystem::file_size(dbPath), sizeBefore);
+}
+
+TEST_F(WeatherRetentionTest, PassesStayWithinTheRowBudget) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    auto rows = history(24 * 40);
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 512), rows.size());
+
+    RetentionOptions options;
+    options.maxAge = std::chrono::seconds(10 * DAY);
+    options.maxRowsPerPass = 300;
+    options.stepInterval = std::chrono::milliseconds(0);
+    WeatherRetention retention(storage, options, false);
+
+    // 719 expired rows take three budgeted passes
+    EXPECT_EQ(retention.runPass(NOW), 300u);
+    EXPECT_EQ(retention.runPass(NOW), 300u);
+    EXPECT_EQ(retention.runPass(NOW), 119u);
+    EXPECT_EQ(retention.runPass(NOW), 0u);
+    EXPECT_EQ(countRows("SELECT COUNT(*) FROM weather_data"), 24 * 10 + 1);
+
+    // The oldest rows went first and the rollup followed them
+    EXPECT_EQ(countRows("SELECT MIN(timestamp) FROM weather_data"), NOW - 10 * DAY);
+    EXPECT_EQ(countRows("SELECT SUM(count) FROM weather_monthly_rollup"), 24 * 10 + 1);
+
+    auto progress = retention.progress();
+    EXPECT_EQ(progress.passes, 4u);
+    EXPECT_EQ(progress.rowsDeleted, 719u);
+    EXPECT_GT(progress.steps, 4u);
+    EXPECT_GT(progress.pagesReleased, 0u);
+    EXPECT_TRUE(progress.incrementalVacuum);
+    EXPECT_EQ(storage.freePageCount(), 0);
+}
+
+TEST_F(WeatherRetentionTest, SkipsPassesOutsideActiveHours) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    auto rows = history(24 * 20);
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 512), rows.size());
+
+    std::time_t now = NOW;
+    std::tm local = *std::localtime(&now);
+
+    // Every hour but the current one
+    RetentionOptions options;
+    options.maxAge = std::chrono::seconds(10 * DAY);
+    options.stepInterval = std::chrono::milliseconds(0);
+    options.activeFromHour = (local.tm_hour + 1) % 24;
+    options.activeUntilHour = local.tm_hour;
+    WeatherRetention retention(storage, options, false);
+
+    EXPECT_EQ(retention.runPass(NOW), 0u);
+    EXPECT_EQ(retention.progress().skippedPasses, 1u);
+    EXPECT_EQ(retention.progress().passes, 0u);
+
+    EXPECT_EQ(retention.runPass(NOW + 3600), 240u);
+    EXPECT_EQ(retention.progress().passes, 1u);
+}
+
+TEST_F(WeatherRetentionTest, RunsInTheBackground) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    auto rows = history(24 * 3);
+    // Shift the history back so part of it is older than a day by wall clock
+    std::time_t shift = std::time(nullptr) - NOW;
+    for (auto& row : rows) row.data.timestamp += shift;
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 512), rows.size());
+
+    RetentionOptions options;
+    options.maxAge = std::chrono::seconds(DAY);
+    options.passInterval = std::chrono::milliseconds(10);
+    options.stepInterval = std::chrono::milliseconds(0);
+    {
+        WeatherRetention retention(storage, options);
+        for (int i = 0; i < 200 && retention.progress().passes == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_GT(retention.progress().passes, 0u);
+    }
+    EXPECT_LE(countRows("SELECT COUNT(*) FROM weather_data"), 25);
+    EXPECT_GE(countRows("SELECT COUNT(*) FROM weather_data"), 24);
+}
+
+TEST_F(WeatherRetentionTest, ConvertsLegacyDatabases) {
+    {
+        // A database created before incremental vacuum was the default
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_exec(db, "PRAGMA auto_vacuum = NONE; CREATE TABLE legacy (id INTEGER);",
+                     nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+    }
+
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    EXPECT_FALSE(storage.incrementalVacuumEnabled());
+
+    auto rows = history(24 * 20);
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 512), rows.size());
+    storage.clearOldData(NOW - 10 * DAY);
+    EXPECT_GT(storage.freePageCount(), 0);
+    EXPECT_EQ(storage.releaseFreePages(100), 0);
+
+    ASSERT_TRUE(storage.enableIncrementalVacuum());
+    EXPECT_TRUE(storage.incrementalVacuumEnabled());
+    EXPECT_EQ(storage.freePageCount(), 0);
+    EXPECT_EQ(countRows("SELECT COUNT(*) FROM weather_data"), 24 * 10 + 1);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "weather/weather_storage.h"
+#include <sqlite3.h>
+#include <filesystem>
+
+using namespace gptgolf::weather;
+
+class WeatherRollupTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_weather_rollup.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    // 2023-06-15 12:00:00 UTC plus the given number of hours
+    static WeatherData reading(double temp, double windDirection, int hours = 0) {
+        WeatherData data{};
+        data.temperature = temp;
+        data.humidity = 60.0;
+        data.pressure = 1012.0;
+        data.windSpeed = temp / 4.0;
+        data.windDirection = windDirection;
+        data.timestamp = 1686830400 + hours * 3600;
+        return data;
+    }
+
+    int countRows(const std::string& table) {
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_stmt* stmt;
+        std::string sql = "SELECT COUNT(*) FROM " + table;
+        sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return count;
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(WeatherRollupTest, SumsByMonthAndDirectionBin) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    storage.storeWeatherData(40.0, -74.0, reading(20.0, 5.0, 0));
+    storage.storeWeatherData(40.0, -74.0, reading(24.0, 8.0, 1));
+    storage.storeWeatherData(40.0, -74.0, reading(28.0, 355.0, 2));
+    storage.storeWeatherData(40.0, -74.0, reading(50.0, 90.0, 24 * 30));   // July
+    storage.storeWeatherData(41.0, -74.0, reading(10.0, 90.0, 0));         // Elsewhere
+
+    auto june = storage.getHistoricalStats(40.0, -74.0, 6);
+    ASSERT_TRUE(june.has_value());
+    EXPECT_DOUBLE_EQ(june->avgTemperature, 24.0);
+    EXPECT_DOUBLE_EQ(june->avgWindSpeed, 6.0);
+    EXPECT_DOUBLE_EQ(june->avgHumidity, 60.0);
+    ASSERT_EQ(june->windDirectionFrequency.size(), 36u);
+    EXPECT_DOUBLE_EQ(june->windDirectionFrequency[0], 2.0);
+    EXPECT_DOUBLE_EQ(june->windDirectionFrequency[35], 1.0);
+    EXPECT_DOUBLE_EQ(june->windDirectionFrequency[9], 0.0);
+
+    auto july = storage.getHistoricalStats(40.0, -74.0, 7);
+    ASSERT_TRUE(july.has_value());
+    EXPECT_DOUBLE_EQ(july->avgTemperature, 50.0);
+
+    EXPECT_FALSE(storage.getHistoricalStats(40.0, -74.0, 8).has_value());
+    EXPECT_EQ(countRows("weather_monthly_rollup"), 4);
+}
+
+TEST_F(WeatherRollupTest, FollowsReplacesAndDeletes) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    storage.storeWeatherData(40.0, -74.0, reading(20.0, 5.0, 0));
+    storage.storeWeatherData(40.0, -74.0, reading(30.0, 95.0, 1));
+    // Same location and time, so it replaces the first reading and its bin
+    storage.storeWeatherData(40.0, -74.0, reading(40.0, 95.0, 0));
+
+    auto stats = storage.getHistoricalStats(40.0, -74.0, 6);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_DOUBLE_EQ(stats->avgTemperature, 35.0);
+    EXPECT_DOUBLE_EQ(stats->windDirectionFrequency[0], 0.0);
+    EXPECT_DOUBLE_EQ(stats->windDirectionFrequency[9], 2.0);
+    EXPECT_EQ(countRows("weather_monthly_rollup"), 1);
+
+    storage.clearOldData(1686830400 + 24 * 3600);
+    EXPECT_FALSE(storage.getHistoricalStats(40.0, -74.0, 6).has_value());
+    EXPECT_EQ(countRows("weather_monthly_rollup"), 0);
+}
+
+TEST_F(WeatherRollupTest, BulkLoadsAreSummarized) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+
+    std::vector<WeatherObservation> rows;
+    for (int hour = 0; hour < 240; ++hour) {
+        rows.push_back({40.0, -74.0, reading(hour % 2 ? 30.0 : 10.0, (hour % 36) * 10.0, hour)});
+    }
+    ASSERT_EQ(storage.bulkStoreWeatherData(rows, 64), rows.size());
+
+    auto stats = storage.getHistoricalStats(40.0, -74.0, 6);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_DOUBLE_EQ(stats->avgTemperature, 20.0);
+    double total = 0.0;
+    for (double frequency : stats->windDirectionFrequency) total += frequency;
+    EXPECT_DOUBLE_EQ(total, 240.0);
+}
+
+TEST_F(WeatherRollupTest, BackfillsDatabasesWithoutRollup) {
+    {
+        WeatherStorage storage;
+        ASSERT_TRUE(storage.initialize(dbPath));
+        storage.storeWeatherData(40.0, -74.0, reading(18.0, 180.0));
+        storage.storeWeatherData(40.0, -74.0, reading(22.0, 185.0, 1));
+    }
+
+    // Simulate a database written before the rollup existed
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_exec(db, R"(
+        DROP TRIGGER weather_data_rollup_insert;
+        DROP TRIGGER weather_data_rollup_delete;
+        DROP TABLE weather_monthly_rollup;
+    )", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    EXPECT_EQ(countRows("weather_monthly_rollup"), 1);
+    auto stats = storage.getHistoricalStats(40.0, -74.0, 6);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_DOUBLE_EQ(stats->avgTemperature, 20.0);
+    EXPECT_DOUBLE_EQ(stats->windDirectionFrequency[18], 2.0);
+}
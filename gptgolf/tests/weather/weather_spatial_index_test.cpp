@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "weather/weather_storage.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <ctime>
+
+using namespace gptgolf::weather;
+
+class WeatherSpatialIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_weather_spatial.db";
+        std::filesystem::remove(dbPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    static WeatherData reading(double temp, std::time_t timestamp = std::time(nullptr)) {
+        WeatherData data{};
+        data.temperature = temp;
+        data.humidity = 65.0;
+        data.pressure = 1013.25;
+        data.windSpeed = 5.0;
+        data.windDirection = 180.0;
+        data.timestamp = timestamp;
+        return data;
+    }
+
+    int countRows(const std::string& table) {
+        sqlite3* db;
+        sqlite3_open(dbPath.c_str(), &db);
+        sqlite3_stmt* stmt;
+        std::string sql = "SELECT COUNT(*) FROM " + table;
+        sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return count;
+    }
+
+    std::string dbPath;
+};
+
+TEST_F(WeatherSpatialIndexTest, FindsClosestOfManyStations) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+
+    // A grid of stations about 1.1 km apart
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 20; ++j) {
+            storage.storeWeatherData(40.0 + i * 0.01, -74.0 + j * 0.01, reading(i * 100 + j));
+        }
+    }
+
+    auto nearest = storage.getNearestWeatherData(40.052, -73.931, 5.0);
+    ASSERT_TRUE(nearest.has_value());
+    EXPECT_DOUBLE_EQ(nearest->temperature, 5 * 100 + 7);
+}
+
+TEST_F(WeatherSpatialIndexTest, RefinesBoundingBoxByDistance) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+
+    // Inside the 10 km box around the origin but about 13 km away on the diagonal
+    storage.storeWeatherData(40.08, -73.905, reading(20.0));
+    EXPECT_FALSE(storage.getNearestWeatherData(40.0, -74.0, 10.0).has_value());
+    EXPECT_TRUE(storage.getNearestWeatherData(40.0, -74.0, 15.0).has_value());
+}
+
+TEST_F(WeatherSpatialIndexTest, IgnoresReadingsOlderThanAnHour) {
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+
+    storage.storeWeatherData(40.001, -74.0, reading(10.0, std::time(nullptr) - 7200));
+    storage.storeWeatherData(40.02, -74.0, reading(20.0));
+
+    auto nearest = storage.getNearestWeatherData(40.0, -74.0, 10.0);
+    ASSERT_TRUE(nearest.has_value());
+    EXPECT_DOUBLE_EQ(nearest->temperature, 20.0);
+}
+
+TEST_F(WeatherSpatialIndexTest, IndexFollowsReplacesAndDeletes) {
+    std::time_t now = std::time(nullptr);
+    {
+        WeatherStorage storage;
+        ASSERT_TRUE(storage.initialize(dbPath));
+        storage.storeWeatherData(40.0, -74.0, reading(10.0, now - 86400));
+        storage.storeWeatherData(40.0, -74.0, reading(12.0, now));
+        storage.storeWeatherData(40.0, -74.0, reading(14.0, now));   // Replaces the previous row
+        storage.storeWeatherData(41.0, -74.0, reading(16.0, now));
+    }
+    // The day-old row is too old to be indexed
+    EXPECT_EQ(countRows("weather_data"), 3);
+    EXPECT_EQ(countRows("weather_location_rtree"), 2);
+
+    {
+        WeatherStorage storage;
+        ASSERT_TRUE(storage.initialize(dbPath));
+        storage.clearOldData(now - 3600);
+        auto nearest = storage.getNearestWeatherData(40.0, -74.0, 1.0);
+        ASSERT_TRUE(nearest.has_value());
+        EXPECT_DOUBLE_EQ(nearest->temperature, 14.0);
+    }
+    EXPECT_EQ(countRows("weather_data"), 2);
+    EXPECT_EQ(countRows("weather_location_rtree"), 2);
+}
+
+TEST_F(WeatherSpatialIndexTest, BackfillsDatabasesWithoutIndex) {
+    {
+        WeatherStorage storage;
+        ASSERT_TRUE(storage.initialize(dbPath));
+        storage.storeWeatherData(40.0, -74.0, reading(18.0));
+    }
+
+    // Simulate a database written before the index existed
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_exec(db, R"(
+        DROP TRIGGER weather_data_rtree_insert_recent;
+        DROP TRIGGER weather_data_rtree_delete;
+        DROP TABLE weather_location_rtree;
+    )", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    WeatherStorage storage;
+    ASSERT_TRUE(storage.initialize(dbPath));
+    EXPECT_EQ(countRows("weather_location_rtree"), 1);
+    auto nearest = storage.getNearestWeatherData(40.01, -74.0, 5.0);
+    ASSERT_TRUE(nearest.has_value());
+    EXPECT_DOUBLE_EQ(nearest->temperature, 18.0);
+}
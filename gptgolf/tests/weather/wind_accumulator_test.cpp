@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "weather/terrain_analyzer.h"
+#include <sqlite3.h>
+#include <cmath>
+#include <filesystem>
+#include <numeric>
+
+using namespace gptgolf::weather;
+
+namespace {
+
+const std::time_t MIDNIGHT = 1686787200;    // 2023-06-15 00:00:00 UTC
+
+WindPattern pattern(double speed, double direction, double gust, std::time_t timestamp) {
+    WindPattern p;
+    p.speed = speed;
+    p.direction = direction;
+    p.gustSpeed = gust;
+    p.temperature = 20.0;
+    p.pressure = 1013.0;
+    p.timestamp = timestamp;
+    return p;
+}
+
+} // namespace
+
+TEST(WindAccumulatorTest, MatchesTwoPassStatistics) {
+    std::vector<double> speeds = {3.0, 5.5, 4.0, 8.0, 6.5, 2.0, 7.0};
+    WindAccumulator accumulator;
+    for (size_t i = 0; i < speeds.size(); ++i) {
+        accumulator.add(pattern(speeds[i], 90.0, speeds[i] * 1.4, MIDNIGHT + i));
+    }
+
+    double mean = std::accumulate(speeds.begin(), speeds.end(), 0.0) / speeds.size();
+    double squares = 0.0;
+    for (double speed : speeds) squares += (speed - mean) * (speed - mean);
+    double stdDev = std::sqrt(squares / (speeds.size() - 1));
+
+    EXPECT_EQ(accumulator.count, speeds.size());
+    EXPECT_NEAR(accumulator.meanSpeed, mean, 1e-12);
+    EXPECT_NEAR(accumulator.speedStdDev(), stdDev, 1e-12);
+    EXPECT_NEAR(accumulator.turbulenceIntensity(), stdDev / mean, 1e-12);
+    EXPECT_NEAR(accumulator.gustRatio(), 1.4, 1e-12);
+    EXPECT_DOUBLE_EQ(accumulator.maxSpeed, 8.0 * 1.4);
+    EXPECT_NEAR(accumulator.prevailingDirection(), 90.0, 1e-9);
+    EXPECT_NEAR(accumulator.directionStdDev(), 0.0, 1e-6);
+    EXPECT_EQ(accumulator.lastTimestamp, MIDNIGHT + 6);
+}
+
+TEST(WindAccumulatorTest, AveragesDirectionOnTheCircle) {
+    WindAccumulator accumulator;
+    accumulator.add(pattern(5.0, 350.0, 5.0, MIDNIGHT));
+    accumulator.add(pattern(5.0, 20.0, 5.0, MIDNIGHT + 1));
+    EXPECT_NEAR(accumulator.prevailingDirection(), 5.0, 1e-9);
+    EXPECT_GT(accumulator.directionStdDev(), 10.0);
+    EXPECT_LT(accumulator.directionStdDev(), 20.0);
+
+    WindAccumulator opposed;
+    opposed.add(pattern(5.0, 0.0, 5.0, MIDNIGHT));
+    opposed.add(pattern(5.0, 180.0, 5.0, MIDNIGHT + 1));
+    EXPECT_DOUBLE_EQ(opposed.directionStdDev(), 180.0);
+}
+
+TEST(WindAccumulatorTest, MergeEqualsSequentialAdds) {
+    WindAccumulator all, first, second;
+    for (int i = 0; i < 50; ++i) {
+        WindPattern p = pattern(2.0 + (i * 7) % 11, (i * 37) % 360, 3.0 + i % 5, MIDNIGHT + i);
+        all.add(p);
+        (i < 20 ? first : second).add(p);
+    }
+    first.merge(second);
+    first.merge(WindAccumulator());
+
+    EXPECT_EQ(first.count, all.count);
+    EXPECT_NEAR(first.meanSpeed, all.meanSpeed, 1e-12);
+    EXPECT_NEAR(first.m2Speed, all.m2Speed, 1e-9);
+    EXPECT_NEAR(first.prevailingDirection(), all.prevailingDirection(), 1e-9);
+    EXPECT_NEAR(first.meanGust, all.meanGust, 1e-12);
+    EXPECT_DOUBLE_EQ(first.maxSpeed, all.maxSpeed);
+}
+
+class WindPatternStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = "test_wind_stats.db";
+        std::filesystem::remove(dbPath);
+        ASSERT_TRUE(storage.initialize(dbPath));
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(dbPath);
+    }
+
+    std::string dbPath;
+    WeatherStorage storage;
+    const double lat = 36.5686;
+    const double lon = -121.9508;
+};
+
+TEST_F(WindPatternStatsTest, StoreUpdatesPerHourAccumulators) {
+    TerrainAnalyzer analyzer(storage);
+    // Thirty days of 08:00 and 14:00 readings
+    for (int day = 0; day < 30; ++day) {
+        std::time_t base = MIDNIGHT + day * 86400;
+        analyzer.storeWindPattern(lat, lon, pattern(3.0 + day % 3, 200.0, 5.0, base + 8 * 3600));
+        analyzer.storeWindPattern(lat, lon, pattern(8.0, 280.0, 12.0, base + 14 * 3600));
+    }
+    // A repeat of a stored observation is not counted twice
+    EXPECT_FALSE(storage.storeWindPattern(lat, lon, pattern(50.0, 0.0, 60.0, MIDNIGHT + 8 * 3600)));
+
+    auto morning = storage.getWindAccumulator(lat, lon, 8);
+    ASSERT_TRUE(morning.has_value());
+    EXPECT_EQ(morning->count, 30u);
+    EXPECT_NEAR(morning->meanSpeed, 4.0, 1e-12);
+    EXPECT_FALSE(storage.getWindAccumulator(lat, lon, 9).has_value());
+
+    auto typical = analyzer.getTypicalPatterns(lat, lon, 14);
+    ASSERT_EQ(typical.size(), 1u);
+    EXPECT_NEAR(typical[0].speed, 8.0, 1e-12);
+    EXPECT_NEAR(typical[0].direction, 280.0, 1e-9);
+    EXPECT_NEAR(typical[0].gustSpeed, 12.0, 1e-12);
+    EXPECT_TRUE(analyzer.getTypicalPatterns(lat, lon, 3).empty());
+
+    // A morning window sees only the 08:00 readings
+    auto window = analyzer.getWindStats(lat, lon, 7, 9);
+    ASSERT_TRUE(window.has_value());
+    EXPECT_NEAR(window->meanSpeed, 4.0, 1e-12);
+    EXPECT_NEAR(window->prevailingDirection, 200.0, 1e-9);
+    EXPECT_NEAR(window->gustFactor, 1.25, 1e-12);
+
+    // A full day sees both
+    auto day = analyzer.getWindStats(lat, lon, 0, 23);
+    ASSERT_TRUE(day.has_value());
+    EXPECT_NEAR(day->meanSpeed, 6.0, 1e-12);
+    EXPECT_DOUBLE_EQ(day->maxSpeed, 12.0);
+    EXPECT_GT(day->turbulenceIntensity, 0.0);
+
+    // Too little data in the window
+    EXPECT_FALSE(analyzer.getWindStats(lat, lon, 10, 11).has_value());
+
+    // An evening round past midnight wraps to the 08:00 readings; hours are 0-23
+    auto late = analyzer.getWindStats(lat, lon, 22, 8);
+    ASSERT_TRUE(late.has_value());
+    EXPECT_NEAR(late->meanSpeed, 4.0, 1e-12);
+    EXPECT_FALSE(analyzer.getWindStats(lat, lon, 0, 24).has_value());
+}
+
+TEST_F(WindPatternStatsTest, WeatherDataUsesSpeedAsGust) {
+    TerrainAnalyzer analyzer(storage);
+    WeatherData weather{};
+    weather.windSpeed = 6.0;
+    weather.windDirection = 45.0;
+    weather.temperature = 18.0;
+    weather.pressure = 1009.0;
+    weather.timestamp = MIDNIGHT + 12 * 3600;
+    analyzer.storeWindPattern(lat, lon, weather);
+
+    auto noon = storage.getWindAccumulator(lat, lon, 12);
+    ASSERT_TRUE(noon.has_value());
+    EXPECT_DOUBLE_EQ(noon->gustRatio(), 1.0);
+    EXPECT_DOUBLE_EQ(noon->meanTemperature, 18.0);
+}
+
+TEST_F(WindPatternStatsTest, BackfillsFromStoredPatterns) {
+    for (int i = 0; i < 12; ++i) {
+        storage.storeWindPattern(lat, lon, pattern(2.0 + i, 90.0, 4.0 + i, MIDNIGHT + i * 86400 + 6 * 3600));
+    }
+    auto before = storage.getWindAccumulator(lat, lon, 6);
+    ASSERT_TRUE(before.has_value());
+
+    // Simulate a database written before the statistics table existed
+    sqlite3* db;
+    sqlite3_open(dbPath.c_str(), &db);
+    sqlite3_exec(db, "DROP TABLE wind_pattern_stats", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    WeatherStorage reopened;
+    ASSERT_TRUE(reopened.initialize(dbPath));
+    auto after = reopened.getWindAccumulator(lat, lon, 6);
+    ASSERT_TRUE(after.has_value());
+    EXPECT_EQ(after->count, before->count);
+    EXPECT_NEAR(after->meanSpeed, before->meanSpeed, 1e-12);
+    EXPECT_NEAR(after->m2Speed, before->m2Speed, 1e-9);
+    EXPECT_DOUBLE_EQ(after->maxSpeed, before->maxSpeed);
+}